@@ -21,13 +21,222 @@
 #define BIOMETRY_DICTIONARY_H_
 
 #include <biometry/variant.h>
+#include <biometry/visibility.h>
 
-#include <map>
+#include <cstddef>
+#include <initializer_list>
+#include <iosfwd>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace biometry
 {
-typedef std::map<std::string, Variant> Dictionary;
+// Dictionary moved to a flat vector in v2, changing its layout and the one of
+// Progress. See variant.h for why it lives in the versioned namespace.
+inline namespace v2
+{
+/// @brief Dictionary maps string keys to Variant values.
+///
+/// Entries are kept in a vector sorted by key, keeping lookups cache-friendly and
+/// iteration order identical to a std::map. Keys created with Key::from_static refer to
+/// strings with static storage duration and are never copied. All lookups accept C strings,
+/// std::strings and Keys without creating a temporary Key.
+class BIOMETRY_DLL_PUBLIC Dictionary
+{
+public:
+    /// @brief Key names an entry, either referring to a static string or owning a copy of a string.
+    class BIOMETRY_DLL_PUBLIC Key
+    {
+    public:
+        /// @brief from_static returns a Key referring to s, which has to outlive all copies of the Key.
+        static Key from_static(const char* s);
+
+        /// @brief Key initializes a new instance with a copy of s.
+        explicit Key(const char* s);
+        /// @brief Key initializes a new instance with a copy of s.
+        explicit Key(const std::string& s);
+        /// @brief Key initializes a new instance, taking over s.
+        explicit Key(std::string&& s);
+
+        /// @brief c_str returns a pointer to the NUL-terminated key.
+        const char* c_str() const;
+        /// @brief size returns the length of the key.
+        std::size_t size() const;
+        /// @brief str returns a copy of the key.
+        std::string str() const;
+
+    private:
+        /// @cond
+        Key(const char* data, std::size_t size);
+
+        const char* static_data;
+        std::size_t static_size;
+        std::string owned;
+        /// @endcond
+    };
+
+    typedef Key key_type;
+    typedef Variant mapped_type;
+    typedef std::pair<Key, Variant> value_type;
+    typedef std::vector<value_type>::size_type size_type;
+    typedef std::vector<value_type>::iterator iterator;
+    typedef std::vector<value_type>::const_iterator const_iterator;
+
+    /// @brief Dictionary initializes an empty instance.
+    Dictionary() = default;
+    /// @brief Dictionary initializes an instance from values, later duplicates replace earlier ones.
+    Dictionary(std::initializer_list<value_type> values);
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+
+    /// @brief empty returns true if the instance does not contain any entries.
+    bool empty() const;
+    /// @brief size returns the number of entries.
+    size_type size() const;
+    /// @brief clear removes all entries, keeping the allocated memory around.
+    void clear();
+    /// @brief reserve preallocates memory for n entries.
+    void reserve(size_type n);
+
+    /// @brief operator[] returns the value known for key, inserting a default-constructed value if missing.
+    template<typename K>
+    Variant& operator[](K&& key);
+
+    /// @brief insert adds value if its key is not known yet.
+    /// @return An iterator to the entry for the key and true if value was inserted.
+    std::pair<iterator, bool> insert(value_type value);
+
+    /// @brief find returns an iterator to the entry for key, or end().
+    template<typename K>
+    iterator find(const K& key);
+    /// @brief find returns an iterator to the entry for key, or end().
+    template<typename K>
+    const_iterator find(const K& key) const;
+
+    /// @brief count returns 1 if key is known, 0 otherwise.
+    template<typename K>
+    size_type count(const K& key) const;
+
+    /// @brief at returns the value known for key.
+    /// @throws std::out_of_range if key is not known.
+    template<typename K>
+    Variant& at(const K& key);
+    /// @brief at returns the value known for key.
+    /// @throws std::out_of_range if key is not known.
+    template<typename K>
+    const Variant& at(const K& key) const;
+
+    /// @brief erase removes the entry for key, returning the number of removed entries.
+    template<typename K>
+    size_type erase(const K& key);
+    /// @brief erase removes the entry at it, returning an iterator to the next entry.
+    iterator erase(const_iterator it);
+
+private:
+    /// @cond
+    // View is a non-owning reference to a key, used for lookups.
+    struct View
+    {
+        const char* data;
+        std::size_t size;
+    };
+
+    static View view_of(const char* key);
+    static View view_of(const std::string& key);
+    static View view_of(const Key& key);
+
+    const_iterator lower_bound(View view) const;
+    iterator lower_bound(View view);
+    static bool equals(const Key& key, View view);
+    static void throw_out_of_range(View view);
+
+    std::vector<value_type> entries;
+    /// @endcond
+};
+}
+
+/// @brief operator== returns true if lhs and rhs refer to the same string.
+BIOMETRY_DLL_PUBLIC bool operator==(const Dictionary::Key& lhs, const Dictionary::Key& rhs);
+/// @brief operator< returns true if lhs sorts before rhs.
+BIOMETRY_DLL_PUBLIC bool operator<(const Dictionary::Key& lhs, const Dictionary::Key& rhs);
+/// @brief operator<< inserts key into out.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, const Dictionary::Key& key);
+
+/// @brief operator== returns true if lhs and rhs contain the same entries.
+BIOMETRY_DLL_PUBLIC bool operator==(const Dictionary& lhs, const Dictionary& rhs);
+/// @brief operator!= returns true if lhs and rhs differ in any entry.
+BIOMETRY_DLL_PUBLIC bool operator!=(const Dictionary& lhs, const Dictionary& rhs);
+}
+
+template<typename K>
+biometry::Variant& biometry::Dictionary::operator[](K&& key)
+{
+    auto view = view_of(key);
+    auto it = lower_bound(view);
+
+    if (it == entries.end() || not equals(it->first, view))
+        it = entries.emplace(it, Key{std::forward<K>(key)}, Variant{});
+
+    return it->second;
+}
+
+template<typename K>
+biometry::Dictionary::iterator biometry::Dictionary::find(const K& key)
+{
+    auto view = view_of(key);
+    auto it = lower_bound(view);
+    return (it != entries.end() && equals(it->first, view)) ? it : entries.end();
+}
+
+template<typename K>
+biometry::Dictionary::const_iterator biometry::Dictionary::find(const K& key) const
+{
+    auto view = view_of(key);
+    auto it = lower_bound(view);
+    return (it != entries.end() && equals(it->first, view)) ? it : entries.end();
+}
+
+template<typename K>
+biometry::Dictionary::size_type biometry::Dictionary::count(const K& key) const
+{
+    return find(key) == end() ? 0 : 1;
+}
+
+template<typename K>
+biometry::Variant& biometry::Dictionary::at(const K& key)
+{
+    auto it = find(key);
+    if (it == end())
+        throw_out_of_range(view_of(key));
+
+    return it->second;
+}
+
+template<typename K>
+const biometry::Variant& biometry::Dictionary::at(const K& key) const
+{
+    auto it = find(key);
+    if (it == end())
+        throw_out_of_range(view_of(key));
+
+    return it->second;
+}
+
+template<typename K>
+biometry::Dictionary::size_type biometry::Dictionary::erase(const K& key)
+{
+    auto it = find(key);
+    if (it == end())
+        return 0;
+
+    entries.erase(it);
+    return 1;
 }
 
 #endif // BIOMETRY_DICTIONARY_H_
@@ -28,6 +28,9 @@
 
 namespace biometry
 {
+// Progress embeds a Dictionary and thus shares its versioned namespace.
+inline namespace v2
+{
 /// @brief Progress bundles information about the current progress of an operation.
 struct BIOMETRY_DLL_PUBLIC Progress
 {
@@ -37,6 +40,7 @@ struct BIOMETRY_DLL_PUBLIC Progress
     Percent percent;         ///< Percent completed.
     Dictionary details;      ///< Extended information about the current state of the operation.
 };
+}
 
 /// @brief operator<< inserts progress into out.
 BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, const Progress& progress);
@@ -28,10 +28,21 @@
 #include <iosfwd>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <vector>
 
 namespace biometry
 {
+// Variant stores its value inline since v2, changing its size and layout. The
+// versioned namespace turns mixing binaries built against different layouts into
+// a link-time error instead of silent memory corruption. Keep it in sync with the
+// major version, which determines the soname and is checked for plugins.
+inline namespace v2
+{
+/// @brief Variant models a value of one of a fixed set of types.
+///
+/// Scalars and rectangles are stored inline, as are strings and vectors. The latter
+/// only allocate for their contents, with short strings kept in place, too.
 class BIOMETRY_DLL_PUBLIC Variant
 {
 public:
@@ -60,16 +71,21 @@ public:
 
     Variant();
     Variant(const Variant&);
+    Variant(Variant&&) noexcept;
     explicit Variant(bool b);
     explicit Variant(std::int64_t i);
     explicit Variant(double d);
     explicit Variant(const biometry::Rectangle& value);
     explicit Variant(const std::string& s);
+    explicit Variant(std::string&& s);
     explicit Variant(const std::vector<std::uint8_t>& b);
+    explicit Variant(std::vector<std::uint8_t>&& b);
     explicit Variant(const std::vector<Variant>& b);
+    explicit Variant(std::vector<Variant>&& b);
     ~Variant();
 
     Variant& operator=(const Variant&);
+    Variant& operator=(Variant&&) noexcept;
     bool operator==(const Variant&) const;
 
     std::ostream& print(std::ostream&) const;
@@ -98,9 +114,22 @@ public:
     void vector(const std::vector<Variant>& vector);
 
 private:
-    struct Private;
-    std::unique_ptr<Private> p;
+    /// @cond
+    // std::vector<Variant> has the same layout as std::vector<std::uint8_t>, which is
+    // checked when compiling the implementation.
+    typedef std::aligned_union<0, biometry::Rectangle, std::string, std::vector<std::uint8_t>>::type Storage;
+
+    template<typename T> T& as();
+    template<typename T> const T& as() const;
+    template<typename T> const T& checked_as(Type expected) const;
+    template<typename T, typename U> void assign(Type type, U&& value);
+    void reset();
+
+    Type type_;
+    Storage storage;
+    /// @endcond
 };
+}
 BIOMETRY_DLL_PUBLIC bool operator==(const Variant::None&, const Variant::None&);
 BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, const Variant::None&);
 BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, const Variant& v);
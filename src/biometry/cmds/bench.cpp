@@ -0,0 +1,473 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/cmds/bench.h>
+
+#include <biometry/cmds/test.h>
+
+#include <biometry/application.h>
+#include <biometry/identifier.h>
+#include <biometry/reason.h>
+#include <biometry/service.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <biometry/dbus/service.h>
+
+#include <biometry/util/json.hpp>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/bimap.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cmath>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace cli = biometry::util::cli;
+namespace json = nlohmann;
+
+namespace
+{
+typedef boost::bimap<biometry::cmds::Bench::Kind, std::string> KindLut;
+const KindLut& kind_lut()
+{
+    static const auto entries =
+    {
+        KindLut::value_type{biometry::cmds::Bench::Kind::identify, "identify"},
+        KindLut::value_type{biometry::cmds::Bench::Kind::verify, "verify"},
+        KindLut::value_type{biometry::cmds::Bench::Kind::size, "size"},
+        KindLut::value_type{biometry::cmds::Bench::Kind::list, "list"},
+        KindLut::value_type{biometry::cmds::Bench::Kind::enroll, "enroll"},
+        KindLut::value_type{biometry::cmds::Bench::Kind::remove, "remove"}
+    };
+    static const KindLut instance{entries.begin(), entries.end()};
+    return instance;
+}
+
+typedef boost::bimap<biometry::cmds::Bench::Format, std::string> FormatLut;
+const FormatLut& format_lut()
+{
+    static const auto entries =
+    {
+        FormatLut::value_type{biometry::cmds::Bench::Format::json, "json"},
+        FormatLut::value_type{biometry::cmds::Bench::Format::csv, "csv"}
+    };
+    static const FormatLut instance{entries.begin(), entries.end()};
+    return instance;
+}
+
+// WaitingObserver enables calling code to block until an operation reached a terminal state.
+template<typename T>
+class WaitingObserver : public biometry::Operation<T>::Observer
+{
+public:
+    typedef typename biometry::Operation<T>::Observer Super;
+
+    // wait_for returns false if the operation did not finish within timeout,
+    // and throws if the operation failed or has been canceled.
+    bool wait_for(const std::chrono::milliseconds& timeout)
+    {
+        if (future.wait_for(timeout) != std::future_status::ready)
+            return false;
+
+        future.get();
+        return true;
+    }
+
+    // From biometry::Operation<T>::Observer
+    void on_started() override
+    {
+    }
+
+    void on_progress(const typename Super::Progress&) override
+    {
+    }
+
+    void on_canceled(const typename Super::Reason& reason) override
+    {
+        promise.set_exception(std::make_exception_ptr(std::runtime_error{reason}));
+    }
+
+    void on_failed(const typename Super::Error& error) override
+    {
+        promise.set_exception(std::make_exception_ptr(std::runtime_error{error}));
+    }
+
+    void on_succeeded(const typename Super::Result&) override
+    {
+        promise.set_value();
+    }
+
+private:
+    std::promise<void> promise;
+    std::future<void> future{promise.get_future()};
+};
+
+template<typename T>
+void execute(const typename biometry::Operation<T>::Ptr& op, const std::chrono::milliseconds& timeout)
+{
+    auto observer = std::make_shared<WaitingObserver<T>>();
+    op->start_with_observer(observer);
+
+    if (observer->wait_for(timeout))
+        return;
+
+    try { op->cancel(); } catch (...) {}
+    throw std::runtime_error{"Operation timed out"};
+}
+
+void execute(biometry::cmds::Bench::Kind kind, biometry::Device& device, const biometry::User& user, const std::chrono::milliseconds& timeout)
+{
+    static const biometry::Reason reason{"benchmark"};
+    const auto app = biometry::Application::system();
+
+    switch (kind)
+    {
+    case biometry::cmds::Bench::Kind::identify:
+        execute<biometry::Identification>(device.identifier().identify_user(app, reason), timeout);
+        break;
+    case biometry::cmds::Bench::Kind::verify:
+        execute<biometry::Verification>(device.verifier().verify_user(app, user, reason), timeout);
+        break;
+    case biometry::cmds::Bench::Kind::size:
+        execute<biometry::TemplateStore::SizeQuery>(device.template_store().size(app, user), timeout);
+        break;
+    case biometry::cmds::Bench::Kind::list:
+        execute<biometry::TemplateStore::List>(device.template_store().list(app, user), timeout);
+        break;
+    case biometry::cmds::Bench::Kind::enroll:
+        execute<biometry::TemplateStore::Enrollment>(device.template_store().enroll(app, user), timeout);
+        break;
+    case biometry::cmds::Bench::Kind::remove:
+        // We do not track enrolled templates and thus exercise the code path for an unknown template.
+        execute<biometry::TemplateStore::Removal>(device.template_store().remove(app, user, 0), timeout);
+        break;
+    }
+}
+
+std::uint64_t successes_of(const biometry::cmds::Bench::Result& result)
+{
+    return result.latencies.count();
+}
+
+double error_rate_of(const biometry::cmds::Bench::Result& result)
+{
+    auto total = successes_of(result) + result.errors;
+    return total == 0 ? 0. : static_cast<double>(result.errors) / total;
+}
+
+double throughput_of(const biometry::cmds::Bench::Result& result, const std::chrono::microseconds& elapsed)
+{
+    return elapsed.count() == 0 ? 0. : successes_of(result) / std::chrono::duration<double>(elapsed).count();
+}
+
+// Latency summary in the order of latency_labels, all 0 if no operation succeeded.
+std::vector<double> latencies_of(const biometry::cmds::Bench::Result& result)
+{
+    const auto& stats = result.latencies;
+
+    if (stats.count() == 0)
+        return std::vector<double>(8, 0.);
+
+    return
+    {
+        stats.min(), stats.mean(), std::sqrt(stats.variance()),
+        stats.percentile(50), stats.percentile(95), stats.percentile(99), stats.percentile(99.9),
+        stats.max()
+    };
+}
+
+const std::vector<std::string>& latency_labels()
+{
+    static const std::vector<std::string> instance
+    {
+        "min", "mean", "stddev", "p50", "p95", "p99", "p99.9", "max"
+    };
+    return instance;
+}
+}
+
+biometry::cmds::Bench::Mix biometry::cmds::Bench::parse_mix(const std::string& s)
+{
+    Mix result;
+
+    std::vector<std::string> entries;
+    boost::split(entries, s, boost::is_any_of(","), boost::token_compress_on);
+
+    for (const auto& entry : entries)
+    {
+        std::vector<std::string> pair;
+        boost::split(pair, entry, boost::is_any_of("="));
+
+        if (pair.empty() || pair.size() > 2)
+            throw cli::Command::FlagsWithInvalidValue{};
+
+        auto name = boost::trim_copy(pair[0]);
+        if (kind_lut().right.count(name) == 0)
+            throw cli::Command::FlagsWithInvalidValue{};
+
+        try
+        {
+            result[kind_lut().right.at(name)] = pair.size() == 2 ? boost::lexical_cast<std::uint32_t>(boost::trim_copy(pair[1])) : 1;
+        }
+        catch (const boost::bad_lexical_cast&)
+        {
+            throw cli::Command::FlagsWithInvalidValue{};
+        }
+    }
+
+    return result;
+}
+
+biometry::cmds::Bench::Report biometry::cmds::Bench::measure(const Configuration& configuration, const std::shared_ptr<Device>& device)
+{
+    std::vector<Kind> kinds; std::vector<std::uint32_t> weights;
+    for (const auto& pair : configuration.mix)
+    {
+        if (pair.second == 0)
+            continue;
+
+        kinds.push_back(pair.first);
+        weights.push_back(pair.second);
+    }
+
+    if (kinds.empty())
+        throw std::invalid_argument{"Bench::measure: mix must contain at least one operation with non-zero weight"};
+
+    if (configuration.clients == 0)
+        throw std::invalid_argument{"Bench::measure: at least one client is required"};
+
+    // All clients start measuring at the same time, once the last client finished warming up.
+    std::mutex guard; std::condition_variable ready;
+    std::uint32_t warm{0}; Optional<std::chrono::steady_clock::time_point> start;
+
+    std::vector<std::map<Kind, Result>> results(configuration.clients);
+    std::vector<std::thread> clients;
+
+    for (std::uint32_t i = 0; i < configuration.clients; i++)
+    {
+        clients.emplace_back([&, i]()
+        {
+            std::mt19937 rng{i};
+            std::discrete_distribution<std::size_t> pick{weights.begin(), weights.end()};
+
+            for (std::uint32_t j = 0; j < configuration.warmup; j++)
+            {
+                try { execute(kinds[pick(rng)], *device, configuration.user, configuration.timeout); } catch (...) {}
+            }
+
+            std::chrono::steady_clock::time_point t0;
+            {
+                std::unique_lock<std::mutex> ul{guard};
+                if (++warm == configuration.clients)
+                {
+                    start = std::chrono::steady_clock::now();
+                    ready.notify_all();
+                }
+                ready.wait(ul, [&start]() { return static_cast<bool>(start); });
+                t0 = *start;
+            }
+
+            const auto deadline = t0 + configuration.duration;
+            const bool open_loop = configuration.rate > 0.;
+
+            // In open-loop mode, every client issues operations at rate / clients, and clients are staggered
+            // such that arrivals are spread evenly.
+            const auto interval = open_loop ?
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>{configuration.clients / configuration.rate}) :
+                        std::chrono::steady_clock::duration{};
+            const auto stagger = interval * i / configuration.clients;
+
+            for (std::int64_t n = 0;; n++)
+            {
+                auto scheduled = open_loop ? t0 + stagger + interval * n : std::chrono::steady_clock::now();
+
+                if (scheduled >= deadline)
+                    break;
+
+                if (open_loop)
+                    std::this_thread::sleep_until(scheduled);
+
+                auto kind = kinds[pick(rng)];
+
+                try
+                {
+                    execute(kind, *device, configuration.user, configuration.timeout);
+                    auto latency = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - scheduled);
+                    results[i][kind].latencies.update(latency.count());
+                }
+                catch (...)
+                {
+                    results[i][kind].errors++;
+                }
+            }
+        });
+    }
+
+    for (auto& client : clients)
+        client.join();
+
+    Report report;
+    report.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - *start);
+
+    for (auto kind : kinds)
+        report.results[kind] = Result{0, util::Statistics{}};
+
+    for (const auto& client : results)
+    {
+        for (const auto& pair : client)
+        {
+            auto& result = report.results[pair.first];
+            result.errors += pair.second.errors;
+            result.latencies.merge(pair.second.latencies);
+        }
+    }
+
+    return report;
+}
+
+void biometry::cmds::Bench::print_json(std::ostream& out, const Report& report)
+{
+    json::json operations = json::json::object();
+
+    for (const auto& pair : report.results)
+    {
+        json::json latency = json::json::object();
+
+        auto latencies = latencies_of(pair.second);
+        for (std::size_t i = 0; i < latencies.size(); i++)
+            latency[latency_labels()[i]] = latencies[i];
+
+        operations[boost::lexical_cast<std::string>(pair.first)] =
+        {
+            {"count", successes_of(pair.second) + pair.second.errors},
+            {"errors", pair.second.errors},
+            {"error_rate", error_rate_of(pair.second)},
+            {"throughput", throughput_of(pair.second, report.elapsed)},
+            {"latency_us", latency}
+        };
+    }
+
+    json::json doc =
+    {
+        {"elapsed_us", report.elapsed.count()},
+        {"operations", operations}
+    };
+
+    out << doc.dump(4) << std::endl;
+}
+
+void biometry::cmds::Bench::print_csv(std::ostream& out, const Report& report)
+{
+    out << "operation,count,errors,error_rate,throughput";
+    for (const auto& label : latency_labels())
+        out << "," << label << "_us";
+    out << std::endl;
+
+    for (const auto& pair : report.results)
+    {
+        out << pair.first
+            << "," << successes_of(pair.second) + pair.second.errors
+            << "," << pair.second.errors
+            << "," << error_rate_of(pair.second)
+            << "," << throughput_of(pair.second, report.elapsed);
+
+        for (auto latency : latencies_of(pair.second))
+            out << "," << latency;
+
+        out << std::endl;
+    }
+}
+
+biometry::cmds::Bench::Bench()
+    : CommandWithFlagsAndAction{cli::Name{"bench"}, cli::Usage{"bench"}, cli::Description{"generates load against a device and reports latencies"}}
+{
+    flag(cli::make_flag(cli::Name{"config"}, cli::Description{"in-process device configuration, the daemon if omitted"}, config));
+    flag(cli::make_flag(cli::Name{"user"}, cli::Description{"The numeric user id for benchmarking purposes"}, user = biometry::User::current()));
+    flag(cli::make_flag(cli::Name{"clients"}, cli::Description{"Number of concurrent clients"}, clients = 1));
+    flag(cli::make_flag(cli::Name{"mix"}, cli::Description{"Weighted operation mix, e.g., identify=8,verify=1,size=1"}, mix = "identify=1"));
+    flag(cli::make_flag(cli::Name{"warmup"}, cli::Description{"Number of unmeasured operations per client"}, warmup = 0));
+    flag(cli::make_flag(cli::Name{"rate"}, cli::Description{"Arrival rate in ops/s across all clients, 0 for closed-loop"}, rate = 0.));
+    flag(cli::make_flag(cli::Name{"duration"}, cli::Description{"Duration of the measurement in seconds"}, duration = 10));
+    flag(cli::make_flag(cli::Name{"timeout"}, cli::Description{"Timeout of an individual operation in seconds"}, timeout = 30));
+    flag(cli::make_flag(cli::Name{"format"}, cli::Description{"Output format, one of {json, csv}"}, format = Format::json));
+
+    action([this](const cli::Command::Context& ctxt)
+    {
+        auto device = config ? Test::device_from_config_file(*config) : biometry::dbus::Service::create_stub()->default_device();
+
+        auto report = measure(Configuration
+        {
+            user,
+            clients,
+            parse_mix(mix),
+            warmup,
+            rate,
+            std::chrono::seconds{duration},
+            std::chrono::seconds{timeout}
+        }, device);
+
+        switch (format)
+        {
+        case Format::json: print_json(ctxt.cout, report); break;
+        case Format::csv: print_csv(ctxt.cout, report); break;
+        }
+
+        return EXIT_SUCCESS;
+    });
+}
+
+std::ostream& biometry::cmds::operator<<(std::ostream& out, Bench::Kind kind)
+{
+    return out << kind_lut().left.at(kind);
+}
+
+std::istream& biometry::cmds::operator>>(std::istream& in, Bench::Kind& kind)
+{
+    std::string s; in >> s;
+
+    if (kind_lut().right.count(s) == 0)
+        throw cli::Command::FlagsWithInvalidValue{};
+
+    kind = kind_lut().right.at(s);
+    return in;
+}
+
+std::ostream& biometry::cmds::operator<<(std::ostream& out, Bench::Format format)
+{
+    return out << format_lut().left.at(format);
+}
+
+std::istream& biometry::cmds::operator>>(std::istream& in, Bench::Format& format)
+{
+    std::string s; in >> s;
+
+    if (format_lut().right.count(s) == 0)
+        throw cli::Command::FlagsWithInvalidValue{};
+
+    format = format_lut().right.at(s);
+    return in;
+}
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_CMDS_BENCH_H_
+#define BIOMETRYD_CMDS_BENCH_H_
+
+#include <biometry/device.h>
+#include <biometry/optional.h>
+#include <biometry/user.h>
+#include <biometry/visibility.h>
+
+#include <biometry/util/cli.h>
+#include <biometry/util/statistics.h>
+
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace biometry
+{
+namespace cmds
+{
+// biometryd bench --help
+// NAME:
+//     bench - generates load against a device and reports latencies
+//
+// USAGE:
+//     bench [command options] [arguments...]
+//
+// OPTIONS:
+//     --config          in-process device configuration, the daemon if omitted
+//     --user            The numeric user id for benchmarking purposes
+//     --clients         Number of concurrent clients
+//     --mix             Weighted operation mix, e.g., identify=8,verify=1,size=1
+//     --warmup          Number of unmeasured operations per client
+//     --rate            Arrival rate in ops/s across all clients, 0 for closed-loop
+//     --duration        Duration of the measurement in seconds
+//     --timeout         Timeout of an individual operation in seconds
+//     --format          Output format, one of {json, csv}
+class BIOMETRY_DLL_PUBLIC Bench : public util::cli::CommandWithFlagsAndAction
+{
+public:
+    /// @brief Kind enumerates all operations that can be part of a mix.
+    enum class Kind
+    {
+        identify,
+        verify,
+        size,
+        list,
+        enroll,
+        remove
+    };
+
+    /// @brief Format enumerates all known output formats.
+    enum class Format
+    {
+        json,
+        csv
+    };
+
+    /// @brief Mix maps operations to their relative weight.
+    typedef std::map<Kind, std::uint32_t> Mix;
+
+    /// @brief Configuration bundles the parameters of a benchmark run.
+    struct Configuration
+    {
+        User user;                          ///< The user operations are issued for.
+        std::uint32_t clients;              ///< Number of concurrent clients.
+        Mix mix;                            ///< Weighted operation mix.
+        std::uint32_t warmup;               ///< Number of unmeasured operations per client.
+        double rate;                        ///< Open-loop arrival rate across all clients, 0 for closed-loop.
+        std::chrono::milliseconds duration; ///< Duration of the measurement.
+        std::chrono::milliseconds timeout;  ///< Timeout of an individual operation.
+    };
+
+    /// @brief Result bundles the outcome of all operations of one kind.
+    struct Result
+    {
+        std::uint64_t errors;               ///< Number of failed, canceled or timed out operations.
+        util::Statistics latencies;         ///< Latencies of successful operations in [µs].
+    };
+
+    /// @brief Report summarizes a benchmark run.
+    struct Report
+    {
+        std::chrono::microseconds elapsed;  ///< Wall-clock time of the measurement.
+        std::map<Kind, Result> results;     ///< Results per kind of operation.
+    };
+
+    /// @brief parse_mix parses a comma-separated list of kind=weight pairs.
+    /// @throws util::cli::Command::FlagsWithInvalidValue if s is malformed.
+    static Mix parse_mix(const std::string& s);
+
+    /// @brief measure executes a benchmark of device according to configuration.
+    ///
+    /// Every client issues operations drawn from the mix one after another. In open-loop mode,
+    /// operations are issued according to a fixed schedule, and latencies are measured from the
+    /// scheduled start such that queueing delay caused by a slow device is accounted for.
+    static Report measure(const Configuration& configuration, const std::shared_ptr<Device>& device);
+
+    /// @brief print_json inserts report into out as a JSON document.
+    static void print_json(std::ostream& out, const Report& report);
+
+    /// @brief print_csv inserts report into out as CSV, with one line per kind of operation.
+    static void print_csv(std::ostream& out, const Report& report);
+
+    /// @brief Bench creates a new instance, initializing flags to default values.
+    Bench();
+
+private:
+    Optional<boost::filesystem::path> config;
+    User user;
+    std::uint32_t clients;
+    std::string mix;
+    std::uint32_t warmup;
+    double rate;
+    std::uint32_t duration;
+    std::uint32_t timeout;
+    Format format;
+};
+
+/// @brief operator<< inserts kind into out and returns out.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, Bench::Kind kind);
+/// @brief operator>> extracts kind from in, and returns in.
+BIOMETRY_DLL_PUBLIC std::istream& operator>>(std::istream& in, Bench::Kind& kind);
+/// @brief operator<< inserts format into out and returns out.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, Bench::Format format);
+/// @brief operator>> extracts format from in, and returns in.
+BIOMETRY_DLL_PUBLIC std::istream& operator>>(std::istream& in, Bench::Format& format);
+}
+}
+
+#endif // BIOMETRYD_CMDS_BENCH_H_
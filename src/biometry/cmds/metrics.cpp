@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/cmds/metrics.h>
+
+#include <biometry/dbus/stub/metrics.h>
+
+#include <iostream>
+
+namespace cli = biometry::util::cli;
+
+biometry::cmds::Metrics::Metrics(const Run::BusFactory& bus_factory)
+    : CommandWithFlagsAndAction{cli::Name{"metrics"}, cli::Usage{"metrics"}, cli::Description{"print runtime metrics of a running daemon"}},
+      bus_factory{bus_factory}
+{
+    action([this](const cli::Command::Context& ctxt)
+    {
+        try
+        {
+            ctxt.cout << biometry::dbus::stub::Metrics::create_for_bus(this->bus_factory())->dump();
+        }
+        catch (const std::exception& e)
+        {
+            ctxt.cout << "Failed to query metrics: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    });
+}
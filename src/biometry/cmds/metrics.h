@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_CMDS_METRICS_H_
+#define BIOMETRYD_CMDS_METRICS_H_
+
+#include <biometry/cmds/run.h>
+
+#include <biometry/util/cli.h>
+
+namespace biometry
+{
+namespace cmds
+{
+/// @brief Metrics queries a running daemon for its runtime metrics and prints them.
+class Metrics : public util::cli::CommandWithFlagsAndAction
+{
+public:
+    /// @brief Metrics creates a new instance, connecting to the bus created by bus_factory.
+    Metrics(const Run::BusFactory& bus_factory = Run::system_bus_factory());
+
+private:
+    Run::BusFactory bus_factory;
+};
+}
+}
+
+#endif // BIOMETRYD_CMDS_METRICS_H_
@@ -19,21 +19,40 @@
 
 #include <biometry/cmds/run.h>
 
+#include <biometry/daemon.h>
 #include <biometry/device_registry.h>
-#include <biometry/dispatching_service.h>
+#include <biometry/identifier.h>
 #include <biometry/runtime.h>
+#include <biometry/service.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+#include <biometry/dbus/skeleton/admission_control.h>
 #include <biometry/dbus/skeleton/service.h>
+#include <biometry/dbus/stub/observer.h>
+#include <biometry/devices/caching.h>
+#include <biometry/devices/coalescing.h>
+#include <biometry/devices/deferred.h>
+#include <biometry/devices/dispatching.h>
+#include <biometry/devices/scheduling.h>
 
 #include <biometry/util/configuration.h>
 #include <biometry/util/json_configuration_builder.h>
+#include <biometry/util/metrics.h>
 #include <biometry/util/streaming_configuration_builder.h>
+#include <biometry/util/trace.h>
 
 #include <core/dbus/bus.h>
 #include <core/dbus/asio/executor.h>
 
 #include <core/posix/signal.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <fstream>
+#include <future>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 
 namespace cli = biometry::util::cli;
@@ -50,13 +69,16 @@ const std::unordered_map<std::string, biometry::Device::Id>& device_id_lut()
     return instance;
 }
 
-std::shared_ptr<biometry::Device> device_from_config(const boost::filesystem::path& config_file)
+biometry::util::Configuration load_config(const boost::filesystem::path& config_file)
 {
     using StreamingJsonConfigurationBuilder = biometry::util::StreamingConfigurationBuilder<biometry::util::JsonConfigurationBuilder>;
     StreamingJsonConfigurationBuilder builder{StreamingJsonConfigurationBuilder::make_streamer(config_file)};
-    auto configuration = builder.build_configuration();
+    return builder.build_configuration();
+}
 
-    auto default_device = configuration["defaultDevice"];
+std::shared_ptr<biometry::Device> device_from_config(const biometry::util::Configuration& configuration)
+{
+    const auto& default_device = configuration["defaultDevice"];
     biometry::util::Configuration device_config; device_config["config"] = default_device["config"];
     auto default_device_descriptor = biometry::device_registry().at(default_device[std::string("id")].value().string());
 
@@ -70,9 +92,167 @@ std::shared_ptr<biometry::Device> device_from_oracle(const biometry::util::Prope
     return default_device_descriptor->create({});
 }
 
-std::shared_ptr<biometry::Device> create_default_device(const biometry::Optional<boost::filesystem::path>& config_file, const biometry::util::PropertyStore& property_store)
+// worker_threads_for returns the size of the runtime's thread pool, preferring
+// an explicit value over the daemon configuration over the default.
+//
+// Values are clamped to [1, max_worker_threads]. In particular, negative values in the
+// configuration must not wrap around to a huge number of threads.
+std::uint32_t worker_threads_for(const biometry::Optional<std::uint32_t>& worker_threads, const biometry::util::Configuration& configuration)
+{
+    static constexpr const std::int64_t max_worker_threads{256};
+
+    auto clamp = [](std::int64_t value)
+    {
+        return static_cast<std::uint32_t>(std::min(std::max<std::int64_t>(1, value), max_worker_threads));
+    };
+
+    if (worker_threads)
+        return clamp(*worker_threads);
+
+    if (auto node = configuration[biometry::cmds::Run::worker_threads_config_key])
+        return clamp(node.value().integer());
+
+    return biometry::Runtime::worker_threads;
+}
+
+// template_cache_for returns the path of the template cache database, preferring an explicit
+// value over the daemon configuration over the default. An empty path disables the cache.
+boost::filesystem::path template_cache_for(const biometry::Optional<boost::filesystem::path>& template_cache, const biometry::util::Configuration& configuration)
+{
+    if (template_cache)
+        return *template_cache;
+
+    if (auto node = configuration[biometry::cmds::Run::template_cache_config_key])
+        return node.value().string();
+
+    return biometry::Daemon::Configuration::default_template_cache_file();
+}
+
+// scheduling_policy_for returns the scheduling policy specified in the daemon configuration, or the default one.
+biometry::devices::Scheduling::Policy scheduling_policy_for(const biometry::util::Configuration& configuration)
+{
+    return biometry::devices::Scheduling::Policy::from_configuration(configuration[biometry::cmds::Run::scheduler_config_key]);
+}
+
+// coalescing_policy_for returns the coalescing policy specified in the daemon configuration, or the default one.
+biometry::devices::Coalescing::Policy coalescing_policy_for(const biometry::util::Configuration& configuration)
+{
+    return biometry::devices::Coalescing::Policy::from_configuration(configuration[biometry::cmds::Run::coalescing_config_key]);
+}
+
+// admission_control_for returns the limits on requests by peers specified in the daemon configuration, or the default ones.
+biometry::dbus::skeleton::AdmissionControl::Configuration admission_control_for(const biometry::util::Configuration& configuration)
+{
+    return biometry::dbus::skeleton::AdmissionControl::Configuration::from_configuration(configuration[biometry::cmds::Run::admission_control_config_key]);
+}
+
+// configure_progress_for adjusts how progress updates of operations of type T are delivered to clients,
+// applying the configuration found in node and spacing updates with timers running on runtime.
+template<typename T>
+void configure_progress_for(const biometry::util::Configuration::Node& node, const std::shared_ptr<biometry::Runtime>& runtime)
+{
+    auto configuration = biometry::dbus::stub::Observer<T>::default_configuration();
+    configuration.timer = biometry::dbus::stub::ProgressTimer::for_runtime(runtime);
+
+    if (auto interval = node["minIntervalMs"])
+        configuration.min_progress_interval = std::chrono::milliseconds{std::max<std::int64_t>(0, interval.value().integer())};
+
+    biometry::dbus::stub::Observer<T>::configure_defaults(configuration);
+}
+
+// configure_progress adjusts how progress updates of all operations are delivered to clients according
+// to the daemon configuration, spacing updates with timers running on runtime.
+void configure_progress(const biometry::util::Configuration& configuration, const std::shared_ptr<biometry::Runtime>& runtime)
+{
+    const auto& node = configuration[biometry::cmds::Run::progress_config_key];
+
+    configure_progress_for<biometry::Identification>(node, runtime);
+    configure_progress_for<biometry::Verification>(node, runtime);
+    configure_progress_for<biometry::TemplateStore::SizeQuery>(node, runtime);
+    configure_progress_for<biometry::TemplateStore::List>(node, runtime);
+    configure_progress_for<biometry::TemplateStore::Enrollment>(node, runtime);
+    configure_progress_for<biometry::TemplateStore::Removal>(node, runtime);
+    configure_progress_for<biometry::TemplateStore::Clearance>(node, runtime);
+}
+
+// InstantiationPolicy describes how often instantiating the default device is attempted.
+struct InstantiationPolicy
+{
+    std::uint32_t attempts{5};                  // Number of attempts before giving up.
+    std::chrono::milliseconds backoff{500};     // Delay before the second attempt, doubling for every further one.
+};
+
+// instantiation_policy_for returns the instantiation policy specified in the daemon configuration, or the default one.
+InstantiationPolicy instantiation_policy_for(const biometry::util::Configuration& configuration)
+{
+    InstantiationPolicy policy;
+
+    const auto& node = configuration[biometry::cmds::Run::instantiation_config_key];
+
+    if (auto attempts = node["attempts"])
+        policy.attempts = std::max<std::int64_t>(1, attempts.value().integer());
+    if (auto backoff = node["backoffMs"])
+        policy.backoff = std::chrono::milliseconds{std::max<std::int64_t>(0, backoff.value().integer())};
+
+    return policy;
+}
+
+// with_template_cache returns a device serving template metadata of device from the cache at path.
+//
+// Failing to open the cache is not fatal, we just serve all calls from device then.
+std::shared_ptr<biometry::Device> with_template_cache(const std::shared_ptr<biometry::Device>& device, const boost::filesystem::path& path, std::ostream& out)
+{
+    if (path.empty())
+        return device;
+
+    try
+    {
+        auto caching = std::make_shared<biometry::devices::Caching>(device, biometry::devices::TemplateCache::open(path));
+        // Templates might have been changed behind our back, e.g., by a previous version of the daemon.
+        caching->resync();
+        return caching;
+    }
+    catch (const std::exception& e)
+    {
+        out << "Failed to open template cache: " << e.what() << std::endl;
+    }
+
+    return device;
+}
+
+// create_default_device creates the device described by configuration if the daemon has been
+// given a configuration file, and the device suggested by the oracle otherwise.
+std::shared_ptr<biometry::Device> create_default_device(const biometry::Optional<boost::filesystem::path>& config_file, const biometry::util::Configuration& configuration, const biometry::util::PropertyStore& property_store)
 {
-    return config_file ? device_from_config(*config_file) : device_from_oracle(property_store);
+    return config_file ? device_from_config(configuration) : device_from_oracle(property_store);
+}
+
+// DeferredService hands out a device that is still being instantiated.
+class DeferredService : public biometry::Service
+{
+public:
+    DeferredService(const std::shared_ptr<biometry::devices::Deferred>& device)
+        : device{device}
+    {
+    }
+
+    // From biometry::Service.
+    std::shared_ptr<biometry::Device> default_device() const override
+    {
+        return device;
+    }
+
+private:
+    std::shared_ptr<biometry::devices::Deferred> device;
+};
+
+// record_startup_stage records the time elapsed since started_at as the duration of the
+// startup stage known under name, returning the end of the stage.
+biometry::util::trace::Clock::time_point record_startup_stage(const char* name, const biometry::util::trace::Clock::time_point& started_at)
+{
+    biometry::util::metrics().latency(std::string{"startup."} + name + "_us").record_since(started_at);
+    biometry::util::trace::tracer().complete("startup", name, started_at);
+    return biometry::util::trace::Clock::now();
 }
 }
 
@@ -89,6 +269,14 @@ biometry::Device::Id biometry::cmds::Run::ConfigurationOracle::make_an_educated_
     return device_id_lut().at(value);
 }
 
+constexpr const char* biometry::cmds::Run::worker_threads_config_key;
+constexpr const char* biometry::cmds::Run::template_cache_config_key;
+constexpr const char* biometry::cmds::Run::scheduler_config_key;
+constexpr const char* biometry::cmds::Run::coalescing_config_key;
+constexpr const char* biometry::cmds::Run::admission_control_config_key;
+constexpr const char* biometry::cmds::Run::progress_config_key;
+constexpr const char* biometry::cmds::Run::instantiation_config_key;
+
 biometry::cmds::Run::BusFactory biometry::cmds::Run::system_bus_factory()
 {
     return []()
@@ -103,39 +291,136 @@ biometry::cmds::Run::Run(const std::shared_ptr<biometry::util::PropertyStore>& p
       property_store{property_store}
 {
     flag(cli::make_flag(cli::Name{"config"}, cli::Description{"The daemon configuration"}, config));
+    flag(cli::make_flag(cli::Name{"worker-threads"}, cli::Description{"The number of threads executing device operations"}, worker_threads));
+    flag(cli::make_flag(cli::Name{"template-cache"}, cli::Description{"The database caching template metadata"}, template_cache));
     action([this](const cli::Command::Context& ctxt)
     {
+        // Retrying to instantiate the device gives up as soon as we are asked to shut down.
+        auto shutdown = std::make_shared<std::promise<void>>();
+        auto shutting_down = shutdown->get_future().share();
+        auto shutdown_once = std::make_shared<std::once_flag>();
+
         auto trap = core::posix::trap_signals_for_all_subsequent_threads({core::posix::Signal::sig_term});
-        trap->signal_raised().connect([trap](const core::posix::Signal&) mutable
+        trap->signal_raised().connect([trap, shutdown, shutdown_once](const core::posix::Signal&) mutable
         {
+            std::call_once(*shutdown_once, [shutdown]() { shutdown->set_value(); });
             trap->stop();
         });
         
+        // We claim our name and install handlers right away, such that clients reach us
+        // while the device is still being instantiated. Requests issued in the meantime
+        // are parked by the deferred device until the actual device becomes available.
+        auto device = std::make_shared<biometry::devices::Deferred>();
+        std::atomic<bool> instantiation_failed{false};
+        std::thread instantiator;
+
         try
         {
-            auto device = create_default_device(config, *Run::property_store);
-                    
-            auto runtime = Runtime::create();
+            auto started_at = biometry::util::trace::Clock::now();
+
+            // We parse the configuration once and hand the tree to everybody interested in it.
+            const auto configuration = config ? load_config(*config) : biometry::util::Configuration{};
+
+            auto runtime = Runtime::create(worker_threads_for(worker_threads, configuration));
             runtime->start();
-        
+            started_at = record_startup_stage("runtime", started_at);
+
+            // Vendor HALs might take their time to come up. We instantiate the device on a
+            // dedicated thread, in parallel to connecting to the bus and without blocking
+            // the workers of the runtime.
+            auto template_cache_file = template_cache_for(template_cache, configuration);
+            auto scheduling_policy = scheduling_policy_for(configuration);
+            auto coalescing_policy = coalescing_policy_for(configuration);
+            auto admission_control = biometry::dbus::skeleton::AdmissionControl::create(admission_control_for(configuration));
+            auto instantiation_policy = instantiation_policy_for(configuration);
+
+            instantiator = std::thread{[config = this->config, configuration, property_store = Run::property_store, template_cache_file, scheduling_policy, coalescing_policy, instantiation_policy,
+                                        runtime, device, started_at, shutting_down, trap, &instantiation_failed, &ctxt]()
+            {
+                static auto& failures = biometry::util::metrics().counter("startup.device_failures");
+
+                std::string error{"Failed to instantiate device"};
+                auto backoff = instantiation_policy.backoff;
+
+                for (std::uint32_t attempt = 1; attempt <= instantiation_policy.attempts; attempt++)
+                {
+                    try
+                    {
+                        auto actual = create_default_device(config, configuration, *property_store);
+                        record_startup_stage("device", started_at);
+
+                        // Every interface of the device gets its own strand, and the scheduler hands
+                        // the sensor to pending operations by priority, such that an enrollment does
+                        // not delay unlocking the device. Concurrent identifications share a single
+                        // capture as far as the coalescing policy allows, and template metadata is served
+                        // from the cache.
+                        auto dispatching = std::make_shared<biometry::devices::Dispatching>(
+                            biometry::util::create_dispatcher_factory_for_runtime(runtime), actual);
+                        auto scheduling = std::make_shared<biometry::devices::Scheduling>(dispatching, scheduling_policy);
+                        auto coalescing = std::make_shared<biometry::devices::Coalescing>(scheduling, coalescing_policy);
+                        device->resolve(with_template_cache(coalescing, template_cache_file, ctxt.cout));
+                        return;
+                    }
+                    catch (const std::exception& e)
+                    {
+                        error = e.what();
+                    }
+                    catch (...)
+                    {
+                        error = "Failed to instantiate device";
+                    }
+
+                    failures.increment();
+                    ctxt.cout << "Failed to instantiate device (attempt " << attempt << " of " << instantiation_policy.attempts << "): " << error << std::endl;
+
+                    if (attempt == instantiation_policy.attempts)
+                        break;
+
+                    // Requests stay parked with the deferred device while we wait for the next attempt.
+                    if (shutting_down.wait_for(backoff) == std::future_status::ready)
+                    {
+                        device->fail("Shutting down");
+                        return;
+                    }
+
+                    backoff *= 2;
+                }
+
+                record_startup_stage("device", started_at);
+                device->fail(error);
+
+                // There is no point in keeping the daemon around without a device. We stop the main
+                // loop, exit with an error and let our supervisor respawn us. A trap stopped before
+                // the main thread starts running it returns from run right away.
+                instantiation_failed = true;
+                trap->stop();
+            }};
+
             auto bus = this->bus_factory();
             bus->install_executor(core::dbus::asio::make_executor(bus, runtime->service()));
+            // Deferred progress updates are delivered by the runtime executing the bus.
+            configure_progress(configuration, runtime);
+            started_at = record_startup_stage("bus", started_at);
 
-            auto impl = std::make_shared<biometry::DispatchingService>(
-                biometry::util::create_dispatcher_for_runtime(runtime),device);
-            auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(bus, impl);            
+            auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(bus, std::make_shared<DeferredService>(device), device, admission_control);
+            record_startup_stage("service", started_at);
 
             trap->run();
 
+            instantiator.join();
+
             bus->stop();
             runtime->stop();
         }
-        catch (...)
+        catch (const std::exception& e)
         {
-            ctxt.cout << "Failed to instantiate device...going to sleep" << std::endl;
+            ctxt.cout << "Failed to start the daemon: " << e.what() << "...going to sleep" << std::endl;
             trap->run();
         }
 
-        return EXIT_SUCCESS;
+        if (instantiator.joinable())
+            instantiator.join();
+
+        return instantiation_failed ? EXIT_FAILURE : EXIT_SUCCESS;
     });
 }
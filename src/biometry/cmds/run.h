@@ -31,6 +31,7 @@
 
 #include <boost/filesystem.hpp>
 
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <memory>
@@ -60,6 +61,44 @@ public:
     /// @brief system_bus_factory returns a BusFactory creating connections to the system bus.
     static BusFactory system_bus_factory();
 
+    /// @brief worker_threads_config_key is the key of the daemon configuration specifying the number of worker threads.
+    ///
+    /// The value is clamped to [1, 256].
+    static constexpr const char* worker_threads_config_key{"workerThreads"};
+
+    /// @brief template_cache_config_key is the key of the daemon configuration specifying the template cache database.
+    ///
+    /// An empty value disables caching of template metadata.
+    static constexpr const char* template_cache_config_key{"templateCache"};
+
+    /// @brief scheduler_config_key is the key of the daemon configuration specifying the scheduling policy.
+    ///
+    /// See biometry::devices::Scheduling::Policy::from_configuration for the expected layout.
+    static constexpr const char* scheduler_config_key{"scheduler"};
+
+    /// @brief coalescing_config_key is the key of the daemon configuration specifying which identifications share a capture.
+    ///
+    /// See biometry::devices::Coalescing::Policy::from_configuration for the expected layout.
+    static constexpr const char* coalescing_config_key{"coalescing"};
+
+    /// @brief admission_control_config_key is the key of the daemon configuration specifying the limits on requests by peers.
+    ///
+    /// See biometry::dbus::skeleton::AdmissionControl::Configuration::from_configuration for the expected layout.
+    static constexpr const char* admission_control_config_key{"admissionControl"};
+
+    /// @brief progress_config_key is the key of the daemon configuration specifying how progress updates are delivered to clients.
+    ///
+    /// The value is an object with the minimum time in "minIntervalMs" between two progress updates of an operation.
+    static constexpr const char* progress_config_key{"progress"};
+
+    /// @brief instantiation_config_key is the key of the daemon configuration specifying how often
+    /// instantiating the default device is attempted.
+    ///
+    /// The value is an object with the number of "attempts" and the "backoffMs" before the second
+    /// attempt, doubling for every further one. The daemon exits with EXIT_FAILURE once all attempts
+    /// have failed, leaving it to its supervisor to start over.
+    static constexpr const char* instantiation_config_key{"deviceInstantiation"};
+
     /// @brief Run initializes a new instance with the given bus_factory.
     Run(const std::shared_ptr<biometry::util::PropertyStore>& property_store, const BusFactory& bus_factory = system_bus_factory());
 
@@ -67,6 +106,8 @@ private:
     BusFactory bus_factory;
     std::shared_ptr<biometry::util::PropertyStore> property_store;
     Optional<boost::filesystem::path> config;
+    Optional<std::uint32_t> worker_threads;
+    Optional<boost::filesystem::path> template_cache;
 };
 }
 }
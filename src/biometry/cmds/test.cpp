@@ -35,6 +35,7 @@
 #include <biometry/util/json_configuration_builder.h>
 #include <biometry/util/streaming_configuration_builder.h>
 
+#include <cmath>
 #include <iomanip>
 #include <future>
 #include <stdexcept>
@@ -91,8 +92,20 @@ private:
     std::promise<typename Super::Result> promise;
     std::future<typename Super::Result> future{promise.get_future()};
 };
+}
+
+biometry::cmds::Test::ConfigurationInvalid::ConfigurationInvalid()
+    : std::runtime_error{"Configuration is invalid"}
+{
+}
+
 
-std::shared_ptr<biometry::Device> device_from_config_file(const boost::filesystem::path& file)
+biometry::cmds::Test::CouldNotInstiantiateDevice::CouldNotInstiantiateDevice()
+    : std::runtime_error{"Could not instantiate device"}
+{
+}
+
+std::shared_ptr<biometry::Device> biometry::cmds::Test::device_from_config_file(const boost::filesystem::path& file)
 {
     using StreamingJsonConfigurationBuilder = biometry::util::StreamingConfigurationBuilder<biometry::util::JsonConfigurationBuilder>;
     StreamingJsonConfigurationBuilder builder{StreamingJsonConfigurationBuilder::make_streamer(file)};
@@ -113,18 +126,6 @@ std::shared_ptr<biometry::Device> device_from_config_file(const boost::filesyste
         return biometry::device_registry().at(id.value().string())->create(config);
     } catch(...) { std::throw_with_nested(biometry::cmds::Test::CouldNotInstiantiateDevice{});}
 }
-}
-
-biometry::cmds::Test::ConfigurationInvalid::ConfigurationInvalid()
-    : std::runtime_error{"Configuration is invalid"}
-{
-}
-
-
-biometry::cmds::Test::CouldNotInstiantiateDevice::CouldNotInstiantiateDevice()
-    : std::runtime_error{"Could not instantiate device"}
-{
-}
 
 biometry::cmds::Test::Test()
     : CommandWithFlagsAndAction{cli::Name{"test"}, cli::Usage{"executes runtime tests for a device"}, cli::Description{"executes runtime tests for a device"}}
@@ -185,13 +186,23 @@ int biometry::cmds::Test::test_device(const User& user, const cli::Command::Cont
             ->start_with_observer(observer);
         try { observer->sync(); } catch(...) { ctxt.cout << "  Failed to identify user." << std::endl; };
 
-    }}.trials(25).on_progress([&pb](std::size_t current, std::size_t total) { pb.update(current/static_cast<double>(total)); }).run();
+    }}.trials(trials).on_progress([&pb](std::size_t current, std::size_t total) { pb.update(current/static_cast<double>(total)); }).run();
 
-    ctxt.cout << std::endl
-              << "    min:      " << std::setw(6) << std::right << std::fixed << std::setprecision(2) << stats.min()                 << " [µs]" << std::endl
-              << "    mean:     " << std::setw(6) << std::right << std::fixed << std::setprecision(2) << stats.mean()                << " [µs]" << std::endl
-              << "    std.dev.: " << std::setw(6) << std::right << std::fixed << std::setprecision(2) << std::sqrt(stats.variance()) << " [µs]" << std::endl
-              << "    max:      " << std::setw(6) << std::right << std::fixed << std::setprecision(2) << stats.max()                 << " [µs]" << std::endl;
+    auto print = [&ctxt](const std::string& label, double value)
+    {
+        ctxt.cout << "    " << std::setw(10) << std::left << label
+                  << std::setw(10) << std::right << std::fixed << std::setprecision(2) << value << " [µs]" << std::endl;
+    };
+
+    ctxt.cout << std::endl;
+    print("min:", stats.min());
+    print("p50:", stats.percentile(50));
+    print("p95:", stats.percentile(95));
+    print("p99:", stats.percentile(99));
+    print("p99.9:", stats.percentile(99.9));
+    print("max:", stats.max());
+    print("mean:", stats.mean());
+    print("std.dev.:", std::sqrt(stats.variance()));
 
     return EXIT_SUCCESS;
 }
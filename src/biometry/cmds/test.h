@@ -61,6 +61,11 @@ public:
         CouldNotInstiantiateDevice();
     };
 
+    /// @brief device_from_config_file returns the device described by the "device" entry of file.
+    /// @throws ConfigurationInvalid if file does not describe a device.
+    /// @throws CouldNotInstiantiateDevice if the device cannot be created.
+    static std::shared_ptr<Device> device_from_config_file(const boost::filesystem::path& file);
+
     Test();
 
     int test_device(const User& user, const Command::Context& ctxt, const std::shared_ptr<Device>& device);
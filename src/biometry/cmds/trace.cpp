@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/cmds/trace.h>
+
+#include <biometry/dbus/stub/metrics.h>
+
+#include <iostream>
+
+namespace cli = biometry::util::cli;
+
+biometry::cmds::Trace::Trace(const Run::BusFactory& bus_factory)
+    : CommandWithFlagsAndAction{cli::Name{"trace"}, cli::Usage{"trace"}, cli::Description{"print trace events of a running daemon as json"}},
+      bus_factory{bus_factory}
+{
+    action([this](const cli::Command::Context& ctxt)
+    {
+        try
+        {
+            ctxt.cout << biometry::dbus::stub::Metrics::create_for_bus(this->bus_factory())->trace() << std::endl;
+        }
+        catch (const std::exception& e)
+        {
+            ctxt.cout << "Failed to query trace events: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        return EXIT_SUCCESS;
+    });
+}
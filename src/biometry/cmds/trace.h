@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_CMDS_TRACE_H_
+#define BIOMETRYD_CMDS_TRACE_H_
+
+#include <biometry/cmds/run.h>
+
+#include <biometry/util/cli.h>
+
+namespace biometry
+{
+namespace cmds
+{
+/// @brief Trace queries a running daemon for its buffered trace events and prints them in the
+/// Chrome trace-event format. The daemon only records events if started with BIOMETRYD_TRACE=1.
+class Trace : public util::cli::CommandWithFlagsAndAction
+{
+public:
+    /// @brief Trace creates a new instance, connecting to the bus created by bus_factory.
+    Trace(const Run::BusFactory& bus_factory = Run::system_bus_factory());
+
+private:
+    Run::BusFactory bus_factory;
+};
+}
+}
+
+#endif // BIOMETRYD_CMDS_TRACE_H_
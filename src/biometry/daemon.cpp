@@ -21,12 +21,15 @@
 
 #include <biometry/devices/plugin/enumerator.h>
 
+#include <biometry/cmds/bench.h>
 #include <biometry/cmds/config.h>
 #include <biometry/cmds/enroll.h>
 #include <biometry/cmds/identify.h>
 #include <biometry/cmds/list_devices.h>
+#include <biometry/cmds/metrics.h>
 #include <biometry/cmds/run.h>
 #include <biometry/cmds/test.h>
+#include <biometry/cmds/trace.h>
 #include <biometry/cmds/version.h>
 
 #include <boost/program_options.hpp>
@@ -39,15 +42,18 @@ namespace cli = biometry::util::cli;
 namespace po = boost::program_options;
 
 biometry::Daemon::Daemon()
-    : device_registrar{biometry::devices::plugin::DirectoryEnumerator{Configuration::default_plugin_directories()}},
+    : device_registrar{biometry::devices::plugin::DirectoryEnumerator{Configuration::default_plugin_directories(), Configuration::default_plugin_cache_file()}},
       cmd{cli::Name{"biometryd"}, cli::Usage{"biometryd"}, cli::Description{"biometryd"}}
 {
-    cmd.command(std::make_shared<cmds::Enroll>())
+    cmd.command(std::make_shared<cmds::Bench>())
+       .command(std::make_shared<cmds::Enroll>())
        .command(std::make_shared<cmds::Config>())
        .command(std::make_shared<cmds::Identify>())
        .command(std::make_shared<cmds::ListDevices>())
-       .command(std::make_shared<cmds::Run>(std::make_shared<biometry::util::AndroidPropertyStore>()))
+       .command(std::make_shared<cmds::Metrics>())
+       .command(std::make_shared<cmds::Run>(std::make_shared<biometry::util::MappedAndroidPropertyStore>()))
        .command(std::make_shared<cmds::Test>())
+       .command(std::make_shared<cmds::Trace>())
        .command(std::make_shared<cmds::Version>());
 }
 
@@ -50,6 +50,14 @@ public:
         /// that is scanned for biometryd plugins.
         static boost::filesystem::path custom_plugin_directory();
 
+        /// @brief default_plugin_cache_file returns the path of the file caching
+        /// the descriptors of plugins found in the plugin directories.
+        static boost::filesystem::path default_plugin_cache_file();
+
+        /// @brief default_template_cache_file returns the path of the database caching
+        /// the template metadata of the default device.
+        static boost::filesystem::path default_template_cache_file();
+
         /// @brief default_plugin_directories returns the paths that should be scanned for
         /// plugins.
         static std::set<boost::filesystem::path> default_plugin_directories();
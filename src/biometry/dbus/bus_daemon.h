@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_BUS_DAEMON_H_
+#define BIOMETRYD_DBUS_BUS_DAEMON_H_
+
+#include <core/dbus/macros.h>
+#include <core/dbus/types/object_path.h>
+
+#include <string>
+#include <tuple>
+
+namespace biometry
+{
+namespace dbus
+{
+/// @brief BusDaemon describes the parts of org.freedesktop.DBus that we rely upon.
+struct BusDaemon
+{
+    static inline const std::string& name()
+    {
+        static const std::string s = "org.freedesktop.DBus";
+        return s;
+    }
+
+    static inline core::dbus::types::ObjectPath path()
+    {
+        return core::dbus::types::ObjectPath{"/org/freedesktop/DBus"};
+    }
+
+    // Gets the AppArmor confinement string associated with the unique connection name. If
+    // D-Bus is not performing AppArmor mediation, the
+    // org.freedesktop.DBus.Error.AppArmorSecurityContextUnknown error is returned.
+    DBUS_CPP_METHOD_DEF(GetConnectionAppArmorSecurityContext, BusDaemon)
+
+    // Gets the unix user id of the user that the requesting party is running under.
+    DBUS_CPP_METHOD_DEF(GetConnectionUnixUser, BusDaemon)
+
+    // Emitted whenever the owner of a name changes. Arguments are the name, its old
+    // and its new owner. An empty new owner indicates that the name vanished from the bus.
+    DBUS_CPP_SIGNAL_DEF(NameOwnerChanged, BusDaemon, std::tuple<std::string, std::string, std::string>)
+};
+}
+}
+
+#endif // BIOMETRYD_DBUS_BUS_DAEMON_H_
@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/client_connection.h>
+
+#include <biometry/runtime.h>
+
+#include <biometry/dbus/bus_daemon.h>
+#include <biometry/dbus/interface.h>
+
+#include <biometry/util/metrics.h>
+
+#include <core/dbus/asio/executor.h>
+#include <core/dbus/signal.h>
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// Binding ties a bus connection to the runtime executing it.
+//
+// Replies to asynchronous calls and incoming calls to observers are dispatched on the
+// runtime's worker threads, and it thus has to outlive all users of the bus connection.
+// We hand out the bus connection as an alias of the binding to guarantee that.
+struct biometry::dbus::ClientConnection::Binding
+{
+    ~Binding()
+    {
+        bus.reset();
+
+        // The last user of the bus connection might go away in a handler executing on the
+        // runtime, which cannot join its own worker thread. We stop it from a helper thread then,
+        // handing over the only reference such that it is never released on the worker.
+        if (runtime->is_worker_thread())
+            std::thread{[rt = std::move(runtime)]() mutable { rt.reset(); }}.detach();
+    }
+
+    std::shared_ptr<biometry::Runtime> runtime;
+    core::dbus::Bus::Ptr bus;
+};
+
+class biometry::dbus::ClientConnection::Cache
+{
+public:
+    core::dbus::Object::Ptr object_for_path(const core::dbus::Service::Ptr& service, const core::dbus::types::ObjectPath& path)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        auto it = objects.find(path.as_string());
+        if (it != objects.end())
+            return it->second;
+
+        auto object = service->object_for_path(path);
+        objects.insert(std::make_pair(path.as_string(), object));
+        return object;
+    }
+
+    void invalidate()
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        objects.clear();
+        ++generation;
+    }
+
+    std::atomic<std::uint64_t> generation{0};
+
+private:
+    std::mutex guard;
+    std::map<std::string, core::dbus::Object::Ptr> objects;
+};
+
+biometry::dbus::ClientConnection::Ptr biometry::dbus::ClientConnection::instance()
+{
+    static std::mutex guard;
+    static std::weak_ptr<ClientConnection> instance;
+
+    std::lock_guard<std::mutex> lg{guard};
+    if (auto sp = instance.lock())
+        return sp;
+
+    // Every connection comes with its own runtime, torn down together with the connection.
+    auto runtime = Runtime::create();
+    runtime->start();
+
+    auto sp = create([]() { return std::make_shared<core::dbus::Bus>(core::dbus::WellKnownBus::system); }, runtime);
+    instance = sp;
+    return sp;
+}
+
+biometry::dbus::ClientConnection::Ptr biometry::dbus::ClientConnection::create(const BusFactory& bus_factory, const std::shared_ptr<Runtime>& runtime)
+{
+    static auto& connections = biometry::util::metrics().counter("client.connections");
+    connections.increment();
+
+    return Ptr{new ClientConnection{bus_factory(), runtime}};
+}
+
+biometry::dbus::ClientConnection::ClientConnection(const core::dbus::Bus::Ptr& bus, const std::shared_ptr<Runtime>& runtime)
+    : binding_{new Binding{runtime, bus}},
+      bus_{binding_, binding_->bus.get()},
+      cache_{std::make_shared<Cache>()}
+{
+    bus_->install_executor(core::dbus::asio::make_executor(binding_->bus, runtime->service()));
+
+    service_ = core::dbus::Service::use_service(bus_, biometry::dbus::interface::Service::name());
+    bus_daemon_ = core::dbus::Service::use_service<BusDaemon>(bus_)->object_for_path(BusDaemon::path());
+
+    auto signal = bus_daemon_->get_signal<BusDaemon::NameOwnerChanged>();
+
+    std::weak_ptr<Cache> wc{cache_};
+    signal->connect([wc](const BusDaemon::NameOwnerChanged::ArgumentType& args)
+    {
+        // We only care about the daemon (re-)appearing on the bus. Objects created for a previous
+        // daemon instance refer to state that is gone, we thus drop all of them.
+        if (std::get<0>(args) != biometry::dbus::interface::Service::name() || std::get<2>(args).empty())
+            return;
+
+        if (auto sc = wc.lock())
+            sc->invalidate();
+    });
+
+    name_owner_changed_ = signal;
+}
+
+const core::dbus::Bus::Ptr& biometry::dbus::ClientConnection::bus() const
+{
+    return bus_;
+}
+
+const std::shared_ptr<biometry::Runtime>& biometry::dbus::ClientConnection::runtime() const
+{
+    return binding_->runtime;
+}
+
+const core::dbus::Service::Ptr& biometry::dbus::ClientConnection::service() const
+{
+    return service_;
+}
+
+core::dbus::Object::Ptr biometry::dbus::ClientConnection::object_for_path(const core::dbus::types::ObjectPath& path)
+{
+    return cache_->object_for_path(service_, path);
+}
+
+std::uint64_t biometry::dbus::ClientConnection::generation() const
+{
+    return cache_->generation.load();
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_CLIENT_CONNECTION_H_
+#define BIOMETRYD_DBUS_CLIENT_CONNECTION_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <core/dbus/bus.h>
+#include <core/dbus/object.h>
+#include <core/dbus/service.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace biometry
+{
+/// @cond
+class Runtime;
+/// @endcond
+
+namespace dbus
+{
+/// @brief ClientConnection bundles the bus connection, the executor and the service proxy shared by all stubs of a process.
+///
+/// Stubs hold on to the instance they were created for, and the process-wide instance handed out
+/// by ClientConnection::instance is torn down once the last stub referring to it goes away. The
+/// runtime executing the bus connection is owned by the instance and stays around for as long as
+/// anybody holds on to the bus connection. Objects
+/// returned from object_for_path are cached and dropped whenever the daemon (re-)appears on the bus,
+/// such that subsequent calls reach the objects exported by the new daemon instance.
+class BIOMETRY_DLL_PUBLIC ClientConnection : public DoNotCopyOrMove
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<ClientConnection> Ptr;
+
+    /// @brief BusFactory models creation of bus instances.
+    typedef std::function<core::dbus::Bus::Ptr()> BusFactory;
+
+    /// @brief instance returns the process-wide instance connected to the system bus.
+    ///
+    /// A new connection is established if no other caller holds on to the previous instance anymore.
+    static Ptr instance();
+
+    /// @brief create returns a new instance for a bus created by bus_factory, executed by runtime.
+    static Ptr create(const BusFactory& bus_factory, const std::shared_ptr<Runtime>& runtime);
+
+    /// @brief bus returns the bus connection.
+    const core::dbus::Bus::Ptr& bus() const;
+
+    /// @brief runtime returns the runtime executing the bus connection.
+    const std::shared_ptr<Runtime>& runtime() const;
+
+    /// @brief service returns the proxy for com.ubuntu.biometryd.Service.
+    const core::dbus::Service::Ptr& service() const;
+
+    /// @brief object_for_path returns the proxy for the remote object at path, reusing a previously created one if possible.
+    core::dbus::Object::Ptr object_for_path(const core::dbus::types::ObjectPath& path);
+
+    /// @brief generation returns the number of times the daemon has (re-)appeared on the bus since connecting.
+    std::uint64_t generation() const;
+
+private:
+    /// @cond
+    class Cache;
+    struct Binding;
+
+    ClientConnection(const core::dbus::Bus::Ptr& bus, const std::shared_ptr<Runtime>& runtime);
+
+    std::shared_ptr<Binding> binding_;
+    core::dbus::Bus::Ptr bus_;
+    core::dbus::Service::Ptr service_;
+    core::dbus::Object::Ptr bus_daemon_;
+    std::shared_ptr<Cache> cache_;
+    std::shared_ptr<void> name_owner_changed_;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRYD_DBUS_CLIENT_CONNECTION_H_
@@ -21,19 +21,24 @@
 #define BIOMETRYD_DBUS_CODEC_H_
 
 #include <biometry/application.h>
+#include <biometry/dictionary.h>
 #include <biometry/geometry.h>
 #include <biometry/progress.h>
 #include <biometry/reason.h>
 #include <biometry/user.h>
 #include <biometry/variant.h>
+#include <biometry/verifier.h>
 #include <biometry/void.h>
 
+#include <biometry/dbus/fixed_array.h>
+
 #include <core/dbus/types/variant.h>
 #include <core/dbus/types/stl/map.h>
 #include <core/dbus/types/stl/string.h>
 #include <core/dbus/types/stl/vector.h>
 
 #include <iostream>
+#include <stdexcept>
 
 namespace core
 {
@@ -139,6 +144,39 @@ struct TypeMapper<biometry::Variant>
     }
 };
 
+template<>
+struct TypeMapper<biometry::Dictionary>
+{
+    constexpr static inline ArgumentType type_value()
+    {
+        return ArgumentType::array;
+    }
+
+    constexpr static bool is_basic_type()
+    {
+        return false;
+    }
+
+    constexpr static bool requires_signature()
+    {
+        return true;
+    }
+
+    // We stay compatible with the signature of std::map<std::string, biometry::Variant>.
+    static std::string entry_signature()
+    {
+        return DBUS_DICT_ENTRY_BEGIN_CHAR_AS_STRING
+                + TypeMapper<std::string>::signature()
+                + TypeMapper<biometry::Variant>::signature()
+                + DBUS_DICT_ENTRY_END_CHAR_AS_STRING;
+    }
+
+    static std::string signature()
+    {
+        return DBUS_TYPE_ARRAY_AS_STRING + entry_signature();
+    }
+};
+
 template<>
 struct TypeMapper<biometry::Void>
 {
@@ -176,28 +214,6 @@ template<> struct Codec<biometry::Application>
     }
 };
 
-template<> struct Codec<biometry::Progress>
-{
-    static void encode_argument(Message::Writer& out, const biometry::Progress& in)
-    {
-        auto sw = out.open_structure();
-        {
-            sw.push_floating_point(*in.percent);
-            Codec<biometry::Dictionary>::encode_argument(sw, in.details);
-        }
-        out.close_structure(std::move(sw));
-    }
-
-    static void decode_argument(Message::Reader& in, biometry::Progress& out)
-    {
-        auto sr = in.pop_structure();
-        {
-            out.percent = biometry::Percent::from_raw_value(sr.pop_floating_point());
-            Codec<biometry::Dictionary>::decode_argument(sr, out.details);
-        }
-    }
-};
-
 template<> struct Codec<biometry::Point>
 {
     static void encode_argument(Message::Writer& out, const biometry::Point& in)
@@ -264,6 +280,19 @@ template<> struct Codec<biometry::User>
     }
 };
 
+template<> struct Codec<biometry::Verification::Result>
+{
+    static void encode_argument(Message::Writer& out, const biometry::Verification::Result& in)
+    {
+        out.push_uint32(static_cast<std::uint32_t>(in));
+    }
+
+    static void decode_argument(Message::Reader& in, biometry::Verification::Result& out)
+    {
+        out = static_cast<biometry::Verification::Result>(in.pop_uint32());
+    }
+};
+
 template<> struct Codec<biometry::Variant::None>
 {
     static void encode_argument(Message::Writer& out, const biometry::Variant::None&)
@@ -343,6 +372,11 @@ template<> struct Codec<biometry::Variant>
             }
             case biometry::Variant::Type::blob:
             {
+                auto vw = sw.open_variant(types::Signature{helper::TypeMapper<std::vector<std::uint8_t>>::signature()});
+                {
+                    Codec<biometry::Variant>::encode_blob(vw, in.blob());
+                }
+                sw.close_variant(std::move(vw));
                 break;
             }
             case biometry::Variant::Type::vector:
@@ -375,6 +409,7 @@ template<> struct Codec<biometry::Variant>
             {
             case biometry::Variant::Type::none:
                 static biometry::Variant::None none; Codec<biometry::Variant::None>::decode_argument(vr, none);
+                out = biometry::Variant{};
                 break;
             case biometry::Variant::Type::boolean:
             {
@@ -404,17 +439,101 @@ template<> struct Codec<biometry::Variant>
             }
             case biometry::Variant::Type::blob:
             {
+                // We copy the payload exactly once, from the message straight into the vector handed over to out.
+                auto view = biometry::dbus::pop_byte_array(vr);
+                out = biometry::Variant{std::vector<std::uint8_t>(view.data, view.data + view.size)};
                 break;
             }
             case biometry::Variant::Type::vector:
             {
                 std::vector<biometry::Variant> v; Codec<std::vector<biometry::Variant>>::decode_argument(vr, v);
-                out.vector(v);
+                out = biometry::Variant{std::move(v)};
                 break;
             }
             }
         }
     }
+
+    // encode_blob writes blob as an array of bytes, in a single call to libdbus.
+    static void encode_blob(Message::Writer& out, const std::vector<std::uint8_t>& blob)
+    {
+        biometry::dbus::append_byte_array(out, blob.data(), blob.size());
+    }
+
+    // decode_blob reads a variant holding an array of bytes, as written by encode_argument for blobs,
+    // without copying the payload. The view keeps the message alive.
+    static void decode_blob(Message::Reader& in, biometry::dbus::BlobView& view)
+    {
+        auto sr = in.pop_structure();
+        {
+            if (static_cast<biometry::Variant::Type>(sr.pop_uint16()) != biometry::Variant::Type::blob)
+                throw std::runtime_error{"Expected a blob"};
+
+            auto vr = sr.pop_variant();
+            view = biometry::dbus::pop_byte_array(vr);
+        }
+    }
+};
+
+template<> struct Codec<biometry::Dictionary>
+{
+    static void encode_argument(Message::Writer& out, const biometry::Dictionary& in)
+    {
+        static const types::Signature signature{helper::TypeMapper<biometry::Dictionary>::entry_signature()};
+
+        auto aw = out.open_array(signature);
+        {
+            for (const auto& entry : in)
+            {
+                auto dw = aw.open_dict_entry();
+                {
+                    dw.push_stringn(entry.first.c_str(), entry.first.size());
+                    Codec<biometry::Variant>::encode_argument(dw, entry.second);
+                }
+                aw.close_dict_entry(std::move(dw));
+            }
+        }
+        out.close_array(std::move(aw));
+    }
+
+    static void decode_argument(Message::Reader& in, biometry::Dictionary& out)
+    {
+        out.clear();
+
+        auto ar = in.pop_array();
+        while (ar.type() != ArgumentType::invalid)
+        {
+            auto dr = ar.pop_dict_entry();
+            {
+                // Entries arrive sorted if sent by another Dictionary, which keeps insertion cheap.
+                biometry::Dictionary::Key key{std::string{dr.pop_string()}};
+                biometry::Variant value; Codec<biometry::Variant>::decode_argument(dr, value);
+                out.insert(std::make_pair(std::move(key), std::move(value)));
+            }
+        }
+    }
+};
+
+template<> struct Codec<biometry::Progress>
+{
+    static void encode_argument(Message::Writer& out, const biometry::Progress& in)
+    {
+        auto sw = out.open_structure();
+        {
+            sw.push_floating_point(*in.percent);
+            Codec<biometry::Dictionary>::encode_argument(sw, in.details);
+        }
+        out.close_structure(std::move(sw));
+    }
+
+    static void decode_argument(Message::Reader& in, biometry::Progress& out)
+    {
+        auto sr = in.pop_structure();
+        {
+            out.percent = biometry::Percent::from_raw_value(sr.pop_floating_point());
+            Codec<biometry::Dictionary>::decode_argument(sr, out.details);
+        }
+    }
 };
 
 template<> struct Codec<biometry::Void>
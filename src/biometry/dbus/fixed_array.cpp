@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/fixed_array.h>
+
+#include <dbus/dbus.h>
+
+#include <stdexcept>
+
+namespace
+{
+// dbus-cpp neither exposes libdbus' fixed array support nor the libdbus iterators of its readers
+// and writers, which would force us to marshal blobs byte by byte. We reach the iterators through
+// the private implementation of readers and writers instead, which bundles the message and the
+// iterator positioned in it. Iterator mirrors its layout.
+struct Iterator
+{
+    core::dbus::Message::Ptr message;
+    DBusMessageIter iter;
+};
+
+// Expose hands out a pointer to a private member through a friend function found via Tag,
+// relying on access checks not applying to explicit instantiations.
+template<typename Tag, typename Member, Member member>
+struct Expose
+{
+    friend auto access(Tag)
+    {
+        return member;
+    }
+};
+
+struct ReaderTag
+{
+    friend auto access(ReaderTag);
+};
+
+struct WriterTag
+{
+    friend auto access(WriterTag);
+};
+
+template struct Expose<ReaderTag, decltype(&core::dbus::Message::Reader::d), &core::dbus::Message::Reader::d>;
+template struct Expose<WriterTag, decltype(&core::dbus::Message::Writer::d), &core::dbus::Message::Writer::d>;
+
+Iterator& iterator_of(core::dbus::Message::Reader& reader)
+{
+    return *reinterpret_cast<Iterator*>((reader.*access(ReaderTag{})).get());
+}
+
+Iterator& iterator_of(core::dbus::Message::Writer& writer)
+{
+    return *reinterpret_cast<Iterator*>((writer.*access(WriterTag{})).get());
+}
+}
+
+void biometry::dbus::append_byte_array(core::dbus::Message::Writer& out, const std::uint8_t* data, std::size_t size)
+{
+    auto& it = iterator_of(out);
+
+    DBusMessageIter sub;
+    if (not dbus_message_iter_open_container(&it.iter, DBUS_TYPE_ARRAY, DBUS_TYPE_BYTE_AS_STRING, &sub))
+        throw std::runtime_error{"Failed to open array of bytes"};
+
+    if (not dbus_message_iter_append_fixed_array(&sub, DBUS_TYPE_BYTE, &data, static_cast<int>(size)))
+    {
+        dbus_message_iter_abandon_container(&it.iter, &sub);
+        throw std::runtime_error{"Failed to append array of bytes"};
+    }
+
+    if (not dbus_message_iter_close_container(&it.iter, &sub))
+        throw std::runtime_error{"Failed to close array of bytes"};
+}
+
+biometry::dbus::BlobView biometry::dbus::pop_byte_array(core::dbus::Message::Reader& in)
+{
+    auto& it = iterator_of(in);
+
+    if (dbus_message_iter_get_arg_type(&it.iter) != DBUS_TYPE_ARRAY || dbus_message_iter_get_element_type(&it.iter) != DBUS_TYPE_BYTE)
+        throw std::runtime_error{"Expected an array of bytes"};
+
+    DBusMessageIter sub;
+    dbus_message_iter_recurse(&it.iter, &sub);
+
+    const std::uint8_t* data{nullptr}; int size{0};
+    dbus_message_iter_get_fixed_array(&sub, &data, &size);
+    dbus_message_iter_next(&it.iter);
+
+    return BlobView{it.message, data, static_cast<std::size_t>(size)};
+}
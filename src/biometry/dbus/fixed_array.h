@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_FIXED_ARRAY_H_
+#define BIOMETRYD_DBUS_FIXED_ARRAY_H_
+
+#include <biometry/visibility.h>
+
+#include <core/dbus/message.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace biometry
+{
+namespace dbus
+{
+/// @brief BlobView refers to the payload of a byte array in a message, without copying it.
+///
+/// data stays valid for as long as the view holds on to message.
+struct BIOMETRY_DLL_PUBLIC BlobView
+{
+    /// @brief message contains the payload.
+    core::dbus::Message::Ptr message;
+    /// @brief data points to the first byte of the payload.
+    const std::uint8_t* data;
+    /// @brief size is the number of bytes in the payload.
+    std::size_t size;
+};
+
+/// @brief append_byte_array appends size bytes starting at data to out as an array of bytes, in a single call to libdbus.
+BIOMETRY_DLL_PUBLIC void append_byte_array(core::dbus::Message::Writer& out, const std::uint8_t* data, std::size_t size);
+
+/// @brief pop_byte_array reads the array of bytes at the current position of in, without copying its payload.
+/// @throws std::runtime_error if in is not positioned at an array of bytes.
+BIOMETRY_DLL_PUBLIC BlobView pop_byte_array(core::dbus::Message::Reader& in);
+}
+}
+
+#endif // BIOMETRYD_DBUS_FIXED_ARRAY_H_
@@ -22,6 +22,7 @@
 
 #include <core/dbus/macros.h>
 #include <core/dbus/types/object_path.h>
+#include <core/dbus/types/unix_fd.h>
 
 #include <chrono>
 #include <string>
@@ -41,6 +42,22 @@ struct Errors
             return "com.ubuntu.biometryd.Error.NotPermitted";
         }
     };
+
+    struct InvalidSideChannel
+    {
+        static inline std::string name()
+        {
+            return "com.ubuntu.biometryd.Error.InvalidSideChannel";
+        }
+    };
+
+    struct Busy
+    {
+        static inline std::string name()
+        {
+            return "com.ubuntu.biometryd.Error.Busy";
+        }
+    };
 };
 
 struct Service
@@ -74,6 +91,98 @@ struct Service
                 return std::chrono::seconds{5};
             }
         };
+
+        // Replies with true if the default device has been instantiated and is ready to serve requests.
+        // Requests issued before are parked until the device becomes available.
+        struct IsReady
+        {
+            static inline std::string name()
+            {
+                return "IsReady";
+            }
+
+            typedef biometry::dbus::interface::Service Interface;
+            typedef bool ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+    };
+
+    struct Signals
+    {
+        Signals() = delete;
+
+        // Emitted once the daemon is done instantiating the default device. The argument
+        // is true if the device is ready to serve requests and false if instantiation failed.
+        struct Ready
+        {
+            static inline std::string name()
+            {
+                return "Ready";
+            }
+
+            typedef biometry::dbus::interface::Service Interface;
+            typedef bool ArgumentType;
+        };
+    };
+};
+
+// Metrics exposes runtime statistics about the daemon, see biometry::util::Metrics.
+struct Metrics
+{
+    static inline const std::string& name()
+    {
+        static const std::string s{"com.ubuntu.biometryd.Metrics"};
+        return s;
+    }
+
+    static inline core::dbus::types::ObjectPath path()
+    {
+        return core::dbus::types::ObjectPath{"/metrics"};
+    }
+
+    struct Methods
+    {
+        Methods() = delete;
+
+        // Replies with a snapshot of all instruments, one "name value" pair per line.
+        struct Dump
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"Dump"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::Metrics Interface;
+            typedef std::string ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Replies with all buffered trace events in the Chrome trace-event format, see biometry::util::trace::Tracer.
+        struct Trace
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"Trace"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::Metrics Interface;
+            typedef std::string ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
     };
 };
 
@@ -172,6 +281,75 @@ struct Identifier
                 return std::chrono::seconds{5};
             }
         };
+
+        // Creates an identification operation and starts it with the observer
+        // exported by the caller at the given path, replying with the operation's path.
+        struct IdentifyUserAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"IdentifyUserAndStart"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::Identifier Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+    };
+};
+
+struct Verifier
+{
+    static inline const std::string& name()
+    {
+        static const std::string s{"com.ubuntu.biometryd.Verifier"};
+        return s;
+    }
+
+    struct Methods
+    {
+        Methods() = delete;
+
+        struct VerifyUser
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"VerifyUser"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::Verifier Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Creates a verification operation and starts it with the observer
+        // exported by the caller at the given path, replying with the operation's path.
+        struct VerifyUserAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"VerifyUserAndStart"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::Verifier Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
     };
 };
 
@@ -265,6 +443,101 @@ struct TemplateStore
             }
 
 
+            typedef biometry::dbus::interface::TemplateStore Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Creates a size operation and starts it with the observer exported by
+        // the caller at the given path, replying with the operation's path.
+        struct SizeAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"SizeAndStart"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::TemplateStore Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Creates a list operation and starts it with the observer exported by
+        // the caller at the given path, replying with the operation's path.
+        struct ListAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"ListAndStart"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::TemplateStore Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Creates an enroll operation and starts it with the observer exported by
+        // the caller at the given path, replying with the operation's path.
+        struct EnrollAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"EnrollAndStart"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::TemplateStore Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Creates a remove operation and starts it with the observer exported by
+        // the caller at the given path, replying with the operation's path.
+        struct RemoveAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"RemoveAndStart"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::TemplateStore Interface;
+            typedef core::dbus::types::ObjectPath ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
+        // Creates a clear operation and starts it with the observer exported by
+        // the caller at the given path, replying with the operation's path.
+        struct ClearAndStart
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"ClearAndStart"};
+                return s;
+            }
+
             typedef biometry::dbus::interface::TemplateStore Interface;
             typedef core::dbus::types::ObjectPath ResultType;
 
@@ -325,6 +598,26 @@ struct Operation
             }
         };
 
+        // Starts the operation with the observer exported by the caller at the given path, passing
+        // large blobs in progress details through the SideChannel backed by the given memfd. The
+        // observer calls then only carry references into the shared memory.
+        struct StartWithObserverAndSideChannel
+        {
+            static inline const std::string& name()
+            {
+                static const std::string s{"StartWithObserverAndSideChannel"};
+                return s;
+            }
+
+            typedef biometry::dbus::interface::Operation Interface;
+            typedef void ResultType;
+
+            inline static const std::chrono::milliseconds default_timeout()
+            {
+                return std::chrono::seconds{5};
+            }
+        };
+
         struct Cancel
         {
             static inline const std::string& name()
@@ -18,17 +18,11 @@
  */
 
 #include <biometry/dbus/service.h>
+#include <biometry/dbus/client_connection.h>
 #include <biometry/dbus/stub/service.h>
 
-#include <biometry/runtime.h>
-
-#include <core/dbus/bus.h>
-#include <core/dbus/asio/executor.h>
-
 std::shared_ptr<biometry::Service> biometry::dbus::Service::create_stub()
-{    
-    auto bus = std::make_shared<core::dbus::Bus>(core::dbus::WellKnownBus::system);
-    bus->install_executor(core::dbus::asio::make_executor(bus));
-
-    return biometry::dbus::stub::Service::create_for_bus(bus);
+{
+    // All stubs of a process share a single connection to the bus, executed by a single runtime.
+    return biometry::dbus::stub::Service::create_for_connection(biometry::dbus::ClientConnection::instance());
 }
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/side_channel.h>
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/memfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+#ifndef F_GET_SEALS
+#define F_GET_SEALS 1034
+#endif
+
+namespace
+{
+// The first bytes of the shared memory identify a side channel and its layout.
+struct Header
+{
+    std::uint64_t magic;
+    std::uint64_t capacity;
+};
+
+// Records start after a cache line reserved for the header, and are 8-byte aligned.
+constexpr const std::size_t ring_offset{64};
+constexpr const std::uint64_t magic{0x62696f6d65747279}; // "biometry"
+
+// Every record starts with a sequence number and the length of the payload. A sequence
+// number of 0 marks a record as invalid, either being written or overwritten.
+constexpr const std::size_t record_header_size{2 * sizeof(std::uint64_t)};
+
+// A reference to a blob in the ring is a vector of the marker, offset, length and sequence number.
+constexpr const char* reference_marker{"biometry::dbus::SideChannel::Reference"};
+
+std::size_t record_size_for(std::size_t payload)
+{
+    return record_header_size + ((payload + 7) & ~std::size_t{7});
+}
+
+std::system_error last_error(const char* what)
+{
+    return std::system_error{errno, std::system_category(), what};
+}
+
+bool is_reference(const biometry::Variant& v)
+{
+    if (v.type() != biometry::Variant::Type::vector)
+        return false;
+
+    const auto& vector = v.vector();
+
+    return vector.size() == 4
+            && vector[0].type() == biometry::Variant::Type::string && vector[0].string() == reference_marker
+            && vector[1].type() == biometry::Variant::Type::integer
+            && vector[2].type() == biometry::Variant::Type::integer
+            && vector[3].type() == biometry::Variant::Type::integer;
+}
+}
+
+constexpr const std::size_t biometry::dbus::SideChannel::default_capacity;
+constexpr const std::size_t biometry::dbus::SideChannel::default_threshold;
+
+biometry::dbus::SideChannel::Ptr biometry::dbus::SideChannel::create(std::size_t capacity, std::size_t threshold)
+{
+#if defined(SYS_memfd_create)
+    int fd = ::syscall(SYS_memfd_create, "biometryd-side-channel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+    int fd = -1; errno = ENOSYS;
+#endif
+    if (fd < 0)
+        throw last_error("SideChannel::create: failed to create memfd");
+
+    const std::size_t size = ring_offset + capacity;
+
+    if (::ftruncate(fd, size) < 0)
+    {
+        auto error = last_error("SideChannel::create: failed to resize memfd");
+        ::close(fd); throw error;
+    }
+
+    // Peers must not be able to resize the memory under our feet, which would result in SIGBUS.
+    if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0)
+    {
+        auto error = last_error("SideChannel::create: failed to seal memfd");
+        ::close(fd); throw error;
+    }
+
+    auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        auto error = last_error("SideChannel::create: failed to map memfd");
+        ::close(fd); throw error;
+    }
+
+    auto header = static_cast<Header*>(data);
+    header->magic = magic;
+    header->capacity = capacity;
+
+    return Ptr{new SideChannel{fd, static_cast<std::uint8_t*>(data), size, threshold}};
+}
+
+biometry::dbus::SideChannel::Ptr biometry::dbus::SideChannel::attach(int fd, std::size_t threshold)
+{
+    const int required_seals = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL;
+
+    int seals = ::fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (seals & required_seals) != required_seals)
+    {
+        ::close(fd); throw std::runtime_error{"SideChannel::attach: fd is not sealed"};
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0)
+    {
+        auto error = last_error("SideChannel::attach: failed to query fd");
+        ::close(fd); throw error;
+    }
+
+    const std::size_t size = st.st_size;
+    if (size <= ring_offset)
+    {
+        ::close(fd); throw std::runtime_error{"SideChannel::attach: fd is too small for a side channel"};
+    }
+
+    auto data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        auto error = last_error("SideChannel::attach: failed to map fd");
+        ::close(fd); throw error;
+    }
+
+    auto header = static_cast<const Header*>(data);
+    if (header->magic != magic || header->capacity != size - ring_offset)
+    {
+        ::munmap(data, size); ::close(fd);
+        throw std::runtime_error{"SideChannel::attach: fd does not refer to a side channel"};
+    }
+
+    return Ptr{new SideChannel{fd, static_cast<std::uint8_t*>(data), size, threshold}};
+}
+
+biometry::dbus::SideChannel::~SideChannel()
+{
+    ::munmap(data, size);
+    ::close(fd_);
+}
+
+int biometry::dbus::SideChannel::fd() const
+{
+    return fd_;
+}
+
+biometry::Progress biometry::dbus::SideChannel::pack(const Progress& progress)
+{
+    Progress result{progress.percent, Dictionary{}};
+    result.details.reserve(progress.details.size());
+
+    std::lock_guard<std::mutex> lg{guard};
+
+    for (const auto& entry : progress.details)
+    {
+        const auto& value = entry.second;
+
+        if (value.type() != Variant::Type::blob
+                || value.blob().size() < threshold
+                || record_size_for(value.blob().size()) > size - ring_offset)
+        {
+            result.details.insert(entry);
+            continue;
+        }
+
+        auto sequence = next_sequence++;
+        auto offset = write(value.blob(), sequence);
+
+        result.details.insert(std::make_pair(entry.first, Variant::v(
+        {
+            Variant::s(reference_marker),
+            Variant::i(offset),
+            Variant::i(value.blob().size()),
+            Variant::i(sequence)
+        })));
+    }
+
+    return result;
+}
+
+biometry::Progress biometry::dbus::SideChannel::unpack(const Progress& progress) const
+{
+    Progress result{progress.percent, Dictionary{}};
+    result.details.reserve(progress.details.size());
+
+    for (const auto& entry : progress.details)
+    {
+        if (not is_reference(entry.second))
+        {
+            result.details.insert(entry);
+            continue;
+        }
+
+        const auto& reference = entry.second.vector();
+
+        std::vector<std::uint8_t> payload;
+        if (read(reference[1].integer(), reference[2].integer(), reference[3].integer(), payload))
+            result.details.insert(std::make_pair(entry.first, Variant{std::move(payload)}));
+    }
+
+    return result;
+}
+
+biometry::dbus::SideChannel::SideChannel(int fd, std::uint8_t* data, std::size_t size, std::size_t threshold)
+    : fd_{fd},
+      data{data},
+      size{size},
+      threshold{threshold},
+      head{ring_offset}
+{
+}
+
+std::size_t biometry::dbus::SideChannel::write(const std::vector<std::uint8_t>& payload, std::uint64_t sequence)
+{
+    const auto record_size = record_size_for(payload.size());
+
+    if (head + record_size > size)
+        head = ring_offset;
+
+    const auto begin = head, end = head + record_size;
+
+    // We invalidate all records we are about to overwrite before touching their memory.
+    for (auto it = records.begin(); it != records.end();)
+    {
+        if (it->first < end && begin < it->second)
+        {
+            __atomic_store_n(reinterpret_cast<std::uint64_t*>(data + it->first), 0, __ATOMIC_RELAXED);
+            it = records.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    auto record = reinterpret_cast<std::uint64_t*>(data + begin);
+
+    __atomic_store_n(&record[0], 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    record[1] = payload.size();
+    std::memcpy(data + begin + record_header_size, payload.data(), payload.size());
+
+    __atomic_store_n(&record[0], sequence, __ATOMIC_RELEASE);
+
+    records.push_back(std::make_pair(begin, end));
+    head = end;
+
+    return begin;
+}
+
+bool biometry::dbus::SideChannel::read(std::size_t offset, std::size_t length, std::uint64_t sequence, std::vector<std::uint8_t>& payload) const
+{
+    // We do not trust references, and validate them against the mapped memory.
+    if (offset < ring_offset || offset % 8 != 0 || offset > size || record_size_for(length) > size - offset)
+        return false;
+
+    auto record = reinterpret_cast<const std::uint64_t*>(data + offset);
+
+    if (__atomic_load_n(&record[0], __ATOMIC_ACQUIRE) != sequence || record[1] != length)
+        return false;
+
+    payload.resize(length);
+    std::memcpy(payload.data(), data + offset + record_header_size, length);
+
+    // The writer might have overwritten the record while we were copying.
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&record[0], __ATOMIC_RELAXED) == sequence;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_SIDE_CHANNEL_H_
+#define BIOMETRYD_DBUS_SIDE_CHANNEL_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/progress.h>
+#include <biometry/visibility.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace biometry
+{
+namespace dbus
+{
+/// @brief SideChannel passes large blobs in progress details out of band, through a ring buffer
+/// in shared memory backed by a memfd.
+///
+/// The client creates an instance and hands its fd to the daemon, which attaches to it. The daemon
+/// packs progress before sending it, moving blobs into the ring and replacing them with references
+/// that are resolved by unpack on the client side. The writer never waits for the reader: references
+/// to data that has been overwritten in the meantime are detected and dropped.
+class BIOMETRY_DLL_PUBLIC SideChannel : public DoNotCopyOrMove
+{
+public:
+    // Safe us some typing
+    typedef std::shared_ptr<SideChannel> Ptr;
+
+    /// @brief default_capacity is the default size of the ring buffer in bytes.
+    static constexpr const std::size_t default_capacity{4 * 1024 * 1024};
+    /// @brief default_threshold is the default size in bytes a blob has to reach to be passed through the ring.
+    static constexpr const std::size_t default_threshold{4 * 1024};
+
+    /// @brief create returns a new instance, backed by a fresh, sealed memfd of the given capacity.
+    /// @throws std::system_error if creating or mapping the memfd fails.
+    static Ptr create(std::size_t capacity, std::size_t threshold);
+
+    /// @brief attach returns a new instance mapping fd, taking ownership of fd.
+    ///
+    /// fd is checked for having been created by create. In particular, its size must be sealed
+    /// such that a peer cannot truncate the memory and fault the process.
+    /// @throws std::system_error if mapping fd fails, std::runtime_error if fd does not refer to a side channel.
+    static Ptr attach(int fd, std::size_t threshold);
+
+    /// @brief Unmaps the shared memory and closes the underlying fd.
+    ~SideChannel();
+
+    /// @brief fd returns the fd backing the shared memory.
+    int fd() const;
+
+    /// @brief pack moves blobs of at least threshold bytes from progress.details into the ring.
+    Progress pack(const Progress& progress);
+
+    /// @brief unpack resolves references in progress.details, dropping references to data that has been overwritten.
+    Progress unpack(const Progress& progress) const;
+
+private:
+    /// @cond
+    SideChannel(int fd, std::uint8_t* data, std::size_t size, std::size_t threshold);
+
+    /// @brief write places payload in the ring, returning the offset of its record.
+    std::size_t write(const std::vector<std::uint8_t>& payload, std::uint64_t sequence);
+
+    /// @brief read copies the payload of the record at offset to payload, returning false if it is stale.
+    bool read(std::size_t offset, std::size_t length, std::uint64_t sequence, std::vector<std::uint8_t>& payload) const;
+
+    int fd_;
+    std::uint8_t* data;
+    std::size_t size;
+    std::size_t threshold;
+
+    // Only accessed when packing.
+    std::mutex guard;
+    std::size_t head{0};
+    std::uint64_t next_sequence{1};
+    std::deque<std::pair<std::size_t, std::size_t>> records;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRYD_DBUS_SIDE_CHANNEL_H_
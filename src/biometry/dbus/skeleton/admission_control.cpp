@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/admission_control.h>
+
+#include <biometry/util/metrics.h>
+#include <biometry/util/trace.h>
+
+#include <algorithm>
+#include <ostream>
+
+namespace
+{
+double floating_point_of(const biometry::Variant& value)
+{
+    return value.type() == biometry::Variant::Type::integer ? value.integer() : value.floating_point();
+}
+}
+
+biometry::dbus::skeleton::AdmissionControl::Configuration biometry::dbus::skeleton::AdmissionControl::Configuration::from_configuration(const util::Configuration::Node& node)
+{
+    Configuration configuration;
+
+    if (auto n = node["maxOperationsPerPeer"])
+        configuration.max_operations_per_peer = n.value().integer();
+
+    if (auto n = node["maxOperationsPerApp"])
+        configuration.max_operations_per_app = n.value().integer();
+
+    if (auto n = node["requestsPerSecond"])
+        configuration.requests_per_second = floating_point_of(n.value());
+
+    if (auto n = node["burst"])
+        configuration.burst = n.value().integer();
+
+    // Arrays end up as nodes without a value, with children named by index.
+    const auto& trusted_apps = node["trustedApps"];
+    if (not trusted_apps.children().empty())
+    {
+        configuration.trusted_apps.clear();
+        for (const auto& pair : trusted_apps.children())
+            configuration.trusted_apps.insert(pair.second.value().string());
+    }
+
+    return configuration;
+}
+
+biometry::dbus::skeleton::AdmissionControl::Ticket::Ticket(const std::function<void()>& on_release)
+    : on_release{on_release}
+{
+}
+
+biometry::dbus::skeleton::AdmissionControl::Ticket::~Ticket()
+{
+    release();
+}
+
+void biometry::dbus::skeleton::AdmissionControl::Ticket::release()
+{
+    std::call_once(once, [this]() { on_release(); });
+}
+
+biometry::dbus::skeleton::AdmissionControl::Admission::operator bool() const
+{
+    return verdict == Verdict::admitted;
+}
+
+biometry::dbus::skeleton::AdmissionControl::Ptr biometry::dbus::skeleton::AdmissionControl::create(const Configuration& configuration)
+{
+    return Ptr{new AdmissionControl{configuration}};
+}
+
+biometry::dbus::skeleton::AdmissionControl::AdmissionControl(const Configuration& configuration)
+    : configuration(configuration),
+      forgotten_at{Clock::now()}
+{
+}
+
+biometry::dbus::skeleton::AdmissionControl::Admission biometry::dbus::skeleton::AdmissionControl::admit(const std::string& peer, const Application& app, const Clock::time_point& now)
+{
+    static auto& admitted = util::metrics().counter("admission.admitted");
+    static auto& rejected = util::metrics().counter("admission.rejected");
+
+    Verdict verdict{Verdict::admitted};
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        forget_idle_peers(now);
+
+        auto it = peers.find(peer);
+        if (it == peers.end())
+            it = peers.insert(std::make_pair(peer, Peer{app, static_cast<double>(configuration.burst), now, now, 0, 0, 0})).first;
+
+        auto& p = it->second;
+        p.active_at = now;
+
+        auto jt = apps.find(app.as_string());
+        if (jt == apps.end())
+            jt = apps.insert(std::make_pair(app.as_string(), App{now, 0, 0})).first;
+
+        auto& a = jt->second;
+        a.active_at = now;
+
+        bool trusted = configuration.trusted_apps.count(app.as_string()) > 0;
+        bool rate_limited = configuration.requests_per_second > 0 && configuration.burst > 0;
+
+        if (rate_limited)
+        {
+            std::chrono::duration<double> elapsed = now - p.refilled_at;
+            p.tokens = std::min<double>(configuration.burst, p.tokens + elapsed.count() * configuration.requests_per_second);
+            p.refilled_at = std::max(p.refilled_at, now);
+        }
+
+        // Trusted peers are accounted for, but never rejected.
+        if (trusted)
+            verdict = Verdict::admitted;
+        else if (configuration.max_operations_per_peer > 0 && p.in_flight >= configuration.max_operations_per_peer)
+            verdict = Verdict::too_many_operations_for_peer;
+        else if (configuration.max_operations_per_app > 0 && a.in_flight >= configuration.max_operations_per_app)
+            verdict = Verdict::too_many_operations_for_app;
+        else if (rate_limited && p.tokens < 1.)
+            verdict = Verdict::rate_exceeded;
+
+        if (verdict != Verdict::admitted)
+        {
+            // Rejections are accounted for by app label, too, such that an abusive app can be told apart
+            // from the peers it spawned over time.
+            p.rejected++;
+            a.rejected++;
+        }
+        else
+        {
+            p.admitted++;
+            p.in_flight++;
+            a.in_flight++;
+            if (rate_limited && not trusted)
+                p.tokens -= 1.;
+        }
+    }
+
+    if (verdict != Verdict::admitted)
+    {
+        // App labels carry version strings, we thus do not export metrics by app label.
+        rejected.increment();
+        util::trace::tracer().instant("admission", "rejected");
+        return Admission{verdict, Ticket::Ptr{}};
+    }
+
+    admitted.increment();
+
+    std::weak_ptr<AdmissionControl> wp{shared_from_this()};
+    return Admission{verdict, std::make_shared<Ticket>([wp, peer, app]()
+    {
+        if (auto sp = wp.lock())
+            sp->release(peer, app);
+    })};
+}
+
+std::map<std::string, biometry::dbus::skeleton::AdmissionControl::Counters> biometry::dbus::skeleton::AdmissionControl::counters() const
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    std::map<std::string, Counters> result;
+    for (const auto& pair : peers)
+        result.insert(std::make_pair(pair.first, Counters{pair.second.app, pair.second.admitted, pair.second.rejected, pair.second.in_flight}));
+
+    return result;
+}
+
+std::map<std::string, biometry::dbus::skeleton::AdmissionControl::AppCounters> biometry::dbus::skeleton::AdmissionControl::app_counters() const
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    std::map<std::string, AppCounters> result;
+    for (const auto& pair : apps)
+        result.insert(std::make_pair(pair.first, AppCounters{pair.second.rejected, pair.second.in_flight}));
+
+    return result;
+}
+
+void biometry::dbus::skeleton::AdmissionControl::release(const std::string& peer, const Application& app)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    auto it = peers.find(peer);
+    if (it != peers.end() && it->second.in_flight > 0)
+    {
+        it->second.in_flight--;
+        // The peer stays idle from now on, unless it requests more operations.
+        it->second.active_at = Clock::now();
+    }
+
+    auto jt = apps.find(app.as_string());
+    if (jt != apps.end() && jt->second.in_flight > 0)
+    {
+        jt->second.in_flight--;
+        jt->second.active_at = Clock::now();
+    }
+}
+
+void biometry::dbus::skeleton::AdmissionControl::forget_idle_peers(const Clock::time_point& now)
+{
+    if (now - forgotten_at < configuration.idle_ttl)
+        return;
+
+    forgotten_at = now;
+
+    for (auto it = peers.begin(); it != peers.end();)
+    {
+        if (it->second.in_flight == 0 && now - it->second.active_at >= configuration.idle_ttl)
+            it = peers.erase(it);
+        else
+            ++it;
+    }
+
+    for (auto it = apps.begin(); it != apps.end();)
+    {
+        if (it->second.in_flight == 0 && now - it->second.active_at >= configuration.idle_ttl)
+            it = apps.erase(it);
+        else
+            ++it;
+    }
+}
+
+std::ostream& biometry::dbus::skeleton::operator<<(std::ostream& out, AdmissionControl::Verdict verdict)
+{
+    switch (verdict)
+    {
+    case AdmissionControl::Verdict::admitted: return out << "admitted";
+    case AdmissionControl::Verdict::too_many_operations_for_peer: return out << "too many operations in flight for peer";
+    case AdmissionControl::Verdict::too_many_operations_for_app: return out << "too many operations in flight for app";
+    case AdmissionControl::Verdict::rate_exceeded: return out << "request rate exceeded";
+    }
+
+    return out;
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_SKELETON_ADMISSION_CONTROL_H_
+#define BIOMETRYD_DBUS_SKELETON_ADMISSION_CONTROL_H_
+
+#include <biometry/application.h>
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <biometry/util/configuration.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+/// @brief AdmissionControl limits the operations peers are allowed to create on the bus.
+///
+/// A request is admitted if:
+///   * the peer has less than Configuration::max_operations_per_peer operations in flight,
+///   * the app label of the peer has less than Configuration::max_operations_per_app operations in flight,
+///   * the token bucket of the peer, holding up to Configuration::burst tokens and refilled at
+///     Configuration::requests_per_second, has a token left. Setting either of them to 0 disables the check.
+///
+/// Requests by peers running with one of the app labels in Configuration::trusted_apps are
+/// admitted without checking any of the limits, but are still accounted for.
+///
+/// An admitted operation is in flight until the ticket handed out on admission is released or destroyed.
+/// Peers and app labels without operations in flight are forgotten after Configuration::idle_ttl.
+/// Rejections are exported as a single admission.rejected metric, and are accounted for by peer and
+/// by app label in counters() and app_counters().
+class BIOMETRY_DLL_PUBLIC AdmissionControl : public DoNotCopyOrMove, public std::enable_shared_from_this<AdmissionControl>
+{
+public:
+    // Safe us some typing
+    typedef std::shared_ptr<AdmissionControl> Ptr;
+    typedef std::chrono::steady_clock Clock;
+
+    /// @brief Configuration bundles the limits enforced by an AdmissionControl instance.
+    ///
+    /// A limit of 0 disables the respective check.
+    struct BIOMETRY_DLL_PUBLIC Configuration
+    {
+        /// @brief from_configuration returns the default configuration, adjusted by the settings in node.
+        ///
+        /// node is expected to look like:
+        ///   {
+        ///     "maxOperationsPerPeer": 32,
+        ///     "maxOperationsPerApp": 64,
+        ///     "requestsPerSecond": 20,
+        ///     "burst": 40,
+        ///     "trustedApps": ["unconfined"]
+        ///   }
+        /// All entries are optional.
+        static Configuration from_configuration(const util::Configuration::Node& node);
+
+        /// @brief max_operations_per_peer is the number of operations a single peer might have in flight.
+        std::uint32_t max_operations_per_peer{32};
+        /// @brief max_operations_per_app is the number of operations all peers sharing an app label might have in flight.
+        std::uint32_t max_operations_per_app{64};
+        /// @brief requests_per_second is the rate at which the token bucket of a peer is refilled.
+        double requests_per_second{20.};
+        /// @brief burst is the capacity of the token bucket of a peer.
+        std::uint32_t burst{40};
+        /// @brief idle_ttl is the time the state of a peer without operations in flight is kept around.
+        std::chrono::milliseconds idle_ttl{std::chrono::minutes{5}};
+        /// @brief trusted_apps are the app labels exempt from all limits, e.g., the biometryd shell and benchmarks.
+        std::set<std::string> trusted_apps{"unconfined"};
+    };
+
+    /// @brief Verdict enumerates the outcomes of admitting a request.
+    enum class Verdict
+    {
+        admitted,                       ///< The request has been admitted.
+        too_many_operations_for_peer,   ///< The peer has too many operations in flight.
+        too_many_operations_for_app,    ///< The app label of the peer has too many operations in flight.
+        rate_exceeded                   ///< The peer has exhausted its token bucket.
+    };
+
+    /// @brief Ticket keeps an admitted operation in flight until released or destroyed.
+    class BIOMETRY_DLL_PUBLIC Ticket : public DoNotCopyOrMove
+    {
+    public:
+        // Safe us some typing
+        typedef std::shared_ptr<Ticket> Ptr;
+
+        /// @brief Ticket initializes a new instance, invoking on_release once the operation leaves flight.
+        explicit Ticket(const std::function<void()>& on_release);
+
+        /// @brief Releases the ticket if that has not happened before.
+        ~Ticket();
+
+        /// @brief release accounts for the operation leaving flight, subsequent calls are no-ops.
+        void release();
+
+    private:
+        /// @cond
+        std::once_flag once;
+        std::function<void()> on_release;
+        /// @endcond
+    };
+
+    /// @brief Admission bundles a verdict with the ticket of an admitted request.
+    struct Admission
+    {
+        /// @brief operator bool returns true if the request has been admitted.
+        explicit operator bool() const;
+
+        Verdict verdict;                ///< The verdict on the request.
+        Ticket::Ptr ticket;             ///< Keeps the admitted operation in flight, empty if rejected.
+    };
+
+    /// @brief Counters bundles statistics about the requests of a single peer.
+    struct Counters
+    {
+        Application app;            ///< The app label of the peer.
+        std::uint64_t admitted;     ///< The number of requests admitted so far.
+        std::uint64_t rejected;     ///< The number of requests rejected so far.
+        std::uint64_t in_flight;    ///< The number of operations currently in flight.
+    };
+
+    /// @brief AppCounters bundles statistics about the requests of all peers sharing an app label.
+    struct AppCounters
+    {
+        std::uint64_t rejected;     ///< The number of requests rejected so far.
+        std::uint64_t in_flight;    ///< The number of operations currently in flight.
+    };
+
+    /// @brief create returns a new instance, enforcing the limits in configuration.
+    static Ptr create(const Configuration& configuration);
+
+    /// @brief admit decides on a request by peer, running with the given app label, at the point in time now.
+    Admission admit(const std::string& peer, const Application& app, const Clock::time_point& now = Clock::now());
+
+    /// @brief counters returns a snapshot of the statistics of all peers known right now, by peer.
+    std::map<std::string, Counters> counters() const;
+
+    /// @brief app_counters returns a snapshot of the statistics of all app labels known right now, by app label.
+    std::map<std::string, AppCounters> app_counters() const;
+
+private:
+    /// @cond
+    struct Peer
+    {
+        Application app;
+        double tokens;
+        Clock::time_point refilled_at;
+        Clock::time_point active_at;
+        std::uint64_t admitted;
+        std::uint64_t rejected;
+        std::uint64_t in_flight;
+    };
+
+    struct App
+    {
+        Clock::time_point active_at;
+        std::uint64_t rejected;
+        std::uint64_t in_flight;
+    };
+
+    AdmissionControl(const Configuration& configuration);
+
+    /// @brief release accounts for an operation of peer and app leaving flight.
+    void release(const std::string& peer, const Application& app);
+
+    /// @brief forget_idle_peers drops the state of all peers and app labels that have been idle for longer than the idle ttl.
+    void forget_idle_peers(const Clock::time_point& now);
+
+    Configuration configuration;
+
+    mutable std::mutex guard;
+    std::map<std::string, Peer> peers;
+    std::map<std::string, App> apps;
+    Clock::time_point forgotten_at;
+    /// @endcond
+};
+
+/// @brief operator<< inserts verdict into out.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, AdmissionControl::Verdict verdict);
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_ADMISSION_CONTROL_H_
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/credentials_cache.h>
+
+biometry::dbus::skeleton::CredentialsCache::Ptr biometry::dbus::skeleton::CredentialsCache::create()
+{
+    return Ptr{new CredentialsCache{}};
+}
+
+void biometry::dbus::skeleton::CredentialsCache::lookup(const std::string& name, const Query& query, const Handler& then)
+{
+    Optional<RequestVerifier::Credentials> credentials; bool issue_query{false};
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        auto it = cache.find(name);
+        if (it != cache.end())
+        {
+            credentials = it->second;
+        }
+        else
+        {
+            auto& p = pending[name];
+            issue_query = p.handlers.empty();
+            p.handlers.push_back(then);
+        }
+    }
+
+    if (credentials)
+    {
+        then(credentials);
+        return;
+    }
+
+    if (not issue_query)
+        return;
+
+    // We keep the cache alive until the query completed to not lose any waiting handlers.
+    auto thiz = shared_from_this();
+    query([thiz, name](const Optional<RequestVerifier::Credentials>& credentials)
+    {
+        thiz->resolved(name, credentials);
+    });
+}
+
+void biometry::dbus::skeleton::CredentialsCache::invalidate(const std::string& name)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    cache.erase(name);
+
+    // A pending query might still report credentials for name, which we must not cache.
+    auto it = pending.find(name);
+    if (it != pending.end())
+        it->second.left = true;
+}
+
+std::size_t biometry::dbus::skeleton::CredentialsCache::size() const
+{
+    std::lock_guard<std::mutex> lg{guard};
+    return cache.size();
+}
+
+void biometry::dbus::skeleton::CredentialsCache::resolved(const std::string& name, const Optional<RequestVerifier::Credentials>& credentials)
+{
+    std::vector<Handler> handlers;
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        auto it = pending.find(name);
+        if (it == pending.end())
+            return;
+
+        if (credentials && not it->second.left)
+            cache[name] = credentials.get();
+
+        std::swap(handlers, it->second.handlers);
+        pending.erase(it);
+    }
+
+    for (const auto& handler : handlers)
+        handler(credentials);
+}
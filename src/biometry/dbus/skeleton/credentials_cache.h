@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_SKELETON_CREDENTIALS_CACHE_H_
+#define BIOMETRYD_DBUS_SKELETON_CREDENTIALS_CACHE_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/optional.h>
+#include <biometry/visibility.h>
+
+#include <biometry/dbus/skeleton/request_verifier.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+/// @brief CredentialsCache caches the credentials of peers per unique connection name.
+///
+/// Concurrent lookups for a name that is not cached yet share a single query. Credentials
+/// are only cached if the query succeeded and the name has not left the bus while the
+/// query was pending.
+class BIOMETRY_DLL_PUBLIC CredentialsCache : public DoNotCopyOrMove, public std::enable_shared_from_this<CredentialsCache>
+{
+public:
+    // Safe us some typing
+    typedef std::shared_ptr<CredentialsCache> Ptr;
+    typedef std::function<void(const Optional<RequestVerifier::Credentials>&)> Handler;
+    typedef std::function<void(const Handler&)> Query;
+
+    /// @brief create returns a new, empty instance.
+    static Ptr create();
+
+    /// @brief lookup hands the credentials of name to then.
+    ///
+    /// If name is not cached and no query for name is pending, query is invoked
+    /// with a handler that has to be called with the outcome of the query.
+    void lookup(const std::string& name, const Query& query, const Handler& then);
+
+    /// @brief invalidate drops the credentials of name, to be called when name leaves the bus.
+    void invalidate(const std::string& name);
+
+    /// @brief size returns the number of cached entries.
+    std::size_t size() const;
+
+private:
+    /// @cond
+    struct Pending
+    {
+        std::vector<Handler> handlers;
+        bool left{false};
+    };
+
+    CredentialsCache() = default;
+
+    /// @brief resolved hands credentials to all handlers waiting for name.
+    void resolved(const std::string& name, const Optional<RequestVerifier::Credentials>& credentials);
+
+    mutable std::mutex guard;
+    std::unordered_map<std::string, RequestVerifier::Credentials> cache;
+    std::unordered_map<std::string, Pending> pending;
+    /// @endcond
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_CREDENTIALS_CACHE_H_
@@ -22,11 +22,18 @@
 #include <biometry/application.h>
 #include <biometry/user.h>
 
-#include <core/dbus/macros.h>
+#include <biometry/dbus/bus_daemon.h>
+#include <biometry/dbus/skeleton/instruments.h>
+#include <biometry/dbus/skeleton/peer_watcher.h>
+
 #include <core/dbus/object.h>
+#include <core/dbus/service.h>
 
 #include <core/posix/this_process.h>
 
+#include <chrono>
+#include <mutex>
+
 namespace
 {
 bool is_running_in_a_testing_environment()
@@ -34,84 +41,118 @@ bool is_running_in_a_testing_environment()
     return core::posix::this_process::env::get("BIOMETRYD_DBUS_SKELETON_IS_RUNNING_UNDER_TESTING", "0") == "1";
 }
 
-struct DBus
+struct Stub
 {
-    static const std::string& name()
+    // Creates a new stub instance for the given object to access
+    // DBus functionality.
+    Stub(const core::dbus::Object::Ptr& object) : object{object}
     {
-        static const std::string s = "org.freedesktop.DBus";
-        return s;
     }
 
     // Gets the AppArmor confinement string associated with the unique connection name. If
     // D-Bus is not performing AppArmor mediation, the
     // org.freedesktop.DBus.Error.AppArmorSecurityContextUnknown error is returned.
-    DBUS_CPP_METHOD_DEF(GetConnectionAppArmorSecurityContext, DBus)
-
-    // Gets the unix user id of the user that the requesting party is running under.
-    DBUS_CPP_METHOD_DEF(GetConnectionUnixUser, DBus)
-
-    struct Stub
+    //
+    // Invokes the given handler on completion.
+    void get_connection_app_armor_security_async(const std::string& name, std::function<void(const biometry::Optional<std::string>&)> handler)
     {
-        // Creates a new stub instance for the given object to access
-        // DBus functionality.
-        Stub(const core::dbus::Object::Ptr& object) : object{object}
-        {
-        }
-
-        // Creates a new stub instance for the given bus connection
-        Stub(const core::dbus::Bus::Ptr& bus)
-            : object
-              {
-                  core::dbus::Service::use_service<DBus>(bus)
-                      ->object_for_path(core::dbus::types::ObjectPath{"/org/freedesktop/DBus"})
-              }
+        object->invoke_method_asynchronously_with_callback<biometry::dbus::BusDaemon::GetConnectionAppArmorSecurityContext, std::string>([handler](const core::dbus::Result<std::string>& result)
         {
-        }
-
-        // Gets the AppArmor confinement string associated with the unique connection name. If
-        // D-Bus is not performing AppArmor mediation, the
-        // org.freedesktop.DBus.Error.AppArmorSecurityContextUnknown error is returned.
-        //
-        // Invokes the given handler on completion.
-        void get_connection_app_armor_security_async(const std::string& name, std::function<void(const biometry::Optional<std::string>&)> handler)
-        {
-            object->invoke_method_asynchronously_with_callback<GetConnectionAppArmorSecurityContext, std::string>([handler](const core::dbus::Result<std::string>& result)
-            {
-                biometry::Optional<std::string> label; handler((not result.is_error() ?
-                                                                        label = result.value() :
-                                                                        is_running_in_a_testing_environment() ? label = "unconfined" : label));
-            }, name);
-        }
-
-        // Gets the unix user id of the sender identified by name, invoking handler on completion.
-        void get_connection_unix_user_async(const std::string& name, const std::function<void(biometry::Optional<std::uint32_t>)>& handler)
+            biometry::Optional<std::string> label; handler((not result.is_error() ?
+                                                                    label = result.value() :
+                                                                    is_running_in_a_testing_environment() ? label = "unconfined" : label));
+        }, name);
+    }
+
+    // Gets the unix user id of the sender identified by name, invoking handler on completion.
+    void get_connection_unix_user_async(const std::string& name, const std::function<void(biometry::Optional<std::uint32_t>)>& handler)
+    {
+        object->invoke_method_asynchronously_with_callback<biometry::dbus::BusDaemon::GetConnectionUnixUser, std::uint32_t>([handler](const core::dbus::Result<std::uint32_t>& result)
         {
-            object->invoke_method_asynchronously_with_callback<GetConnectionUnixUser, std::uint32_t>([handler](const core::dbus::Result<std::uint32_t>& result)
-            {
-                biometry::Optional<std::uint32_t> uid; handler((not result.is_error() ? uid = result.value() : uid));
-            }, name);
-        }
+            biometry::Optional<std::uint32_t> uid; handler((not result.is_error() ? uid = result.value() : uid));
+        }, name);
+    }
 
-        core::dbus::Object::Ptr object;
-    };
+    core::dbus::Object::Ptr object;
+};
+
+// Lookup bundles the state of the two concurrent queries issued on a cache miss.
+struct Lookup
+{
+    std::mutex guard;
+    std::size_t outstanding{2};
+    biometry::Optional<std::uint32_t> uid;
+    biometry::Optional<std::string> label;
 };
 }
 
-biometry::dbus::skeleton::DaemonCredentialsResolver::DaemonCredentialsResolver(const core::dbus::Bus::Ptr& bus) : bus{bus}
+biometry::dbus::skeleton::DaemonCredentialsResolver::DaemonCredentialsResolver(const core::dbus::Bus::Ptr& bus)
+    : bus{bus},
+      bus_daemon{core::dbus::Service::use_service<BusDaemon>(bus)->object_for_path(BusDaemon::path())},
+      cache{CredentialsCache::create()}
 {
+    std::weak_ptr<CredentialsCache> wc{cache};
+    peer_vanished = PeerWatcher::for_bus(bus)->on_peer_vanished([wc](const std::string& peer)
+    {
+        if (auto sc = wc.lock())
+            sc->invalidate(peer);
+    });
 }
 
 void biometry::dbus::skeleton::DaemonCredentialsResolver::resolve_credentials(
         const core::dbus::Message::Ptr& msg,
         const std::function<void(const Optional<RequestVerifier::Credentials>&)>& then)
 {
-    DBus::Stub stub{bus};
-    stub.get_connection_unix_user_async(msg->sender(), [stub, msg, then](biometry::Optional<std::uint32_t> uid) mutable
+    const auto sender = msg->sender();
+    const auto started_at = std::chrono::steady_clock::now();
+    const auto id = util::trace::correlation_id();
+
+    auto bus_daemon = this->bus_daemon;
+
+    // We issue both queries concurrently and hand the result to the cache when the last one completes.
+    auto query = [bus_daemon, sender](const CredentialsCache::Handler& handler)
     {
-        stub.get_connection_app_armor_security_async(msg->sender(), [stub, msg, then, uid](const biometry::Optional<std::string>& label) mutable
+        auto lookup = std::make_shared<Lookup>();
+
+        auto complete = [lookup, handler]()
         {
             Optional<RequestVerifier::Credentials> credentials;
-            then((label && uid ? credentials = RequestVerifier::Credentials{biometry::Application{label.get()}, biometry::User{uid.get()}} : credentials));
+
+            if (lookup->label && lookup->uid)
+                credentials = RequestVerifier::Credentials{biometry::Application{lookup->label.get()}, biometry::User{lookup->uid.get()}};
+
+            handler(credentials);
+        };
+
+        Stub stub{bus_daemon};
+
+        stub.get_connection_unix_user_async(sender, [lookup, complete](biometry::Optional<std::uint32_t> uid)
+        {
+            bool done{false};
+            {
+                std::lock_guard<std::mutex> lg{lookup->guard};
+                lookup->uid = uid; done = --lookup->outstanding == 0;
+            }
+
+            if (done) complete();
         });
+
+        stub.get_connection_app_armor_security_async(sender, [lookup, complete](const biometry::Optional<std::string>& label)
+        {
+            bool done{false};
+            {
+                std::lock_guard<std::mutex> lg{lookup->guard};
+                lookup->label = label; done = --lookup->outstanding == 0;
+            }
+
+            if (done) complete();
+        });
+    };
+
+    cache->lookup(sender, query, [started_at, id, then](const Optional<RequestVerifier::Credentials>& credentials)
+    {
+        instruments::credentials_resolution().record_since(started_at);
+        util::trace::tracer().complete("dbus", "resolve_credentials", started_at, id);
+        then(credentials);
     });
 }
@@ -20,10 +20,14 @@
 #ifndef BIOMETRYD_DBUS_SKELETON_DAEMON_CREDENTIALS_RESOLVER_H_
 #define BIOMETRYD_DBUS_SKELETON_DAEMON_CREDENTIALS_RESOLVER_H_
 
+#include <biometry/dbus/skeleton/credentials_cache.h>
 #include <biometry/dbus/skeleton/credentials_resolver.h>
 
 #include <core/dbus/bus.h>
 #include <core/dbus/message.h>
+#include <core/dbus/object.h>
+
+#include <memory>
 
 namespace biometry
 {
@@ -32,6 +36,11 @@ namespace dbus
 namespace skeleton
 {
 /// @brief CredentialsResolver resolves incoming messages to RequestVerifier::Credentials.
+///
+/// Credentials are queried from the bus daemon and cached per unique connection name.
+/// The uid and the AppArmor label of a connection never change during its lifetime, and
+/// unique connection names are never reused. Cache entries are invalidated when
+/// the connection leaves the bus, see CredentialsCache.
 class DaemonCredentialsResolver : public CredentialsResolver
 {
 public:
@@ -43,7 +52,12 @@ public:
                              const std::function<void(const Optional<RequestVerifier::Credentials>&)>& then) override;
 
 private:
+    /// @cond
     core::dbus::Bus::Ptr bus;
+    core::dbus::Object::Ptr bus_daemon;
+    CredentialsCache::Ptr cache;
+    std::shared_ptr<void> peer_vanished;
+    /// @endcond
 };
 }
 }
@@ -21,7 +21,9 @@
 
 #include <biometry/dbus/interface.h>
 #include <biometry/dbus/skeleton/daemon_credentials_resolver.h>
+#include <biometry/dbus/skeleton/instruments.h>
 #include <biometry/dbus/skeleton/template_store.h>
+#include <biometry/dbus/skeleton/verifier.h>
 
 #include <boost/format.hpp>
 
@@ -50,9 +52,10 @@ biometry::dbus::skeleton::Device::Ptr biometry::dbus::skeleton::Device::create_f
         const core::dbus::Bus::Ptr& bus,
         const core::dbus::Service::Ptr& service,
         const core::dbus::Object::Ptr& object,
-        const std::shared_ptr<biometry::Device>& impl)
+        const std::shared_ptr<biometry::Device>& impl,
+        const AdmissionControl::Ptr& admission_control)
 {
-    return Ptr{new Device{bus, service, object, impl}};
+    return Ptr{new Device{bus, service, object, impl, admission_control}};
 }
 
 /// @brief Frees up resources and removes routes to message handlers.
@@ -60,6 +63,7 @@ biometry::dbus::skeleton::Device::~Device()
 {
     object_->uninstall_method_handler<biometry::dbus::interface::Device::Methods::TemplateStore>();
     object_->uninstall_method_handler<biometry::dbus::interface::Device::Methods::Identifier>();
+    object_->uninstall_method_handler<biometry::dbus::interface::Device::Methods::Verifier>();
 }
 
 // From biometry::Device
@@ -82,20 +86,26 @@ biometry::dbus::skeleton::Device::Device(
         const core::dbus::Bus::Ptr& bus,
         const core::dbus::Service::Ptr& service,
         const core::dbus::Object::Ptr& object,
-        const std::shared_ptr<biometry::Device>& impl)
+        const std::shared_ptr<biometry::Device>& impl,
+        const AdmissionControl::Ptr& admission_control)
     : impl_{impl},
       bus_{bus},
       service_{service},
-      object_{object}
+      object_{object},
+      credentials_resolver_{std::make_shared<DaemonCredentialsResolver>(bus)},
+      admission_control_{admission_control},
+      lifecycle_manager_{LifecycleManager::create_for_bus(bus, LifecycleManager::Configuration{})}
 {
     object_->install_method_handler<biometry::dbus::interface::Device::Methods::TemplateStore>([this](const core::dbus::Message::Ptr& msg)
     {
+        auto span = instruments::received<biometry::dbus::interface::Device::Methods::TemplateStore>();
+
         auto path = PrefixedPath{"template_store"}.prefix(object_->path());
 
         template_store_([this, &path]()
         {
             return TemplateStore::create_for_service_and_object(bus_, service_, service_->add_object_for_path(path), std::ref(template_store()),
-                                                                std::make_shared<TemplateStore::RequestVerifier>(), std::make_shared<DaemonCredentialsResolver>(bus_));
+                                                                std::make_shared<TemplateStore::RequestVerifier>(), credentials_resolver_, admission_control_, lifecycle_manager_);
         });
 
         auto reply = core::dbus::Message::make_method_return(msg);
@@ -105,12 +115,31 @@ biometry::dbus::skeleton::Device::Device(
 
     object_->install_method_handler<biometry::dbus::interface::Device::Methods::Identifier>([this](const core::dbus::Message::Ptr& msg)
     {
+        auto span = instruments::received<biometry::dbus::interface::Device::Methods::Identifier>();
+
         auto path = PrefixedPath{"identifier"}.prefix(object_->path());
 
         identifier_([this, &path]()
         {
             return Identifier::create_for_service_and_object(bus_, service_, service_->add_object_for_path(path), std::ref(identifier()),
-                                                             std::make_shared<Identifier::RequestVerifier>(), std::make_shared<DaemonCredentialsResolver>(bus_));
+                                                             std::make_shared<Identifier::RequestVerifier>(), credentials_resolver_, admission_control_, lifecycle_manager_);
+        });
+
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << path;
+        this->bus_->send(reply);
+    });
+
+    object_->install_method_handler<biometry::dbus::interface::Device::Methods::Verifier>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Device::Methods::Verifier>();
+
+        auto path = PrefixedPath{"verifier"}.prefix(object_->path());
+
+        verifier_([this, &path]()
+        {
+            return Verifier::create_for_service_and_object(bus_, service_, service_->add_object_for_path(path), std::ref(verifier()),
+                                                           std::make_shared<Verifier::RequestVerifier>(), credentials_resolver_, admission_control_, lifecycle_manager_);
         });
 
         auto reply = core::dbus::Message::make_method_return(msg);
@@ -23,8 +23,12 @@
 #include <biometry/device.h>
 #include <biometry/visibility.h>
 
+#include <biometry/dbus/skeleton/admission_control.h>
+#include <biometry/dbus/skeleton/credentials_resolver.h>
 #include <biometry/dbus/skeleton/identifier.h>
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
 #include <biometry/dbus/skeleton/template_store.h>
+#include <biometry/dbus/skeleton/verifier.h>
 
 #include <biometry/util/once.h>
 
@@ -48,7 +52,8 @@ public:
             const core::dbus::Bus::Ptr& bus,
             const core::dbus::Service::Ptr& service,
             const core::dbus::Object::Ptr& object,
-            const std::shared_ptr<biometry::Device>& impl);
+            const std::shared_ptr<biometry::Device>& impl,
+            const AdmissionControl::Ptr& admission_control);
 
     /// @brief Frees up resources and removes routes to message handlers.
     ~Device();
@@ -60,7 +65,7 @@ public:
 
 private:
     /// @brief Device creates a new instance for the given remote service and object;
-    Device(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const std::shared_ptr<biometry::Device>& impl);
+    Device(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const std::shared_ptr<biometry::Device>& impl, const AdmissionControl::Ptr& admission_control);
 
     std::shared_ptr<biometry::Device> impl_;
 
@@ -68,8 +73,14 @@ private:
     core::dbus::Service::Ptr service_;
     core::dbus::Object::Ptr object_;
 
+    std::shared_ptr<CredentialsResolver> credentials_resolver_;
+    AdmissionControl::Ptr admission_control_;
+    // Shared by all skeletons exported for this device.
+    LifecycleManager::Ptr lifecycle_manager_;
+
     util::Once<std::shared_ptr<biometry::dbus::skeleton::TemplateStore>> template_store_;
     util::Once<std::shared_ptr<biometry::dbus::skeleton::Identifier>> identifier_;
+    util::Once<std::shared_ptr<biometry::dbus::skeleton::Verifier>> verifier_;
 };
 }
 }
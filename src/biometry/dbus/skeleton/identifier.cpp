@@ -22,6 +22,7 @@
 #include <biometry/reason.h>
 #include <biometry/dbus/codec.h>
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/skeleton/instruments.h>
 #include <biometry/dbus/skeleton/operation.h>
 
 #include <biometry/util/atomic_counter.h>
@@ -32,8 +33,15 @@ namespace
 {
 core::dbus::Message::Ptr not_permitted_in_reply_to(const core::dbus::Message::Ptr& msg)
 {
+    biometry::dbus::skeleton::instruments::not_permitted().increment();
     return core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::NotPermitted::name(), "");
 }
+
+core::dbus::Message::Ptr busy_in_reply_to(const core::dbus::Message::Ptr& msg, biometry::dbus::skeleton::AdmissionControl::Verdict verdict)
+{
+    biometry::dbus::skeleton::instruments::busy().increment();
+    return core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::Busy::name(), (boost::format{"%1%"} % verdict).str());
+}
 }
 
 bool biometry::dbus::skeleton::Identifier::RequestVerifier::verify_identify_user_request(const biometry::Application& app, const Credentials& provided)
@@ -53,9 +61,11 @@ biometry::dbus::skeleton::Identifier::Ptr biometry::dbus::skeleton::Identifier::
         const core::dbus::Object::Ptr& object,
         const std::reference_wrapper<biometry::Identifier>& impl,
         const std::shared_ptr<RequestVerifier>& request_verifier,
-        const std::shared_ptr<CredentialsResolver>& credentials_resolver)
+        const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+        const AdmissionControl::Ptr& admission_control,
+        const LifecycleManager::Ptr& lifecycle_manager)
 {
-    return Ptr{new Identifier{bus, service, object, impl, request_verifier, credentials_resolver}};
+    return Ptr{new Identifier{bus, service, object, impl, request_verifier, credentials_resolver, admission_control, lifecycle_manager}};
 }
 
 // From biometry::Identifier.
@@ -64,63 +74,118 @@ biometry::Operation<biometry::Identification>::Ptr biometry::dbus::skeleton::Ide
     return impl.get().identify_user(app, reason);
 }
 
+void biometry::dbus::skeleton::Identifier::export_operation(
+        const core::dbus::Message::Ptr& msg,
+        const RequestVerifier::Credentials& credentials,
+        const std::function<biometry::Operation<biometry::Identification>::Ptr()>& create,
+        const Optional<core::dbus::types::ObjectPath>& observer)
+{
+    auto admission = admission_control->admit(msg->sender(), credentials.app);
+    if (not admission)
+    {
+        bus->send(busy_in_reply_to(msg, admission.verdict));
+        return;
+    }
+
+    auto op = create();
+
+    core::dbus::types::ObjectPath op_path
+    {
+        (boost::format{"%1%/operation/identification/%2%/%3%/%4%"}
+            % object->path().as_string()
+            % credentials.app.as_string()
+            % credentials.user.id
+            % util::counter<Identifier>().increment()).str()
+    };
+
+    auto skeleton = skeleton::Operation<Identification>::create_for_object(bus, service->add_object_for_path(op_path), op, lifecycle, admission.ticket);
+    // The ticket is released early if the operation is canceled or finishes, at the latest when it is reaped.
+    auto ticket = admission.ticket;
+    lifecycle->add(op_path, msg->sender(), skeleton, [op, ticket]() { op->cancel(); ticket->release(); });
+
+    if (observer)
+        skeleton->start_with_remote_observer(msg->sender(), observer.get());
+
+    auto reply = core::dbus::Message::make_method_return(msg);
+    reply->writer() << op_path;
+    bus->send(reply);
+}
+
 biometry::dbus::skeleton::Identifier::Identifier(
         const core::dbus::Bus::Ptr& bus,
         const core::dbus::Service::Ptr& service,
         const core::dbus::Object::Ptr& object,
         const std::reference_wrapper<biometry::Identifier>& impl,
         const std::shared_ptr<RequestVerifier>& request_verifier,
-        const std::shared_ptr<CredentialsResolver>& credentials_resolver)
+        const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+        const AdmissionControl::Ptr& admission_control,
+        const LifecycleManager::Ptr& lifecycle_manager)
     : impl{impl},
       request_verifier{request_verifier},
       credentials_resolver{credentials_resolver},
+      admission_control{admission_control},
       bus{bus},
       service{service},
-      object{object}
+      object{object},
+      lifecycle{lifecycle_manager}
 {
     object->install_method_handler<biometry::dbus::interface::Identifier::Methods::IdentifyUser>([this](const core::dbus::Message::Ptr& msg)
     {
-        Identifier::credentials_resolver->resolve_credentials(msg, [this, msg](const Optional<RequestVerifier::Credentials>& credentials)
+        auto span = instruments::received<biometry::dbus::interface::Identifier::Methods::IdentifyUser>();
+        util::trace::Correlation correlation{span.id()};
+        handle(msg, false);
+    });
+
+    object->install_method_handler<biometry::dbus::interface::Identifier::Methods::IdentifyUserAndStart>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Identifier::Methods::IdentifyUserAndStart>();
+        util::trace::Correlation correlation{span.id()};
+        handle(msg, true);
+    });
+}
+
+void biometry::dbus::skeleton::Identifier::handle(const core::dbus::Message::Ptr& msg, bool with_observer)
+{
+    // Resolving credentials completes asynchronously, we carry over the correlation id of the request.
+    auto id = util::trace::correlation_id();
+
+    credentials_resolver->resolve_credentials(msg, [this, msg, with_observer, id](const Optional<RequestVerifier::Credentials>& credentials)
+    {
+        util::trace::Correlation correlation{id};
+
+        if (not credentials)
+        {
+            bus->send(not_permitted_in_reply_to(msg));
+            return;
+        }
+
+        biometry::Application app = biometry::Application::system(); biometry::Reason reason = biometry::Reason::unknown();
+        auto reader = msg->reader(); reader >> app >> reason;
+
+        Optional<core::dbus::types::ObjectPath> observer;
+        if (with_observer)
+        {
+            core::dbus::types::ObjectPath path; reader >> path;
+            observer = path;
+        }
+
+        if (not request_verifier->verify_identify_user_request(app, credentials.get()))
         {
-            if (not credentials)
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            biometry::Application app = biometry::Application::system(); biometry::Reason reason = biometry::Reason::unknown();
-            auto reader = msg->reader(); reader >> app >> reason;
-
-            if (not this->request_verifier->verify_identify_user_request(app, credentials.get()))
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            auto op = identify_user(app, reason);
-
-            core::dbus::types::ObjectPath op_path
-            {
-                (boost::format{"%1%/operation/identification/%2%/%3%/%4%"}
-                    % this->object->path().as_string()
-                    % credentials.get().app.as_string()
-                    % credentials.get().user.id
-                    % util::counter<Identifier>().increment()).str()
-            };
-
-            ops.synchronized([this, op_path, op](IdentificationOps::ValueType& ops)
-            {
-                ops[op_path] = skeleton::Operation<Identification>::create_for_object(this->bus, this->service->add_object_for_path(op_path), op);
-            });
-
-            auto reply = core::dbus::Message::make_method_return(msg);
-            reply->writer() << op_path;
-            this->bus->send(reply);
-        });
+            bus->send(not_permitted_in_reply_to(msg));
+            return;
+        }
+
+        export_operation(msg, credentials.get(), [this, app, reason]() { return identify_user(app, reason); }, observer);
     });
 }
 
 biometry::dbus::skeleton::Identifier::~Identifier()
 {
     object->uninstall_method_handler<biometry::dbus::interface::Identifier::Methods::IdentifyUser>();
+    object->uninstall_method_handler<biometry::dbus::interface::Identifier::Methods::IdentifyUserAndStart>();
+}
+
+const biometry::dbus::skeleton::LifecycleManager::Ptr& biometry::dbus::skeleton::Identifier::lifecycle_manager() const
+{
+    return lifecycle;
 }
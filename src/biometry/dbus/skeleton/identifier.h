@@ -22,15 +22,13 @@
 
 #include <biometry/identifier.h>
 
+#include <biometry/dbus/skeleton/admission_control.h>
 #include <biometry/dbus/skeleton/credentials_resolver.h>
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
 
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
 
-#include <biometry/util/synchronized.h>
-
-#include <unordered_map>
-
 namespace biometry
 {
 namespace dbus
@@ -63,16 +61,34 @@ public:
                                              const core::dbus::Object::Ptr& object,
                                              const std::reference_wrapper<biometry::Identifier>& impl,
                                              const std::shared_ptr<RequestVerifier>& request_verifier,
-                                             const std::shared_ptr<CredentialsResolver>& credentials_resolver);
+                                             const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+                                             const AdmissionControl::Ptr& admission_control,
+                                             const LifecycleManager::Ptr& lifecycle_manager);
 
     /// @brief Frees up resources and uninstalls method handlers.
     ~Identifier();
 
+    /// @brief lifecycle_manager returns the LifecycleManager tracking the operations exported by this instance.
+    const LifecycleManager::Ptr& lifecycle_manager() const;
+
     // From biometry::Identifier.
     Operation<Identification>::Ptr identify_user(const Application& app, const Reason& reason) override;
 
 private:
-    typedef biometry::util::Synchronized<std::unordered_map<core::dbus::types::ObjectPath, Operation<Identification>::Ptr>> IdentificationOps;
+    /// @brief handle reads the arguments of a request from msg, verifies the request and exports the operation.
+    ///
+    /// If with_observer is true, the arguments are followed by the path of an observer exported by the sender of msg.
+    void handle(const core::dbus::Message::Ptr& msg, bool with_observer);
+
+    /// @brief export_operation admits the request in msg, exports the operation returned by create
+    /// on the bus and replies to msg with the path of the operation.
+    ///
+    /// Requests that are not admitted are rejected with Errors::Busy, without invoking create. If observer
+    /// is set, the operation is started right away, reporting to the observer exported by the sender of msg at the given path.
+    void export_operation(const core::dbus::Message::Ptr& msg,
+                          const RequestVerifier::Credentials& credentials,
+                          const std::function<Operation<Identification>::Ptr()>& create,
+                          const Optional<core::dbus::types::ObjectPath>& observer);
 
     /// @brief Service creates a new instance for the given remote service and object.
     Identifier(const core::dbus::Bus::Ptr& bus,
@@ -80,17 +96,19 @@ private:
                const core::dbus::Object::Ptr& object,
                const std::reference_wrapper<biometry::Identifier>& impl,
                const std::shared_ptr<RequestVerifier>& request_verifier,
-               const std::shared_ptr<CredentialsResolver>& credentials_resolver);
+               const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+               const AdmissionControl::Ptr& admission_control,
+               const LifecycleManager::Ptr& lifecycle_manager);
 
     std::reference_wrapper<biometry::Identifier> impl;
     std::shared_ptr<RequestVerifier> request_verifier;
     std::shared_ptr<CredentialsResolver> credentials_resolver;
+    AdmissionControl::Ptr admission_control;
 
     core::dbus::Bus::Ptr bus;
     core::dbus::Service::Ptr service;
     core::dbus::Object::Ptr object;
-
-    IdentificationOps ops;
+    LifecycleManager::Ptr lifecycle;
 };
 }
 }
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_DBUS_SKELETON_INSTRUMENTS_H_
+#define BIOMETRYD_DBUS_SKELETON_INSTRUMENTS_H_
+
+#include <biometry/identifier.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <biometry/util/metrics.h>
+#include <biometry/util/trace.h>
+
+#include <cstdint>
+#include <string>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+// instruments bundles accessors to the util::Metrics instruments and trace events
+// recorded by the skeleton implementations. Every accessor looks up its instrument once.
+namespace instruments
+{
+/// @brief OperationName maps an operation type to the name used in the names of its instruments.
+template<typename T> struct OperationName;
+
+/// @cond
+template<> struct OperationName<biometry::Identification> { static const char* value() { return "identification"; } };
+template<> struct OperationName<biometry::Verification> { static const char* value() { return "verification"; } };
+template<> struct OperationName<biometry::TemplateStore::SizeQuery> { static const char* value() { return "size"; } };
+template<> struct OperationName<biometry::TemplateStore::List> { static const char* value() { return "list"; } };
+template<> struct OperationName<biometry::TemplateStore::Enrollment> { static const char* value() { return "enrollment"; } };
+template<> struct OperationName<biometry::TemplateStore::Removal> { static const char* value() { return "removal"; } };
+template<> struct OperationName<biometry::TemplateStore::Clearance> { static const char* value() { return "clearance"; } };
+/// @endcond
+
+/// @brief requests counts the requests received for Method.
+template<typename Method>
+inline util::Metrics::Counter& requests()
+{
+    static auto& instance = util::metrics().counter("requests." + Method::Interface::name() + "." + Method::name());
+    return instance;
+}
+
+/// @brief received accounts for a request invoking Method, returning a span that covers handling the request.
+///
+/// The span is correlated with id, or with a new id if id is 0.
+template<typename Method>
+inline util::trace::Span received(std::uint64_t id = 0)
+{
+    static const std::string name = Method::Interface::name() + "." + Method::name();
+    requests<Method>().increment();
+    return util::trace::Span{"dbus", name.c_str(), id ? id : util::trace::next_id()};
+}
+
+/// @brief progress_event returns the name of the trace event recorded for progress of an operation of type T.
+template<typename T>
+inline const char* progress_event()
+{
+    static const std::string name = std::string{OperationName<T>::value()} + ".progress";
+    return name.c_str();
+}
+
+/// @brief lifetime_event returns the name of the trace event spanning an operation of type T from start to its terminal event.
+template<typename T>
+inline const char* lifetime_event()
+{
+    static const std::string name = OperationName<T>::value();
+    return name.c_str();
+}
+
+/// @brief not_permitted counts the requests rejected with Errors::NotPermitted.
+inline util::Metrics::Counter& not_permitted()
+{
+    static auto& instance = util::metrics().counter("rejections.not_permitted");
+    return instance;
+}
+
+/// @brief busy counts the requests rejected with Errors::Busy.
+inline util::Metrics::Counter& busy()
+{
+    static auto& instance = util::metrics().counter("rejections.busy");
+    return instance;
+}
+
+/// @brief credentials_resolution tracks the time it takes to resolve the credentials of a peer.
+inline util::Metrics::Latency& credentials_resolution()
+{
+    static auto& instance = util::metrics().latency("credentials.resolution_us");
+    return instance;
+}
+
+/// @brief live_operations tracks the number of operation objects currently exported on the bus.
+inline util::Metrics::Gauge& live_operations()
+{
+    static auto& instance = util::metrics().gauge("operations.live");
+    return instance;
+}
+
+/// @brief time_to_first_progress tracks the time from starting an operation of type T to its first progress event.
+template<typename T>
+inline util::Metrics::Latency& time_to_first_progress()
+{
+    static auto& instance = util::metrics().latency(std::string{"operations."} + OperationName<T>::value() + ".first_progress_us");
+    return instance;
+}
+
+/// @brief time_to_completion tracks the time from starting an operation of type T to it reaching a terminal state.
+template<typename T>
+inline util::Metrics::Latency& time_to_completion()
+{
+    static auto& instance = util::metrics().latency(std::string{"operations."} + OperationName<T>::value() + ".completion_us");
+    return instance;
+}
+}
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_INSTRUMENTS_H_
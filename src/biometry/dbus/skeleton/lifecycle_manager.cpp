@@ -0,0 +1,269 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
+
+#include <biometry/dbus/skeleton/peer_watcher.h>
+#include <biometry/util/metrics.h>
+#include <biometry/util/trace.h>
+
+#include <ostream>
+#include <utility>
+#include <vector>
+
+biometry::dbus::skeleton::LifecycleManager::Ptr biometry::dbus::skeleton::LifecycleManager::create(const Configuration& configuration)
+{
+    return Ptr{new LifecycleManager{configuration}}->start();
+}
+
+biometry::dbus::skeleton::LifecycleManager::Ptr biometry::dbus::skeleton::LifecycleManager::create_for_bus(
+        const core::dbus::Bus::Ptr& bus,
+        const Configuration& configuration)
+{
+    auto result = create(configuration);
+
+    std::weak_ptr<LifecycleManager> wp{result};
+    result->peer_vanished = PeerWatcher::for_bus(bus)->on_peer_vanished([wp](const std::string& peer)
+    {
+        if (auto sp = wp.lock())
+            sp->vanished(peer);
+    });
+
+    return result;
+}
+
+biometry::dbus::skeleton::LifecycleManager::LifecycleManager(const Configuration& configuration)
+    : configuration(configuration)
+{
+}
+
+biometry::dbus::skeleton::LifecycleManager::~LifecycleManager()
+{
+    {
+        std::lock_guard<std::mutex> lg{shutdown->guard};
+        shutdown->requested = true;
+    }
+
+    shutdown->wakeup.notify_all();
+
+    if (not worker.joinable())
+        return;
+
+    // A sweep might end up dropping the last reference to this instance, e.g. if
+    // the observer of a reaped operation held on to it. Joining ourselves would throw.
+    if (worker.get_id() == std::this_thread::get_id())
+        worker.detach();
+    else
+        worker.join();
+}
+
+void biometry::dbus::skeleton::LifecycleManager::add(
+        const core::dbus::types::ObjectPath& path,
+        const std::string& peer,
+        const std::shared_ptr<void>& operation,
+        const std::function<void()>& cancel)
+{
+    std::lock_guard<std::mutex> lg{guard};
+    entries[path] = Entry{peer, operation, cancel, State::idle, std::chrono::steady_clock::now()};
+}
+
+void biometry::dbus::skeleton::LifecycleManager::started(const core::dbus::types::ObjectPath& path)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.state != State::idle)
+        return;
+
+    it->second.state = State::started;
+    it->second.since = std::chrono::steady_clock::now();
+}
+
+void biometry::dbus::skeleton::LifecycleManager::finished(const core::dbus::types::ObjectPath& path)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    auto it = entries.find(path);
+    if (it == entries.end() || it->second.state == State::finished || it->second.state == State::vanished)
+        return;
+
+    it->second.state = State::finished;
+    it->second.since = std::chrono::steady_clock::now();
+}
+
+void biometry::dbus::skeleton::LifecycleManager::vanished(const std::string& peer)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    for (auto& pair : entries)
+    {
+        auto& entry = pair.second;
+
+        if (entry.peer != peer || entry.state == State::finished || entry.state == State::vanished)
+            continue;
+
+        // Only running operations need to be canceled on the way out.
+        if (entry.state != State::started)
+            entry.cancel = nullptr;
+
+        entry.state = State::vanished;
+        entry.since = std::chrono::steady_clock::now();
+    }
+}
+
+std::size_t biometry::dbus::skeleton::LifecycleManager::sweep(const std::chrono::steady_clock::time_point& now)
+{
+    std::vector<std::pair<core::dbus::types::ObjectPath, State>> reapable;
+    std::vector<std::function<void()>> cancels;
+
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        for (const auto& pair : entries)
+        {
+            const auto& entry = pair.second;
+
+            switch (entry.state)
+            {
+            case State::idle:
+                if (now - entry.since < configuration.idle_ttl)
+                    continue;
+                break;
+            case State::started:
+                // Operations that never reach a terminal state are canceled eventually.
+                if (now - entry.since < configuration.started_ttl)
+                    continue;
+                if (entry.cancel)
+                    cancels.push_back(entry.cancel);
+                break;
+            case State::finished:
+                // We give handlers that might still be executing the chance to finish up.
+                if (now - entry.since < configuration.sweep_interval)
+                    continue;
+                break;
+            case State::vanished:
+                if (entry.cancel)
+                    cancels.push_back(entry.cancel);
+                break;
+            }
+
+            reapable.push_back(std::make_pair(pair.first, entry.state));
+        }
+    }
+
+    // Canceling might call back into finished, and we thus must not hold the lock.
+    for (const auto& cancel : cancels)
+    {
+        try
+        {
+            cancel();
+        }
+        catch (...)
+        {
+            static auto& failed_cancels = util::metrics().counter("lifecycle.failed_cancels");
+            failed_cancels.increment();
+            util::trace::tracer().instant("lifecycle", "failed_cancel");
+        }
+    }
+
+    // We move the operations out of the map and release them without holding the lock.
+    std::vector<std::shared_ptr<void>> operations;
+
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        for (const auto& pair : reapable)
+        {
+            auto it = entries.find(pair.first);
+            if (it == entries.end())
+                continue;
+
+            switch (pair.second)
+            {
+            case State::idle: counters_.idle++; break;
+            case State::finished: counters_.terminated++; break;
+            case State::vanished: counters_.vanished++; break;
+            case State::started: counters_.expired++; break;
+            }
+
+            operations.push_back(it->second.operation);
+            entries.erase(it);
+        }
+    }
+
+    counters_.reaped += operations.size();
+    return operations.size();
+}
+
+biometry::dbus::skeleton::LifecycleManager::Counters biometry::dbus::skeleton::LifecycleManager::counters() const
+{
+    std::uint64_t live{0};
+
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        live = entries.size();
+    }
+
+    return Counters
+    {
+        live,
+        counters_.reaped.load(),
+        counters_.terminated.load(),
+        counters_.vanished.load(),
+        counters_.idle.load(),
+        counters_.expired.load()
+    };
+}
+
+biometry::dbus::skeleton::LifecycleManager::Ptr biometry::dbus::skeleton::LifecycleManager::start()
+{
+    // The worker only holds on to this instance for the duration of a sweep and
+    // otherwise solely relies on state it shares with the instance.
+    std::weak_ptr<LifecycleManager> wp{shared_from_this()};
+    auto shutdown = this->shutdown;
+    auto interval = configuration.sweep_interval;
+
+    worker = std::thread{[wp, shutdown, interval]()
+    {
+        std::unique_lock<std::mutex> ul{shutdown->guard};
+
+        while (not shutdown->requested)
+        {
+            if (shutdown->wakeup.wait_for(ul, interval, [shutdown]() { return shutdown->requested; }))
+                break;
+
+            ul.unlock();
+            if (auto sp = wp.lock())
+                sp->sweep();
+            ul.lock();
+        }
+    }};
+
+    return shared_from_this();
+}
+
+std::ostream& biometry::dbus::skeleton::operator<<(std::ostream& out, const LifecycleManager::Counters& counters)
+{
+    return out << "[live: " << counters.live
+               << " reaped: " << counters.reaped
+               << " terminated: " << counters.terminated
+               << " vanished: " << counters.vanished
+               << " idle: " << counters.idle
+               << " expired: " << counters.expired << "]";
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_SKELETON_LIFECYCLE_MANAGER_H_
+#define BIOMETRYD_DBUS_SKELETON_LIFECYCLE_MANAGER_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <core/dbus/bus.h>
+#include <core/dbus/types/object_path.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+/// @brief LifecycleManager keeps track of operations exported on the bus and reaps them
+/// once they are not needed anymore.
+///
+/// An operation is reaped if:
+///   * it reached a terminal state (succeeded, failed or canceled),
+///   * the peer that requested the operation left the bus, in which case a running operation is canceled first,
+///   * it has never been started and stayed idle for longer than Configuration::idle_ttl,
+///   * it has been running for longer than Configuration::started_ttl, in which case it is canceled first.
+///
+/// Reaping drops the last reference to the exported skeleton, which in turn uninstalls
+/// its method handlers and removes the object from the bus. Reaping happens on a dedicated
+/// worker thread and at least one sweep interval after an operation reached a terminal state,
+/// such that handlers that are still executing on the bus thread are not torn down under their feet.
+///
+/// A single instance is meant to be shared by all skeletons exported for a device, such that
+/// there is exactly one worker thread. Peers leaving the bus are reported by the PeerWatcher
+/// shared by everybody on the bus connection.
+class BIOMETRY_DLL_PUBLIC LifecycleManager : public DoNotCopyOrMove, public std::enable_shared_from_this<LifecycleManager>
+{
+public:
+    // Safe us some typing
+    typedef std::shared_ptr<LifecycleManager> Ptr;
+
+    /// @brief Configuration bundles tunables of a LifecycleManager instance.
+    struct Configuration
+    {
+        /// @brief idle_ttl is the time an operation that was never started is kept alive.
+        std::chrono::milliseconds idle_ttl{std::chrono::minutes{5}};
+        /// @brief started_ttl is the time a running operation is kept alive before it is canceled.
+        std::chrono::milliseconds started_ttl{std::chrono::minutes{30}};
+        /// @brief sweep_interval is the time between two sweeps of the worker thread.
+        std::chrono::milliseconds sweep_interval{std::chrono::seconds{1}};
+    };
+
+    /// @brief Counters bundles statistics about the operations known to a LifecycleManager.
+    struct Counters
+    {
+        /// @brief live is the number of operations currently alive.
+        std::uint64_t live;
+        /// @brief reaped is the total number of operations reaped so far.
+        std::uint64_t reaped;
+        /// @brief terminated is the number of reaped operations that reached a terminal state.
+        std::uint64_t terminated;
+        /// @brief vanished is the number of reaped operations whose peer left the bus.
+        std::uint64_t vanished;
+        /// @brief idle is the number of reaped operations that timed out without being started.
+        std::uint64_t idle;
+        /// @brief expired is the number of reaped operations that were canceled after running for too long.
+        std::uint64_t expired;
+    };
+
+    /// @brief create returns a new instance, configured according to configuration.
+    static Ptr create(const Configuration& configuration);
+
+    /// @brief create_for_bus returns a new instance that watches bus for peers leaving the bus.
+    static Ptr create_for_bus(const core::dbus::Bus::Ptr& bus, const Configuration& configuration);
+
+    /// @brief Stops the worker thread and frees up all tracked operations.
+    ///
+    /// If the last reference is dropped on the worker thread itself, the worker
+    /// is detached and winds down on its own.
+    ~LifecycleManager();
+
+    /// @brief add tracks the operation exported at path, requested by peer.
+    ///
+    /// The LifecycleManager keeps operation alive until it is reaped, and invokes
+    /// cancel if the operation has to be torn down while running.
+    void add(const core::dbus::types::ObjectPath& path,
+             const std::string& peer,
+             const std::shared_ptr<void>& operation,
+             const std::function<void()>& cancel);
+
+    /// @brief started marks the operation known under path as started.
+    void started(const core::dbus::types::ObjectPath& path);
+
+    /// @brief finished marks the operation known under path as having reached a terminal state.
+    void finished(const core::dbus::types::ObjectPath& path);
+
+    /// @brief vanished marks all operations requested by peer for reaping.
+    void vanished(const std::string& peer);
+
+    /// @brief sweep reaps all operations that qualify for reaping at the point in time now.
+    ///
+    /// Called periodically by the worker thread, exposed for testing purposes.
+    std::size_t sweep(const std::chrono::steady_clock::time_point& now = std::chrono::steady_clock::now());
+
+    /// @brief counters returns a snapshot of the current statistics.
+    Counters counters() const;
+
+private:
+    /// @cond
+    enum class State
+    {
+        idle,
+        started,
+        finished,
+        vanished
+    };
+
+    struct Entry
+    {
+        std::string peer;
+        std::shared_ptr<void> operation;
+        std::function<void()> cancel;
+        State state;
+        std::chrono::steady_clock::time_point since;
+    };
+
+    LifecycleManager(const Configuration& configuration);
+
+    /// @brief Shutdown is shared with the worker thread, which might outlive the instance.
+    struct Shutdown
+    {
+        std::mutex guard;
+        std::condition_variable wakeup;
+        bool requested{false};
+    };
+
+    /// @brief start launches the worker thread.
+    Ptr start();
+
+    Configuration configuration;
+
+    mutable std::mutex guard;
+    std::unordered_map<core::dbus::types::ObjectPath, Entry> entries;
+
+    struct
+    {
+        std::atomic<std::uint64_t> reaped{0};
+        std::atomic<std::uint64_t> terminated{0};
+        std::atomic<std::uint64_t> vanished{0};
+        std::atomic<std::uint64_t> idle{0};
+        std::atomic<std::uint64_t> expired{0};
+    } counters_;
+
+    std::shared_ptr<void> peer_vanished;
+    std::shared_ptr<Shutdown> shutdown{std::make_shared<Shutdown>()};
+    std::thread worker;
+    /// @endcond
+};
+
+/// @brief operator<< inserts counters into out.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, const LifecycleManager::Counters& counters);
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_LIFECYCLE_MANAGER_H_
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/dbus/skeleton/metrics.h>
+
+#include <biometry/dbus/interface.h>
+#include <biometry/dbus/skeleton/instruments.h>
+
+#include <sstream>
+
+biometry::dbus::skeleton::Metrics::Ptr biometry::dbus::skeleton::Metrics::create_for_object(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Object::Ptr& object,
+        const std::reference_wrapper<util::Metrics>& impl,
+        const std::reference_wrapper<util::trace::Tracer>& tracer)
+{
+    return Ptr{new Metrics{bus, object, impl, tracer}};
+}
+
+biometry::dbus::skeleton::Metrics::Metrics(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Object::Ptr& object,
+        const std::reference_wrapper<util::Metrics>& impl,
+        const std::reference_wrapper<util::trace::Tracer>& tracer)
+    : bus{bus},
+      object{object},
+      impl{impl},
+      tracer{tracer}
+{
+    object->install_method_handler<biometry::dbus::interface::Metrics::Methods::Dump>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Metrics::Methods::Dump>();
+
+        std::stringstream ss; ss << this->impl.get().snapshot();
+
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << ss.str();
+        this->bus->send(reply);
+    });
+
+    object->install_method_handler<biometry::dbus::interface::Metrics::Methods::Trace>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Metrics::Methods::Trace>();
+
+        std::stringstream ss; this->tracer.get().dump(ss);
+
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << ss.str();
+        this->bus->send(reply);
+    });
+}
+
+biometry::dbus::skeleton::Metrics::~Metrics()
+{
+    object->uninstall_method_handler<biometry::dbus::interface::Metrics::Methods::Dump>();
+    object->uninstall_method_handler<biometry::dbus::interface::Metrics::Methods::Trace>();
+}
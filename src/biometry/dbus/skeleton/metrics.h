@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_DBUS_SKELETON_METRICS_H_
+#define BIOMETRYD_DBUS_SKELETON_METRICS_H_
+
+#include <biometry/visibility.h>
+
+#include <biometry/util/metrics.h>
+#include <biometry/util/trace.h>
+
+#include <core/dbus/bus.h>
+#include <core/dbus/object.h>
+
+#include <functional>
+#include <memory>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+// Metrics exports a util::Metrics and a util::trace::Tracer instance on the bus.
+class BIOMETRY_DLL_PUBLIC Metrics
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Metrics> Ptr;
+
+    /// @brief create_for_object returns a new skeleton::Metrics instance on object, reporting the instruments of impl
+    /// and the events buffered by tracer.
+    static Ptr create_for_object(const core::dbus::Bus::Ptr& bus,
+                                 const core::dbus::Object::Ptr& object,
+                                 const std::reference_wrapper<util::Metrics>& impl,
+                                 const std::reference_wrapper<util::trace::Tracer>& tracer);
+
+    /// @brief Frees up resources and uninstalls method handlers.
+    ~Metrics();
+
+private:
+    /// @brief Metrics creates a new instance for the given object.
+    Metrics(const core::dbus::Bus::Ptr& bus,
+            const core::dbus::Object::Ptr& object,
+            const std::reference_wrapper<util::Metrics>& impl,
+            const std::reference_wrapper<util::trace::Tracer>& tracer);
+
+    core::dbus::Bus::Ptr bus;
+    core::dbus::Object::Ptr object;
+    std::reference_wrapper<util::Metrics> impl;
+    std::reference_wrapper<util::trace::Tracer> tracer;
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_METRICS_H_
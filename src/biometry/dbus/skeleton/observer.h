@@ -23,6 +23,7 @@
 #include <biometry/operation.h>
 
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/side_channel.h>
 
 #include <core/dbus/object.h>
 
@@ -51,6 +52,15 @@ public:
     /// @brief create_for_object returns a new instance on the given object.
     static Ptr create_for_object(const core::dbus::Bus::Ptr& bus, const core::dbus::Object::Ptr& object, const typename Operation<T>::Observer::Ptr& impl);
 
+    /// @brief use_side_channel resolves references to blobs in incoming progress updates against side_channel.
+    void use_side_channel(const SideChannel::Ptr& side_channel);
+
+    /// @brief uninstall_method_handlers removes installed method handlers, preparing destruction of the object.
+    ///
+    /// Needs to be called if the remote side is never going to report to the instance, as the
+    /// installed handlers keep the instance alive.
+    void uninstall_method_handlers();
+
     // From Operation<T>::Observer
     void on_started() override;
     void on_progress(const Progress&) override;
@@ -64,10 +74,8 @@ private:
     /// @brief Finalize construction sets up message handlers.
     Ptr finalize_construction();
 
-    /// @brief uninstall_method_handlers removes installed method handlers, preparing destruction of the object.
-    void uninstall_method_handlers();
-
     typename Operation<T>::Observer::Ptr impl;
+    SideChannel::Ptr side_channel;
 
     core::dbus::Bus::Ptr bus;
     core::dbus::Object::Ptr object;
@@ -85,6 +93,12 @@ typename biometry::dbus::skeleton::Observer<T>::Ptr biometry::dbus::skeleton::Ob
     return Ptr{new Observer<T>{bus, object, impl}}->finalize_construction();
 }
 
+template<typename T>
+void biometry::dbus::skeleton::Observer<T>::use_side_channel(const SideChannel::Ptr& side_channel)
+{
+    std::atomic_store(&this->side_channel, side_channel);
+}
+
 template<typename T>
 void biometry::dbus::skeleton::Observer<T>::on_started()
 {
@@ -150,7 +164,11 @@ typename biometry::dbus::skeleton::Observer<T>::Ptr biometry::dbus::skeleton::Ob
     object->install_method_handler<biometry::dbus::interface::Operation::Observer::Methods::OnProgress>([thiz, this](const core::dbus::Message::Ptr& msg)
     {
         auto progress = Progress::none(); msg->reader() >> progress;
-        on_progress(progress);
+
+        if (auto sc = std::atomic_load(&side_channel))
+            on_progress(sc->unpack(progress));
+        else
+            on_progress(progress);
         bus->send(core::dbus::Message::make_method_return(msg));
     });
 
@@ -24,12 +24,22 @@
 #include <biometry/tracing_operation_observer.h>
 
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/side_channel.h>
 
+#include <biometry/dbus/skeleton/admission_control.h>
+#include <biometry/dbus/skeleton/instruments.h>
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
 #include <biometry/dbus/stub/observer.h>
 
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <unistd.h>
+
 namespace biometry
 {
 namespace dbus
@@ -52,22 +62,81 @@ public:
     using typename Super::Result;
 
     /// @brief create_for_object returns a new instance on the given object.
-    static Ptr create_for_object(const core::dbus::Bus::Ptr& bus, const core::dbus::Object::Ptr& object, const typename biometry::Operation<T>::Ptr& impl);
+    ///
+    /// The instance reports state changes to lifecycle_manager, if it is still alive. ticket is
+    /// released as soon as the operation is canceled, reaches a terminal state or its observer goes away.
+    /// All trace events of the instance are correlated with the correlation id of the calling thread.
+    static Ptr create_for_object(const core::dbus::Bus::Ptr& bus,
+                                 const core::dbus::Object::Ptr& object,
+                                 const typename biometry::Operation<T>::Ptr& impl,
+                                 const std::weak_ptr<LifecycleManager>& lifecycle_manager = std::weak_ptr<LifecycleManager>{},
+                                 const AdmissionControl::Ticket::Ptr& ticket = AdmissionControl::Ticket::Ptr{});
 
     /// @brief Frees up resources and uninstall message handlers.
     ~Operation();
 
+    /// @brief start_with_remote_observer starts the operation, reporting to the observer exported by peer at path.
+    ///
+    /// If side_channel is set, large blobs in progress details are passed through it.
+    void start_with_remote_observer(const std::string& peer,
+                                    const core::dbus::types::ObjectPath& path,
+                                    const SideChannel::Ptr& side_channel = SideChannel::Ptr{});
+
     // From biometry::Operation<T>
     void start_with_observer(const typename Observer::Ptr& observer) override;
     void cancel() override;
 
 private:
+    /// @brief ReportingObserver forwards to impl and reports terminal states to a LifecycleManager.
+    ///
+    /// It releases the ticket of the operation on terminal states and on destruction. It also tracks the time to the first progress event and to the terminal state
+    /// in the instruments for operations of type T.
+    class ReportingObserver : public Observer
+    {
+    public:
+        /// @brief ReportingObserver initializes a new instance.
+        ReportingObserver(const typename Observer::Ptr& impl,
+                          const std::weak_ptr<LifecycleManager>& lifecycle_manager,
+                          const core::dbus::types::ObjectPath& path,
+                          const AdmissionControl::Ticket::Ptr& ticket,
+                          std::uint64_t trace_id);
+
+        /// @brief Releases the ticket of the operation.
+        ~ReportingObserver();
+
+        // From Operation<T>::Observer
+        void on_started() override;
+        void on_progress(const Progress&) override;
+        void on_canceled(const Reason&) override;
+        void on_failed(const Error&) override;
+        void on_succeeded(const Result&) override;
+
+    private:
+        /// @brief report_finished notifies the lifecycle manager about the operation having finished with outcome.
+        void report_finished(const char* outcome);
+
+        typename Observer::Ptr impl;
+        std::weak_ptr<LifecycleManager> lifecycle_manager;
+        core::dbus::types::ObjectPath path;
+        AdmissionControl::Ticket::Ptr ticket;
+        std::uint64_t trace_id;
+        std::chrono::steady_clock::time_point started_at;
+        std::atomic<bool> progressed;
+    };
+
     /// @brief Service creates a new instance for the given remote service and object.
-    Operation(const core::dbus::Bus::Ptr& bus, const core::dbus::Object::Ptr& object, const typename biometry::Operation<T>::Ptr& impl);
+    Operation(const core::dbus::Bus::Ptr& bus,
+              const core::dbus::Object::Ptr& object,
+              const typename biometry::Operation<T>::Ptr& impl,
+              const std::weak_ptr<LifecycleManager>& lifecycle_manager,
+              const AdmissionControl::Ticket::Ptr& ticket);
 
     typename biometry::Operation<T>::Ptr impl;
     core::dbus::Bus::Ptr bus;
     core::dbus::Object::Ptr object;
+    std::weak_ptr<LifecycleManager> lifecycle_manager;
+    AdmissionControl::Ticket::Ptr ticket;
+    std::uint64_t trace_id;
 };
 }
 }
@@ -77,18 +146,44 @@ template<typename T>
 typename biometry::dbus::skeleton::Operation<T>::Ptr biometry::dbus::skeleton::Operation<T>::create_for_object(
         const core::dbus::Bus::Ptr& bus,
         const core::dbus::Object::Ptr& object,
-        const typename biometry::Operation<T>::Ptr& impl)
+        const typename biometry::Operation<T>::Ptr& impl,
+        const std::weak_ptr<LifecycleManager>& lifecycle_manager,
+        const AdmissionControl::Ticket::Ptr& ticket)
 {
-    return Ptr{new Operation<T>{bus, object, impl}};
+    return Ptr{new Operation<T>{bus, object, impl, lifecycle_manager, ticket}};
 }
 
 template<typename T>
 biometry::dbus::skeleton::Operation<T>::~Operation()
 {
+    instruments::live_operations().decrement();
+
     object->uninstall_method_handler<biometry::dbus::interface::Operation::Methods::StartWithObserver>();
+    object->uninstall_method_handler<biometry::dbus::interface::Operation::Methods::StartWithObserverAndSideChannel>();
     object->uninstall_method_handler<biometry::dbus::interface::Operation::Methods::Cancel>();
 }
 
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::start_with_remote_observer(
+        const std::string& peer,
+        const core::dbus::types::ObjectPath& path,
+        const SideChannel::Ptr& side_channel)
+{
+    // The remote observer and all layers below us correlate their events with ours.
+    util::trace::Correlation correlation{trace_id};
+
+    auto object = core::dbus::Service::use_service(bus, peer)->object_for_path(path);
+
+    if (auto sp = lifecycle_manager.lock())
+        sp->started(this->object->path());
+
+    auto observer = biometry::dbus::stub::Observer<T>::create_for_object(object);
+    if (side_channel)
+        observer->use_side_channel(side_channel);
+
+    start_with_observer(std::make_shared<ReportingObserver>(observer, lifecycle_manager, this->object->path(), ticket, trace_id));
+}
+
 template<typename T>
 void biometry::dbus::skeleton::Operation<T>::start_with_observer(const typename Observer::Ptr& observer)
 {
@@ -98,31 +193,147 @@ void biometry::dbus::skeleton::Operation<T>::start_with_observer(const typename
 template<typename T>
 void biometry::dbus::skeleton::Operation<T>::cancel()
 {
+    // Canceling might result in this instance being reaped, so we hold on to the ticket.
+    auto ticket = this->ticket;
     impl->cancel();
+
+    if (ticket)
+        ticket->release();
+}
+
+template<typename T>
+biometry::dbus::skeleton::Operation<T>::ReportingObserver::ReportingObserver(
+        const typename Observer::Ptr& impl,
+        const std::weak_ptr<LifecycleManager>& lifecycle_manager,
+        const core::dbus::types::ObjectPath& path,
+        const AdmissionControl::Ticket::Ptr& ticket,
+        std::uint64_t trace_id)
+    : impl{impl},
+      lifecycle_manager{lifecycle_manager},
+      path{path},
+      ticket{ticket},
+      trace_id{trace_id},
+      started_at{std::chrono::steady_clock::now()},
+      progressed{false}
+{
+}
+
+template<typename T>
+biometry::dbus::skeleton::Operation<T>::ReportingObserver::~ReportingObserver()
+{
+    if (ticket)
+        ticket->release();
+}
+
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::ReportingObserver::on_started()
+{
+    impl->on_started();
+}
+
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::ReportingObserver::on_progress(const Progress& progress)
+{
+    if (not progressed.exchange(true))
+        instruments::time_to_first_progress<T>().record_since(started_at);
+
+    util::trace::tracer().instant("operation", instruments::progress_event<T>(), trace_id);
+    impl->on_progress(progress);
+}
+
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::ReportingObserver::on_canceled(const Reason& reason)
+{
+    impl->on_canceled(reason);
+    report_finished("canceled");
+}
+
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::ReportingObserver::on_failed(const Error& error)
+{
+    impl->on_failed(error);
+    report_finished("failed");
+}
+
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::ReportingObserver::on_succeeded(const Result& result)
+{
+    impl->on_succeeded(result);
+    report_finished("succeeded");
+}
+
+template<typename T>
+void biometry::dbus::skeleton::Operation<T>::ReportingObserver::report_finished(const char* outcome)
+{
+    instruments::time_to_completion<T>().record_since(started_at);
+    util::trace::tracer().instant("operation", outcome, trace_id);
+    util::trace::tracer().complete("operation", instruments::lifetime_event<T>(), started_at, trace_id);
+
+    if (ticket)
+        ticket->release();
+
+    if (auto sp = lifecycle_manager.lock())
+        sp->finished(path);
 }
 
 template<typename T>
 biometry::dbus::skeleton::Operation<T>::Operation(
         const core::dbus::Bus::Ptr& bus,
         const core::dbus::Object::Ptr& object,
-        const typename biometry::Operation<T>::Ptr& impl)
+        const typename biometry::Operation<T>::Ptr& impl,
+        const std::weak_ptr<LifecycleManager>& lifecycle_manager,
+        const AdmissionControl::Ticket::Ptr& ticket)
     : impl{impl},
       bus{bus},
-      object{object}
+      object{object},
+      lifecycle_manager{lifecycle_manager},
+      ticket{ticket},
+      trace_id{util::trace::correlation_id()}
 {
+    instruments::live_operations().increment();
+
     object->install_method_handler<biometry::dbus::interface::Operation::Methods::StartWithObserver>([this](const core::dbus::Message::Ptr& msg)
     {
+        auto span = instruments::received<biometry::dbus::interface::Operation::Methods::StartWithObserver>(trace_id);
+
         core::dbus::types::ObjectPath path; msg->reader() >> path;
-        auto object = core::dbus::Service::use_service(this->bus, msg->sender())->object_for_path(path);
-        start_with_observer(biometry::dbus::stub::Observer<T>::create_for_object(object));
+        start_with_remote_observer(msg->sender(), path);
+
+        this->bus->send(core::dbus::Message::make_method_return(msg));
+    });
+
+    object->install_method_handler<biometry::dbus::interface::Operation::Methods::StartWithObserverAndSideChannel>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Operation::Methods::StartWithObserverAndSideChannel>(trace_id);
+
+        core::dbus::types::ObjectPath path; core::dbus::types::UnixFd fd;
+        msg->reader() >> path >> fd;
 
+        SideChannel::Ptr side_channel;
+
+        try
+        {
+            side_channel = SideChannel::attach(::dup(fd.to_raw()), SideChannel::default_threshold);
+        }
+        catch (const std::exception& e)
+        {
+            this->bus->send(core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::InvalidSideChannel::name(), e.what()));
+            return;
+        }
+
+        start_with_remote_observer(msg->sender(), path, side_channel);
         this->bus->send(core::dbus::Message::make_method_return(msg));
     });
 
     object->install_method_handler<biometry::dbus::interface::Operation::Methods::Cancel>([this](const core::dbus::Message::Ptr& msg)
     {
+        auto span = instruments::received<biometry::dbus::interface::Operation::Methods::Cancel>(trace_id);
+        util::trace::Correlation correlation{trace_id};
+
+        // Canceling might result in this instance being reaped, so we hold on to what we need.
+        auto bus = this->bus;
         cancel();
-        this->bus->send(core::dbus::Message::make_method_return(msg));
+        bus->send(core::dbus::Message::make_method_return(msg));
     });
 }
 
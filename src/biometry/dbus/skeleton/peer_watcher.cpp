@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/peer_watcher.h>
+
+#include <biometry/dbus/bus_daemon.h>
+
+#include <core/dbus/object.h>
+#include <core/dbus/service.h>
+#include <core/dbus/signal.h>
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+struct biometry::dbus::skeleton::PeerWatcher::Registration
+{
+    PeerWatcher::Ptr watcher;
+    Handler handler;
+};
+
+biometry::dbus::skeleton::PeerWatcher::Ptr biometry::dbus::skeleton::PeerWatcher::create()
+{
+    return Ptr{new PeerWatcher{}};
+}
+
+biometry::dbus::skeleton::PeerWatcher::Ptr biometry::dbus::skeleton::PeerWatcher::for_bus(const core::dbus::Bus::Ptr& bus)
+{
+    // The watcher keeps its bus alive, a connection's address is thus not reused
+    // for another connection while the entry for it has not expired.
+    static std::mutex guard;
+    static std::map<const core::dbus::Bus*, std::weak_ptr<PeerWatcher>> watchers;
+
+    std::lock_guard<std::mutex> lg{guard};
+
+    for (auto it = watchers.begin(); it != watchers.end();)
+        it = it->second.expired() ? watchers.erase(it) : std::next(it);
+
+    if (auto result = watchers[bus.get()].lock())
+        return result;
+
+    auto result = create();
+
+    auto signal = core::dbus::Service::use_service<BusDaemon>(bus)
+            ->object_for_path(BusDaemon::path())
+            ->get_signal<BusDaemon::NameOwnerChanged>();
+
+    std::weak_ptr<PeerWatcher> wp{result};
+    signal->connect([wp](const BusDaemon::NameOwnerChanged::ArgumentType& args)
+    {
+        // We only care about names leaving the bus.
+        if (not std::get<2>(args).empty())
+            return;
+
+        if (auto sp = wp.lock())
+            sp->vanished(std::get<0>(args));
+    });
+
+    result->name_owner_changed = signal;
+    watchers[bus.get()] = result;
+
+    return result;
+}
+
+std::shared_ptr<void> biometry::dbus::skeleton::PeerWatcher::on_peer_vanished(const Handler& handler)
+{
+    auto registration = std::make_shared<Registration>(Registration{shared_from_this(), handler});
+
+    std::lock_guard<std::mutex> lg{guard};
+
+    registrations.erase(std::remove_if(registrations.begin(), registrations.end(), [](const std::weak_ptr<Registration>& wr)
+    {
+        return wr.expired();
+    }), registrations.end());
+
+    registrations.push_back(registration);
+    return registration;
+}
+
+void biometry::dbus::skeleton::PeerWatcher::vanished(const std::string& peer)
+{
+    std::vector<std::shared_ptr<Registration>> snapshot;
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        for (const auto& wr : registrations)
+            if (auto sr = wr.lock())
+                snapshot.push_back(sr);
+    }
+
+    // We call out without holding the lock, handlers might well register or drop their tokens.
+    for (const auto& registration : snapshot)
+        registration->handler(peer);
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_SKELETON_PEER_WATCHER_H_
+#define BIOMETRYD_DBUS_SKELETON_PEER_WATCHER_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <core/dbus/bus.h>
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+/// @brief PeerWatcher tells interested parties about peers leaving the bus.
+///
+/// Every instance watching a bus installs a match rule for NameOwnerChanged and receives
+/// every name change on the bus. for_bus hands out a single instance per bus connection,
+/// such that all credentials resolvers and lifecycle managers of all skeletons exported
+/// on that connection share one match rule.
+class BIOMETRY_DLL_PUBLIC PeerWatcher : public DoNotCopyOrMove, public std::enable_shared_from_this<PeerWatcher>
+{
+public:
+    // Safe us some typing
+    typedef std::shared_ptr<PeerWatcher> Ptr;
+
+    /// @brief Handler is invoked with the unique name of a peer that left the bus.
+    typedef std::function<void(const std::string&)> Handler;
+
+    /// @brief create returns a new instance that does not watch any bus.
+    static Ptr create();
+
+    /// @brief for_bus returns the instance watching bus, creating it if necessary.
+    static Ptr for_bus(const core::dbus::Bus::Ptr& bus);
+
+    /// @brief on_peer_vanished invokes handler for every peer leaving the bus until the returned token is dropped.
+    ///
+    /// The token keeps the instance alive.
+    std::shared_ptr<void> on_peer_vanished(const Handler& handler);
+
+    /// @brief vanished invokes all handlers for peer.
+    ///
+    /// Called for every peer leaving the bus, exposed for testing purposes.
+    void vanished(const std::string& peer);
+
+private:
+    /// @cond
+    struct Registration;
+
+    PeerWatcher() = default;
+
+    std::mutex guard;
+    std::vector<std::weak_ptr<Registration>> registrations;
+    std::shared_ptr<void> name_owner_changed;
+    /// @endcond
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_PEER_WATCHER_H_
@@ -20,6 +20,7 @@
 #include <biometry/dbus/skeleton/service.h>
 
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/skeleton/instruments.h>
 
 namespace
 {
@@ -27,23 +28,40 @@ const core::dbus::types::ObjectPath default_device_path("/default_device");
 }
 
 biometry::dbus::skeleton::Service::Ptr biometry::dbus::skeleton::Service::create_for_bus(const core::dbus::Bus::Ptr& bus, const std::shared_ptr<biometry::Service>& impl)
+{
+    return create_for_bus(bus, impl, devices::Deferred::Ptr{});
+}
+
+biometry::dbus::skeleton::Service::Ptr biometry::dbus::skeleton::Service::create_for_bus(const core::dbus::Bus::Ptr& bus, const std::shared_ptr<biometry::Service>& impl, const devices::Deferred::Ptr& startup)
+{
+    return create_for_bus(bus, impl, startup, AdmissionControl::create(AdmissionControl::Configuration{}));
+}
+
+biometry::dbus::skeleton::Service::Ptr biometry::dbus::skeleton::Service::create_for_bus(const core::dbus::Bus::Ptr& bus, const std::shared_ptr<biometry::Service>& impl, const devices::Deferred::Ptr& startup, const AdmissionControl::Ptr& admission_control)
 {
     auto service = core::dbus::Service::add_service(bus, biometry::dbus::interface::Service::name());
     auto object = service->add_object_for_path(biometry::dbus::interface::Service::path());
-    return Ptr{new Service{bus, service, object, impl}};
+    return Ptr{new Service{bus, service, object, impl, startup, admission_control}};
 }
 
 biometry::dbus::skeleton::Service::Service(const core::dbus::Bus::Ptr& bus,
                                            const core::dbus::Service::Ptr& service,
                                            const core::dbus::Object::Ptr& object,
-                                           const std::shared_ptr<biometry::Service>& impl)
+                                           const std::shared_ptr<biometry::Service>& impl,
+                                           const devices::Deferred::Ptr& startup,
+                                           const AdmissionControl::Ptr& admission_control)
     : impl_{impl},
+      startup_{startup},
+      admission_control_{admission_control},
       bus_{bus},
       service_{service},
-      object_{object}
+      object_{object},
+      metrics_{Metrics::create_for_object(bus, service->add_object_for_path(biometry::dbus::interface::Metrics::path()), std::ref(util::metrics()), std::ref(util::trace::tracer()))}
 {
     object_->install_method_handler<biometry::dbus::interface::Service::Methods::DefaultDevice>([this](const core::dbus::Message::Ptr& msg)
     {
+        auto span = instruments::received<biometry::dbus::interface::Service::Methods::DefaultDevice>();
+
         // Ensure that the device gets created on demand.
         default_device();
 
@@ -51,10 +69,30 @@ biometry::dbus::skeleton::Service::Service(const core::dbus::Bus::Ptr& bus,
         reply->writer() << core::dbus::types::ObjectPath(default_device_path);
         this->bus_->send(reply);
     });
+
+    object_->install_method_handler<biometry::dbus::interface::Service::Methods::IsReady>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Service::Methods::IsReady>();
+
+        // Without a startup to track, the service is ready as soon as it is reachable.
+        auto reply = core::dbus::Message::make_method_return(msg);
+        reply->writer() << (not startup_ || startup_->state() == devices::Deferred::State::ready);
+        this->bus_->send(reply);
+    });
+
+    if (startup_)
+    {
+        auto ready = object_->get_signal<biometry::dbus::interface::Service::Signals::Ready>();
+        startup_->when_resolved([ready](const std::shared_ptr<biometry::Device>& device, const std::string&)
+        {
+            ready->emit(device != nullptr);
+        });
+    }
 }
 
 biometry::dbus::skeleton::Service::~Service()
 {
+    object_->uninstall_method_handler<biometry::dbus::interface::Service::Methods::IsReady>();
     object_->uninstall_method_handler<biometry::dbus::interface::Service::Methods::DefaultDevice>();
 }
 
@@ -63,6 +101,6 @@ std::shared_ptr<biometry::Device> biometry::dbus::skeleton::Service::default_dev
     return default_device_([this]()
     {
         auto object = service_->add_object_for_path(default_device_path);
-        return Device::create_for_service_and_object(bus_, service_, object, impl_->default_device());
+        return Device::create_for_service_and_object(bus_, service_, object, impl_->default_device(), admission_control_);
     });
 }
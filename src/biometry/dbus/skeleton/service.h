@@ -23,7 +23,11 @@
 #include <biometry/service.h>
 #include <biometry/visibility.h>
 
+#include <biometry/devices/deferred.h>
+
+#include <biometry/dbus/skeleton/admission_control.h>
 #include <biometry/dbus/skeleton/device.h>
+#include <biometry/dbus/skeleton/metrics.h>
 
 #include <biometry/util/once.h>
 
@@ -50,6 +54,17 @@ public:
     /// @brief create_for_bus creates a new instance connecting to bus, forwarding incoming calls to impl.
     static Ptr create_for_bus(const core::dbus::Bus::Ptr& bus_, const std::shared_ptr<biometry::Service>& impl_);
 
+    /// @brief create_for_bus creates a new instance connecting to bus, forwarding incoming calls to impl.
+    ///
+    /// The readiness of the service is reported to clients according to the state of startup, and
+    /// com.ubuntu.biometryd.Service.Ready is emitted once startup is resolved or failed.
+    static Ptr create_for_bus(const core::dbus::Bus::Ptr& bus_, const std::shared_ptr<biometry::Service>& impl_, const devices::Deferred::Ptr& startup);
+
+    /// @brief create_for_bus creates a new instance connecting to bus, forwarding incoming calls to impl.
+    ///
+    /// Requests for new operations are admitted or rejected by admission_control.
+    static Ptr create_for_bus(const core::dbus::Bus::Ptr& bus_, const std::shared_ptr<biometry::Service>& impl_, const devices::Deferred::Ptr& startup, const AdmissionControl::Ptr& admission_control);
+
     /// @brief Frees up resources and removes routes to message handlers.
     ~Service();
 
@@ -58,12 +73,15 @@ public:
 
 private:
     /// @brief Service creates a new instance for the given remote service and object.
-    Service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const std::shared_ptr<biometry::Service>& impl);
+    Service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const std::shared_ptr<biometry::Service>& impl, const devices::Deferred::Ptr& startup, const AdmissionControl::Ptr& admission_control);
 
     std::shared_ptr<biometry::Service> impl_;
+    devices::Deferred::Ptr startup_;
+    AdmissionControl::Ptr admission_control_;
     core::dbus::Bus::Ptr bus_;
     core::dbus::Service::Ptr service_;
     core::dbus::Object::Ptr object_;
+    Metrics::Ptr metrics_;
 
     util::Once<std::shared_ptr<Device>> default_device_;
 };
@@ -23,20 +23,51 @@
 #include <biometry/user.h>
 #include <biometry/dbus/codec.h>
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/skeleton/instruments.h>
 #include <biometry/dbus/skeleton/operation.h>
 
 #include <biometry/util/atomic_counter.h>
-#include <biometry/util/synchronized.h>
 
 #include <boost/format.hpp>
 
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
 namespace
 {
 core::dbus::Message::Ptr not_permitted_in_reply_to(const core::dbus::Message::Ptr& msg)
 {
+    biometry::dbus::skeleton::instruments::not_permitted().increment();
     return core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::NotPermitted::name(), "");
 }
 
+core::dbus::Message::Ptr busy_in_reply_to(const core::dbus::Message::Ptr& msg, biometry::dbus::skeleton::AdmissionControl::Verdict verdict)
+{
+    biometry::dbus::skeleton::instruments::busy().increment();
+    return core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::Busy::name(), (boost::format{"%1%"} % verdict).str());
+}
+
+// next_argument returns the next value of type A from reader.
+template<typename A>
+A next_argument(core::dbus::Message::Reader& reader)
+{
+    A a{}; reader >> a;
+    return a;
+}
+
+// invoke_with calls create on thiz with app, user and the remaining arguments bundled in args.
+template<typename R, typename C, typename Tuple, typename... Args, std::size_t... I>
+R invoke_with(C* thiz,
+         R (C::*create)(const biometry::Application&, const biometry::User&, Args...),
+         const biometry::Application& app,
+         const biometry::User& user,
+         const Tuple& args,
+         std::index_sequence<I...>)
+{
+    return (thiz->*create)(app, user, std::get<I>(args)...);
+}
+
 bool verify(const biometry::dbus::skeleton::RequestVerifier::Credentials& requested, const biometry::dbus::skeleton::RequestVerifier::Credentials& provided)
 {
     // In case of a match: good to go. Please note that we
@@ -86,9 +117,11 @@ biometry::dbus::skeleton::TemplateStore::Ptr biometry::dbus::skeleton::TemplateS
         const core::dbus::Object::Ptr& object,
         const std::reference_wrapper<biometry::TemplateStore>& impl,
         const std::shared_ptr<RequestVerifier>& request_verifier,
-        const std::shared_ptr<CredentialsResolver>& credentials_resolver)
+        const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+        const AdmissionControl::Ptr& admission_control,
+        const LifecycleManager::Ptr& lifecycle_manager)
 {
-    return Ptr{new TemplateStore{bus, service, object, impl, request_verifier, credentials_resolver}};
+    return Ptr{new TemplateStore{bus, service, object, impl, request_verifier, credentials_resolver, admission_control, lifecycle_manager}};
 }
 
 biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::dbus::skeleton::TemplateStore::size(const biometry::Application& app, const biometry::User& user)
@@ -116,229 +149,152 @@ biometry::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::dbus::ske
     return impl.get().clear(app, user);
 }
 
-biometry::dbus::skeleton::TemplateStore::TemplateStore(
-        const core::dbus::Bus::Ptr& bus,
-        const core::dbus::Service::Ptr& service,
-        const core::dbus::Object::Ptr& object,
-        const std::reference_wrapper<biometry::TemplateStore>& impl,
-        const std::shared_ptr<RequestVerifier>& request_verifier,
-        const std::shared_ptr<CredentialsResolver>& credentials_resolver)
-    : impl{impl},
-      request_verifier{request_verifier},
-      credentials_resolver{credentials_resolver},
-      bus{bus},
-      service{service},
-      object{object}
+template<typename T>
+void biometry::dbus::skeleton::TemplateStore::export_operation(
+        const std::string& kind,
+        const core::dbus::Message::Ptr& msg,
+        const RequestVerifier::Credentials& credentials,
+        const std::function<typename biometry::Operation<T>::Ptr()>& create,
+        const Optional<core::dbus::types::ObjectPath>& observer)
 {
-    object->install_method_handler<biometry::dbus::interface::TemplateStore::Methods::Size>([this](const core::dbus::Message::Ptr& msg)
+    auto admission = admission_control->admit(msg->sender(), credentials.app);
+    if (not admission)
     {
-        TemplateStore::credentials_resolver->resolve_credentials(msg, [this, msg](const Optional<RequestVerifier::Credentials>& credentials)
-        {
-            if (not credentials)
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            biometry::User user; biometry::Application app = biometry::Application::system();
-            auto reader = msg->reader(); reader >> app >> user;
-
-            if (not this->request_verifier->verify_size_request({app, user}, credentials.get()))
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            auto op = size(app, user);
-
-            core::dbus::types::ObjectPath op_path
-            {
-                (boost::format{"%1%/operation/size/%2%/%3%/%4%"}
-                    % this->object->path().as_string()
-                    % credentials.get().app.as_string()
-                    % credentials.get().user.id
-                    % util::counter<TemplateStore>().increment()).str()
-            };
-
-            ops.size.synchronized([this, op_path, op](SizeOps::ValueType& ops)
-            {
-                ops[op_path] = skeleton::Operation<SizeQuery>::create_for_object(this->bus, this->service->add_object_for_path(op_path), op);
-            });
-
-            auto reply = core::dbus::Message::make_method_return(msg);
-            reply->writer() << op_path;
-            this->bus->send(reply);
-        });
-    });
+        bus->send(busy_in_reply_to(msg, admission.verdict));
+        return;
+    }
+
+    auto op = create();
 
-    object->install_method_handler<biometry::dbus::interface::TemplateStore::Methods::List>([this](const core::dbus::Message::Ptr& msg)
+    core::dbus::types::ObjectPath op_path
     {
-        TemplateStore::credentials_resolver->resolve_credentials(msg, [this, msg](const Optional<RequestVerifier::Credentials>& credentials)
-        {
-            if (not credentials)
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            biometry::User user; biometry::Application app = biometry::Application::system();
-            auto reader = msg->reader(); reader >> app >> user;
-
-            if (not this->request_verifier->verify_list_request({app, user}, credentials.get()))
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            auto op = list(app, user);
-
-            core::dbus::types::ObjectPath op_path
-            {
-                (boost::format{"%1%/operation/list/%2%/%3%/%4%"}
-                    % this->object->path().as_string()
-                    % credentials.get().app.as_string()
-                    % credentials.get().user.id
-                    % util::counter<TemplateStore>().increment()).str()
-            };
-
-            ops.list.synchronized([this, op_path, op](ListOps::ValueType& ops)
-            {
-                ops[op_path] = skeleton::Operation<List>::create_for_object(this->bus, this->service->add_object_for_path(op_path), op);
-            });
-
-            auto reply = core::dbus::Message::make_method_return(msg);
-            reply->writer() << op_path;
-            this->bus->send(reply);
-        });
-    });
+        (boost::format{"%1%/operation/%2%/%3%/%4%/%5%"}
+            % object->path().as_string()
+            % kind
+            % credentials.app.as_string()
+            % credentials.user.id
+            % util::counter<TemplateStore>().increment()).str()
+    };
+
+    auto skeleton = skeleton::Operation<T>::create_for_object(bus, service->add_object_for_path(op_path), op, lifecycle, admission.ticket);
+    // The ticket is released early if the operation is canceled or finishes, at the latest when it is reaped.
+    auto ticket = admission.ticket;
+    lifecycle->add(op_path, msg->sender(), skeleton, [op, ticket]() { op->cancel(); ticket->release(); });
+
+    if (observer)
+        skeleton->start_with_remote_observer(msg->sender(), observer.get());
+
+    auto reply = core::dbus::Message::make_method_return(msg);
+    reply->writer() << op_path;
+    bus->send(reply);
+}
 
-    object->install_method_handler<biometry::dbus::interface::TemplateStore::Methods::Enroll>([this](const core::dbus::Message::Ptr& msg)
+template<typename Method, typename MethodAndStart, typename T, typename... Args>
+void biometry::dbus::skeleton::TemplateStore::install_handlers(
+        const std::string& kind,
+        Verify verify,
+        typename biometry::Operation<T>::Ptr (TemplateStore::*create)(const Application&, const User&, Args...))
+{
+    object->install_method_handler<Method>([this, kind, verify, create](const core::dbus::Message::Ptr& msg)
     {
-        TemplateStore::credentials_resolver->resolve_credentials(msg, [this, msg](const Optional<RequestVerifier::Credentials>& credentials)
-        {
-            if (not credentials)
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            biometry::User user; biometry::Application app = biometry::Application::system();
-            auto reader = msg->reader(); reader >> app >> user;
-
-            if (not this->request_verifier->verify_enroll_request({app, user}, credentials.get()))
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            auto op = enroll(app, user);
-
-            core::dbus::types::ObjectPath op_path
-            {
-                (boost::format{"%1%/operation/enroll/%2%/%3%/%4%"}
-                    % this->object->path().as_string()
-                    % credentials.get().app.as_string()
-                    % credentials.get().user.id
-                    % util::counter<TemplateStore>().increment()).str()
-            };
-
-            ops.enroll.synchronized([this, op_path, op](EnrollOps::ValueType& ops)
-            {
-                ops[op_path] = skeleton::Operation<Enrollment>::create_for_object(this->bus, this->service->add_object_for_path(op_path), op);
-            });
-
-            auto reply = core::dbus::Message::make_method_return(msg);
-            reply->writer() << op_path;
-            this->bus->send(reply);
-        });
+        auto span = instruments::received<Method>();
+        util::trace::Correlation correlation{span.id()};
+        handle<T>(msg, kind, verify, create, false);
     });
 
-    object->install_method_handler<biometry::dbus::interface::TemplateStore::Methods::Remove>([this](const core::dbus::Message::Ptr& msg)
+    object->install_method_handler<MethodAndStart>([this, kind, verify, create](const core::dbus::Message::Ptr& msg)
     {
-        TemplateStore::credentials_resolver->resolve_credentials(msg, [this, msg](const Optional<RequestVerifier::Credentials>& credentials)
-        {
-            if (not credentials)
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            biometry::User user; biometry::Application app = biometry::Application::system(); biometry::TemplateStore::TemplateId id{0};
-            auto reader = msg->reader(); reader >> app >> user >> id;
-
-            if (not this->request_verifier->verify_remove_request({app, user}, credentials.get()))
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            auto op = remove(app, user, id);
-
-            core::dbus::types::ObjectPath op_path
-            {
-                (boost::format{"%1%/operation/remove/%2%/%3%/%4%"}
-                    % this->object->path().as_string()
-                    % credentials.get().app.as_string()
-                    % credentials.get().user.id
-                    % util::counter<TemplateStore>().increment()).str()
-            };
-
-            ops.remove.synchronized([this, op_path, op](RemoveOps::ValueType& ops)
-            {
-                ops[op_path] = skeleton::Operation<Removal>::create_for_object(this->bus, this->service->add_object_for_path(op_path), op);
-            });
-
-            auto reply = core::dbus::Message::make_method_return(msg);
-            reply->writer() << op_path;
-            this->bus->send(reply);
-        });
+        auto span = instruments::received<MethodAndStart>();
+        util::trace::Correlation correlation{span.id()};
+        handle<T>(msg, kind, verify, create, true);
     });
+}
+
+template<typename T, typename... Args>
+void biometry::dbus::skeleton::TemplateStore::handle(
+        const core::dbus::Message::Ptr& msg,
+        const std::string& kind,
+        Verify verify,
+        typename biometry::Operation<T>::Ptr (TemplateStore::*create)(const Application&, const User&, Args...),
+        bool with_observer)
+{
+    // Resolving credentials completes asynchronously, we carry over the correlation id of the request.
+    auto id = util::trace::correlation_id();
 
-    object->install_method_handler<biometry::dbus::interface::TemplateStore::Methods::Clear>([this](const core::dbus::Message::Ptr& msg)
+    credentials_resolver->resolve_credentials(msg, [this, msg, kind, verify, create, with_observer, id](const Optional<RequestVerifier::Credentials>& credentials)
     {
-        TemplateStore::credentials_resolver->resolve_credentials(msg, [this, msg](const Optional<RequestVerifier::Credentials>& credentials)
+        util::trace::Correlation correlation{id};
+
+        if (not credentials)
         {
-            if (not credentials)
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            biometry::User user; biometry::Application app = biometry::Application::system();
-            auto reader = msg->reader(); reader >> app >> user;
-
-            if (not this->request_verifier->verify_clear_request({app, user}, credentials.get()))
-            {
-                this->bus->send(not_permitted_in_reply_to(msg));
-                return;
-            }
-
-            auto op = clear(app, user);
-
-            core::dbus::types::ObjectPath op_path
-            {
-                (boost::format{"%1%/operation/clear/%2%/%3%/%4%"}
-                    % this->object->path().as_string()
-                    % credentials.get().app.as_string()
-                    % credentials.get().user.id
-                    % util::counter<TemplateStore>().increment()).str()
-            };
-
-            ops.clear.synchronized([this, op_path, op](ClearOps::ValueType& ops)
-            {
-                ops[op_path] = skeleton::Operation<Clearance>::create_for_object(this->bus, this->service->add_object_for_path(op_path), op);
-            });
-
-            auto reply = core::dbus::Message::make_method_return(msg);
-            reply->writer() << op_path;
-            this->bus->send(reply);
-        });
+            bus->send(not_permitted_in_reply_to(msg));
+            return;
+        }
+
+        biometry::User user; biometry::Application app = biometry::Application::system();
+        auto reader = msg->reader(); reader >> app >> user;
+        // Braced initialization guarantees that arguments are read in order.
+        std::tuple<typename std::decay<Args>::type...> args{next_argument<typename std::decay<Args>::type>(reader)...};
+
+        Optional<core::dbus::types::ObjectPath> observer;
+        if (with_observer)
+            observer = next_argument<core::dbus::types::ObjectPath>(reader);
+
+        if (not (request_verifier.get()->*verify)({app, user}, credentials.get()))
+        {
+            bus->send(not_permitted_in_reply_to(msg));
+            return;
+        }
+
+        export_operation<T>(kind, msg, credentials.get(), [this, create, app, user, args]()
+        {
+            return invoke_with(this, create, app, user, args, std::index_sequence_for<Args...>{});
+        }, observer);
     });
 }
 
+biometry::dbus::skeleton::TemplateStore::TemplateStore(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object,
+        const std::reference_wrapper<biometry::TemplateStore>& impl,
+        const std::shared_ptr<RequestVerifier>& request_verifier,
+        const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+        const AdmissionControl::Ptr& admission_control,
+        const LifecycleManager::Ptr& lifecycle_manager)
+    : impl{impl},
+      request_verifier{request_verifier},
+      credentials_resolver{credentials_resolver},
+      admission_control{admission_control},
+      bus{bus},
+      service{service},
+      object{object},
+      lifecycle{lifecycle_manager}
+{
+    typedef biometry::dbus::interface::TemplateStore::Methods Methods;
+
+    install_handlers<Methods::Size, Methods::SizeAndStart, SizeQuery>("size", &RequestVerifier::verify_size_request, &TemplateStore::size);
+    install_handlers<Methods::List, Methods::ListAndStart, List>("list", &RequestVerifier::verify_list_request, &TemplateStore::list);
+    install_handlers<Methods::Enroll, Methods::EnrollAndStart, Enrollment>("enroll", &RequestVerifier::verify_enroll_request, &TemplateStore::enroll);
+    install_handlers<Methods::Remove, Methods::RemoveAndStart, Removal>("remove", &RequestVerifier::verify_remove_request, &TemplateStore::remove);
+    install_handlers<Methods::Clear, Methods::ClearAndStart, Clearance>("clear", &RequestVerifier::verify_clear_request, &TemplateStore::clear);
+}
+
 biometry::dbus::skeleton::TemplateStore::~TemplateStore()
 {
     object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::Size>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::List>();
     object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::Enroll>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::Remove>();
     object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::Clear>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::SizeAndStart>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::ListAndStart>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::EnrollAndStart>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::RemoveAndStart>();
+    object->uninstall_method_handler<biometry::dbus::interface::TemplateStore::Methods::ClearAndStart>();
+}
+
+const biometry::dbus::skeleton::LifecycleManager::Ptr& biometry::dbus::skeleton::TemplateStore::lifecycle_manager() const
+{
+    return lifecycle;
 }
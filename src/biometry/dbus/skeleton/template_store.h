@@ -22,15 +22,14 @@
 
 #include <biometry/template_store.h>
 
+#include <biometry/dbus/skeleton/admission_control.h>
 #include <biometry/dbus/skeleton/credentials_resolver.h>
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
 #include <biometry/dbus/skeleton/request_verifier.h>
-#include <biometry/util/synchronized.h>
 
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
 
-#include <unordered_map>
-
 namespace biometry
 {
 namespace dbus
@@ -80,11 +79,16 @@ public:
             const core::dbus::Object::Ptr& object,
             const std::reference_wrapper<biometry::TemplateStore>& impl,
             const std::shared_ptr<RequestVerifier>& request_verifier,
-            const std::shared_ptr<CredentialsResolver>& credentials_resolver);
+            const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+            const AdmissionControl::Ptr& admission_control,
+            const LifecycleManager::Ptr& lifecycle_manager);
 
     /// @brief Frees up resources and uninstall message handlers.
     ~TemplateStore();
 
+    /// @brief lifecycle_manager returns the LifecycleManager tracking the operations exported by this instance.
+    const LifecycleManager::Ptr& lifecycle_manager() const;
+
     // From biometry::Identifier.
     // biometry::Operation<biometry::TemplateStore::Enrollment>
     Operation<SizeQuery>::Ptr size(const Application&, const User&) override;
@@ -94,11 +98,37 @@ public:
     Operation<Clearance>::Ptr clear(const Application&, const User&) override;
 
 private:
-    typedef util::Synchronized<std::unordered_map<core::dbus::types::ObjectPath, Operation<SizeQuery>::Ptr>> SizeOps;
-    typedef util::Synchronized<std::unordered_map<core::dbus::types::ObjectPath, Operation<List>::Ptr>> ListOps;
-    typedef util::Synchronized<std::unordered_map<core::dbus::types::ObjectPath, Operation<Enrollment>::Ptr>> EnrollOps;
-    typedef util::Synchronized<std::unordered_map<core::dbus::types::ObjectPath, Operation<Removal>::Ptr>> RemoveOps;
-    typedef util::Synchronized<std::unordered_map<core::dbus::types::ObjectPath, Operation<Clearance>::Ptr>> ClearOps;
+    /// @brief export_operation admits the request in msg, exports the operation returned by create
+    /// on the bus and replies to msg with the path of the operation.
+    ///
+    /// Requests that are not admitted are rejected with Errors::Busy, without invoking create. If observer
+    /// is set, the operation is started right away, reporting to the observer exported by the sender of msg at the given path.
+    template<typename T>
+    void export_operation(const std::string& kind,
+                          const core::dbus::Message::Ptr& msg,
+                          const RequestVerifier::Credentials& credentials,
+                          const std::function<typename biometry::Operation<T>::Ptr()>& create,
+                          const Optional<core::dbus::types::ObjectPath>& observer);
+
+    /// @brief Verify models a member function of RequestVerifier checking a request.
+    typedef bool (RequestVerifier::*Verify)(const RequestVerifier::Credentials&, const RequestVerifier::Credentials&);
+
+    /// @brief install_handlers installs the handlers for Method and its fused counterpart MethodAndStart,
+    /// which create operations of type T by invoking create after verifying requests with verify.
+    template<typename Method, typename MethodAndStart, typename T, typename... Args>
+    void install_handlers(const std::string& kind,
+                          Verify verify,
+                          typename biometry::Operation<T>::Ptr (TemplateStore::*create)(const Application&, const User&, Args...));
+
+    /// @brief handle reads the arguments of create from msg, verifies the request and exports the operation.
+    ///
+    /// If with_observer is true, the arguments are followed by the path of an observer exported by the sender of msg.
+    template<typename T, typename... Args>
+    void handle(const core::dbus::Message::Ptr& msg,
+                const std::string& kind,
+                Verify verify,
+                typename biometry::Operation<T>::Ptr (TemplateStore::*create)(const Application&, const User&, Args...),
+                bool with_observer);
 
     /// @brief TemplateStore creates a new instance for the given remote service and object.
     TemplateStore(const core::dbus::Bus::Ptr& bus,
@@ -106,24 +136,19 @@ private:
                   const core::dbus::Object::Ptr& object,
                   const std::reference_wrapper<biometry::TemplateStore>& impl,
                   const std::shared_ptr<RequestVerifier>& request_verifier,
-                  const std::shared_ptr<CredentialsResolver>& credentials_resolver);
+                  const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+                  const AdmissionControl::Ptr& admission_control,
+                  const LifecycleManager::Ptr& lifecycle_manager);
 
 
     std::reference_wrapper<biometry::TemplateStore> impl;
     std::shared_ptr<RequestVerifier> request_verifier;
     std::shared_ptr<CredentialsResolver> credentials_resolver;
+    AdmissionControl::Ptr admission_control;
     core::dbus::Bus::Ptr bus;
     core::dbus::Service::Ptr service;
     core::dbus::Object::Ptr object;
-
-    struct
-    {
-        SizeOps size;
-        ListOps list;
-        EnrollOps enroll;        
-        RemoveOps remove;
-        ClearOps clear;        
-    } ops;
+    LifecycleManager::Ptr lifecycle;
 };
 }
 }
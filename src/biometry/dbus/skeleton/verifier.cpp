@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/verifier.h>
+
+#include <biometry/reason.h>
+#include <biometry/user.h>
+#include <biometry/dbus/codec.h>
+#include <biometry/dbus/interface.h>
+#include <biometry/dbus/skeleton/instruments.h>
+#include <biometry/dbus/skeleton/operation.h>
+
+#include <biometry/util/atomic_counter.h>
+
+#include <boost/format.hpp>
+
+namespace
+{
+core::dbus::Message::Ptr not_permitted_in_reply_to(const core::dbus::Message::Ptr& msg)
+{
+    biometry::dbus::skeleton::instruments::not_permitted().increment();
+    return core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::NotPermitted::name(), "");
+}
+
+core::dbus::Message::Ptr busy_in_reply_to(const core::dbus::Message::Ptr& msg, biometry::dbus::skeleton::AdmissionControl::Verdict verdict)
+{
+    biometry::dbus::skeleton::instruments::busy().increment();
+    return core::dbus::Message::make_error(msg, biometry::dbus::interface::Errors::Busy::name(), (boost::format{"%1%"} % verdict).str());
+}
+}
+
+bool biometry::dbus::skeleton::Verifier::RequestVerifier::verify_verify_user_request(const Credentials& requested, const Credentials& provided)
+{
+    // Requests for the same app and user are fine.
+    if (requested == provided)
+        return true;
+
+    // Unconfined apps are allowed to request verifications on behalf of other applications.
+    // We still limit them to their effective uid.
+    return provided.app.as_string() == "unconfined" && requested.user == provided.user;
+}
+
+/// @brief create_for_bus returns a new skeleton::Verifier instance connected to bus, forwarding calls to impl.
+biometry::dbus::skeleton::Verifier::Ptr biometry::dbus::skeleton::Verifier::create_for_service_and_object(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object,
+        const std::reference_wrapper<biometry::Verifier>& impl,
+        const std::shared_ptr<RequestVerifier>& request_verifier,
+        const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+        const AdmissionControl::Ptr& admission_control,
+        const LifecycleManager::Ptr& lifecycle_manager)
+{
+    return Ptr{new Verifier{bus, service, object, impl, request_verifier, credentials_resolver, admission_control, lifecycle_manager}};
+}
+
+// From biometry::Verifier.
+biometry::Operation<biometry::Verification>::Ptr biometry::dbus::skeleton::Verifier::verify_user(const Application& app, const User& user, const Reason& reason)
+{
+    return impl.get().verify_user(app, user, reason);
+}
+
+void biometry::dbus::skeleton::Verifier::export_operation(
+        const core::dbus::Message::Ptr& msg,
+        const RequestVerifier::Credentials& credentials,
+        const std::function<biometry::Operation<biometry::Verification>::Ptr()>& create,
+        const Optional<core::dbus::types::ObjectPath>& observer)
+{
+    auto admission = admission_control->admit(msg->sender(), credentials.app);
+    if (not admission)
+    {
+        bus->send(busy_in_reply_to(msg, admission.verdict));
+        return;
+    }
+
+    auto op = create();
+
+    core::dbus::types::ObjectPath op_path
+    {
+        (boost::format{"%1%/operation/verification/%2%/%3%/%4%"}
+            % object->path().as_string()
+            % credentials.app.as_string()
+            % credentials.user.id
+            % util::counter<Verifier>().increment()).str()
+    };
+
+    auto skeleton = skeleton::Operation<Verification>::create_for_object(bus, service->add_object_for_path(op_path), op, lifecycle, admission.ticket);
+    // The ticket is released early if the operation is canceled or finishes, at the latest when it is reaped.
+    auto ticket = admission.ticket;
+    lifecycle->add(op_path, msg->sender(), skeleton, [op, ticket]() { op->cancel(); ticket->release(); });
+
+    if (observer)
+        skeleton->start_with_remote_observer(msg->sender(), observer.get());
+
+    auto reply = core::dbus::Message::make_method_return(msg);
+    reply->writer() << op_path;
+    bus->send(reply);
+}
+
+biometry::dbus::skeleton::Verifier::Verifier(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object,
+        const std::reference_wrapper<biometry::Verifier>& impl,
+        const std::shared_ptr<RequestVerifier>& request_verifier,
+        const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+        const AdmissionControl::Ptr& admission_control,
+        const LifecycleManager::Ptr& lifecycle_manager)
+    : impl{impl},
+      request_verifier{request_verifier},
+      credentials_resolver{credentials_resolver},
+      admission_control{admission_control},
+      bus{bus},
+      service{service},
+      object{object},
+      lifecycle{lifecycle_manager}
+{
+    object->install_method_handler<biometry::dbus::interface::Verifier::Methods::VerifyUser>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Verifier::Methods::VerifyUser>();
+        util::trace::Correlation correlation{span.id()};
+        handle(msg, false);
+    });
+
+    object->install_method_handler<biometry::dbus::interface::Verifier::Methods::VerifyUserAndStart>([this](const core::dbus::Message::Ptr& msg)
+    {
+        auto span = instruments::received<biometry::dbus::interface::Verifier::Methods::VerifyUserAndStart>();
+        util::trace::Correlation correlation{span.id()};
+        handle(msg, true);
+    });
+}
+
+void biometry::dbus::skeleton::Verifier::handle(const core::dbus::Message::Ptr& msg, bool with_observer)
+{
+    // Resolving credentials completes asynchronously, we carry over the correlation id of the request.
+    auto id = util::trace::correlation_id();
+
+    credentials_resolver->resolve_credentials(msg, [this, msg, with_observer, id](const Optional<RequestVerifier::Credentials>& credentials)
+    {
+        util::trace::Correlation correlation{id};
+
+        if (not credentials)
+        {
+            bus->send(not_permitted_in_reply_to(msg));
+            return;
+        }
+
+        biometry::Application app = biometry::Application::system(); biometry::User user; biometry::Reason reason = biometry::Reason::unknown();
+        auto reader = msg->reader(); reader >> app >> user >> reason;
+
+        Optional<core::dbus::types::ObjectPath> observer;
+        if (with_observer)
+        {
+            core::dbus::types::ObjectPath path; reader >> path;
+            observer = path;
+        }
+
+        if (not request_verifier->verify_verify_user_request({app, user}, credentials.get()))
+        {
+            bus->send(not_permitted_in_reply_to(msg));
+            return;
+        }
+
+        export_operation(msg, credentials.get(), [this, app, user, reason]() { return verify_user(app, user, reason); }, observer);
+    });
+}
+
+biometry::dbus::skeleton::Verifier::~Verifier()
+{
+    object->uninstall_method_handler<biometry::dbus::interface::Verifier::Methods::VerifyUser>();
+    object->uninstall_method_handler<biometry::dbus::interface::Verifier::Methods::VerifyUserAndStart>();
+}
+
+const biometry::dbus::skeleton::LifecycleManager::Ptr& biometry::dbus::skeleton::Verifier::lifecycle_manager() const
+{
+    return lifecycle;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_SKELETON_VERIFIER_H_
+#define BIOMETRYD_DBUS_SKELETON_VERIFIER_H_
+
+#include <biometry/verifier.h>
+
+#include <biometry/dbus/skeleton/admission_control.h>
+#include <biometry/dbus/skeleton/credentials_resolver.h>
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
+
+#include <core/dbus/object.h>
+#include <core/dbus/service.h>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace skeleton
+{
+/// @cond
+class Device;
+/// @endcond
+
+// Verifier is the dbus SKELETON implementation of biometry::Verifier.
+class Verifier : public biometry::Verifier
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Verifier> Ptr;
+
+    /// @brief RequestVerifier models verification of incoming requests.
+    class RequestVerifier : public biometry::dbus::skeleton::RequestVerifier
+    {
+    public:
+        /// @brief verify_verify_user_request returns true if the requesting app identified by provided
+        /// is allowed to verify the user on behalf of the app bundled in requested.
+        virtual bool verify_verify_user_request(const Credentials& requested, const Credentials& provided);
+    };
+
+    /// @brief create_for_bus returns a new skeleton::Verifier instance connected to bus, forwarding calls to impl.
+    static Ptr create_for_service_and_object(const core::dbus::Bus::Ptr& bus,
+                                             const core::dbus::Service::Ptr& service,
+                                             const core::dbus::Object::Ptr& object,
+                                             const std::reference_wrapper<biometry::Verifier>& impl,
+                                             const std::shared_ptr<RequestVerifier>& request_verifier,
+                                             const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+                                             const AdmissionControl::Ptr& admission_control,
+                                             const LifecycleManager::Ptr& lifecycle_manager);
+
+    /// @brief Frees up resources and uninstalls method handlers.
+    ~Verifier();
+
+    /// @brief lifecycle_manager returns the LifecycleManager tracking the operations exported by this instance.
+    const LifecycleManager::Ptr& lifecycle_manager() const;
+
+    // From biometry::Verifier.
+    Operation<Verification>::Ptr verify_user(const Application& app, const User& user, const Reason& reason) override;
+
+private:
+    /// @brief handle reads the arguments of a request from msg, verifies the request and exports the operation.
+    ///
+    /// If with_observer is true, the arguments are followed by the path of an observer exported by the sender of msg.
+    void handle(const core::dbus::Message::Ptr& msg, bool with_observer);
+
+    /// @brief export_operation admits the request in msg, exports the operation returned by create
+    /// on the bus and replies to msg with the path of the operation.
+    ///
+    /// Requests that are not admitted are rejected with Errors::Busy, without invoking create. If observer
+    /// is set, the operation is started right away, reporting to the observer exported by the sender of msg at the given path.
+    void export_operation(const core::dbus::Message::Ptr& msg,
+                          const RequestVerifier::Credentials& credentials,
+                          const std::function<Operation<Verification>::Ptr()>& create,
+                          const Optional<core::dbus::types::ObjectPath>& observer);
+
+    /// @brief Verifier creates a new instance for the given remote service and object.
+    Verifier(const core::dbus::Bus::Ptr& bus,
+             const core::dbus::Service::Ptr& service,
+             const core::dbus::Object::Ptr& object,
+             const std::reference_wrapper<biometry::Verifier>& impl,
+             const std::shared_ptr<RequestVerifier>& request_verifier,
+             const std::shared_ptr<CredentialsResolver>& credentials_resolver,
+             const AdmissionControl::Ptr& admission_control,
+             const LifecycleManager::Ptr& lifecycle_manager);
+
+    std::reference_wrapper<biometry::Verifier> impl;
+    std::shared_ptr<RequestVerifier> request_verifier;
+    std::shared_ptr<CredentialsResolver> credentials_resolver;
+    AdmissionControl::Ptr admission_control;
+
+    core::dbus::Bus::Ptr bus;
+    core::dbus::Service::Ptr service;
+    core::dbus::Object::Ptr object;
+    LifecycleManager::Ptr lifecycle;
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_SKELETON_VERIFIER_H_
@@ -22,10 +22,15 @@
 #include <biometry/dbus/interface.h>
 #include <biometry/dbus/stub/identifier.h>
 #include <biometry/dbus/stub/template_store.h>
+#include <biometry/dbus/stub/verifier.h>
+
+#include <stdexcept>
 
 /// @brief Device creates a new instance for the given remote service and object;
-biometry::dbus::stub::Device::Device(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object)
-    : bus_{bus},
+biometry::dbus::stub::Device::Device(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object,
+                                     const ClientConnection::Ptr& connection)
+    : connection_{connection},
+      bus_{bus},
       service_{service},
       object_{object}
 {
@@ -41,6 +46,9 @@ biometry::TemplateStore& biometry::dbus::stub::Device::template_store()
                 biometry::dbus::interface::Device::Methods::TemplateStore::ResultType
         >();
 
+        if (result.is_error())
+            throw std::runtime_error{result.error().print()};
+
         return biometry::dbus::stub::TemplateStore::create_for_service_and_object(bus_, service_, service_->object_for_path(result.value()));
     });
 }
@@ -54,11 +62,25 @@ biometry::Identifier& biometry::dbus::stub::Device::identifier()
                 biometry::dbus::interface::Device::Methods::Identifier::ResultType
         >();
 
+        if (result.is_error())
+            throw std::runtime_error{result.error().print()};
+
         return biometry::dbus::stub::Identifier::create_for_service_and_object(bus_, service_, service_->object_for_path(result.value()));
     });
 }
 
 biometry::Verifier& biometry::dbus::stub::Device::verifier()
 {
-    throw std::runtime_error{"Not implemented"};
+    return *verifier_([this]()
+    {
+        auto result = object_->invoke_method_synchronously<
+                biometry::dbus::interface::Device::Methods::Verifier,
+                biometry::dbus::interface::Device::Methods::Verifier::ResultType
+        >();
+
+        if (result.is_error())
+            throw std::runtime_error{result.error().print()};
+
+        return biometry::dbus::stub::Verifier::create_for_service_and_object(bus_, service_, service_->object_for_path(result.value()));
+    });
 }
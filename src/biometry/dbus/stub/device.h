@@ -21,6 +21,9 @@
 #define BIOMETRYD_DBUS_STUB_DEVICE_H_
 
 #include <biometry/device.h>
+#include <biometry/visibility.h>
+
+#include <biometry/dbus/client_connection.h>
 
 #include <biometry/util/once.h>
 
@@ -36,13 +39,17 @@ namespace stub
 /// @cond
 class Identifier;
 class TemplateStore;
+class Verifier;
 /// @endcond
 
-class Device : public biometry::Device
+class BIOMETRY_DLL_PUBLIC Device : public biometry::Device
 {
 public:
     /// @brief Device creates a new instance for the given remote service and object;
-    Device(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
+    ///
+    /// If connection is not null, it is kept alive for the lifetime of the instance.
+    Device(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object,
+           const ClientConnection::Ptr& connection = ClientConnection::Ptr{});
 
     // From biometry::Device
     biometry::TemplateStore& template_store() override;
@@ -50,12 +57,14 @@ public:
     biometry::Verifier& verifier() override;
 
 private:
+    ClientConnection::Ptr connection_;
     core::dbus::Bus::Ptr bus_;
     core::dbus::Service::Ptr service_;
     core::dbus::Object::Ptr object_;
 
     util::Once<std::shared_ptr<biometry::dbus::stub::TemplateStore>> template_store_;
     util::Once<std::shared_ptr<biometry::dbus::stub::Identifier>> identifier_;
+    util::Once<std::shared_ptr<biometry::dbus::stub::Verifier>> verifier_;
 };
 }
 }
@@ -0,0 +1,34 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/stub/errors.h>
+
+#include <biometry/dbus/interface.h>
+
+biometry::dbus::stub::Busy::Busy(const std::string& reason) : std::runtime_error{reason}
+{
+}
+
+std::exception_ptr biometry::dbus::stub::exception_for(const core::dbus::Error& error)
+{
+    if (error.name() == biometry::dbus::interface::Errors::Busy::name())
+        return std::make_exception_ptr(Busy{error.print()});
+
+    return std::make_exception_ptr(std::runtime_error{error.print()});
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_STUB_ERRORS_H_
+#define BIOMETRYD_DBUS_STUB_ERRORS_H_
+
+#include <biometry/visibility.h>
+
+#include <core/dbus/error.h>
+
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace stub
+{
+/// @brief Busy is thrown if the service rejects a request as the requesting peer exceeded its limits.
+///
+/// Callers are expected to back off and retry later.
+struct BIOMETRY_DLL_PUBLIC Busy : public std::runtime_error
+{
+    /// @brief Busy initializes a new instance with the reason handed back by the service.
+    explicit Busy(const std::string& reason);
+};
+
+/// @brief exception_for returns an exception_ptr describing error, mapping well-known errors to typed exceptions.
+BIOMETRY_DLL_PUBLIC std::exception_ptr exception_for(const core::dbus::Error& error);
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_STUB_ERRORS_H_
@@ -31,14 +31,24 @@ biometry::dbus::stub::Identifier::Ptr biometry::dbus::stub::Identifier::create_f
     return Ptr{new Identifier{bus, service, object}};
 }
 
+biometry::dbus::stub::Operation<biometry::Identification>::Ptr biometry::dbus::stub::Identifier::identify_user_async(const Application& app, const Reason& reason)
+{
+    return Operation<Identification>::create_by_invoking<biometry::dbus::interface::Identifier::Methods::IdentifyUser>(bus, service, object, app, reason);
+}
+
 biometry::Operation<biometry::Identification>::Ptr biometry::dbus::stub::Identifier::identify_user(const Application& app, const Reason& reason)
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::Identifier::Methods::IdentifyUser,
-            biometry::dbus::interface::Identifier::Methods::IdentifyUser::ResultType
-    >(app, reason);
+    // The remote operation is created together with starting it, in a single round-trip.
+    return Operation<Identification>::create_deferred<biometry::dbus::interface::Identifier::Methods::IdentifyUser,
+                                                      biometry::dbus::interface::Identifier::Methods::IdentifyUserAndStart>(bus, service, object, app, reason);
+}
 
-    return Operation<Identification>::create_for_object_and_service(bus, service, service->object_for_path(result.value()));
+biometry::dbus::stub::Operation<biometry::Identification>::Ptr biometry::dbus::stub::Identifier::identify_user_and_start_async(
+        const Application& app, const Reason& reason,
+        const biometry::Operation<Identification>::Observer::Ptr& observer,
+        const Operation<Identification>::Completion& then)
+{
+    return Operation<Identification>::create_and_start_by_invoking<biometry::dbus::interface::Identifier::Methods::IdentifyUserAndStart>(bus, service, object, observer, then, app, reason);
 }
 
 biometry::dbus::stub::Identifier::Identifier(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object)
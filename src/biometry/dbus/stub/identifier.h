@@ -21,6 +21,9 @@
 #define BIOMETRYD_DBUS_STUB_IDENTIFIER_H_
 
 #include <biometry/identifier.h>
+#include <biometry/visibility.h>
+
+#include <biometry/dbus/stub/operation.h>
 
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
@@ -32,7 +35,10 @@ namespace dbus
 namespace stub
 {
 // Identifier is the dbus stub implementation of biometry::Service.
-class Identifier : public biometry::Identifier
+//
+// Operations handed out through the generic interface are deferred and only
+// created remotely when started, in a single round-trip.
+class BIOMETRY_DLL_PUBLIC Identifier : public biometry::Identifier
 {
 public:
     // Safe us some typing.
@@ -41,8 +47,16 @@ public:
     /// @brief create_for_bus creates a new instance connecting to bus, forwarding incoming calls to impl.
     static Ptr create_for_service_and_object(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
 
+    /// @brief identify_user_async requests a new identification without waiting for the reply.
+    stub::Operation<Identification>::Ptr identify_user_async(const Application& app, const Reason& reason);
+
+    /// @brief identify_user_and_start_async requests a new identification and starts it with observer in a single round-trip.
+    stub::Operation<Identification>::Ptr identify_user_and_start_async(const Application& app, const Reason& reason,
+                                                                       const Operation<Identification>::Observer::Ptr& observer,
+                                                                       const stub::Operation<Identification>::Completion& then);
+
     // From biometry::Identifier.
-    Operation<Identification>::Ptr identify_user(const Application& app, const Reason& reason) override;
+    biometry::Operation<Identification>::Ptr identify_user(const Application& app, const Reason& reason) override;
 
 private:
     /// @brief Service creates a new instance for the given remote service and object.
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/dbus/stub/metrics.h>
+
+#include <biometry/dbus/interface.h>
+
+#include <stdexcept>
+
+biometry::dbus::stub::Metrics::Ptr biometry::dbus::stub::Metrics::create_for_bus(const core::dbus::Bus::Ptr& bus)
+{
+    auto service = core::dbus::Service::use_service(bus, biometry::dbus::interface::Service::name());
+    auto object = service->object_for_path(biometry::dbus::interface::Metrics::path());
+    return Ptr{new Metrics{bus, service, object}};
+}
+
+std::string biometry::dbus::stub::Metrics::dump() const
+{
+    auto result = object->invoke_method_synchronously<
+            biometry::dbus::interface::Metrics::Methods::Dump,
+            biometry::dbus::interface::Metrics::Methods::Dump::ResultType
+    >();
+
+    if (result.is_error())
+        throw std::runtime_error{result.error().print()};
+
+    return result.value();
+}
+
+std::string biometry::dbus::stub::Metrics::trace() const
+{
+    auto result = object->invoke_method_synchronously<
+            biometry::dbus::interface::Metrics::Methods::Trace,
+            biometry::dbus::interface::Metrics::Methods::Trace::ResultType
+    >();
+
+    if (result.is_error())
+        throw std::runtime_error{result.error().print()};
+
+    return result.value();
+}
+
+biometry::dbus::stub::Metrics::Metrics(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object)
+    : bus{bus},
+      service{service},
+      object{object}
+{
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_DBUS_STUB_METRICS_H_
+#define BIOMETRYD_DBUS_STUB_METRICS_H_
+
+#include <biometry/visibility.h>
+
+#include <core/dbus/object.h>
+#include <core/dbus/service.h>
+
+#include <memory>
+#include <string>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace stub
+{
+/// @brief Metrics is the dbus stub accessing the metrics exported by the daemon.
+class BIOMETRY_DLL_PUBLIC Metrics
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Metrics> Ptr;
+
+    /// @brief create_for_bus creates a new instance accessing the metrics exported on bus.
+    static Ptr create_for_bus(const core::dbus::Bus::Ptr& bus);
+
+    /// @brief dump returns a snapshot of all instruments, one "name value" pair per line.
+    ///
+    /// @throws std::runtime_error if querying the remote end fails.
+    std::string dump() const;
+
+    /// @brief trace returns all trace events buffered by the daemon, in the Chrome trace-event format.
+    ///
+    /// @throws std::runtime_error if querying the remote end fails.
+    std::string trace() const;
+
+private:
+    Metrics(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
+
+    core::dbus::Bus::Ptr bus;
+    core::dbus::Service::Ptr service;
+    core::dbus::Object::Ptr object;
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_STUB_METRICS_H_
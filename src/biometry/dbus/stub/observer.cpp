@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/stub/observer.h>
+
+#include <biometry/runtime.h>
+
+namespace
+{
+// RuntimeProgressTimer schedules tasks on the io_service of a Runtime.
+class RuntimeProgressTimer : public biometry::dbus::stub::ProgressTimer
+{
+public:
+    explicit RuntimeProgressTimer(const std::shared_ptr<biometry::Runtime>& runtime) : runtime{runtime}
+    {
+    }
+
+    Clock::time_point now() const override
+    {
+        return Clock::now();
+    }
+
+    void schedule(const Clock::duration& delay, const std::function<void()>& task) override
+    {
+        auto rt = runtime.lock();
+        if (not rt)
+            return;
+
+        auto timer = std::make_shared<boost::asio::steady_timer>(rt->service());
+        timer->expires_from_now(delay);
+        // The handler keeps timer alive until it has fired.
+        timer->async_wait([timer, task](const boost::system::error_code& ec)
+        {
+            if (ec == boost::asio::error::operation_aborted)
+                return;
+
+            task();
+        });
+    }
+
+private:
+    // We must not keep the runtime alive, e.g., from a default configuration outliving it.
+    std::weak_ptr<biometry::Runtime> runtime;
+};
+}
+
+biometry::dbus::stub::ProgressTimer::Ptr biometry::dbus::stub::ProgressTimer::for_runtime(const std::shared_ptr<Runtime>& runtime)
+{
+    return std::make_shared<RuntimeProgressTimer>(runtime);
+}
@@ -20,20 +20,68 @@
 #ifndef BIOMETRYD_DBUS_STUB_OBSERVER_H_
 #define BIOMETRYD_DBUS_STUB_OBSERVER_H_
 
+#include <biometry/do_not_copy_or_move.h>
 #include <biometry/operation.h>
+#include <biometry/optional.h>
+#include <biometry/visibility.h>
 
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/side_channel.h>
+
+#include <biometry/util/synchronized.h>
+#include <biometry/util/trace.h>
 
 #include <core/dbus/object.h>
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
 namespace biometry
 {
+class Runtime;
+
 namespace dbus
 {
 namespace stub
 {
+/// @brief ProgressTimer tells the time and schedules deferred progress deliveries.
+class BIOMETRY_DLL_PUBLIC ProgressTimer : public DoNotCopyOrMove
+{
+public:
+    // Safe us some typing
+    typedef std::shared_ptr<ProgressTimer> Ptr;
+    typedef std::chrono::steady_clock Clock;
+
+    /// @brief for_runtime returns a ProgressTimer reading Clock and running tasks on runtime.
+    ///
+    /// Tasks scheduled after runtime has been destroyed are dropped.
+    static Ptr for_runtime(const std::shared_ptr<Runtime>& runtime);
+
+    virtual ~ProgressTimer() = default;
+
+    /// @brief now returns the current point in time.
+    virtual Clock::time_point now() const = 0;
+
+    /// @brief schedule invokes task once delay has passed.
+    virtual void schedule(const Clock::duration& delay, const std::function<void()>& task) = 0;
+
+protected:
+    ProgressTimer() = default;
+};
+
+// Observer forwards events to a remote observer.
+//
+// Progress updates are coalesced: at most one OnProgress call is in flight at any point in time,
+// and, given a Configuration::timer, subsequent calls are spaced by at least
+// Configuration::min_progress_interval. Only the latest progress update is kept while waiting,
+// and pending progress is flushed before a terminal event is delivered. Terminal events are
+// always delivered. Every call is traced from sending it until the remote side acknowledged it,
+// correlated with the correlation id of the thread that created the instance.
 template<typename T>
-class Observer : public Operation<T>::Observer
+class Observer : public Operation<T>::Observer, public std::enable_shared_from_this<Observer<T>>
 {
 public:
     // Safe us some typing
@@ -45,9 +93,46 @@ public:
     using typename Super::Error;
     using typename Super::Result;
 
-    /// @brief create_for_object_and_service returns a new instance on the given object.
+    /// @brief Configuration bundles the tunables of progress coalescing.
+    struct Configuration
+    {
+        /// @brief min_progress_interval is the minimum time between two OnProgress calls.
+        std::chrono::milliseconds min_progress_interval;
+        /// @brief timer measures min_progress_interval and delivers deferred progress updates.
+        ///
+        /// Without a timer, progress updates are not spaced but only coalesced while a call is in flight.
+        ProgressTimer::Ptr timer;
+    };
+
+    /// @brief Counters bundles statistics about progress updates.
+    struct Counters
+    {
+        /// @brief delivered is the number of progress updates sent to the remote observer.
+        std::uint64_t delivered;
+        /// @brief merged is the number of progress updates superseded by a later one before delivery.
+        std::uint64_t merged;
+        /// @brief dropped is the number of progress updates received after a terminal event.
+        std::uint64_t dropped;
+    };
+
+    /// @brief default_configuration returns the configuration applied to new instances for operations of type T.
+    static Configuration default_configuration();
+
+    /// @brief configure_defaults adjusts the configuration applied to new instances for operations of type T.
+    static void configure_defaults(const Configuration& configuration);
+
+    /// @brief create_for_object returns a new instance on the given object, configured with default_configuration().
     static Ptr create_for_object(const core::dbus::Object::Ptr& object);
 
+    /// @brief create_for_object returns a new instance on the given object, configured according to configuration.
+    static Ptr create_for_object(const core::dbus::Object::Ptr& object, const Configuration& configuration);
+
+    /// @brief counters returns a snapshot of the current statistics.
+    Counters counters() const;
+
+    /// @brief use_side_channel passes large blobs in subsequent progress updates through side_channel.
+    void use_side_channel(const SideChannel::Ptr& side_channel);
+
     // From Operation<T>::Observer
     void on_started() override;
     void on_progress(const Progress&) override;
@@ -56,19 +141,104 @@ public:
     void on_succeeded(const Result&) override;
 
 private:
+    /// @cond
+    struct State
+    {
+        bool in_flight;
+        bool timer_armed;
+        bool terminal;
+        Optional<Progress> pending;
+        ProgressTimer::Clock::time_point last_sent;
+    };
+
+    static util::Synchronized<Configuration>& defaults();
+
     /// @brief Observer initializes a new instance for the given remote object.
-    Observer(const core::dbus::Object::Ptr& object);
+    Observer(const core::dbus::Object::Ptr& object, const Configuration& configuration);
+
+    /// @brief send_progress invokes OnProgress on the remote object.
+    void send_progress(const Progress& progress);
+
+    /// @brief on_progress_delivered is invoked once the remote side acknowledged a progress update.
+    void on_progress_delivered();
+
+    /// @brief on_timer_expired is invoked once a deferred progress update is due.
+    void on_timer_expired();
+
+    /// @brief arm_timer schedules delivery of a deferred progress update after the given delay.
+    void arm_timer(const ProgressTimer::Clock::duration& delay);
+
+    /// @brief now returns the current point in time according to the configured timer.
+    ProgressTimer::Clock::time_point now() const;
+
+    /// @brief min_progress_interval returns the effective minimum time between two OnProgress calls.
+    ProgressTimer::Clock::duration min_progress_interval() const;
+
+    /// @brief trace_delivery returns a callback tracing a call to method, sent now, until it is acknowledged.
+    std::function<void(const core::dbus::Result<void>&)> trace_delivery(const char* method) const;
+
+    /// @brief flush_for_terminal_event returns pending progress and marks the observer as done.
+    Optional<Progress> flush_for_terminal_event();
 
     core::dbus::Object::Ptr object;
+    Configuration configuration;
+    std::uint64_t trace_id;
+    SideChannel::Ptr side_channel;
+    util::Synchronized<State> state;
+
+    struct
+    {
+        std::atomic<std::uint64_t> delivered{0};
+        std::atomic<std::uint64_t> merged{0};
+        std::atomic<std::uint64_t> dropped{0};
+    } counters_;
+    /// @endcond
 };
 }
 }
 }
 
+template<typename T>
+typename biometry::dbus::stub::Observer<T>::Configuration biometry::dbus::stub::Observer<T>::default_configuration()
+{
+    Configuration result;
+    defaults().synchronized([&result](Configuration& configuration) { result = configuration; });
+    return result;
+}
+
+template<typename T>
+void biometry::dbus::stub::Observer<T>::configure_defaults(const Configuration& configuration)
+{
+    defaults().synchronized([&configuration](Configuration& value) { value = configuration; });
+}
+
 template<typename T>
 typename biometry::dbus::stub::Observer<T>::Ptr biometry::dbus::stub::Observer<T>::create_for_object(const core::dbus::Object::Ptr& object)
 {
-    return Ptr{new Observer<T>{object}};
+    return create_for_object(object, default_configuration());
+}
+
+template<typename T>
+typename biometry::dbus::stub::Observer<T>::Ptr biometry::dbus::stub::Observer<T>::create_for_object(const core::dbus::Object::Ptr& object, const Configuration& configuration)
+{
+    return Ptr{new Observer<T>{object, configuration}};
+}
+
+template<typename T>
+typename biometry::dbus::stub::Observer<T>::Counters biometry::dbus::stub::Observer<T>::counters() const
+{
+    return Counters
+    {
+        counters_.delivered.load(),
+        counters_.merged.load(),
+        counters_.dropped.load()
+    };
+}
+
+template<typename T>
+void biometry::dbus::stub::Observer<T>::use_side_channel(const SideChannel::Ptr& side_channel)
+{
+    std::atomic_store(&this->side_channel, side_channel);
 }
 
 template<typename T>
@@ -77,59 +247,246 @@ void biometry::dbus::stub::Observer<T>::on_started()
     object->invoke_method_asynchronously_with_callback<
             biometry::dbus::interface::Operation::Observer::Methods::OnStarted,
             void
-    >([](const core::dbus::Result<void>&)
-    {
-    });
+    >(trace_delivery("OnStarted"));
 }
 
 template<typename T>
 void biometry::dbus::stub::Observer<T>::on_progress(const typename Observer<T>::Progress& progress)
 {
-    object->invoke_method_asynchronously_with_callback<
-            biometry::dbus::interface::Operation::Observer::Methods::OnProgress,
-            void
-    >([](const core::dbus::Result<void>&)
+    enum class Action { send, arm_timer, none } action{Action::none};
+    ProgressTimer::Clock::duration delay{};
+
+    state.synchronized([this, &progress, &action, &delay](State& state)
+    {
+        if (state.terminal)
+        {
+            counters_.dropped++;
+            return;
+        }
+
+        auto now = this->now();
+        auto elapsed = now - state.last_sent;
+
+        if (not state.in_flight && not state.pending && elapsed >= min_progress_interval())
+        {
+            state.in_flight = true;
+            state.last_sent = now;
+            action = Action::send;
+            return;
+        }
+
+        if (state.pending)
+            counters_.merged++;
+
+        state.pending = progress;
+
+        if (not state.in_flight && not state.timer_armed)
+        {
+            state.timer_armed = true;
+            delay = min_progress_interval() - elapsed;
+            action = Action::arm_timer;
+        }
+    });
+
+    switch (action)
     {
-    }, progress);
+    case Action::send: send_progress(progress); break;
+    case Action::arm_timer: arm_timer(delay); break;
+    case Action::none: break;
+    }
 }
 
 template<typename T>
 void biometry::dbus::stub::Observer<T>::on_canceled(const Reason& reason)
 {
+    if (auto progress = flush_for_terminal_event())
+        send_progress(progress.get());
+
     object->invoke_method_asynchronously_with_callback<
             biometry::dbus::interface::Operation::Observer::Methods::OnCancelled,
             void
-    >([](const core::dbus::Result<void>&)
-    {
-    }, reason);
+    >(trace_delivery("OnCancelled"), reason);
 }
 
 template<typename T>
 void biometry::dbus::stub::Observer<T>::on_failed(const Error& error)
 {
+    if (auto progress = flush_for_terminal_event())
+        send_progress(progress.get());
+
     object->invoke_method_asynchronously_with_callback<
             biometry::dbus::interface::Operation::Observer::Methods::OnFailed,
             void
-    >([](const core::dbus::Result<void>&)
-    {
-    }, error);
+    >(trace_delivery("OnFailed"), error);
 }
 
 template<typename T>
 void biometry::dbus::stub::Observer<T>::on_succeeded(const Result& result)
 {
+    if (auto progress = flush_for_terminal_event())
+        send_progress(progress.get());
+
     object->invoke_method_asynchronously_with_callback<
             biometry::dbus::interface::Operation::Observer::Methods::OnSucceeded,
             void
-    >([](const core::dbus::Result<void>&)
+    >(trace_delivery("OnSucceeded"), result);
+}
+
+template<typename T>
+biometry::util::Synchronized<typename biometry::dbus::stub::Observer<T>::Configuration>& biometry::dbus::stub::Observer<T>::defaults()
+{
+    // Enrollment reports progress per captured frame, 20 updates per second are plenty for any UI.
+    // The daemon hands in a timer running on the runtime executing its bus.
+    static util::Synchronized<Configuration> instance{Configuration{std::chrono::milliseconds{50}, ProgressTimer::Ptr{}}};
+    return instance;
+}
+
+template<typename T>
+biometry::dbus::stub::Observer<T>::Observer(const core::dbus::Object::Ptr& object, const Configuration& configuration)
+    : object{object},
+      configuration(configuration),
+      trace_id{util::trace::correlation_id()},
+      state{State{false, false, false, Optional<Progress>{}, ProgressTimer::Clock::time_point{}}}
+{
+}
+
+template<typename T>
+void biometry::dbus::stub::Observer<T>::send_progress(const Progress& progress)
+{
+    counters_.delivered++;
+
+    std::weak_ptr<Observer<T>> wp{std::enable_shared_from_this<Observer<T>>::shared_from_this()};
+
+    auto traced = trace_delivery("OnProgress");
+    auto callback = [wp, traced](const core::dbus::Result<void>& result)
+    {
+        traced(result);
+
+        if (auto sp = wp.lock())
+            sp->on_progress_delivered();
+    };
+
+    if (auto sc = std::atomic_load(&side_channel))
+    {
+        object->invoke_method_asynchronously_with_callback<
+                biometry::dbus::interface::Operation::Observer::Methods::OnProgress,
+                void
+        >(callback, sc->pack(progress));
+    }
+    else
     {
-    }, result);
+        object->invoke_method_asynchronously_with_callback<
+                biometry::dbus::interface::Operation::Observer::Methods::OnProgress,
+                void
+        >(callback, progress);
+    }
 }
 
 template<typename T>
-biometry::dbus::stub::Observer<T>::Observer(const core::dbus::Object::Ptr& object)
-    : object{object}
+std::function<void(const core::dbus::Result<void>&)> biometry::dbus::stub::Observer<T>::trace_delivery(const char* method) const
 {
+    auto id = trace_id;
+    auto sent_at = util::trace::Clock::now();
+
+    return [method, id, sent_at](const core::dbus::Result<void>&)
+    {
+        util::trace::tracer().complete("delivery", method, sent_at, id);
+    };
+}
+
+template<typename T>
+void biometry::dbus::stub::Observer<T>::on_progress_delivered()
+{
+    Optional<Progress> next;
+    bool arm{false}; ProgressTimer::Clock::duration delay{};
+
+    state.synchronized([this, &next, &arm, &delay](State& state)
+    {
+        state.in_flight = false;
+
+        if (state.terminal || not state.pending)
+            return;
+
+        auto now = this->now();
+        auto elapsed = now - state.last_sent;
+
+        if (elapsed >= min_progress_interval())
+        {
+            std::swap(next, state.pending);
+            state.in_flight = true;
+            state.last_sent = now;
+        }
+        else if (not state.timer_armed)
+        {
+            state.timer_armed = arm = true;
+            delay = min_progress_interval() - elapsed;
+        }
+    });
+
+    if (next)
+        send_progress(next.get());
+    else if (arm)
+        arm_timer(delay);
+}
+
+template<typename T>
+void biometry::dbus::stub::Observer<T>::on_timer_expired()
+{
+    Optional<Progress> next;
+
+    state.synchronized([this, &next](State& state)
+    {
+        state.timer_armed = false;
+
+        if (state.terminal || state.in_flight || not state.pending)
+            return;
+
+        std::swap(next, state.pending);
+        state.in_flight = true;
+        state.last_sent = now();
+    });
+
+    if (next)
+        send_progress(next.get());
+}
+
+template<typename T>
+void biometry::dbus::stub::Observer<T>::arm_timer(const ProgressTimer::Clock::duration& delay)
+{
+    std::weak_ptr<Observer<T>> wp{std::enable_shared_from_this<Observer<T>>::shared_from_this()};
+
+    // Only reached with a timer, min_progress_interval() is zero otherwise.
+    configuration.timer->schedule(delay, [wp]()
+    {
+        if (auto sp = wp.lock())
+            sp->on_timer_expired();
+    });
+}
+
+template<typename T>
+biometry::dbus::stub::ProgressTimer::Clock::time_point biometry::dbus::stub::Observer<T>::now() const
+{
+    return configuration.timer ? configuration.timer->now() : ProgressTimer::Clock::now();
+}
+
+template<typename T>
+biometry::dbus::stub::ProgressTimer::Clock::duration biometry::dbus::stub::Observer<T>::min_progress_interval() const
+{
+    return configuration.timer ? ProgressTimer::Clock::duration{configuration.min_progress_interval} : ProgressTimer::Clock::duration::zero();
+}
+
+template<typename T>
+biometry::Optional<typename biometry::dbus::stub::Observer<T>::Progress> biometry::dbus::stub::Observer<T>::flush_for_terminal_event()
+{
+    Optional<Progress> result;
+
+    state.synchronized([&result](State& state)
+    {
+        state.terminal = true;
+        std::swap(result, state.pending);
+    });
+
+    return result;
 }
 
 #endif // BIOMETRYD_DBUS_STUB_OBSERVER_H_
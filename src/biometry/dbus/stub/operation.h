@@ -24,13 +24,25 @@
 #include <biometry/tracing_operation_observer.h>
 
 #include <biometry/dbus/interface.h>
+#include <biometry/dbus/side_channel.h>
 #include <biometry/dbus/skeleton/observer.h>
+#include <biometry/dbus/stub/errors.h>
+
+#include <biometry/util/atomic_counter.h>
+#include <biometry/util/synchronized.h>
 
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
 
 #include <boost/format.hpp>
 
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
 namespace biometry
 {
 namespace dbus
@@ -38,8 +50,18 @@ namespace dbus
 namespace stub
 {
 // Identifier is the dbus SKELETON implementation of biometry::Service.
+//
+// An Operation might be pending, i.e., the call creating the remote operation
+// has been issued but its reply has not arrived yet. Asynchronous calls on a pending
+// operation are queued and issued as soon as the remote object is known, thus
+// pipelining the creation of an operation and starting it.
+//
+// An Operation might also be deferred, i.e., the remote operation has not been requested
+// at all. It is requested together with starting it, in a single round-trip, or as soon as
+// any other call needs the remote object.
 template<typename T>
-class Operation : public biometry::Operation<T>
+class Operation : public biometry::Operation<T>,
+                  public std::enable_shared_from_this<Operation<T>>
 {
 public:
     // Safe us some typing
@@ -52,23 +74,124 @@ public:
     using typename Super::Error;
     using typename Super::Result;
 
+    /// @brief Completion is invoked with the outcome of an asynchronous call, an empty
+    /// exception_ptr indicates success.
+    typedef std::function<void(std::exception_ptr)> Completion;
+
     /// @brief create_for_object_and_service returns a new instance on the given object.
     static Ptr create_for_object_and_service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
 
+    /// @brief create_by_invoking invokes Method on object with args without waiting for the reply.
+    ///
+    /// Returns a pending instance that resolves to the object path handed back in the reply. If the
+    /// service rejects the request for exceeding the limits of the caller, the instance resolves to Busy.
+    template<typename Method, typename... Args>
+    static Ptr create_by_invoking(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const Args&... args);
+
+    /// @brief create_and_start_by_invoking invokes the fused Method on object with args and the path
+    /// of a freshly exported observer, creating and starting the remote operation in a single round-trip.
+    ///
+    /// Returns a pending instance that resolves to the object path handed back in the reply. then
+    /// is invoked once the remote side acknowledged.
+    template<typename Method, typename... Args>
+    static Ptr create_and_start_by_invoking(const core::dbus::Bus::Ptr& bus,
+                                            const core::dbus::Service::Ptr& service,
+                                            const core::dbus::Object::Ptr& object,
+                                            const typename Observer::Ptr& observer,
+                                            const Completion& then,
+                                            const Args&... args);
+
+    /// @brief create_deferred returns a deferred instance that does not contact the remote side yet.
+    ///
+    /// Starting the instance with an observer invokes the fused MethodAndStart on object with args,
+    /// creating and starting the remote operation in a single round-trip. Any other call that needs the
+    /// remote object invokes Method on object with args first.
+    template<typename Method, typename MethodAndStart, typename... Args>
+    static Ptr create_deferred(const core::dbus::Bus::Ptr& bus,
+                               const core::dbus::Service::Ptr& service,
+                               const core::dbus::Object::Ptr& object,
+                               const Args&... args);
+
     /// @brief Frees up resources and uninstall message handlers.
     ~Operation();
 
+    /// @brief wait_for_resolution blocks until the remote object is known, throwing if its creation failed.
+    ///
+    /// Must not be called from a thread that executes the bus.
+    void wait_for_resolution();
+
+    /// @brief start_with_observer_async starts the operation, invoking then once the remote side acknowledged.
+    void start_with_observer_async(const typename Observer::Ptr& observer, const Completion& then);
+
+    /// @brief start_with_observer_async starts the operation, returning a future that is satisfied once the remote side acknowledged.
+    std::future<void> start_with_observer_async(const typename Observer::Ptr& observer);
+
+    /// @brief start_with_observer_and_side_channel_async starts the operation, receiving large blobs in
+    /// progress details through side_channel, and invokes then once the remote side acknowledged.
+    void start_with_observer_and_side_channel_async(const typename Observer::Ptr& observer,
+                                                    const SideChannel::Ptr& side_channel,
+                                                    const Completion& then);
+
+    /// @brief start_with_observer_and_side_channel_async starts the operation, receiving large blobs in
+    /// progress details through side_channel, and returns a future that is satisfied once the remote side acknowledged.
+    std::future<void> start_with_observer_and_side_channel_async(const typename Observer::Ptr& observer,
+                                                                 const SideChannel::Ptr& side_channel);
+
+    /// @brief cancel_async cancels the operation, invoking then once the remote side acknowledged.
+    void cancel_async(const Completion& then);
+
+    /// @brief cancel_async cancels the operation, returning a future that is satisfied once the remote side acknowledged.
+    std::future<void> cancel_async();
+
     // From biometry::Operation<T>
     void start_with_observer(const typename Observer::Ptr& observer) override;
     void cancel() override;
 
 private:
+    /// @cond
+    typedef std::function<void(const core::dbus::Object::Ptr&, std::exception_ptr)> Continuation;
+    typedef std::function<void(const Ptr&, const typename Observer::Ptr&, const Completion&)> Request;
+
+    struct State
+    {
+        core::dbus::Object::Ptr object;
+        std::exception_ptr error;
+        std::vector<Continuation> continuations;
+        // Set as long as the remote operation has not been requested.
+        Request request;
+    };
+
+    /// @brief future_for returns a future satisfied by the Completion handed to f.
+    static std::future<void> future_for(const std::function<void(const Completion&)>& f);
+
     /// @brief Operation creates a new instance for the given remote service and object.
     Operation(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
 
+    /// @brief resolve hands the remote object or an error to all queued continuations.
+    void resolve(const core::dbus::Object::Ptr& object, std::exception_ptr error);
+
+    /// @brief when_resolved invokes continuation once the remote object is known.
+    void when_resolved(const Continuation& continuation);
+
+    /// @brief invoke invokes Method on object with args, resolving to the object path handed back in the reply.
+    template<typename Method, typename... Args>
+    void invoke(const core::dbus::Object::Ptr& object, const Args&... args);
+
+    /// @brief invoke_and_start invokes the fused Method on object with args and the path of a freshly
+    /// exported observer, resolving to the object path handed back in the reply.
+    template<typename Method, typename... Args>
+    void invoke_and_start(const core::dbus::Object::Ptr& object, const typename Observer::Ptr& observer, const Completion& then, const Args&... args);
+
+    /// @brief request_remote requests the remote operation of a deferred instance, starting it with
+    /// observer if observer is not null.
+    ///
+    /// Returns false if the remote operation has already been requested.
+    bool request_remote(const typename Observer::Ptr& observer, const Completion& then);
+
     core::dbus::Bus::Ptr bus;
     core::dbus::Service::Ptr service;
-    core::dbus::Object::Ptr object;
+    util::Synchronized<State> state;
+    /// @endcond
 };
 }
 }
@@ -84,39 +207,247 @@ typename biometry::dbus::stub::Operation<T>::Ptr biometry::dbus::stub::Operation
 }
 
 template<typename T>
-biometry::dbus::stub::Operation<T>::~Operation()
+template<typename Method, typename... Args>
+typename biometry::dbus::stub::Operation<T>::Ptr biometry::dbus::stub::Operation<T>::create_by_invoking(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object,
+        const Args&... args)
 {
+    Ptr result{new Operation<T>{bus, service, core::dbus::Object::Ptr{}}};
+    result->template invoke<Method>(object, args...);
+    return result;
 }
 
-// From biometry::Operation<T>
 template<typename T>
-void biometry::dbus::stub::Operation<T>::start_with_observer(const typename Observer::Ptr& observer)
+template<typename Method, typename... Args>
+typename biometry::dbus::stub::Operation<T>::Ptr biometry::dbus::stub::Operation<T>::create_and_start_by_invoking(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object,
+        const typename Observer::Ptr& observer,
+        const Completion& then,
+        const Args&... args)
 {
-    auto path = core::dbus::types::ObjectPath
+    Ptr result{new Operation<T>{bus, service, core::dbus::Object::Ptr{}}};
+    result->template invoke_and_start<Method>(object, observer, then, args...);
+    return result;
+}
+
+template<typename T>
+template<typename Method, typename MethodAndStart, typename... Args>
+typename biometry::dbus::stub::Operation<T>::Ptr biometry::dbus::stub::Operation<T>::create_deferred(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object,
+        const Args&... args)
+{
+    Ptr result{new Operation<T>{bus, service, core::dbus::Object::Ptr{}}};
+
+    Request request = [object, args...](const Ptr& self, const typename Observer::Ptr& observer, const Completion& then)
     {
-        (boost::format("%1%/observer") % object->path().as_string()).str()
+        if (observer)
+            self->template invoke_and_start<MethodAndStart>(object, observer, then, args...);
+        else
+            self->template invoke<Method>(object, args...);
     };
 
-    auto obs = biometry::dbus::skeleton::Observer<T>::create_for_object(bus, service->add_object_for_path(path), observer);
+    result->state.synchronized([&request](State& state)
+    {
+        state.request = request;
+    });
+
+    return result;
+}
+
+template<typename T>
+biometry::dbus::stub::Operation<T>::~Operation()
+{
+}
+
+template<typename T>
+void biometry::dbus::stub::Operation<T>::wait_for_resolution()
+{
+    future_for([this](const Completion& then)
+    {
+        when_resolved([then](const core::dbus::Object::Ptr&, std::exception_ptr error)
+        {
+            then(error);
+        });
+    }).get();
+}
+
+template<typename T>
+void biometry::dbus::stub::Operation<T>::start_with_observer_async(const typename Observer::Ptr& observer, const Completion& then)
+{
+    // A deferred instance is created and started in a single round-trip.
+    if (request_remote(observer, then))
+        return;
+
+    auto bus = this->bus; auto service = this->service;
+
+    when_resolved([bus, service, observer, then](const core::dbus::Object::Ptr& object, std::exception_ptr error)
+    {
+        if (error)
+        {
+            then(error);
+            return;
+        }
+
+        auto path = core::dbus::types::ObjectPath
+        {
+            (boost::format("%1%/observer") % object->path().as_string()).str()
+        };
 
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::Operation::Methods::StartWithObserver,
-            biometry::dbus::interface::Operation::Methods::StartWithObserver::ResultType
-    >(path);
+        auto obs = biometry::dbus::skeleton::Observer<T>::create_for_object(bus, service->add_object_for_path(path), observer);
 
-    if (result.is_error())
-        throw std::runtime_error{result.error().print()};
+        object->invoke_method_asynchronously_with_callback<
+                biometry::dbus::interface::Operation::Methods::StartWithObserver,
+                biometry::dbus::interface::Operation::Methods::StartWithObserver::ResultType
+        >([obs, then](const core::dbus::Result<void>& result)
+        {
+            // The remote side never reports to an observer it did not accept.
+            if (result.is_error())
+                obs->uninstall_method_handlers();
 
+            then(result.is_error() ? std::make_exception_ptr(std::runtime_error{result.error().print()}) : std::exception_ptr{});
+        }, path);
+    });
+}
 
+template<typename T>
+std::future<void> biometry::dbus::stub::Operation<T>::start_with_observer_async(const typename Observer::Ptr& observer)
+{
+    return future_for([this, observer](const Completion& then)
+    {
+        start_with_observer_async(observer, then);
+    });
+}
+
+template<typename T>
+void biometry::dbus::stub::Operation<T>::start_with_observer_and_side_channel_async(
+        const typename Observer::Ptr& observer,
+        const SideChannel::Ptr& side_channel,
+        const Completion& then)
+{
+    auto bus = this->bus; auto service = this->service;
+
+    when_resolved([bus, service, observer, side_channel, then](const core::dbus::Object::Ptr& object, std::exception_ptr error)
+    {
+        if (error)
+        {
+            then(error);
+            return;
+        }
+
+        auto path = core::dbus::types::ObjectPath
+        {
+            (boost::format("%1%/observer") % object->path().as_string()).str()
+        };
+
+        // The side channel is in place before the remote side is able to report any progress.
+        auto obs = biometry::dbus::skeleton::Observer<T>::create_for_object(bus, service->add_object_for_path(path), observer);
+        obs->use_side_channel(side_channel);
+
+        object->invoke_method_asynchronously_with_callback<
+                biometry::dbus::interface::Operation::Methods::StartWithObserverAndSideChannel,
+                biometry::dbus::interface::Operation::Methods::StartWithObserverAndSideChannel::ResultType
+        >([obs, then](const core::dbus::Result<void>& result)
+        {
+            // The remote side never reports to an observer it did not accept.
+            if (result.is_error())
+                obs->uninstall_method_handlers();
+
+            then(result.is_error() ? std::make_exception_ptr(std::runtime_error{result.error().print()}) : std::exception_ptr{});
+        }, path, core::dbus::types::UnixFd{side_channel->fd()});
+    });
+}
+
+template<typename T>
+std::future<void> biometry::dbus::stub::Operation<T>::start_with_observer_and_side_channel_async(
+        const typename Observer::Ptr& observer,
+        const SideChannel::Ptr& side_channel)
+{
+    return future_for([this, observer, side_channel](const Completion& then)
+    {
+        start_with_observer_and_side_channel_async(observer, side_channel, then);
+    });
+}
+
+template<typename T>
+void biometry::dbus::stub::Operation<T>::cancel_async(const Completion& then)
+{
+    Request request;
+
+    state.synchronized([&request](State& state)
+    {
+        std::swap(request, state.request);
+    });
+
+    // There is nothing to cancel remotely if the remote operation has never been requested.
+    if (request)
+    {
+        resolve(core::dbus::Object::Ptr{}, std::make_exception_ptr(std::runtime_error{"Operation has been cancelled"}));
+        then(std::exception_ptr{});
+        return;
+    }
+
+    when_resolved([then](const core::dbus::Object::Ptr& object, std::exception_ptr error)
+    {
+        if (error)
+        {
+            then(error);
+            return;
+        }
+
+        object->invoke_method_asynchronously_with_callback<
+                biometry::dbus::interface::Operation::Methods::Cancel,
+                biometry::dbus::interface::Operation::Methods::Cancel::ResultType
+        >([then](const core::dbus::Result<void>& result)
+        {
+            then(result.is_error() ? std::make_exception_ptr(std::runtime_error{result.error().print()}) : std::exception_ptr{});
+        });
+    });
+}
+
+template<typename T>
+std::future<void> biometry::dbus::stub::Operation<T>::cancel_async()
+{
+    return future_for([this](const Completion& then)
+    {
+        cancel_async(then);
+    });
+}
+
+// From biometry::Operation<T>
+template<typename T>
+void biometry::dbus::stub::Operation<T>::start_with_observer(const typename Observer::Ptr& observer)
+{
+    start_with_observer_async(observer).get();
 }
 
 template<typename T>
 void biometry::dbus::stub::Operation<T>::cancel()
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::Operation::Methods::Cancel,
-            biometry::dbus::interface::Operation::Methods::Cancel::ResultType
-    >();
+    // Errors during cancellation are not reported to calling code.
+    cancel_async().wait();
+}
+
+template<typename T>
+std::future<void> biometry::dbus::stub::Operation<T>::future_for(const std::function<void(const Completion&)>& f)
+{
+    auto promise = std::make_shared<std::promise<void>>();
+    auto future = promise->get_future();
+
+    f([promise](std::exception_ptr error)
+    {
+        if (error)
+            promise->set_exception(error);
+        else
+            promise->set_value();
+    });
+
+    return future;
 }
 
 template<typename T>
@@ -126,8 +457,116 @@ biometry::dbus::stub::Operation<T>::Operation(
         const core::dbus::Object::Ptr& object)
     : bus{bus},
       service{service},
-      object{object}
+      state{State{object, std::exception_ptr{}, {}, {}}}
 {
 }
 
+template<typename T>
+void biometry::dbus::stub::Operation<T>::resolve(const core::dbus::Object::Ptr& object, std::exception_ptr error)
+{
+    std::vector<Continuation> continuations;
+
+    state.synchronized([&object, &error, &continuations](State& state)
+    {
+        state.object = object;
+        state.error = error;
+        std::swap(continuations, state.continuations);
+    });
+
+    for (const auto& continuation : continuations)
+        continuation(object, error);
+}
+
+template<typename T>
+void biometry::dbus::stub::Operation<T>::when_resolved(const Continuation& continuation)
+{
+    core::dbus::Object::Ptr object; std::exception_ptr error;
+
+    state.synchronized([&object, &error, &continuation](State& state)
+    {
+        if (not state.object && not state.error)
+            state.continuations.push_back(continuation);
+
+        object = state.object;
+        error = state.error;
+    });
+
+    if (object || error)
+        continuation(object, error);
+    else
+        request_remote(typename Observer::Ptr{}, Completion{});
+}
+
+template<typename T>
+template<typename Method, typename... Args>
+void biometry::dbus::stub::Operation<T>::invoke(const core::dbus::Object::Ptr& object, const Args&... args)
+{
+    auto thiz = this->shared_from_this(); auto service = this->service;
+
+    // We keep the pending operation alive until the reply arrived.
+    object->invoke_method_asynchronously_with_callback<Method, typename Method::ResultType>([thiz, service](const core::dbus::Result<typename Method::ResultType>& reply)
+    {
+        if (reply.is_error())
+            thiz->resolve(core::dbus::Object::Ptr{}, exception_for(reply.error()));
+        else
+            thiz->resolve(service->object_for_path(reply.value()), std::exception_ptr{});
+    }, args...);
+}
+
+template<typename T>
+template<typename Method, typename... Args>
+void biometry::dbus::stub::Operation<T>::invoke_and_start(
+        const core::dbus::Object::Ptr& object,
+        const typename Observer::Ptr& observer,
+        const Completion& then,
+        const Args&... args)
+{
+    auto thiz = this->shared_from_this(); auto service = this->service;
+
+    // The path of the remote operation is not known yet, and we thus pick the observer's path up front.
+    auto path = core::dbus::types::ObjectPath
+    {
+        (boost::format("%1%/observer/%2%") % object->path().as_string() % util::counter<Operation<T>>().increment()).str()
+    };
+
+    auto obs = biometry::dbus::skeleton::Observer<T>::create_for_object(bus, service->add_object_for_path(path), observer);
+
+    object->invoke_method_asynchronously_with_callback<Method, typename Method::ResultType>([thiz, service, obs, then](const core::dbus::Result<typename Method::ResultType>& reply)
+    {
+        std::exception_ptr error;
+
+        if (reply.is_error())
+        {
+            // The remote side never reports to an observer it did not accept.
+            obs->uninstall_method_handlers();
+
+            error = exception_for(reply.error());
+            thiz->resolve(core::dbus::Object::Ptr{}, error);
+        }
+        else
+        {
+            thiz->resolve(service->object_for_path(reply.value()), error);
+        }
+
+        if (then) then(error);
+    }, args..., path);
+}
+
+template<typename T>
+bool biometry::dbus::stub::Operation<T>::request_remote(const typename Observer::Ptr& observer, const Completion& then)
+{
+    Request request;
+
+    state.synchronized([&request](State& state)
+    {
+        std::swap(request, state.request);
+    });
+
+    if (not request)
+        return false;
+
+    request(this->shared_from_this(), observer, then);
+    return true;
+}
+
 #endif // BIOMETRYD_DBUS_STUB_OPERATION_H_
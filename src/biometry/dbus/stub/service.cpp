@@ -22,30 +22,87 @@
 #include <biometry/dbus/interface.h>
 #include <biometry/dbus/stub/device.h>
 
+#include <stdexcept>
+
 biometry::dbus::stub::Service::Ptr biometry::dbus::stub::Service::create_for_bus(const core::dbus::Bus::Ptr& bus)
 {
     auto service = core::dbus::Service::use_service(bus, biometry::dbus::interface::Service::name());
     auto object = service->object_for_path(biometry::dbus::interface::Service::path());
-    return Ptr{new Service{bus, service, object}};
+    return Ptr{new Service{bus, service, object, ClientConnection::Ptr{}}};
 }
 
-// From biometry::Service.
-std::shared_ptr<biometry::Device> biometry::dbus::stub::Service::default_device() const
+biometry::dbus::stub::Service::Ptr biometry::dbus::stub::Service::create_for_connection(const ClientConnection::Ptr& connection)
+{
+    auto object = connection->object_for_path(biometry::dbus::interface::Service::path());
+    return Ptr{new Service{connection->bus(), connection->service(), object, connection}};
+}
+
+void biometry::dbus::stub::Service::default_device_async(const DefaultDeviceCompletion& then) const
 {
-    auto result = object->invoke_method_synchronously<
+    auto bus = this->bus; auto service = this->service; auto connection = this->connection;
+
+    root()->invoke_method_asynchronously_with_callback<
             biometry::dbus::interface::Service::Methods::DefaultDevice,
             biometry::dbus::interface::Service::Methods::DefaultDevice::ResultType
+    >([bus, service, connection, then](const core::dbus::Result<biometry::dbus::interface::Service::Methods::DefaultDevice::ResultType>& result)
+    {
+        if (result.is_error())
+        {
+            then(std::shared_ptr<biometry::Device>{}, std::make_exception_ptr(std::runtime_error{result.error().print()}));
+            return;
+        }
+
+        auto object = connection ? connection->object_for_path(result.value()) : service->object_for_path(result.value());
+        then(std::make_shared<biometry::dbus::stub::Device>(bus, service, object, connection), std::exception_ptr{});
+    });
+}
+
+std::future<std::shared_ptr<biometry::Device>> biometry::dbus::stub::Service::default_device_async() const
+{
+    auto promise = std::make_shared<std::promise<std::shared_ptr<biometry::Device>>>();
+    auto future = promise->get_future();
+
+    default_device_async([promise](const std::shared_ptr<biometry::Device>& device, std::exception_ptr error)
+    {
+        if (error)
+            promise->set_exception(error);
+        else
+            promise->set_value(device);
+    });
+
+    return future;
+}
+
+bool biometry::dbus::stub::Service::is_ready() const
+{
+    auto result = root()->invoke_method_synchronously<
+            biometry::dbus::interface::Service::Methods::IsReady,
+            biometry::dbus::interface::Service::Methods::IsReady::ResultType
     >();
 
     if (result.is_error())
         throw std::runtime_error{result.error().print()};
 
-    return std::make_shared<biometry::dbus::stub::Device>(bus, service, service->object_for_path(result.value()));
+    return result.value();
+}
+
+// From biometry::Service.
+std::shared_ptr<biometry::Device> biometry::dbus::stub::Service::default_device() const
+{
+    return default_device_async().get();
 }
 
-biometry::dbus::stub::Service::Service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object)
-    : bus{bus},
+biometry::dbus::stub::Service::Service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const ClientConnection::Ptr& connection)
+    : connection{connection},
+      bus{bus},
       service{service},
       object{object}
 {
 }
+
+core::dbus::Object::Ptr biometry::dbus::stub::Service::root() const
+{
+    // Objects cached by the connection are dropped whenever the daemon restarts, we thus
+    // always ask the connection instead of holding on to the object we were created with.
+    return connection ? connection->object_for_path(biometry::dbus::interface::Service::path()) : object;
+}
@@ -23,9 +23,15 @@
 #include <biometry/service.h>
 #include <biometry/visibility.h>
 
+#include <biometry/dbus/client_connection.h>
+
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
 
+#include <exception>
+#include <functional>
+#include <future>
+
 namespace biometry
 {
 namespace dbus
@@ -43,15 +49,41 @@ public:
     // Safe us some typing.
     typedef std::shared_ptr<Service> Ptr;
 
+    /// @brief DefaultDeviceCompletion is invoked with the default device or with the error that occurred.
+    typedef std::function<void(const std::shared_ptr<biometry::Device>&, std::exception_ptr)> DefaultDeviceCompletion;
+
     /// @brief create_for_bus creates a new instance connecting to bus, forwarding incoming calls to impl.
     static Ptr create_for_bus(const core::dbus::Bus::Ptr& bus);
 
+    /// @brief create_for_connection creates a new instance sharing connection with other stubs.
+    ///
+    /// Remote objects are looked up via connection, and devices handed out by the instance keep connection alive.
+    static Ptr create_for_connection(const ClientConnection::Ptr& connection);
+
+    /// @brief default_device_async queries the default device without waiting for the reply, invoking then on completion.
+    void default_device_async(const DefaultDeviceCompletion& then) const;
+
+    /// @brief default_device_async queries the default device without waiting for the reply.
+    ///
+    /// The returned future must not be waited upon from a thread that executes the bus.
+    std::future<std::shared_ptr<biometry::Device>> default_device_async() const;
+
+    /// @brief is_ready returns true if the daemon has instantiated its default device.
+    ///
+    /// Requests issued before the daemon is ready are parked and served once the device is available.
+    /// @throws std::runtime_error in case of issues.
+    bool is_ready() const;
+
     // From biometry::Service.
     std::shared_ptr<biometry::Device> default_device() const override;
 
 private:
-    Service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
+    Service(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object, const ClientConnection::Ptr& connection);
+
+    /// @brief root returns the object implementing com.ubuntu.biometryd.Service.
+    core::dbus::Object::Ptr root() const;
 
+    ClientConnection::Ptr connection;
     core::dbus::Bus::Ptr bus;
     core::dbus::Service::Ptr service;
     core::dbus::Object::Ptr object;
@@ -34,54 +34,100 @@ biometry::dbus::stub::TemplateStore::Ptr biometry::dbus::stub::TemplateStore::cr
     return Ptr{new TemplateStore{bus, service, object}};
 }
 
+biometry::dbus::stub::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::dbus::stub::TemplateStore::size_async(const biometry::Application& app, const biometry::User& user)
+{
+    return Operation<SizeQuery>::create_by_invoking<biometry::dbus::interface::TemplateStore::Methods::Size>(bus, service, object, app, user);
+}
+
 biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::dbus::stub::TemplateStore::size(const biometry::Application& app, const biometry::User& user)
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::TemplateStore::Methods::Size,
-            biometry::dbus::interface::TemplateStore::Methods::Size::ResultType
-    >(app, user);
+    // The remote operation is created together with starting it, in a single round-trip.
+    return Operation<SizeQuery>::create_deferred<biometry::dbus::interface::TemplateStore::Methods::Size,
+                                                 biometry::dbus::interface::TemplateStore::Methods::SizeAndStart>(bus, service, object, app, user);
+}
 
-    return Operation<SizeQuery>::create_for_object_and_service(bus, service, service->object_for_path(result.value()));
+biometry::dbus::stub::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::dbus::stub::TemplateStore::size_and_start_async(
+        const biometry::Application& app, const biometry::User& user,
+        const biometry::Operation<SizeQuery>::Observer::Ptr& observer,
+        const Operation<SizeQuery>::Completion& then)
+{
+    return Operation<SizeQuery>::create_and_start_by_invoking<biometry::dbus::interface::TemplateStore::Methods::SizeAndStart>(bus, service, object, observer, then, app, user);
+}
+
+biometry::dbus::stub::Operation<biometry::TemplateStore::List>::Ptr biometry::dbus::stub::TemplateStore::list_async(const biometry::Application& app, const biometry::User& user)
+{
+    return Operation<List>::create_by_invoking<biometry::dbus::interface::TemplateStore::Methods::List>(bus, service, object, app, user);
 }
 
 biometry::Operation<biometry::TemplateStore::List>::Ptr biometry::dbus::stub::TemplateStore::list(const biometry::Application& app, const biometry::User& user)
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::TemplateStore::Methods::List,
-            biometry::dbus::interface::TemplateStore::Methods::List::ResultType
-    >(app, user);
+    return Operation<List>::create_deferred<biometry::dbus::interface::TemplateStore::Methods::List,
+                                            biometry::dbus::interface::TemplateStore::Methods::ListAndStart>(bus, service, object, app, user);
+}
+
+biometry::dbus::stub::Operation<biometry::TemplateStore::List>::Ptr biometry::dbus::stub::TemplateStore::list_and_start_async(
+        const biometry::Application& app, const biometry::User& user,
+        const biometry::Operation<List>::Observer::Ptr& observer,
+        const Operation<List>::Completion& then)
+{
+    return Operation<List>::create_and_start_by_invoking<biometry::dbus::interface::TemplateStore::Methods::ListAndStart>(bus, service, object, observer, then, app, user);
+}
 
-    return Operation<List>::create_for_object_and_service(bus, service, service->object_for_path(result.value()));
+biometry::dbus::stub::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::dbus::stub::TemplateStore::enroll_async(const biometry::Application& app, const biometry::User& user)
+{
+    return Operation<Enrollment>::create_by_invoking<biometry::dbus::interface::TemplateStore::Methods::Enroll>(bus, service, object, app, user);
 }
 
 biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::dbus::stub::TemplateStore::enroll(const biometry::Application& app, const biometry::User& user)
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::TemplateStore::Methods::Enroll,
-            biometry::dbus::interface::TemplateStore::Methods::Enroll::ResultType
-    >(app, user);
+    return Operation<Enrollment>::create_deferred<biometry::dbus::interface::TemplateStore::Methods::Enroll,
+                                                  biometry::dbus::interface::TemplateStore::Methods::EnrollAndStart>(bus, service, object, app, user);
+}
+
+biometry::dbus::stub::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::dbus::stub::TemplateStore::enroll_and_start_async(
+        const biometry::Application& app, const biometry::User& user,
+        const biometry::Operation<Enrollment>::Observer::Ptr& observer,
+        const Operation<Enrollment>::Completion& then)
+{
+    return Operation<Enrollment>::create_and_start_by_invoking<biometry::dbus::interface::TemplateStore::Methods::EnrollAndStart>(bus, service, object, observer, then, app, user);
+}
 
-    return Operation<Enrollment>::create_for_object_and_service(bus, service, service->object_for_path(result.value()));
+biometry::dbus::stub::Operation<biometry::TemplateStore::Removal>::Ptr biometry::dbus::stub::TemplateStore::remove_async(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id)
+{
+    return Operation<Removal>::create_by_invoking<biometry::dbus::interface::TemplateStore::Methods::Remove>(bus, service, object, app, user, id);
 }
 
 biometry::Operation<biometry::TemplateStore::Removal>::Ptr biometry::dbus::stub::TemplateStore::remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id)
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::TemplateStore::Methods::Remove,
-            biometry::dbus::interface::TemplateStore::Methods::Remove::ResultType
-    >(app, user, id);
+    return Operation<Removal>::create_deferred<biometry::dbus::interface::TemplateStore::Methods::Remove,
+                                               biometry::dbus::interface::TemplateStore::Methods::RemoveAndStart>(bus, service, object, app, user, id);
+}
+
+biometry::dbus::stub::Operation<biometry::TemplateStore::Removal>::Ptr biometry::dbus::stub::TemplateStore::remove_and_start_async(
+        const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id,
+        const biometry::Operation<Removal>::Observer::Ptr& observer,
+        const Operation<Removal>::Completion& then)
+{
+    return Operation<Removal>::create_and_start_by_invoking<biometry::dbus::interface::TemplateStore::Methods::RemoveAndStart>(bus, service, object, observer, then, app, user, id);
+}
 
-    return Operation<Removal>::create_for_object_and_service(bus, service, service->object_for_path(result.value()));
+biometry::dbus::stub::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::dbus::stub::TemplateStore::clear_async(const biometry::Application& app, const biometry::User& user)
+{
+    return Operation<Clearance>::create_by_invoking<biometry::dbus::interface::TemplateStore::Methods::Clear>(bus, service, object, app, user);
 }
 
 biometry::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::dbus::stub::TemplateStore::clear(const biometry::Application& app, const biometry::User& user)
 {
-    auto result = object->invoke_method_synchronously<
-            biometry::dbus::interface::TemplateStore::Methods::Clear,
-            biometry::dbus::interface::TemplateStore::Methods::Clear::ResultType
-    >(app, user);
+    return Operation<Clearance>::create_deferred<biometry::dbus::interface::TemplateStore::Methods::Clear,
+                                                 biometry::dbus::interface::TemplateStore::Methods::ClearAndStart>(bus, service, object, app, user);
+}
 
-    return Operation<Clearance>::create_for_object_and_service(bus, service, service->object_for_path(result.value()));
+biometry::dbus::stub::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::dbus::stub::TemplateStore::clear_and_start_async(
+        const biometry::Application& app, const biometry::User& user,
+        const biometry::Operation<Clearance>::Observer::Ptr& observer,
+        const Operation<Clearance>::Completion& then)
+{
+    return Operation<Clearance>::create_and_start_by_invoking<biometry::dbus::interface::TemplateStore::Methods::ClearAndStart>(bus, service, object, observer, then, app, user);
 }
 
 biometry::dbus::stub::TemplateStore::TemplateStore(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object)
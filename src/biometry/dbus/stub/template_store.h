@@ -21,6 +21,9 @@
 #define BIOMETRYD_DBUS_STUB_TEMPLATE_STORE_H_
 
 #include <biometry/template_store.h>
+#include <biometry/visibility.h>
+
+#include <biometry/dbus/stub/operation.h>
 
 #include <core/dbus/object.h>
 #include <core/dbus/service.h>
@@ -32,7 +35,10 @@ namespace dbus
 namespace stub
 {
 // TemplateStore is the dbus stub implementation of biometry::TemplateStore.
-class TemplateStore : public biometry::TemplateStore
+//
+// Operations handed out through the generic interface are deferred and only
+// created remotely when started, in a single round-trip.
+class BIOMETRY_DLL_PUBLIC TemplateStore : public biometry::TemplateStore
 {
 public:
     // Safe us some typing.
@@ -41,13 +47,53 @@ public:
     /// @brief create_for_bus creates a new instance on the given service and object.
     static Ptr create_for_service_and_object(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
 
+    /// @brief size_async requests a new size query without waiting for the reply.
+    stub::Operation<SizeQuery>::Ptr size_async(const Application& app, const User& user);
+
+    /// @brief list_async requests a new list operation without waiting for the reply.
+    stub::Operation<List>::Ptr list_async(const Application& app, const User& user);
+
+    /// @brief enroll_async requests a new enrollment without waiting for the reply.
+    stub::Operation<Enrollment>::Ptr enroll_async(const Application& app, const User& user);
+
+    /// @brief remove_async requests a new removal without waiting for the reply.
+    stub::Operation<Removal>::Ptr remove_async(const Application& app, const User& user, TemplateStore::TemplateId id);
+
+    /// @brief clear_async requests a new clearance without waiting for the reply.
+    stub::Operation<Clearance>::Ptr clear_async(const Application& app, const User& user);
+
+    /// @brief size_and_start_async requests a new size query and starts it with observer in a single round-trip.
+    stub::Operation<SizeQuery>::Ptr size_and_start_async(const Application& app, const User& user,
+                                                         const Operation<SizeQuery>::Observer::Ptr& observer,
+                                                         const stub::Operation<SizeQuery>::Completion& then);
+
+    /// @brief list_and_start_async requests a new list operation and starts it with observer in a single round-trip.
+    stub::Operation<List>::Ptr list_and_start_async(const Application& app, const User& user,
+                                                    const Operation<List>::Observer::Ptr& observer,
+                                                    const stub::Operation<List>::Completion& then);
+
+    /// @brief enroll_and_start_async requests a new enrollment and starts it with observer in a single round-trip.
+    stub::Operation<Enrollment>::Ptr enroll_and_start_async(const Application& app, const User& user,
+                                                            const Operation<Enrollment>::Observer::Ptr& observer,
+                                                            const stub::Operation<Enrollment>::Completion& then);
+
+    /// @brief remove_and_start_async requests a new removal and starts it with observer in a single round-trip.
+    stub::Operation<Removal>::Ptr remove_and_start_async(const Application& app, const User& user, TemplateStore::TemplateId id,
+                                                         const Operation<Removal>::Observer::Ptr& observer,
+                                                         const stub::Operation<Removal>::Completion& then);
+
+    /// @brief clear_and_start_async requests a new clearance and starts it with observer in a single round-trip.
+    stub::Operation<Clearance>::Ptr clear_and_start_async(const Application& app, const User& user,
+                                                          const Operation<Clearance>::Observer::Ptr& observer,
+                                                          const stub::Operation<Clearance>::Completion& then);
+
     // From biometry::Identifier.
     // biometry::Operation<biometry::TemplateStore::Enrollment>
-    Operation<SizeQuery>::Ptr size(const Application&, const User&) override;
-    Operation<TemplateStore::List>::Ptr list(const Application& app, const User& user) override;
-    Operation<Enrollment>::Ptr enroll(const Application&, const User&) override;
-    Operation<TemplateStore::Removal>::Ptr remove(const Application& app, const User& user, TemplateStore::TemplateId id) override;
-    Operation<Clearance>::Ptr clear(const Application&, const User&) override;
+    biometry::Operation<SizeQuery>::Ptr size(const Application&, const User&) override;
+    biometry::Operation<TemplateStore::List>::Ptr list(const Application& app, const User& user) override;
+    biometry::Operation<Enrollment>::Ptr enroll(const Application&, const User&) override;
+    biometry::Operation<TemplateStore::Removal>::Ptr remove(const Application& app, const User& user, TemplateStore::TemplateId id) override;
+    biometry::Operation<Clearance>::Ptr clear(const Application&, const User&) override;
 
 private:
     /// @brief TemplateStore creates a new instance for the given remote service and object.
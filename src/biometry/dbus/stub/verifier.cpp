@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/stub/verifier.h>
+
+#include <biometry/dbus/codec.h>
+#include <biometry/dbus/interface.h>
+#include <biometry/dbus/stub/operation.h>
+
+biometry::dbus::stub::Verifier::Ptr biometry::dbus::stub::Verifier::create_for_service_and_object(
+        const core::dbus::Bus::Ptr& bus,
+        const core::dbus::Service::Ptr& service,
+        const core::dbus::Object::Ptr& object)
+{
+    return Ptr{new Verifier{bus, service, object}};
+}
+
+biometry::dbus::stub::Operation<biometry::Verification>::Ptr biometry::dbus::stub::Verifier::verify_user_async(const Application& app, const User& user, const Reason& reason)
+{
+    return Operation<Verification>::create_by_invoking<biometry::dbus::interface::Verifier::Methods::VerifyUser>(bus, service, object, app, user, reason);
+}
+
+biometry::Operation<biometry::Verification>::Ptr biometry::dbus::stub::Verifier::verify_user(const Application& app, const User& user, const Reason& reason)
+{
+    // The remote operation is created together with starting it, in a single round-trip.
+    return Operation<Verification>::create_deferred<biometry::dbus::interface::Verifier::Methods::VerifyUser,
+                                                    biometry::dbus::interface::Verifier::Methods::VerifyUserAndStart>(bus, service, object, app, user, reason);
+}
+
+biometry::dbus::stub::Operation<biometry::Verification>::Ptr biometry::dbus::stub::Verifier::verify_user_and_start_async(
+        const Application& app, const User& user, const Reason& reason,
+        const biometry::Operation<Verification>::Observer::Ptr& observer,
+        const Operation<Verification>::Completion& then)
+{
+    return Operation<Verification>::create_and_start_by_invoking<biometry::dbus::interface::Verifier::Methods::VerifyUserAndStart>(bus, service, object, observer, then, app, user, reason);
+}
+
+biometry::dbus::stub::Verifier::Verifier(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object)
+    : bus{bus},
+      service{service},
+      object{object}
+{
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DBUS_STUB_VERIFIER_H_
+#define BIOMETRYD_DBUS_STUB_VERIFIER_H_
+
+#include <biometry/verifier.h>
+#include <biometry/visibility.h>
+
+#include <biometry/dbus/stub/operation.h>
+
+#include <core/dbus/object.h>
+#include <core/dbus/service.h>
+
+namespace biometry
+{
+namespace dbus
+{
+namespace stub
+{
+// Verifier is the dbus stub implementation of biometry::Verifier.
+//
+// Operations handed out through the generic interface are deferred and only
+// created remotely when started, in a single round-trip.
+class BIOMETRY_DLL_PUBLIC Verifier : public biometry::Verifier
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Verifier> Ptr;
+
+    /// @brief create_for_bus creates a new instance connecting to bus, forwarding incoming calls to impl.
+    static Ptr create_for_service_and_object(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
+
+    /// @brief verify_user_async requests a new verification without waiting for the reply.
+    stub::Operation<Verification>::Ptr verify_user_async(const Application& app, const User& user, const Reason& reason);
+
+    /// @brief verify_user_and_start_async requests a new verification and starts it with observer in a single round-trip.
+    stub::Operation<Verification>::Ptr verify_user_and_start_async(const Application& app, const User& user, const Reason& reason,
+                                                                   const Operation<Verification>::Observer::Ptr& observer,
+                                                                   const stub::Operation<Verification>::Completion& then);
+
+    // From biometry::Verifier.
+    biometry::Operation<Verification>::Ptr verify_user(const Application& app, const User& user, const Reason& reason) override;
+
+private:
+    /// @brief Verifier creates a new instance for the given remote service and object.
+    Verifier(const core::dbus::Bus::Ptr& bus, const core::dbus::Service::Ptr& service, const core::dbus::Object::Ptr& object);
+
+    core::dbus::Bus::Ptr bus;
+    core::dbus::Service::Ptr service;
+    core::dbus::Object::Ptr object;
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DBUS_STUB_VERIFIER_H_
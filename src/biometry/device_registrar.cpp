@@ -22,6 +22,7 @@
 #include <biometry/device_registry.h>
 
 #include <biometry/devices/dummy.h>
+#include <biometry/devices/simulated.h>
 #include <biometry/devices/plugin/device.h>
 #include <biometry/devices/plugin/enumerator.h>
 
@@ -30,6 +31,7 @@ namespace plugin = biometry::devices::plugin;
 biometry::DeviceRegistrar::DeviceRegistrar(const biometry::devices::plugin::Enumerator& enumerator)
 {
     biometry::device_registry()[biometry::devices::Dummy::id] = biometry::devices::Dummy::make_descriptor();
+    biometry::device_registry()[biometry::devices::Simulated::id] = biometry::devices::Simulated::make_descriptor();
     biometry::device_registry()[biometry::devices::plugin::id] = biometry::devices::plugin::make_descriptor();
 
     enumerator.enumerate([](const biometry::Device::Descriptor::Ptr& desc)
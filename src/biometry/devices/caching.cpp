@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/caching.h>
+
+#include <biometry/operation.h>
+
+#include <biometry/util/metrics.h>
+
+#include <functional>
+#include <stdexcept>
+
+namespace
+{
+biometry::util::Metrics::Counter& hits()
+{
+    static auto& instance = biometry::util::metrics().counter("template_cache.hits");
+    return instance;
+}
+
+biometry::util::Metrics::Counter& misses()
+{
+    static auto& instance = biometry::util::metrics().counter("template_cache.misses");
+    return instance;
+}
+
+biometry::util::Metrics::Counter& errors()
+{
+    static auto& instance = biometry::util::metrics().counter("template_cache.errors");
+    return instance;
+}
+
+// best_effort invokes f, swallowing all errors. The cache is an optimization, and
+// failing to access it must not fail an operation.
+template<typename F>
+void best_effort(F f)
+{
+    try
+    {
+        f();
+    }
+    catch (const std::exception&)
+    {
+        errors().increment();
+    }
+}
+
+// CachedOperation reports result from the cache without involving the actual device.
+template<typename T>
+class CachedOperation : public biometry::Operation<T>
+{
+public:
+    CachedOperation(const typename T::Result& result) : result{result}
+    {
+    }
+
+    void start_with_observer(const typename biometry::Operation<T>::Observer::Ptr& observer) override
+    {
+        observer->on_started();
+        observer->on_succeeded(result);
+    }
+
+    void cancel() override
+    {
+        // Empty on purpose, we complete immediately.
+    }
+
+private:
+    typename T::Result result;
+};
+
+// SucceedingObserver forwards all events to impl, invoking then before reporting success.
+template<typename T>
+class SucceedingObserver : public biometry::Operation<T>::Observer
+{
+public:
+    // Safe us some typing.
+    typedef typename biometry::Operation<T>::Observer Super;
+    typedef std::function<void(const typename Super::Result&)> Then;
+
+    SucceedingObserver(const typename Super::Ptr& impl, const Then& then) : impl{impl}, then{then}
+    {
+    }
+
+    void on_started() override
+    {
+        if (impl) impl->on_started();
+    }
+
+    void on_progress(const typename Super::Progress& progress) override
+    {
+        if (impl) impl->on_progress(progress);
+    }
+
+    void on_canceled(const typename Super::Reason& reason) override
+    {
+        if (impl) impl->on_canceled(reason);
+    }
+
+    void on_failed(const typename Super::Error& error) override
+    {
+        if (impl) impl->on_failed(error);
+    }
+
+    void on_succeeded(const typename Super::Result& result) override
+    {
+        auto t = then;
+        best_effort([&t, &result]() { t(result); });
+
+        if (impl) impl->on_succeeded(result);
+    }
+
+private:
+    typename Super::Ptr impl;
+    Then then;
+};
+
+// ObservedOperation forwards to impl, invoking then when impl succeeds.
+template<typename T>
+class ObservedOperation : public biometry::Operation<T>
+{
+public:
+    ObservedOperation(const typename biometry::Operation<T>::Ptr& impl, const typename SucceedingObserver<T>::Then& then)
+        : impl{impl},
+          then{then}
+    {
+    }
+
+    void start_with_observer(const typename biometry::Operation<T>::Observer::Ptr& observer) override
+    {
+        impl->start_with_observer(std::make_shared<SucceedingObserver<T>>(observer, then));
+    }
+
+    void cancel() override
+    {
+        impl->cancel();
+    }
+
+private:
+    typename biometry::Operation<T>::Ptr impl;
+    typename SucceedingObserver<T>::Then then;
+};
+}
+
+biometry::devices::Caching::TemplateStore::TemplateStore(const std::shared_ptr<biometry::Device>& impl, const TemplateCache::Ptr& cache)
+    : impl{impl},
+      cache{cache}
+{
+}
+
+biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::devices::Caching::TemplateStore::size(const biometry::Application& app, const biometry::User& user)
+{
+    Optional<std::uint32_t> size;
+    best_effort([this, &size, &app, &user]() { size = cache->size(app, user); });
+
+    if (size)
+    {
+        hits().increment();
+        return std::make_shared<CachedOperation<biometry::TemplateStore::SizeQuery>>(*size);
+    }
+
+    misses().increment();
+
+    auto c = cache;
+    return std::make_shared<ObservedOperation<biometry::TemplateStore::SizeQuery>>(impl->template_store().size(app, user), [c, app, user](std::uint32_t size)
+    {
+        c->store_size(app, user, size);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::List>::Ptr biometry::devices::Caching::TemplateStore::list(const biometry::Application& app, const biometry::User& user)
+{
+    Optional<std::vector<biometry::TemplateStore::TemplateId>> ids;
+    best_effort([this, &ids, &app, &user]() { ids = cache->list(app, user); });
+
+    if (ids)
+    {
+        hits().increment();
+        return std::make_shared<CachedOperation<biometry::TemplateStore::List>>(*ids);
+    }
+
+    misses().increment();
+
+    auto c = cache;
+    return std::make_shared<ObservedOperation<biometry::TemplateStore::List>>(impl->template_store().list(app, user), [c, app, user](const std::vector<biometry::TemplateStore::TemplateId>& ids)
+    {
+        c->store_list(app, user, ids);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::devices::Caching::TemplateStore::enroll(const biometry::Application& app, const biometry::User& user)
+{
+    auto c = cache;
+    return std::make_shared<ObservedOperation<biometry::TemplateStore::Enrollment>>(impl->template_store().enroll(app, user), [c, app, user](biometry::TemplateStore::TemplateId id)
+    {
+        c->enrolled(app, user, id);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Removal>::Ptr biometry::devices::Caching::TemplateStore::remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id)
+{
+    auto c = cache;
+    return std::make_shared<ObservedOperation<biometry::TemplateStore::Removal>>(impl->template_store().remove(app, user, id), [c, app, user](biometry::TemplateStore::TemplateId id)
+    {
+        c->removed(app, user, id);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::devices::Caching::TemplateStore::clear(const biometry::Application& app, const biometry::User& user)
+{
+    auto c = cache;
+    return std::make_shared<ObservedOperation<biometry::TemplateStore::Clearance>>(impl->template_store().clear(app, user), [c, app, user](const biometry::Void&)
+    {
+        c->store_list(app, user, std::vector<biometry::TemplateStore::TemplateId>{});
+    });
+}
+
+biometry::devices::Caching::Caching(const std::shared_ptr<biometry::Device>& device, const TemplateCache::Ptr& cache)
+    : impl{device},
+      cache{cache},
+      template_store_{device, cache}
+{
+    if (not impl)
+        throw std::runtime_error{"Missing device implementation"};
+    if (not cache)
+        throw std::runtime_error{"Missing template cache"};
+}
+
+void biometry::devices::Caching::resync()
+{
+    std::vector<TemplateCache::Key> keys;
+    best_effort([this, &keys]() { keys = cache->keys(); });
+
+    std::vector<biometry::Operation<biometry::TemplateStore::List>::Ptr> ops;
+    for (const auto& key : keys)
+    {
+        best_effort([this, &key]() { cache->invalidate(key.first, key.second); });
+
+        // We go through our own template store, which records the result on success.
+        auto op = template_store_.list(key.first, key.second);
+        op->start_with_observer(std::make_shared<SucceedingObserver<biometry::TemplateStore::List>>(
+            biometry::Operation<biometry::TemplateStore::List>::Observer::Ptr{},
+            [](const std::vector<biometry::TemplateStore::TemplateId>&) {}));
+        ops.push_back(op);
+    }
+
+    // Operations are kept alive until the next re-sync, by which time they have long completed.
+    resyncs.swap(ops);
+}
+
+biometry::TemplateStore& biometry::devices::Caching::template_store()
+{
+    return template_store_;
+}
+
+biometry::Identifier& biometry::devices::Caching::identifier()
+{
+    return impl->identifier();
+}
+
+biometry::Verifier& biometry::devices::Caching::verifier()
+{
+    return impl->verifier();
+}
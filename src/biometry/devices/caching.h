@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DEVICES_CACHING_H_
+#define BIOMETRYD_DEVICES_CACHING_H_
+
+#include <biometry/device.h>
+
+#include <biometry/identifier.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <biometry/devices/template_cache.h>
+
+#include <memory>
+#include <vector>
+
+namespace biometry
+{
+namespace devices
+{
+/// @brief Caching is a biometry::Device that serves template store queries from a TemplateCache.
+///
+/// Size and list queries are answered from the cache if possible, and are forwarded to the
+/// actual device otherwise, recording the result on success. Successful enrollments, removals
+/// and clearances update the cache accordingly. Identification and verification are forwarded
+/// to the actual device as-is. Failing to access the cache never fails an operation, it just
+/// degrades to forwarding all calls.
+class BIOMETRY_DLL_PUBLIC Caching : public biometry::Device
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Caching> Ptr;
+
+    class TemplateStore : public biometry::TemplateStore
+    {
+    public:
+        TemplateStore(const std::shared_ptr<biometry::Device>& impl, const TemplateCache::Ptr& cache);
+
+        // From biometry::TemplateStore.
+        biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr size(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::List>::Ptr list(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr enroll(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Removal>::Ptr remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id) override;
+        biometry::Operation<biometry::TemplateStore::Clearance>::Ptr clear(const biometry::Application& app, const biometry::User& user) override;
+
+    private:
+        std::shared_ptr<biometry::Device> impl;
+        TemplateCache::Ptr cache;
+    };
+
+    /// @brief Caching creates a new instance, forwarding calls to device and caching template metadata in cache.
+    /// @throws std::runtime_error if device or cache is null.
+    Caching(const std::shared_ptr<biometry::Device>& device, const TemplateCache::Ptr& cache);
+
+    /// @brief resync re-reads the template ids of all entries known to the cache from the actual device.
+    ///
+    /// Entries are dropped before querying the device, such that stale data is never served
+    /// while the re-sync is in progress. The queries complete asynchronously.
+    void resync();
+
+    // From biometry::Device
+    biometry::TemplateStore& template_store() override;
+    biometry::Identifier& identifier() override;
+    biometry::Verifier& verifier() override;
+
+private:
+    std::shared_ptr<biometry::Device> impl;
+    TemplateCache::Ptr cache;
+    TemplateStore template_store_;
+    std::vector<biometry::Operation<biometry::TemplateStore::List>::Ptr> resyncs;
+};
+}
+}
+
+#endif // BIOMETRYD_DEVICES_CACHING_H_
@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/coalescing.h>
+
+#include <biometry/application.h>
+#include <biometry/operation.h>
+#include <biometry/reason.h>
+
+#include <biometry/util/metrics.h>
+#include <biometry/util/trace.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace
+{
+// Safe us some typing.
+typedef biometry::Operation<biometry::Identification> Identification;
+typedef Identification::Observer Observer;
+
+// Capture bundles an identification in flight on the actual device with all requesters attached to it.
+class Capture : public std::enable_shared_from_this<Capture>
+{
+public:
+    // Attachment enumerates the outcomes of attaching a requester.
+    enum class Attachment
+    {
+        rejected,       ///< The capture is finishing and does not accept requesters anymore.
+        attached,       ///< The requester has been attached.
+        late            ///< The requester has been attached to a capture that has already started.
+    };
+
+    Capture(const Identification::Ptr& impl) : impl{impl}
+    {
+    }
+
+    Attachment attach(const void* requester, const Observer::Ptr& observer)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        if (closed)
+            return Attachment::rejected;
+
+        requesters.push_back(std::make_pair(requester, observer));
+        return started ? Attachment::late : Attachment::attached;
+    }
+
+    // detach detaches requester, canceling the actual operation if requester is the last one attached.
+    void detach(const void* requester)
+    {
+        Observer::Ptr observer;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+
+            auto it = std::find_if(requesters.begin(), requesters.end(), [requester](const std::pair<const void*, Observer::Ptr>& p)
+            {
+                return p.first == requester;
+            });
+
+            if (it == requesters.end())
+                return;
+
+            // The last requester stays attached to learn about the outcome of canceling.
+            if (requesters.size() == 1)
+            {
+                closed = true;
+            }
+            else
+            {
+                observer = it->second;
+                requesters.erase(it);
+            }
+        }
+
+        if (observer)
+            observer->on_canceled("Canceled by requester");
+        else
+            impl->cancel();
+    }
+
+    void start();
+
+    void on_started()
+    {
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            started = true;
+        }
+
+        for (const auto& observer : snapshot())
+            observer->on_started();
+    }
+
+    void on_progress(const Observer::Progress& progress)
+    {
+        for (const auto& observer : snapshot())
+            observer->on_progress(progress);
+    }
+
+    void on_canceled(const Observer::Reason& reason)
+    {
+        for (const auto& observer : finish())
+            observer->on_canceled(reason);
+    }
+
+    void on_failed(const Observer::Error& error)
+    {
+        for (const auto& observer : finish())
+            observer->on_failed(error);
+    }
+
+    void on_succeeded(const Observer::Result& result)
+    {
+        for (const auto& observer : finish())
+            observer->on_succeeded(result);
+    }
+
+private:
+    // snapshot returns the observers of all requesters attached right now.
+    std::vector<Observer::Ptr> snapshot()
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        std::vector<Observer::Ptr> observers;
+        for (const auto& requester : requesters)
+            observers.push_back(requester.second);
+
+        return observers;
+    }
+
+    // finish closes the capture, detaching and returning the observers of all requesters.
+    std::vector<Observer::Ptr> finish()
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        closed = true;
+
+        std::vector<Observer::Ptr> observers;
+        for (const auto& requester : requesters)
+            observers.push_back(requester.second);
+        requesters.clear();
+
+        return observers;
+    }
+
+    std::mutex guard;
+    Identification::Ptr impl;
+    std::vector<std::pair<const void*, Observer::Ptr>> requesters;
+    bool started{false};
+    bool closed{false};
+};
+
+// Relay forwards the events of the actual operation to a capture without keeping it alive.
+class Relay : public Observer
+{
+public:
+    Relay(const std::shared_ptr<Capture>& capture) : capture{capture}
+    {
+    }
+
+    void on_started() override
+    {
+        if (auto c = capture.lock()) c->on_started();
+    }
+
+    void on_progress(const Progress& progress) override
+    {
+        if (auto c = capture.lock()) c->on_progress(progress);
+    }
+
+    void on_canceled(const Reason& reason) override
+    {
+        if (auto c = capture.lock()) c->on_canceled(reason);
+    }
+
+    void on_failed(const Error& error) override
+    {
+        if (auto c = capture.lock()) c->on_failed(error);
+    }
+
+    void on_succeeded(const Result& result) override
+    {
+        if (auto c = capture.lock()) c->on_succeeded(result);
+    }
+
+private:
+    std::weak_ptr<Capture> capture;
+};
+
+void Capture::start()
+{
+    impl->start_with_observer(std::make_shared<Relay>(shared_from_this()));
+}
+}
+
+class biometry::devices::Coalescing::Coalescer
+{
+public:
+    Coalescer(const std::shared_ptr<biometry::Device>& impl, const Policy& policy) : impl{impl}, policy{policy}
+    {
+    }
+
+    // attach attaches observer to the capture in flight for app and reason, starting a new one if necessary.
+    std::shared_ptr<Capture> attach(const biometry::Application& app, const biometry::Reason& reason, const void* requester, const Observer::Ptr& observer)
+    {
+        static auto& coalesced = biometry::util::metrics().counter("identifier.coalesced");
+
+        std::shared_ptr<Capture> capture;
+        auto attachment = Capture::Attachment::rejected;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+
+            // Requests only ever share a capture with identical requests, unless the policy
+            // explicitly trusts the application. Consent given to one application for one
+            // reason must not carry over to another one by accident.
+            auto& slot = policy.shared_applications.count(app.as_string()) > 0 ?
+                        shared : in_flight[Key{app.as_string(), reason.as_string()}];
+
+            capture = slot.lock();
+            if (capture)
+                attachment = capture->attach(requester, observer);
+
+            if (attachment == Capture::Attachment::rejected)
+            {
+                capture = std::make_shared<Capture>(impl->identifier().identify_user(app, reason));
+                capture->attach(requester, observer);
+                slot = capture;
+            }
+
+            forget_finished_captures();
+        }
+
+        // We call out without holding the lock, observers might well request another identification.
+        switch (attachment)
+        {
+        case Capture::Attachment::rejected:
+            capture->start();
+            break;
+        case Capture::Attachment::late:
+            observer->on_started();
+            // Fallthrough
+        case Capture::Attachment::attached:
+            coalesced.increment();
+            biometry::util::trace::tracer().instant("identifier", "coalesced", biometry::util::trace::correlation_id());
+            break;
+        }
+
+        return capture;
+    }
+
+private:
+    // Key identifies a capture by application and reason.
+    typedef std::pair<std::string, std::string> Key;
+
+    // forget_finished_captures erases all captures that nobody refers to anymore.
+    void forget_finished_captures()
+    {
+        for (auto it = in_flight.begin(); it != in_flight.end();)
+            it = it->second.expired() ? in_flight.erase(it) : std::next(it);
+    }
+
+    std::shared_ptr<biometry::Device> impl;
+    Policy policy;
+    std::mutex guard;
+    std::map<Key, std::weak_ptr<Capture>> in_flight;
+    // The capture in flight for any of the applications in policy.shared_applications.
+    std::weak_ptr<Capture> shared;
+};
+
+namespace
+{
+// CoalescedOperation is the operation handed out to an individual requester.
+class CoalescedOperation : public Identification
+{
+public:
+    CoalescedOperation(const std::shared_ptr<biometry::devices::Coalescing::Coalescer>& coalescer, const biometry::Application& app, const biometry::Reason& reason)
+        : coalescer{coalescer},
+          app{app},
+          reason{reason}
+    {
+    }
+
+    void start_with_observer(const Observer::Ptr& observer) override
+    {
+        bool canceled_before_start{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            canceled_before_start = canceled;
+        }
+
+        if (canceled_before_start)
+        {
+            observer->on_canceled("Canceled by requester");
+            return;
+        }
+
+        // Attaching might start the capture, and we must not hold the lock while calling out.
+        auto c = coalescer->attach(app, reason, this, observer);
+
+        bool canceled_while_attaching{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            capture = c;
+            canceled_while_attaching = canceled;
+        }
+
+        if (canceled_while_attaching)
+            c->detach(this);
+    }
+
+    void cancel() override
+    {
+        std::shared_ptr<Capture> c;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            canceled = true;
+            c = capture;
+        }
+
+        if (c)
+            c->detach(this);
+    }
+
+private:
+    std::shared_ptr<biometry::devices::Coalescing::Coalescer> coalescer;
+    biometry::Application app;
+    biometry::Reason reason;
+    std::mutex guard;
+    bool canceled{false};
+    std::shared_ptr<Capture> capture;
+};
+}
+
+biometry::devices::Coalescing::Policy biometry::devices::Coalescing::Policy::from_configuration(const util::Configuration::Node& node)
+{
+    Policy policy;
+
+    for (const auto& pair : node["sharedApplications"].children())
+        policy.shared_applications.insert(pair.second.value().string());
+
+    return policy;
+}
+
+biometry::devices::Coalescing::Identifier::Identifier(const std::shared_ptr<biometry::Device>& impl, const Policy& policy)
+    : coalescer{std::make_shared<Coalescer>(impl, policy)}
+{
+}
+
+biometry::Operation<biometry::Identification>::Ptr biometry::devices::Coalescing::Identifier::identify_user(const biometry::Application& app, const biometry::Reason& reason)
+{
+    return std::make_shared<CoalescedOperation>(coalescer, app, reason);
+}
+
+biometry::devices::Coalescing::Coalescing(const std::shared_ptr<biometry::Device>& device)
+    : Coalescing{device, Policy{}}
+{
+}
+
+biometry::devices::Coalescing::Coalescing(const std::shared_ptr<biometry::Device>& device, const Policy& policy)
+    : impl{device},
+      identifier_{device, policy}
+{
+    if (not impl)
+        throw std::runtime_error{"Missing device implementation"};
+}
+
+biometry::TemplateStore& biometry::devices::Coalescing::template_store()
+{
+    return impl->template_store();
+}
+
+biometry::Identifier& biometry::devices::Coalescing::identifier()
+{
+    return identifier_;
+}
+
+biometry::Verifier& biometry::devices::Coalescing::verifier()
+{
+    return impl->verifier();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DEVICES_COALESCING_H_
+#define BIOMETRYD_DEVICES_COALESCING_H_
+
+#include <biometry/device.h>
+
+#include <biometry/identifier.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <biometry/util/configuration.h>
+
+#include <memory>
+#include <set>
+#include <string>
+
+namespace biometry
+{
+namespace devices
+{
+/// @brief Coalescing is a biometry::Device that shares one sensor capture across concurrent identifications.
+///
+/// An identification requested while another one for the same application and reason is in
+/// flight is attached to the in-flight operation on the actual device instead of queueing up
+/// for a capture of its own. Requests of different applications only share a capture if the
+/// Policy explicitly lists all of them in shared_applications, and never by default. Progress
+/// and results of the in-flight operation are reported to all attached requesters. A requester canceling is detached immediately, and the in-flight operation is
+/// only canceled once the last requester has canceled. Template store and verifier are
+/// forwarded as-is.
+class BIOMETRY_DLL_PUBLIC Coalescing : public biometry::Device
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Coalescing> Ptr;
+
+    /// @brief Policy describes which requests may share a capture.
+    struct BIOMETRY_DLL_PUBLIC Policy
+    {
+        /// @brief from_configuration returns the default policy, adjusted by the settings in node.
+        ///
+        /// node is expected to look like:
+        ///   {
+        ///     "sharedApplications": ["system", "indicator-session"]
+        ///   }
+        /// All entries are optional.
+        static Policy from_configuration(const util::Configuration::Node& node);
+
+        /// @brief Applications trusted to share captures with each other, regardless of the reason given.
+        ///
+        /// Consent given to one of these applications carries over to all others, so only
+        /// applications acting on behalf of the system with the same user in front of the device
+        /// belong here. Requests of all other applications only share a capture with identical
+        /// requests of the same application.
+        std::set<std::string> shared_applications;
+    };
+
+    /// @cond
+    class Coalescer;
+    /// @endcond
+
+    class Identifier : public biometry::Identifier
+    {
+    public:
+        Identifier(const std::shared_ptr<biometry::Device>& impl, const Policy& policy);
+
+        // From biometry::Identifier.
+        biometry::Operation<biometry::Identification>::Ptr identify_user(const biometry::Application& app, const biometry::Reason& reason) override;
+
+    private:
+        std::shared_ptr<Coalescer> coalescer;
+    };
+
+    /// @brief Coalescing creates a new instance, forwarding calls to device according to the default policy.
+    /// @throws std::runtime_error if device is null.
+    Coalescing(const std::shared_ptr<biometry::Device>& device);
+
+    /// @brief Coalescing creates a new instance, forwarding calls to device according to policy.
+    /// @throws std::runtime_error if device is null.
+    Coalescing(const std::shared_ptr<biometry::Device>& device, const Policy& policy);
+
+    // From biometry::Device
+    biometry::TemplateStore& template_store() override;
+    biometry::Identifier& identifier() override;
+    biometry::Verifier& verifier() override;
+
+private:
+    std::shared_ptr<biometry::Device> impl;
+    Identifier identifier_;
+};
+}
+}
+
+#endif // BIOMETRYD_DEVICES_COALESCING_H_
@@ -0,0 +1,276 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/deferred.h>
+
+#include <biometry/application.h>
+#include <biometry/operation.h>
+#include <biometry/reason.h>
+#include <biometry/user.h>
+
+#include <biometry/util/trace.h>
+
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+class biometry::devices::Deferred::Resolution
+{
+public:
+    State state() const
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        return state_;
+    }
+
+    void settle(State state, const std::shared_ptr<biometry::Device>& device, const std::string& reason)
+    {
+        std::vector<Continuation> continuations;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            if (state_ != State::pending)
+                throw std::logic_error{"Deferred device has already been resolved"};
+
+            state_ = state;
+            device_ = device;
+            reason_ = reason;
+            continuations.swap(parked);
+        }
+
+        // We run continuations without holding the lock, they might well call back into us.
+        for (const auto& continuation : continuations)
+            continuation(device, reason);
+    }
+
+    void when_resolved(const Continuation& continuation)
+    {
+        std::unique_lock<std::mutex> ul{guard};
+        if (state_ == State::pending)
+        {
+            parked.push_back(continuation);
+            return;
+        }
+
+        auto device = device_; auto reason = reason_;
+        ul.unlock();
+
+        continuation(device, reason);
+    }
+
+private:
+    mutable std::mutex guard;
+    State state_{State::pending};
+    std::shared_ptr<biometry::Device> device_;
+    std::string reason_;
+    std::vector<Continuation> parked;
+};
+
+namespace
+{
+template<typename T>
+class DeferredOperation : public biometry::Operation<T>, public std::enable_shared_from_this<DeferredOperation<T>>
+{
+public:
+    // Safe us some typing.
+    typedef std::function<typename biometry::Operation<T>::Ptr(biometry::Device&)> Factory;
+
+    DeferredOperation(const std::shared_ptr<biometry::devices::Deferred::Resolution>& resolution, const Factory& factory)
+        : resolution{resolution},
+          factory{factory}
+    {
+    }
+
+    void start_with_observer(const typename biometry::Operation<T>::Observer::Ptr& observer) override
+    {
+        auto id = biometry::util::trace::correlation_id();
+        if (resolution->state() == biometry::devices::Deferred::State::pending)
+            biometry::util::trace::tracer().instant("startup", "parked", id);
+
+        auto thiz = this->shared_from_this();
+        resolution->when_resolved([thiz, observer, id](const std::shared_ptr<biometry::Device>& device, const std::string& reason)
+        {
+            // Parked operations are started on the thread resolving the device.
+            biometry::util::trace::Correlation correlation{id};
+
+            if (not device)
+            {
+                observer->on_failed(reason);
+                return;
+            }
+
+            typename biometry::Operation<T>::Ptr impl;
+            {
+                std::lock_guard<std::mutex> lg{thiz->guard};
+                if (not thiz->canceled)
+                    impl = thiz->impl = thiz->factory(*device);
+            }
+
+            if (impl)
+                impl->start_with_observer(observer);
+            else
+                observer->on_canceled("Operation was canceled before the device became available");
+        });
+    }
+
+    void cancel() override
+    {
+        typename biometry::Operation<T>::Ptr i;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            canceled = true;
+            i = impl;
+        }
+
+        // We only forward to an operation that has been started on the actual device.
+        // Parked operations are canceled as soon as the device becomes available.
+        if (i)
+            i->cancel();
+    }
+
+private:
+    std::shared_ptr<biometry::devices::Deferred::Resolution> resolution;
+    Factory factory;
+    std::mutex guard;
+    bool canceled{false};
+    typename biometry::Operation<T>::Ptr impl;
+};
+
+template<typename T>
+typename biometry::Operation<T>::Ptr defer(const std::shared_ptr<biometry::devices::Deferred::Resolution>& resolution, const typename DeferredOperation<T>::Factory& factory)
+{
+    return std::make_shared<DeferredOperation<T>>(resolution, factory);
+}
+}
+
+biometry::devices::Deferred::TemplateStore::TemplateStore(const std::shared_ptr<Resolution>& resolution)
+    : resolution{resolution}
+{
+}
+
+biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::devices::Deferred::TemplateStore::size(const biometry::Application& app, const biometry::User& user)
+{
+    return defer<biometry::TemplateStore::SizeQuery>(resolution, [app, user](biometry::Device& device)
+    {
+        return device.template_store().size(app, user);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::List>::Ptr biometry::devices::Deferred::TemplateStore::list(const biometry::Application& app, const biometry::User& user)
+{
+    return defer<biometry::TemplateStore::List>(resolution, [app, user](biometry::Device& device)
+    {
+        return device.template_store().list(app, user);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::devices::Deferred::TemplateStore::enroll(const biometry::Application& app, const biometry::User& user)
+{
+    return defer<biometry::TemplateStore::Enrollment>(resolution, [app, user](biometry::Device& device)
+    {
+        return device.template_store().enroll(app, user);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Removal>::Ptr biometry::devices::Deferred::TemplateStore::remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id)
+{
+    return defer<biometry::TemplateStore::Removal>(resolution, [app, user, id](biometry::Device& device)
+    {
+        return device.template_store().remove(app, user, id);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::devices::Deferred::TemplateStore::clear(const biometry::Application& app, const biometry::User& user)
+{
+    return defer<biometry::TemplateStore::Clearance>(resolution, [app, user](biometry::Device& device)
+    {
+        return device.template_store().clear(app, user);
+    });
+}
+
+biometry::devices::Deferred::Identifier::Identifier(const std::shared_ptr<Resolution>& resolution)
+    : resolution{resolution}
+{
+}
+
+biometry::Operation<biometry::Identification>::Ptr biometry::devices::Deferred::Identifier::identify_user(const biometry::Application& app, const biometry::Reason& reason)
+{
+    return defer<biometry::Identification>(resolution, [app, reason](biometry::Device& device)
+    {
+        return device.identifier().identify_user(app, reason);
+    });
+}
+
+biometry::devices::Deferred::Verifier::Verifier(const std::shared_ptr<Resolution>& resolution)
+    : resolution{resolution}
+{
+}
+
+biometry::Operation<biometry::Verification>::Ptr biometry::devices::Deferred::Verifier::verify_user(const biometry::Application& app, const biometry::User& user, const biometry::Reason& reason)
+{
+    return defer<biometry::Verification>(resolution, [app, user, reason](biometry::Device& device)
+    {
+        return device.verifier().verify_user(app, user, reason);
+    });
+}
+
+biometry::devices::Deferred::Deferred()
+    : resolution{std::make_shared<Resolution>()},
+      template_store_{resolution},
+      identifier_{resolution},
+      verifier_{resolution}
+{
+}
+
+void biometry::devices::Deferred::resolve(const std::shared_ptr<biometry::Device>& device)
+{
+    if (not device)
+        throw std::runtime_error{"Cannot resolve to a null device"};
+
+    resolution->settle(State::ready, device, std::string{});
+}
+
+void biometry::devices::Deferred::fail(const std::string& reason)
+{
+    resolution->settle(State::failed, std::shared_ptr<biometry::Device>{}, reason);
+}
+
+biometry::devices::Deferred::State biometry::devices::Deferred::state() const
+{
+    return resolution->state();
+}
+
+void biometry::devices::Deferred::when_resolved(const Continuation& continuation)
+{
+    resolution->when_resolved(continuation);
+}
+
+biometry::TemplateStore& biometry::devices::Deferred::template_store()
+{
+    return template_store_;
+}
+
+biometry::Identifier& biometry::devices::Deferred::identifier()
+{
+    return identifier_;
+}
+
+biometry::Verifier& biometry::devices::Deferred::verifier()
+{
+    return verifier_;
+}
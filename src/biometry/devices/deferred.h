@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DEVICES_DEFERRED_H_
+#define BIOMETRYD_DEVICES_DEFERRED_H_
+
+#include <biometry/device.h>
+
+#include <biometry/identifier.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace biometry
+{
+namespace devices
+{
+/// @brief Deferred is a biometry::Device standing in for a device that is still being created.
+///
+/// Operations handed out by a Deferred instance can be started right away. They are parked
+/// until the actual device becomes available via resolve, and are then created on and
+/// started against the actual device. If the device cannot be created, fail reports the
+/// given reason to all parked and subsequent operations.
+class BIOMETRY_DLL_PUBLIC Deferred : public biometry::Device
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Deferred> Ptr;
+
+    /// @cond
+    class Resolution;
+    /// @endcond
+
+    /// @brief State enumerates all known states of a Deferred instance.
+    enum class State
+    {
+        pending,    ///< The actual device is still being created.
+        ready,      ///< The actual device is available.
+        failed      ///< The actual device could not be created.
+    };
+
+    /// @brief Continuation is invoked with the actual device, or with a null device and the reason for failing.
+    typedef std::function<void(const std::shared_ptr<biometry::Device>&, const std::string&)> Continuation;
+
+    class TemplateStore : public biometry::TemplateStore
+    {
+    public:
+        TemplateStore(const std::shared_ptr<Resolution>& resolution);
+
+        // From biometry::TemplateStore.
+        biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr size(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::List>::Ptr list(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr enroll(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Removal>::Ptr remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id) override;
+        biometry::Operation<biometry::TemplateStore::Clearance>::Ptr clear(const biometry::Application& app, const biometry::User& user) override;
+
+    private:
+        std::shared_ptr<Resolution> resolution;
+    };
+
+    class Identifier : public biometry::Identifier
+    {
+    public:
+        Identifier(const std::shared_ptr<Resolution>& resolution);
+
+        // From biometry::Identifier.
+        biometry::Operation<biometry::Identification>::Ptr identify_user(const biometry::Application& app, const biometry::Reason& reason) override;
+
+    private:
+        std::shared_ptr<Resolution> resolution;
+    };
+
+    class Verifier : public biometry::Verifier
+    {
+    public:
+        Verifier(const std::shared_ptr<Resolution>& resolution);
+
+        // From biometry::Verifier.
+        Operation<Verification>::Ptr verify_user(const Application& app, const User& user, const Reason& reason) override;
+
+    private:
+        std::shared_ptr<Resolution> resolution;
+    };
+
+    /// @brief Deferred initializes a new instance in State::pending.
+    Deferred();
+
+    /// @brief resolve hands the actual device to the instance, starting all parked operations.
+    /// @throws std::runtime_error if device is null.
+    /// @throws std::logic_error if the instance is not pending anymore.
+    void resolve(const std::shared_ptr<biometry::Device>& device);
+
+    /// @brief fail marks the actual device as unavailable, failing all parked operations with reason.
+    /// @throws std::logic_error if the instance is not pending anymore.
+    void fail(const std::string& reason);
+
+    /// @brief state returns the current state of the instance.
+    State state() const;
+
+    /// @brief when_resolved invokes continuation once the instance is not pending anymore.
+    ///
+    /// The continuation is invoked immediately on the calling thread if the instance has already
+    /// been resolved or failed, and on the thread calling resolve or fail otherwise.
+    void when_resolved(const Continuation& continuation);
+
+    // From biometry::Device
+    biometry::TemplateStore& template_store() override;
+    biometry::Identifier& identifier() override;
+    biometry::Verifier& verifier() override;
+
+private:
+    /// @cond
+    std::shared_ptr<Resolution> resolution;
+    TemplateStore template_store_;
+    Identifier identifier_;
+    Verifier verifier_;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRYD_DEVICES_DEFERRED_H_
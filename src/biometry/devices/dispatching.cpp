@@ -23,6 +23,8 @@
 #include <biometry/operation.h>
 #include <biometry/template_store.h>
 
+#include <biometry/util/trace.h>
+
 namespace
 {
 template<typename T>
@@ -38,9 +40,18 @@ public:
 
     void start_with_observer(const typename biometry::Operation<T>::Observer::Ptr& observer) override
     {
+        // We carry over the correlation id of the caller to the dispatcher's thread.
+        auto id = biometry::util::trace::correlation_id();
+        auto enqueued_at = biometry::util::trace::Clock::now();
+        biometry::util::trace::tracer().instant("dispatch", "enqueue", id);
+
         auto i= impl;
-        dispatcher->dispatch([i, observer]()
+        dispatcher->dispatch([i, observer, id, enqueued_at]()
         {
+            biometry::util::trace::tracer().complete("dispatch", "queued", enqueued_at, id);
+
+            biometry::util::trace::Correlation correlation{id};
+            biometry::util::trace::Span span{"device", "start_with_observer", id};
             i->start_with_observer(observer);
         });
     }
@@ -117,6 +128,13 @@ biometry::devices::Dispatching::Dispatching(const std::shared_ptr<biometry::util
 {
 }
 
+biometry::devices::Dispatching::Dispatching(const biometry::util::DispatcherFactory& factory, const std::shared_ptr<Device>& device)
+    : template_store_{factory(), device},
+      identifier_{factory(), device},
+      verifier_{factory(), device}
+{
+}
+
 biometry::TemplateStore& biometry::devices::Dispatching::template_store()
 {
     return template_store_;
@@ -86,10 +86,17 @@ public:
         std::shared_ptr<biometry::Device> impl;
     };
 
-    /// @brief Forwarding creates a new instance, forwarding calls to device.
+    /// @brief Dispatching creates a new instance, forwarding calls to device.
     /// @throws std::runtime_error if device is null.
     Dispatching(const std::shared_ptr<biometry::util::Dispatcher>& dispatcher, const std::shared_ptr<Device>& device);
 
+    /// @brief Dispatching creates a new instance, forwarding calls to device.
+    ///
+    /// Template store, identifier and verifier each dispatch through their own instance created
+    /// by factory, such that a slow operation on one of them does not delay the others.
+    /// @throws std::runtime_error if device is null.
+    Dispatching(const biometry::util::DispatcherFactory& factory, const std::shared_ptr<Device>& device);
+
     // From biometry::Device
     biometry::TemplateStore& template_store() override;
     biometry::Identifier& identifier() override;
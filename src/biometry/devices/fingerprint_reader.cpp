@@ -90,25 +90,38 @@ private:
 };
 }
 
+// Dictionary lookups bind references to our keys, and we thus need definitions.
+constexpr const char* biometry::devices::FingerprintReader::GuidedEnrollment::Hints::key_is_finger_present;
+constexpr const char* biometry::devices::FingerprintReader::GuidedEnrollment::Hints::key_is_main_cluster_identified;
+constexpr const char* biometry::devices::FingerprintReader::GuidedEnrollment::Hints::key_suggested_next_direction;
+constexpr const char* biometry::devices::FingerprintReader::GuidedEnrollment::Hints::key_estimated_finger_size;
+constexpr const char* biometry::devices::FingerprintReader::GuidedEnrollment::Hints::key_masks;
+
 void biometry::devices::FingerprintReader::GuidedEnrollment::Hints::from_dictionary(const biometry::Dictionary& dict)
 {
+    // Lookups by C string do not create temporary keys.
+    auto it = dict.find(key_is_finger_present);
     is_finger_present.reset();
-    if (dict.count(key_is_finger_present) > 0)
-        is_finger_present = dict.at(key_is_finger_present).boolean();
+    if (it != dict.end())
+        is_finger_present = it->second.boolean();
 
+    it = dict.find(key_is_main_cluster_identified);
     is_main_cluster_identified.reset();
-    if (dict.count(key_is_main_cluster_identified) > 0)
-        is_main_cluster_identified = dict.at(key_is_main_cluster_identified).boolean();
+    if (it != dict.end())
+        is_main_cluster_identified = it->second.boolean();
 
+    it = dict.find(key_suggested_next_direction);
     suggested_next_direction.reset();
-    if (dict.count(key_suggested_next_direction) > 0)
-        suggested_next_direction = static_cast<biometry::devices::FingerprintReader::Direction>(dict.at(key_suggested_next_direction).integer());
+    if (it != dict.end())
+        suggested_next_direction = static_cast<biometry::devices::FingerprintReader::Direction>(it->second.integer());
 
-    if (dict.count(key_masks) > 0)
+    it = dict.find(key_masks);
+    if (it != dict.end())
     {
         masks = std::vector<biometry::Rectangle>{};
 
-        auto v = dict.at(key_masks).vector();
+        const auto& v = it->second.vector();
+        masks->reserve(v.size());
 
         for (const auto& m : v)
             masks->push_back(m.rectangle());
@@ -120,24 +133,27 @@ void biometry::devices::FingerprintReader::GuidedEnrollment::Hints::from_diction
 
 biometry::Dictionary biometry::devices::FingerprintReader::GuidedEnrollment::Hints::to_dictionary() const
 {
-    biometry::Dictionary dict;
+    typedef biometry::Dictionary::Key Key;
+
+    // Our keys are string constants, and we thus avoid copying them into the dictionary.
+    biometry::Dictionary dict; dict.reserve(4);
 
     if (is_finger_present)
-        dict[key_is_finger_present] = biometry::Variant::b(*is_finger_present);
+        dict[Key::from_static(key_is_finger_present)] = biometry::Variant::b(*is_finger_present);
 
     if (is_main_cluster_identified)
-        dict[key_is_main_cluster_identified] = biometry::Variant::b(*is_main_cluster_identified);
+        dict[Key::from_static(key_is_main_cluster_identified)] = biometry::Variant::b(*is_main_cluster_identified);
 
     if (suggested_next_direction)
-       dict[key_suggested_next_direction] = biometry::Variant::i(static_cast<std::uint64_t>(*suggested_next_direction));
+       dict[Key::from_static(key_suggested_next_direction)] = biometry::Variant::i(static_cast<std::uint64_t>(*suggested_next_direction));
 
    if (masks)
    {
-       std::vector<biometry::Variant> v;
+       std::vector<biometry::Variant> v; v.reserve(masks->size());
        for (const auto& r : *masks)
            v.push_back(biometry::Variant::r(r));
 
-       dict[key_masks] = biometry::Variant::v(v);
+       dict[Key::from_static(key_masks)] = biometry::Variant{std::move(v)};
    }
 
    return dict;
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/devices/plugin/descriptor_cache.h>
+
+#include <boost/format.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace plugin = biometry::devices::plugin;
+
+namespace
+{
+// The on-disk format is a header followed by one record per entry:
+//   header: magic, format version, size of plugin::Descriptor (all std::uint32_t)
+//   record: path length (std::uint32_t), path, inode, size (std::uint64_t), mtime (std::int64_t),
+//           has descriptor (std::uint8_t), descriptor (if present)
+// Caches written by a biometryd build with a different layout are discarded on load.
+constexpr const std::uint32_t magic{0x42505343};
+constexpr const std::uint32_t format_version{1};
+constexpr const std::uint32_t max_path_length{4096};
+
+template<typename T>
+void write(std::ostream& out, const T& t)
+{
+    out.write(reinterpret_cast<const char*>(&t), sizeof(T));
+}
+
+template<typename T>
+bool read(std::istream& in, T& t)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&t), sizeof(T)));
+}
+}
+
+biometry::Optional<plugin::DescriptorCache::Key> plugin::DescriptorCache::Key::for_file(const boost::filesystem::path& path)
+{
+    struct stat st;
+    if (::stat(path.string().c_str(), &st) != 0)
+        return Optional<Key>{};
+
+    return Key
+    {
+        path,
+        static_cast<std::uint64_t>(st.st_ino),
+        static_cast<std::uint64_t>(st.st_size),
+        static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000 * 1000 * 1000 + st.st_mtim.tv_nsec
+    };
+}
+
+plugin::DescriptorCache plugin::DescriptorCache::load(const boost::filesystem::path& path)
+{
+    DescriptorCache result;
+
+    std::ifstream in{path.string(), std::ios::binary};
+
+    std::uint32_t m{0}, v{0}, s{0};
+    if (not read(in, m) || not read(in, v) || not read(in, s) || m != magic || v != format_version || s != sizeof(plugin::Descriptor))
+        return result;
+
+    while (true)
+    {
+        std::uint32_t length{0};
+        if (not read(in, length))
+            break;
+
+        if (length > max_path_length)
+            return DescriptorCache{};
+
+        std::string p(length, '\0'); Key key{};
+        std::uint8_t has_descriptor{0};
+
+        if (not in.read(&p[0], length) || not read(in, key.inode) || not read(in, key.size) || not read(in, key.mtime) || not read(in, has_descriptor))
+            return DescriptorCache{};
+
+        key.path = p;
+
+        if (not has_descriptor)
+        {
+            result.insert(Entry{key, Optional<plugin::Descriptor>{}});
+            continue;
+        }
+
+        // Descriptor has const members and cannot be assigned to, so we read into suitably aligned storage.
+        typename std::aligned_storage<sizeof(plugin::Descriptor), alignof(plugin::Descriptor)>::type storage;
+        if (not read(in, storage))
+            return DescriptorCache{};
+
+        result.insert(Entry{key, *reinterpret_cast<const plugin::Descriptor*>(&storage)});
+    }
+
+    return result;
+}
+
+void plugin::DescriptorCache::store(const boost::filesystem::path& path) const
+{
+    boost::system::error_code ec;
+    if (path.has_parent_path())
+        boost::filesystem::create_directories(path.parent_path(), ec);
+
+    // We write to a temporary file first and rename it to path, such that readers never observe partially written caches.
+    const auto tmp = (boost::format("%1%.%2%") % path.string() % ::getpid()).str();
+
+    {
+        std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+
+        write(out, magic); write(out, format_version); write(out, static_cast<std::uint32_t>(sizeof(plugin::Descriptor)));
+
+        for (const auto& pair : entries)
+        {
+            const auto& entry = pair.second;
+            const auto p = entry.key.path.string();
+
+            write(out, static_cast<std::uint32_t>(p.size())); out.write(p.data(), p.size());
+            write(out, entry.key.inode); write(out, entry.key.size); write(out, entry.key.mtime);
+            write(out, static_cast<std::uint8_t>(entry.descriptor ? 1 : 0));
+
+            if (entry.descriptor)
+                write(out, entry.descriptor.get());
+        }
+
+        if (not out.flush())
+        {
+            ::unlink(tmp.c_str());
+            throw std::runtime_error{"Failed to write plugin descriptor cache: " + tmp};
+        }
+    }
+
+    if (::rename(tmp.c_str(), path.string().c_str()) != 0)
+    {
+        ::unlink(tmp.c_str());
+        throw std::runtime_error{"Failed to replace plugin descriptor cache: " + path.string()};
+    }
+}
+
+biometry::Optional<plugin::DescriptorCache::Entry> plugin::DescriptorCache::find(const Key& key) const
+{
+    auto it = entries.find(key.path);
+
+    if (it == entries.end())
+        return Optional<Entry>{};
+
+    const auto& k = it->second.key;
+    if (k.inode != key.inode || k.size != key.size || k.mtime != key.mtime)
+        return Optional<Entry>{};
+
+    return it->second;
+}
+
+void plugin::DescriptorCache::insert(const Entry& entry)
+{
+    // Entry cannot be assigned to, so we replace existing entries.
+    entries.erase(entry.key.path);
+    entries.emplace(entry.key.path, entry);
+}
+
+std::size_t plugin::DescriptorCache::size() const
+{
+    return entries.size();
+}
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_CACHE_H_
+#define BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_CACHE_H_
+
+#include <biometry/optional.h>
+#include <biometry/visibility.h>
+
+#include <biometry/devices/plugin/interface.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <map>
+
+namespace biometry
+{
+namespace devices
+{
+namespace plugin
+{
+/// @brief DescriptorCache remembers the plugin descriptors found in files, saving the effort of
+/// inspecting files that did not change since they were last inspected.
+///
+/// Files are identified by their path, inode, size and modification time. Files that turned out not
+/// to contain a plugin descriptor are remembered, too.
+class BIOMETRY_DLL_PUBLIC DescriptorCache
+{
+public:
+    /// @brief Key identifies a specific revision of a file.
+    struct BIOMETRY_DLL_PUBLIC Key
+    {
+        /// @brief for_file returns the key of the file located at path, or an empty Optional if path cannot be accessed.
+        static Optional<Key> for_file(const boost::filesystem::path& path);
+
+        boost::filesystem::path path;   ///< The path of the file.
+        std::uint64_t inode;            ///< The inode of the file.
+        std::uint64_t size;             ///< The size of the file in bytes.
+        std::int64_t mtime;             ///< The modification time of the file in nanoseconds since the epoch.
+    };
+
+    /// @brief Entry bundles a Key with the descriptor found in the file, if any.
+    struct BIOMETRY_DLL_PUBLIC Entry
+    {
+        Key key;                                ///< The file the entry refers to.
+        Optional<plugin::Descriptor> descriptor;  ///< The plugin descriptor contained in the file, if any.
+    };
+
+    /// @brief load returns the cache stored at path, or an empty cache if path cannot be read or is malformed.
+    static DescriptorCache load(const boost::filesystem::path& path);
+
+    /// @brief store atomically replaces the file at path with the contents of this cache, creating parent directories as necessary.
+    /// @throws std::runtime_error if writing the cache fails.
+    void store(const boost::filesystem::path& path) const;
+
+    /// @brief find returns the entry for key.path if it refers to the same revision of the file as key.
+    Optional<Entry> find(const Key& key) const;
+
+    /// @brief insert adds entry, replacing any existing entry for the same path.
+    void insert(const Entry& entry);
+
+    /// @brief size returns the number of entries.
+    std::size_t size() const;
+
+private:
+    /// @cond
+    std::map<boost::filesystem::path, Entry> entries;
+    /// @endcond
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_CACHE_H_
@@ -18,6 +18,7 @@
  */
 
 #include <biometry/devices/plugin/device.h>
+#include <biometry/devices/plugin/loaded_plugin_cache.h>
 
 #include <biometry/util/configuration.h>
 
@@ -28,6 +29,21 @@ std::shared_ptr<biometry::Device> plugin::load(const std::shared_ptr<util::Dynam
     return loader.verify_and_load(api, path);
 }
 
+std::shared_ptr<biometry::Device> plugin::create(const boost::filesystem::path& path, const util::Configuration& configuration)
+{
+    auto binding = util::DynamicLibrary::Binding::now;
+    if (auto node = configuration["binding"])
+        binding = node.value().string() == "lazy" ? util::DynamicLibrary::Binding::lazy : util::DynamicLibrary::Binding::now;
+
+    auto api = util::glibc::dl_api(binding);
+
+    if (auto node = configuration["pool"])
+        if (node.value().boolean())
+            return LoadedPluginCache::instance().pooled_device(api, path, configuration);
+
+    return LoadedPluginCache::instance().device(api, path);
+}
+
 #include <biometry/device_registry.h>
 
 namespace
@@ -36,9 +52,7 @@ struct PluginDescriptor : public biometry::Device::Descriptor
 {
     std::shared_ptr<biometry::Device> create(const biometry::util::Configuration& config) override
     {
-        auto api = biometry::util::glibc::dl_api();
-        biometry::devices::plugin::ElfDescriptorVerifierLoader loader;
-        return biometry::devices::plugin::load(api, config["path"].value().string(), loader);
+        return biometry::devices::plugin::create(config["path"].value().string(), config);
     }
 
     std::string name() const override
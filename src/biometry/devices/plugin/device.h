@@ -23,6 +23,8 @@
 #include <biometry/devices/forwarding.h>
 #include <biometry/devices/plugin/loader.h>
 
+#include <biometry/util/configuration.h>
+
 #include <boost/filesystem.hpp>
 
 namespace biometry
@@ -44,6 +46,14 @@ using Device = biometry::devices::Forwarding;
 /// @brief load returns a biometry::Device implementation that has been loaded from a shared object located at path,
 /// relying on api to open the library and resolve symbols.
 BIOMETRY_DLL_PUBLIC std::shared_ptr<biometry::Device> load(const std::shared_ptr<util::DynamicLibrary::Api>& api, const boost::filesystem::path& path, const Loader& loader);
+
+/// @brief create returns a biometry::Device implementation loaded from the shared object located at path, sharing the
+/// loaded library with all other devices created from it, see LoadedPluginCache.
+///
+/// configuration is handed to the device and may contain:
+///   - "binding": "lazy" resolves function symbols on first use instead of when loading the library, and
+///   - "pool": true shares a single device instance among all users with an equal configuration.
+BIOMETRY_DLL_PUBLIC std::shared_ptr<biometry::Device> create(const boost::filesystem::path& path, const util::Configuration& configuration);
 }
 }
 }
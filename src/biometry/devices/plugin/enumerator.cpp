@@ -18,9 +18,14 @@
  */
 
 #include <biometry/devices/plugin/enumerator.h>
+#include <biometry/devices/plugin/descriptor_cache.h>
+#include <biometry/devices/plugin/device.h>
 #include <biometry/devices/plugin/loader.h>
 #include <biometry/devices/plugin/verifier.h>
 
+#include <future>
+#include <vector>
+
 namespace plugin = biometry::devices::plugin;
 
 namespace
@@ -35,9 +40,9 @@ struct PluginDeviceDescriptor : public biometry::Device::Descriptor
     {
     }
 
-    std::shared_ptr<biometry::Device> create(const biometry::util::Configuration&) override
+    std::shared_ptr<biometry::Device> create(const biometry::util::Configuration& config) override
     {
-        return plugin::ElfDescriptorVerifierLoader{}.verify_and_load(biometry::util::glibc::dl_api(), path);
+        return plugin::create(path, config);
     }
 
     std::string name() const override
@@ -58,51 +63,86 @@ struct PluginDeviceDescriptor : public biometry::Device::Descriptor
     boost::filesystem::path path;
     biometry::devices::plugin::Descriptor desc;
 };
+
+/// @brief Scan bundles the results of scanning a single directory.
+struct Scan
+{
+    std::vector<plugin::DescriptorCache::Entry> entries;  ///< One entry per regular file in the directory.
+    std::size_t misses;                                   ///< The number of files that had to be inspected.
+};
+
+/// @brief scan inspects all regular files in directory, consulting cache for files that did not change.
+Scan scan(const boost::filesystem::path& directory, const plugin::DescriptorCache& cache)
+{
+    Scan result{{}, 0};
+
+    if (not boost::filesystem::is_directory(directory))
+        return result;
+
+    plugin::ElfDescriptorLoader loader;
+
+    for (boost::filesystem::directory_iterator it{directory}, itE; it != itE; ++it)
+    {
+        if (not boost::filesystem::is_regular_file(it->status()))
+            continue;
+
+        auto key = plugin::DescriptorCache::Key::for_file(it->path());
+        if (not key)
+            continue;
+
+        if (auto entry = cache.find(key.get()))
+        {
+            result.entries.push_back(entry.get());
+            continue;
+        }
+
+        result.entries.push_back(plugin::DescriptorCache::Entry{key.get(), loader.find_with_name(it->path(), BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION)});
+        ++result.misses;
+    }
+
+    return result;
+}
 }
 
-plugin::DirectoryEnumerator::DirectoryEnumerator(const std::set<boost::filesystem::path>& directories)
-    : directories{directories}
+plugin::DirectoryEnumerator::DirectoryEnumerator(const std::set<boost::filesystem::path>& directories, const boost::filesystem::path& cache)
+    : directories{directories},
+      cache{cache}
 {
 }
 
 std::size_t plugin::DirectoryEnumerator::enumerate(const Functor& f) const
 {
-    std::size_t invocations{0};
+    const auto previous = cache.empty() ? DescriptorCache{} : DescriptorCache::load(cache);
 
+    // We scan all directories concurrently, but invoke f sequentially and in order of directories.
+    std::vector<std::future<Scan>> scans;
     for (const auto& directory : directories)
-    {
-        if (not boost::filesystem::is_directory(directory))
-            continue;
+        scans.push_back(std::async(std::launch::async, [&previous, directory]() { return scan(directory, previous); }));
+
+    DescriptorCache current;
+    MajorVersionVerifier verifier;
+
+    std::size_t invocations{0};
+    std::size_t misses{0};
 
-        MajorVersionVerifier verifier;
-        ElfDescriptorLoader loader;
+    for (auto& s : scans)
+    {
+        auto result = s.get();
+        misses += result.misses;
 
-        for (boost::filesystem::directory_iterator it{directory}, itE; it !=  itE; ++it)
+        for (const auto& entry : result.entries)
         {
+            current.insert(entry);
+
+            if (not entry.descriptor)
+                continue;
+
             try
             {
-                auto desc = verifier.verify(loader.load_with_name(it->path(), BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION));
-                f(std::make_shared<PluginDeviceDescriptor>(it->path(), desc));
+                auto desc = verifier.verify(entry.descriptor.get());
+                f(std::make_shared<PluginDeviceDescriptor>(entry.key.path, desc));
                 ++invocations;
             }
-            catch(const ElfDescriptorLoader::FailedToInitializeElf&)
-            {
-                // We silently ignore the exception here as we expect to encounter
-                // files missing a section describing a biometryd plugin. All other
-                // exceptions will be propagated, though.
-            }
-            catch(const ElfDescriptorLoader::NotAnElfObject&)
-            {
-                // We silently ignore the exception here as we expect to encounter
-                // files missing a section describing a biometryd plugin. All other
-                // exceptions will be propagated, though.
-            }
-            catch(const ElfDescriptorLoader::NoSuchSection&)
-            {
-                // We silently ignore the exception here as we expect to encounter
-                // files missing a section describing a biometryd plugin. All other
-                // exceptions will be propagated, though.
-            }
             catch(const MajorVersionVerifier::MajorVersionMismatch&)
             {
                 // We silently ignore major version mismatches as we expect to
@@ -112,5 +152,20 @@ std::size_t plugin::DirectoryEnumerator::enumerate(const Functor& f) const
         }
     }
 
+    // Entries of files that disappeared are dropped by not carrying them over to current.
+    if (not cache.empty() && (misses > 0 || current.size() != previous.size()))
+    {
+        try
+        {
+            current.store(cache);
+        }
+        catch(const std::exception&)
+        {
+            // We silently ignore failures to update the cache, most notably for
+            // CLI invocations lacking permissions to write to the cache. The cache
+            // only speeds up enumeration and we have a valid result at hand.
+        }
+    }
+
     return invocations;
 }
@@ -53,17 +53,22 @@ protected:
 };
 
 /// @brief DirectoryEnumerator implements Enumerator, enumerating all plugins located in a directory.
+///
+/// Directories are scanned concurrently. If a cache file is given, the descriptors found in files are
+/// remembered across enumerations and files that did not change are not inspected again, see DescriptorCache.
 class BIOMETRY_DLL_PUBLIC DirectoryEnumerator : public Enumerator
 {
 public:
-    /// @brief DirectoryEnumerator initializes a new instance with the given directory.
-    explicit DirectoryEnumerator(const std::set<boost::filesystem::path>& directories);
+    /// @brief DirectoryEnumerator initializes a new instance with the given directories, caching descriptors in cache if not empty.
+    explicit DirectoryEnumerator(const std::set<boost::filesystem::path>& directories,
+                                 const boost::filesystem::path& cache = boost::filesystem::path{});
 
     // From Enumerator.
     std::size_t enumerate(const Functor& f) const override;
 
 private:
     std::set<boost::filesystem::path> directories;
+    boost::filesystem::path cache;
 };
 }
 }
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/devices/plugin/loaded_plugin_cache.h>
+
+#include <biometry/devices/plugin/interface.h>
+#include <biometry/devices/plugin/loader.h>
+#include <biometry/devices/plugin/verifier.h>
+
+#include <sstream>
+
+namespace plugin = biometry::devices::plugin;
+
+namespace
+{
+// print inserts a canonical textual form of children into out. Children are ordered by name,
+// and values are tagged with their type, so equal configurations yield equal output.
+void print(std::ostream& out, const biometry::util::Configuration::Children& children)
+{
+    for (const auto& pair : children)
+    {
+        out << pair.first << "=" << static_cast<int>(pair.second.value().type()) << ":" << pair.second.value();
+
+        if (not pair.second.children().empty())
+        {
+            out << "{"; print(out, pair.second.children()); out << "}";
+        }
+
+        out << ";";
+    }
+}
+
+template<typename Key, typename Value>
+void prune(std::map<Key, std::weak_ptr<Value>>& map)
+{
+    for (auto it = map.begin(); it != map.end();)
+        it = it->second.expired() ? map.erase(it) : std::next(it);
+}
+}
+
+plugin::LoadedPluginCache& plugin::LoadedPluginCache::instance()
+{
+    static LoadedPluginCache cache;
+    return cache;
+}
+
+std::shared_ptr<biometry::util::DynamicLibrary> plugin::LoadedPluginCache::library(const std::shared_ptr<util::DynamicLibrary::Api>& api, const boost::filesystem::path& path)
+{
+    std::lock_guard<std::mutex> lg{libraries_guard};
+
+    if (auto library = libraries[path].lock())
+        return library;
+
+    // We only verify when actually opening the library, files are not expected to change while loaded.
+    auto desc = ElfDescriptorLoader{}.find_with_name(path, BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION);
+    if (not desc)
+        throw ElfDescriptorLoader::NoSuchSection{BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION};
+
+    MajorVersionVerifier{}.verify(desc.get());
+
+    auto library = std::make_shared<util::DynamicLibrary>(api, path);
+
+    prune(libraries);
+    libraries[path] = library;
+
+    return library;
+}
+
+std::shared_ptr<biometry::Device> plugin::LoadedPluginCache::device(const std::shared_ptr<util::DynamicLibrary::Api>& api, const boost::filesystem::path& path)
+{
+    auto dl = library(api, path);
+
+    util::DynamicLibrary::Symbol create = dl->resolve_symbol_or_throw(BIOMETRYD_DEVICES_PLUGIN_CREATE_SYMBOL_NAME);
+    util::DynamicLibrary::Symbol destroy = dl->resolve_symbol_or_throw(BIOMETRYD_DEVICES_PLUGIN_DESTROY_SYMBOL_NAME);
+
+    return std::shared_ptr<biometry::Device>{
+        create.as<BiometrydPluginDeviceCreate>()(),
+        // We are passing in dl to keep the library loaded for as long as the
+        // shared plugin instance is alive.
+        [dl, destroy](biometry::Device* dev)
+        {
+            if (dev)
+                destroy.as<BiometrydPluginDeviceDestroy>()(dev);
+        }
+    };
+}
+
+std::shared_ptr<biometry::Device> plugin::LoadedPluginCache::pooled_device(
+        const std::shared_ptr<util::DynamicLibrary::Api>& api,
+        const boost::filesystem::path& path,
+        const util::Configuration& configuration)
+{
+    std::stringstream ss; print(ss, configuration.children());
+    auto key = std::make_pair(path, ss.str());
+
+    std::lock_guard<std::mutex> lg{devices_guard};
+
+    if (auto device = devices[key].lock())
+        return device;
+
+    auto device = this->device(api, path);
+
+    prune(devices);
+    devices[key] = device;
+
+    return device;
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_DEVICES_PLUGIN_LOADED_PLUGIN_CACHE_H_
+#define BIOMETRYD_DEVICES_PLUGIN_LOADED_PLUGIN_CACHE_H_
+
+#include <biometry/device.h>
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <biometry/util/configuration.h>
+#include <biometry/util/dynamic_library.h>
+
+#include <boost/filesystem.hpp>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace biometry
+{
+namespace devices
+{
+namespace plugin
+{
+/// @brief LoadedPluginCache shares loaded plugin libraries, and optionally device instances, across all their users.
+///
+/// A library is opened and verified once, and stays loaded for as long as any device created from it is alive.
+/// Pooled devices are shared by all users requesting a device from the same library with an equal configuration.
+class BIOMETRY_DLL_PUBLIC LoadedPluginCache : public DoNotCopyOrMove
+{
+public:
+    /// @brief instance returns the process-wide instance.
+    static LoadedPluginCache& instance();
+
+    /// @brief LoadedPluginCache initializes a new, empty instance.
+    LoadedPluginCache() = default;
+
+    /// @brief library returns the library located at path, verifying and opening it with api if it is not loaded yet.
+    ///
+    /// If the library is loaded already, it is returned as is, regardless of the binding mode of api.
+    /// @throws ElfDescriptorLoader::NoSuchSection if the library does not describe a plugin.
+    /// @throws MajorVersionVerifier::MajorVersionMismatch if the plugin does not fit with biometryd.
+    /// @throws util::DynamicLibrary::Api::Error in case of issues opening the library.
+    std::shared_ptr<util::DynamicLibrary> library(const std::shared_ptr<util::DynamicLibrary::Api>& api, const boost::filesystem::path& path);
+
+    /// @brief device returns a new device instance created by the library located at path.
+    /// @throws all exceptions thrown by library and util::DynamicLibrary::NoSuchSymbol.
+    std::shared_ptr<biometry::Device> device(const std::shared_ptr<util::DynamicLibrary::Api>& api, const boost::filesystem::path& path);
+
+    /// @brief pooled_device returns the live device created by the library located at path for an equal configuration, or a new one.
+    /// @throws all exceptions thrown by device.
+    std::shared_ptr<biometry::Device> pooled_device(const std::shared_ptr<util::DynamicLibrary::Api>& api,
+                                                    const boost::filesystem::path& path,
+                                                    const util::Configuration& configuration);
+
+private:
+    /// @cond
+    std::mutex libraries_guard;
+    std::map<boost::filesystem::path, std::weak_ptr<util::DynamicLibrary>> libraries;
+    // Pooled devices are keyed by path and the canonical textual form of their configuration.
+    std::mutex devices_guard;
+    std::map<std::pair<boost::filesystem::path, std::string>, std::weak_ptr<biometry::Device>> devices;
+    /// @endcond
+};
+}
+}
+}
+
+#endif // BIOMETRYD_DEVICES_PLUGIN_LOADED_PLUGIN_CACHE_H_
@@ -23,12 +23,17 @@
 
 #include <boost/format.hpp>
 
+#include <cstring>
 #include <iostream>
 #include <system_error>
+#include <type_traits>
 
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 #include <fcntl.h>
 
+#include <elf.h>
 #include <gelf.h>
 
 namespace plugin = biometry::devices::plugin;
@@ -73,6 +78,104 @@ struct Fd
 
     int handle;
 };
+
+/// @brief Mapping performs resource handling of a read-only memory mapping of a file.
+struct Mapping
+{
+    /// @brief Constructs a new instance, mapping size bytes of the file referred to by fd.
+    Mapping(int fd, std::size_t size)
+        : addr{::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0)},
+          size{size}
+    {
+    }
+
+    ~Mapping()
+    {
+        if (addr != MAP_FAILED)
+            ::munmap(addr, size);
+    }
+
+    explicit operator bool() const
+    {
+        return addr != MAP_FAILED;
+    }
+
+    const unsigned char* data() const
+    {
+        return static_cast<const unsigned char*>(addr);
+    }
+
+    void* addr;
+    std::size_t size;
+};
+
+/// @brief read copies an instance of T from offset in the given buffer, returning false if it would exceed the buffer.
+template<typename T>
+bool read(const unsigned char* buffer, std::size_t size, std::uint64_t offset, T& t)
+{
+    if (offset > size || size - offset < sizeof(T))
+        return false;
+
+    std::memcpy(&t, buffer + offset, sizeof(T));
+    return true;
+}
+
+/// @brief find_section walks the section headers of the elf object in buffer, looking for section.
+template<typename Ehdr, typename Shdr>
+biometry::Optional<plugin::Descriptor> find_section(const unsigned char* buffer, std::size_t size, const std::string& section)
+{
+    Ehdr ehdr;
+    if (not read(buffer, size, 0, ehdr) || ehdr.e_shoff == 0 || ehdr.e_shentsize != sizeof(Shdr))
+        return biometry::Optional<plugin::Descriptor>{};
+
+    auto header_at = [buffer, size, &ehdr](std::uint64_t index, Shdr& shdr)
+    {
+        return read(buffer, size, ehdr.e_shoff + index * sizeof(Shdr), shdr);
+    };
+
+    std::uint64_t count{ehdr.e_shnum}, strndx{ehdr.e_shstrndx};
+
+    // Objects with many sections store the actual values in the first section header.
+    if (count == 0 || strndx == SHN_XINDEX)
+    {
+        Shdr first;
+        if (not header_at(0, first))
+            return biometry::Optional<plugin::Descriptor>{};
+
+        if (count == 0) count = first.sh_size;
+        if (strndx == SHN_XINDEX) strndx = first.sh_link;
+    }
+
+    if (count > size / sizeof(Shdr) || strndx >= count)
+        return biometry::Optional<plugin::Descriptor>{};
+
+    Shdr strtab;
+    if (not header_at(strndx, strtab) || strtab.sh_type == SHT_NOBITS || strtab.sh_offset > size || size - strtab.sh_offset < strtab.sh_size)
+        return biometry::Optional<plugin::Descriptor>{};
+
+    const char* names = reinterpret_cast<const char*>(buffer + strtab.sh_offset);
+
+    for (std::uint64_t i = 0; i < count; i++)
+    {
+        Shdr shdr;
+        if (not header_at(i, shdr) || shdr.sh_name >= strtab.sh_size)
+            continue;
+
+        const char* name = names + shdr.sh_name;
+        if (::strnlen(name, strtab.sh_size - shdr.sh_name) != section.size() || section.compare(0, section.size(), name, section.size()) != 0)
+            continue;
+
+        if (shdr.sh_type == SHT_NOBITS || shdr.sh_size != sizeof(plugin::Descriptor))
+            continue;
+
+        // Descriptor has const members and cannot be assigned to, so we copy into suitably aligned storage.
+        typename std::aligned_storage<sizeof(plugin::Descriptor), alignof(plugin::Descriptor)>::type storage;
+        if (read(buffer, size, shdr.sh_offset, storage))
+            return *reinterpret_cast<const plugin::Descriptor*>(&storage);
+    }
+
+    return biometry::Optional<plugin::Descriptor>{};
+}
 }
 
 plugin::ElfDescriptorLoader::FailedToInitializeElf::FailedToInitializeElf()
@@ -130,6 +233,45 @@ plugin::Descriptor plugin::ElfDescriptorLoader::load_with_name(const boost::file
     throw NoSuchSection(section);
 }
 
+biometry::Optional<plugin::Descriptor> plugin::ElfDescriptorLoader::find_with_name(const boost::filesystem::path& p, const std::string& section) const
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    static constexpr const unsigned char host_data{ELFDATA2LSB};
+#else
+    static constexpr const unsigned char host_data{ELFDATA2MSB};
+#endif
+
+    int handle = ::open(p.string().c_str(), O_RDONLY | O_CLOEXEC);
+    if (handle < 0)
+        return Optional<plugin::Descriptor>{};
+
+    Fd fd{handle};
+
+    struct stat st;
+    if (::fstat(fd.handle, &st) != 0 || not S_ISREG(st.st_mode) || st.st_size < EI_NIDENT)
+        return Optional<plugin::Descriptor>{};
+
+    Mapping mapping{fd.handle, static_cast<std::size_t>(st.st_size)};
+    if (not mapping)
+        return Optional<plugin::Descriptor>{};
+
+    auto ident = mapping.data();
+    if (std::memcmp(ident, ELFMAG, SELFMAG) != 0 || ident[EI_DATA] != host_data)
+        return Optional<plugin::Descriptor>{};
+
+    switch (ident[EI_CLASS])
+    {
+    case ELFCLASS32:
+        return find_section<Elf32_Ehdr, Elf32_Shdr>(mapping.data(), mapping.size, section);
+    case ELFCLASS64:
+        return find_section<Elf64_Ehdr, Elf64_Shdr>(mapping.data(), mapping.size, section);
+    default:
+        break;
+    }
+
+    return Optional<plugin::Descriptor>{};
+}
+
 std::shared_ptr<biometry::Device> plugin::ElfDescriptorVerifierLoader::verify_and_load(const std::shared_ptr<util::DynamicLibrary::Api>& api, const boost::filesystem::path& path) const
 {
     MajorVersionVerifier{}.verify(ElfDescriptorLoader{}.load_with_name(path, BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION));
@@ -21,6 +21,7 @@
 #define BIOMETRYD_DEVICES_PLUGIN_LOADER_H_
 
 #include <biometry/device.h>
+#include <biometry/optional.h>
 #include <biometry/visibility.h>
 
 #include <biometry/devices/plugin/interface.h>
@@ -82,6 +83,13 @@ public:
     /// @brief load_with_name opens the dynamic library located at p, tries to find section section, interpreting it as a plugin::Descriptor on return.
     /// @throws NoSuchSection if a section of the given name cannot be found.
     plugin::Descriptor load_with_name(const boost::filesystem::path& p, const std::string& section) const;
+
+    /// @brief find_with_name maps the file located at p into memory, looking up section by walking the section headers directly.
+    ///
+    /// In contrast to load_with_name, find_with_name reports files that cannot be accessed, are not elf objects of the host's
+    /// byte order or lack the section by returning an empty Optional, and never throws. It is meant for scanning directories
+    /// that contain files other than plugins.
+    Optional<plugin::Descriptor> find_with_name(const boost::filesystem::path& p, const std::string& section) const;
 };
 
 /// @brief ElfDescriptorVerifierLoader checks if the biometry::Device plugin contained in the library
@@ -0,0 +1,686 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/scheduling.h>
+
+#include <biometry/application.h>
+#include <biometry/operation.h>
+#include <biometry/optional.h>
+#include <biometry/reason.h>
+#include <biometry/user.h>
+
+#include <biometry/util/metrics.h>
+#include <biometry/util/trace.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Safe us some typing.
+typedef biometry::devices::Scheduling::Kind Kind;
+
+const char* name_of(Kind kind)
+{
+    switch (kind)
+    {
+    case Kind::enrollment: return "enrollment";
+    case Kind::identification: return "identification";
+    case Kind::verification: return "verification";
+    }
+
+    return "unknown";
+}
+
+Kind kind_from_name(const std::string& name)
+{
+    static const Kind kinds[] =
+    {
+        Kind::enrollment, Kind::identification, Kind::verification
+    };
+
+    for (auto kind : kinds)
+        if (name == name_of(kind))
+            return kind;
+
+    throw std::runtime_error{"Unknown kind of operation: " + name};
+}
+
+// Job is an operation waiting for or holding the actual device.
+struct Job
+{
+    Kind kind;
+    int priority;
+    std::uint64_t sequence;
+    biometry::util::trace::Clock::time_point enqueued_at;
+    // trace_id correlates the events of the job with the operation it starts.
+    std::uint64_t trace_id{0};
+    // start starts the actual operation.
+    std::function<void()> start;
+    // cancel cancels the actual operation.
+    std::function<void()> cancel;
+    // drop reports the cancelation of a job that has never been started.
+    std::function<void(const std::string&)> drop;
+    // fail reports a job that failed to start.
+    std::function<void(const std::string&)> fail;
+    // preempted is true if the job has been canceled in favor of a job of higher priority.
+    bool preempted{false};
+    // launched is true once start has returned.
+    bool launched{false};
+    // cancel_pending is true if the job has been canceled before start returned.
+    bool cancel_pending{false};
+    // preempted_at is the point in time when the job has been asked to wind down in favor of another one.
+    std::chrono::steady_clock::time_point preempted_at;
+};
+
+// Watchdog is shared between a scheduler and the thread abandoning preempted jobs that do not wind down in time.
+struct Watchdog
+{
+    std::mutex guard;
+    std::condition_variable wakeup;
+    bool shutdown{false};
+    // deadline is the point in time when the running job is checked next, if any.
+    biometry::Optional<std::chrono::steady_clock::time_point> deadline;
+};
+}
+
+class biometry::devices::Scheduling::Scheduler : public std::enable_shared_from_this<Scheduler>
+{
+public:
+    Scheduler(const Policy& policy) : policy_{policy}
+    {
+    }
+
+    ~Scheduler()
+    {
+        {
+            std::lock_guard<std::mutex> lg{watchdog->guard};
+            watchdog->shutdown = true;
+        }
+        watchdog->wakeup.notify_all();
+
+        if (not watcher.joinable())
+            return;
+
+        // The watcher might drop the last reference to us while abandoning a job.
+        if (watcher.get_id() == std::this_thread::get_id())
+            watcher.detach();
+        else
+            watcher.join();
+    }
+
+    // start fires up the thread abandoning preempted jobs, if the policy asks for it.
+    std::shared_ptr<Scheduler> start()
+    {
+        if (not policy_.preemption || policy_.preemption_timeout <= std::chrono::milliseconds::zero())
+            return shared_from_this();
+
+        // The watcher only holds on to this instance while abandoning a job and
+        // otherwise solely relies on state it shares with the instance.
+        std::weak_ptr<Scheduler> wp{shared_from_this()};
+        auto watchdog = this->watchdog;
+
+        watcher = std::thread{[wp, watchdog]()
+        {
+            std::unique_lock<std::mutex> ul{watchdog->guard};
+
+            while (not watchdog->shutdown)
+            {
+                if (not watchdog->deadline)
+                {
+                    watchdog->wakeup.wait(ul);
+                    continue;
+                }
+
+                auto deadline = *watchdog->deadline;
+                if (std::chrono::steady_clock::now() < deadline)
+                {
+                    watchdog->wakeup.wait_until(ul, deadline);
+                    continue;
+                }
+
+                watchdog->deadline.reset();
+
+                ul.unlock();
+                if (auto sp = wp.lock())
+                    sp->abandon_overdue();
+                ul.lock();
+            }
+        }};
+
+        return shared_from_this();
+    }
+
+    const Policy& policy() const
+    {
+        return policy_;
+    }
+
+    // submit starts job right away if the device is idle, and queues it up otherwise,
+    // preempting the running job if allowed by the policy.
+    void submit(const std::shared_ptr<Job>& job)
+    {
+        static auto& queue_depth = biometry::util::metrics().gauge("scheduler.queue_depth");
+
+        bool launch_now{false};
+        std::shared_ptr<Job> victim;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            job->sequence = next_sequence++;
+            job->enqueued_at = biometry::util::trace::Clock::now();
+
+            if (not running)
+            {
+                running = job;
+                launch_now = true;
+            }
+            else
+            {
+                pending.push_back(job);
+                queue_depth.increment();
+
+                if (policy_.preemption && job->priority > running->priority && not running->preempted)
+                {
+                    running->preempted = true;
+
+                    // A job that is still starting up is canceled by launch once start returned.
+                    if (running->launched)
+                        victim = running;
+                    else
+                        running->cancel_pending = true;
+                }
+            }
+        }
+
+        // We call out without holding the lock, operations might well report synchronously.
+        // Only the decision taken above counts: job might well have been preempted in the meantime.
+        if (launch_now)
+            launch(job);
+        else if (victim)
+            preempt(victim);
+    }
+
+    // withdraw removes job from the queue, or cancels it if it is running.
+    void withdraw(const std::shared_ptr<Job>& job)
+    {
+        static auto& queue_depth = biometry::util::metrics().gauge("scheduler.queue_depth");
+
+        bool was_pending{false};
+        bool is_running{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+
+            auto it = std::find(pending.begin(), pending.end(), job);
+            if (it != pending.end())
+            {
+                pending.erase(it);
+                queue_depth.decrement();
+                was_pending = true;
+            }
+            else if (running == job)
+            {
+                // A job that is still starting up is canceled by launch once start returned.
+                is_running = job->launched;
+                job->cancel_pending = job->cancel_pending || not job->launched;
+            }
+        }
+
+        if (was_pending)
+            job->drop("Canceled by requester");
+        else if (is_running)
+            job->cancel();
+    }
+
+    // release hands the device to the pending job of highest priority, returning
+    // true if job has been preempted.
+    bool release(const std::shared_ptr<Job>& job)
+    {
+        static auto& queue_depth = biometry::util::metrics().gauge("scheduler.queue_depth");
+
+        std::shared_ptr<Job> next;
+        bool preempted{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            // An abandoned job has handed over the device already.
+            if (running != job)
+                return job->preempted;
+
+            preempted = job->preempted;
+            running.reset();
+
+            // Highest priority first, in order of arrival among equal priorities.
+            auto it = std::max_element(pending.begin(), pending.end(), [](const std::shared_ptr<Job>& lhs, const std::shared_ptr<Job>& rhs)
+            {
+                return lhs->priority < rhs->priority || (lhs->priority == rhs->priority && lhs->sequence > rhs->sequence);
+            });
+
+            if (it != pending.end())
+            {
+                next = *it;
+                pending.erase(it);
+                queue_depth.decrement();
+                running = next;
+            }
+        }
+
+        if (next)
+            launch(next);
+
+        return preempted;
+    }
+
+    // abandon_overdue hands the device to the next job if the running job has been
+    // preempted but has not wound down within the preemption timeout.
+    void abandon_overdue()
+    {
+        static auto& abandoned = biometry::util::metrics().counter("scheduler.abandoned");
+
+        std::shared_ptr<Job> job;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            if (not running || not running->preempted || not running->launched)
+                return;
+
+            if (std::chrono::steady_clock::now() < running->preempted_at + policy_.preemption_timeout)
+                return;
+
+            job = running;
+        }
+
+        abandoned.increment();
+        biometry::util::trace::tracer().instant("scheduler", "abandoned", job->trace_id);
+
+        // The job reports its cancelation whenever the device gets around to it.
+        release(job);
+    }
+
+private:
+    void launch(const std::shared_ptr<Job>& job)
+    {
+        static auto& wait = biometry::util::metrics().latency("scheduler.wait_us");
+
+        wait.record_since(job->enqueued_at);
+        biometry::util::metrics().latency(std::string{"scheduler."} + name_of(job->kind) + ".wait_us").record_since(job->enqueued_at);
+        biometry::util::trace::tracer().complete("scheduler", name_of(job->kind), job->enqueued_at, job->trace_id);
+
+        // Queued jobs are launched on the thread of the job finishing before them.
+        biometry::util::trace::Correlation correlation{job->trace_id};
+
+        // A job failing to start never reports back, and would hold the device forever.
+        std::string error;
+
+        try
+        {
+            job->start();
+        }
+        catch (const std::exception& e)
+        {
+            error = e.what();
+        }
+        catch (...)
+        {
+            error = "Failed to start operation";
+        }
+
+        if (not error.empty())
+        {
+            release(job);
+            job->fail(error);
+            return;
+        }
+
+        bool cancel_now{false};
+        bool preempted{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            job->launched = true;
+            cancel_now = running == job && job->cancel_pending;
+            preempted = job->preempted;
+        }
+
+        if (not cancel_now)
+            return;
+
+        if (preempted)
+            preempt(job);
+        else
+            job->cancel();
+    }
+
+    void preempt(const std::shared_ptr<Job>& job)
+    {
+        static auto& preemptions = biometry::util::metrics().counter("scheduler.preemptions");
+
+        preemptions.increment();
+        biometry::util::trace::tracer().instant("scheduler", "preempted", job->trace_id);
+
+        arm(job);
+        job->cancel();
+    }
+
+    // arm makes the watcher abandon job if it has not wound down within the preemption timeout.
+    void arm(const std::shared_ptr<Job>& job)
+    {
+        if (not watcher.joinable())
+            return;
+
+        auto now = std::chrono::steady_clock::now();
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            job->preempted_at = now;
+        }
+
+        {
+            std::lock_guard<std::mutex> lg{watchdog->guard};
+            watchdog->deadline = now + policy_.preemption_timeout;
+        }
+        watchdog->wakeup.notify_all();
+    }
+
+    Policy policy_;
+    std::mutex guard;
+    std::uint64_t next_sequence{0};
+    std::shared_ptr<Job> running;
+    std::vector<std::shared_ptr<Job>> pending;
+    std::shared_ptr<Watchdog> watchdog{std::make_shared<Watchdog>()};
+    std::thread watcher;
+};
+
+namespace
+{
+// ScheduledObserver forwards the events of the actual operation to the requester,
+// releasing the device once the actual operation has finished.
+template<typename T>
+class ScheduledObserver : public biometry::Operation<T>::Observer
+{
+public:
+    typedef typename biometry::Operation<T>::Observer Super;
+
+    ScheduledObserver(const std::shared_ptr<biometry::devices::Scheduling::Scheduler>& scheduler, const std::shared_ptr<Job>& job, const typename Super::Ptr& impl)
+        : scheduler{scheduler},
+          job{job},
+          impl{impl}
+    {
+    }
+
+    void on_started() override
+    {
+        impl->on_started();
+    }
+
+    void on_progress(const typename Super::Progress& progress) override
+    {
+        impl->on_progress(progress);
+    }
+
+    void on_canceled(const typename Super::Reason& reason) override
+    {
+        if (release())
+            impl->on_canceled(biometry::devices::Scheduling::preempted);
+        else
+            impl->on_canceled(reason);
+    }
+
+    void on_failed(const typename Super::Error& error) override
+    {
+        release();
+        impl->on_failed(error);
+    }
+
+    void on_succeeded(const typename Super::Result& result) override
+    {
+        release();
+        impl->on_succeeded(result);
+    }
+
+private:
+    bool release()
+    {
+        auto s = scheduler.lock();
+        auto j = job.lock();
+
+        if (s && j)
+            return s->release(j);
+
+        return false;
+    }
+
+    // The scheduler keeps the job, and with it this observer, alive while it holds the device.
+    std::weak_ptr<biometry::devices::Scheduling::Scheduler> scheduler;
+    std::weak_ptr<Job> job;
+    typename Super::Ptr impl;
+};
+
+// ScheduledOperation submits the actual operation to the scheduler when started.
+template<typename T>
+class ScheduledOperation : public biometry::Operation<T>
+{
+public:
+    typedef typename biometry::Operation<T>::Observer Observer;
+
+    ScheduledOperation(const std::shared_ptr<biometry::devices::Scheduling::Scheduler>& scheduler, Kind kind, int priority, const typename biometry::Operation<T>::Ptr& impl)
+        : scheduler{scheduler},
+          kind{kind},
+          priority{priority},
+          impl{impl}
+    {
+    }
+
+    void start_with_observer(const typename Observer::Ptr& observer) override
+    {
+        bool canceled_before_start{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            canceled_before_start = canceled;
+        }
+
+        if (canceled_before_start)
+        {
+            observer->on_canceled("Canceled by requester");
+            return;
+        }
+
+        auto j = std::make_shared<Job>();
+        j->kind = kind;
+        j->priority = priority;
+        j->trace_id = biometry::util::trace::correlation_id();
+
+        auto relay = std::make_shared<ScheduledObserver<T>>(scheduler, j, observer);
+        j->start = [impl = this->impl, relay]() { impl->start_with_observer(relay); };
+        j->cancel = [impl = this->impl]() { impl->cancel(); };
+        j->drop = [observer](const std::string& reason) { observer->on_canceled(reason); };
+        j->fail = [observer](const std::string& error) { observer->on_failed(error); };
+
+        // Submitting might start the operation, and we must not hold the lock while calling out.
+        scheduler->submit(j);
+
+        bool canceled_while_submitting{false};
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            job = j;
+            canceled_while_submitting = canceled;
+        }
+
+        if (canceled_while_submitting)
+            scheduler->withdraw(j);
+    }
+
+    void cancel() override
+    {
+        std::shared_ptr<Job> j;
+        {
+            std::lock_guard<std::mutex> lg{guard};
+            canceled = true;
+            j = job;
+        }
+
+        if (j)
+            scheduler->withdraw(j);
+    }
+
+private:
+    std::shared_ptr<biometry::devices::Scheduling::Scheduler> scheduler;
+    Kind kind;
+    int priority;
+    typename biometry::Operation<T>::Ptr impl;
+    std::mutex guard;
+    bool canceled{false};
+    std::shared_ptr<Job> job;
+};
+
+template<typename T>
+typename biometry::Operation<T>::Ptr schedule(const std::shared_ptr<biometry::devices::Scheduling::Scheduler>& scheduler, Kind kind, const biometry::Application& app, const typename biometry::Operation<T>::Ptr& impl)
+{
+    return std::make_shared<ScheduledOperation<T>>(scheduler, kind, scheduler->policy().priority_for(kind, app), impl);
+}
+}
+
+constexpr const char* biometry::devices::Scheduling::preempted;
+
+biometry::devices::Scheduling::Policy biometry::devices::Scheduling::Policy::from_configuration(const util::Configuration::Node& node)
+{
+    Policy policy;
+
+    for (const auto& pair : node["priorities"].children())
+        policy.priorities[kind_from_name(pair.first)] = pair.second.value().integer();
+
+    const auto& unlock_applications = node["unlockApplications"].children();
+    if (not unlock_applications.empty())
+    {
+        policy.unlock_applications.clear();
+        for (const auto& pair : unlock_applications)
+            policy.unlock_applications.insert(pair.second.value().string());
+    }
+
+    if (auto n = node["unlockPriority"])
+        policy.unlock_priority = n.value().integer();
+
+    if (auto n = node["preemption"])
+        policy.preemption = n.value().boolean();
+
+    if (auto n = node["preemptionTimeoutMs"])
+        policy.preemption_timeout = std::chrono::milliseconds{std::max<std::int64_t>(0, n.value().integer())};
+
+    return policy;
+}
+
+int biometry::devices::Scheduling::Policy::priority_for(Kind kind, const Application& app) const
+{
+    if ((kind == Kind::identification || kind == Kind::verification) && unlock_applications.count(app.as_string()) > 0)
+        return unlock_priority;
+
+    auto it = priorities.find(kind);
+    return it == priorities.end() ? 0 : it->second;
+}
+
+biometry::devices::Scheduling::TemplateStore::TemplateStore(const std::shared_ptr<Scheduler>& scheduler, const std::shared_ptr<biometry::Device>& impl)
+    : scheduler{scheduler},
+      impl{impl}
+{
+}
+
+biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::devices::Scheduling::TemplateStore::size(const biometry::Application& app, const biometry::User& user)
+{
+    // Size queries, listings, removals and clearances do not need the sensor.
+    return impl->template_store().size(app, user);
+}
+
+biometry::Operation<biometry::TemplateStore::List>::Ptr biometry::devices::Scheduling::TemplateStore::list(const biometry::Application& app, const biometry::User& user)
+{
+    return impl->template_store().list(app, user);
+}
+
+biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::devices::Scheduling::TemplateStore::enroll(const biometry::Application& app, const biometry::User& user)
+{
+    return schedule<biometry::TemplateStore::Enrollment>(scheduler, Kind::enrollment, app, impl->template_store().enroll(app, user));
+}
+
+biometry::Operation<biometry::TemplateStore::Removal>::Ptr biometry::devices::Scheduling::TemplateStore::remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id)
+{
+    return impl->template_store().remove(app, user, id);
+}
+
+biometry::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::devices::Scheduling::TemplateStore::clear(const biometry::Application& app, const biometry::User& user)
+{
+    return impl->template_store().clear(app, user);
+}
+
+biometry::devices::Scheduling::Identifier::Identifier(const std::shared_ptr<Scheduler>& scheduler, const std::shared_ptr<biometry::Device>& impl)
+    : scheduler{scheduler},
+      impl{impl}
+{
+}
+
+biometry::Operation<biometry::Identification>::Ptr biometry::devices::Scheduling::Identifier::identify_user(const biometry::Application& app, const biometry::Reason& reason)
+{
+    return schedule<biometry::Identification>(scheduler, Kind::identification, app, impl->identifier().identify_user(app, reason));
+}
+
+biometry::devices::Scheduling::Verifier::Verifier(const std::shared_ptr<Scheduler>& scheduler, const std::shared_ptr<biometry::Device>& impl)
+    : scheduler{scheduler},
+      impl{impl}
+{
+}
+
+biometry::Operation<biometry::Verification>::Ptr biometry::devices::Scheduling::Verifier::verify_user(const Application& app, const User& user, const Reason& reason)
+{
+    return schedule<biometry::Verification>(scheduler, Kind::verification, app, impl->verifier().verify_user(app, user, reason));
+}
+
+biometry::devices::Scheduling::Scheduling(const std::shared_ptr<biometry::Device>& device)
+    : Scheduling{device, Policy{}}
+{
+}
+
+biometry::devices::Scheduling::Scheduling(const std::shared_ptr<biometry::Device>& device, const Policy& policy)
+    : impl{device},
+      scheduler{std::make_shared<Scheduler>(policy)->start()},
+      template_store_{scheduler, device},
+      identifier_{scheduler, device},
+      verifier_{scheduler, device}
+{
+    if (not impl)
+        throw std::runtime_error{"Missing device implementation"};
+}
+
+biometry::TemplateStore& biometry::devices::Scheduling::template_store()
+{
+    return template_store_;
+}
+
+biometry::Identifier& biometry::devices::Scheduling::identifier()
+{
+    return identifier_;
+}
+
+biometry::Verifier& biometry::devices::Scheduling::verifier()
+{
+    return verifier_;
+}
+
+std::ostream& biometry::devices::operator<<(std::ostream& out, Scheduling::Kind kind)
+{
+    return out << name_of(kind);
+}
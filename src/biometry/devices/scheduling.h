@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DEVICES_SCHEDULING_H_
+#define BIOMETRYD_DEVICES_SCHEDULING_H_
+
+#include <biometry/device.h>
+
+#include <biometry/identifier.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <biometry/util/configuration.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+
+namespace biometry
+{
+namespace devices
+{
+/// @brief Scheduling is a biometry::Device that grants operations access to the sensor of a second biometry::Device by priority.
+///
+/// Only operations capturing from the sensor are scheduled, i.e., enrollments, identifications and
+/// verifications. At most one of them is running on the actual device at any point in time, from being
+/// started until reporting cancelation, failure or success. Operations started in the meantime are queued,
+/// and the one with the highest priority is started next, in order of arrival among equal priorities.
+/// With preemption enabled, starting an operation of higher priority than the running one cancels the
+/// running one, which then reports Scheduling::preempted as the reason for its cancelation. A preempted
+/// operation not winding down within Policy::preemption_timeout is abandoned, handing the sensor to the
+/// next one right away. An operation failing to start reports the failure and hands the sensor to the next one.
+///
+/// Queries and modifications of the template store that do not need the sensor, i.e., size, list, removal
+/// and clearance, are forwarded right away and never wait for a capture to finish.
+class BIOMETRY_DLL_PUBLIC Scheduling : public biometry::Device
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<Scheduling> Ptr;
+
+    /// @brief preempted is the reason reported by operations canceled in favor of an operation of higher priority.
+    static constexpr const char* preempted{"Preempted by an operation of higher priority"};
+
+    /// @brief Kind enumerates all kinds of operations known to the scheduler.
+    enum class Kind
+    {
+        enrollment,
+        identification,
+        verification
+    };
+
+    /// @brief Policy describes how operations are prioritized.
+    struct BIOMETRY_DLL_PUBLIC Policy
+    {
+        /// @brief from_configuration returns the default policy, adjusted by the settings in node.
+        ///
+        /// node is expected to look like:
+        ///   {
+        ///     "priorities": {"identification": 3, "enrollment": 2, ...},
+        ///     "unlockApplications": ["system"],
+        ///     "unlockPriority": 4,
+        ///     "preemption": true,
+        ///     "preemptionTimeoutMs": 3000
+        ///   }
+        /// All entries are optional.
+        /// @throws std::runtime_error if node refers to an unknown kind of operation.
+        static Policy from_configuration(const util::Configuration::Node& node);
+
+        /// @brief priority_for returns the priority of an operation of kind requested by app.
+        int priority_for(Kind kind, const Application& app) const;
+
+        /// @brief Priority by kind of operation, higher values take precedence.
+        std::map<Kind, int> priorities
+        {
+            {Kind::enrollment, 2},
+            {Kind::identification, 3}, {Kind::verification, 3}
+        };
+        /// @brief Applications identifying or verifying users to unlock the device.
+        ///
+        /// The shell talks to the service as Application::system().
+        std::set<std::string> unlock_applications{"system"};
+        /// @brief Priority of identifications and verifications requested by unlock_applications.
+        int unlock_priority{4};
+        /// @brief Whether operations of higher priority preempt running ones.
+        bool preemption{true};
+        /// @brief Time granted to a preempted operation to wind down before the sensor is handed over anyway.
+        ///
+        /// Zero waits for the preempted operation forever.
+        std::chrono::milliseconds preemption_timeout{3000};
+    };
+
+    /// @cond
+    class Scheduler;
+    /// @endcond
+
+    class TemplateStore : public biometry::TemplateStore
+    {
+    public:
+        TemplateStore(const std::shared_ptr<Scheduler>& scheduler, const std::shared_ptr<biometry::Device>& impl);
+
+        // From biometry::TemplateStore.
+        biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr size(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::List>::Ptr list(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr enroll(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Removal>::Ptr remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id) override;
+        biometry::Operation<biometry::TemplateStore::Clearance>::Ptr clear(const biometry::Application& app, const biometry::User& user) override;
+
+    private:
+        std::shared_ptr<Scheduler> scheduler;
+        std::shared_ptr<biometry::Device> impl;
+    };
+
+    class Identifier : public biometry::Identifier
+    {
+    public:
+        Identifier(const std::shared_ptr<Scheduler>& scheduler, const std::shared_ptr<biometry::Device>& impl);
+
+        // From biometry::Identifier.
+        biometry::Operation<biometry::Identification>::Ptr identify_user(const biometry::Application& app, const biometry::Reason& reason) override;
+
+    private:
+        std::shared_ptr<Scheduler> scheduler;
+        std::shared_ptr<biometry::Device> impl;
+    };
+
+    class Verifier : public biometry::Verifier
+    {
+    public:
+        Verifier(const std::shared_ptr<Scheduler>& scheduler, const std::shared_ptr<biometry::Device>& impl);
+
+        // From biometry::Verifier.
+        Operation<Verification>::Ptr verify_user(const Application& app, const User& user, const Reason& reason) override;
+
+    private:
+        std::shared_ptr<Scheduler> scheduler;
+        std::shared_ptr<biometry::Device> impl;
+    };
+
+    /// @brief Scheduling creates a new instance, scheduling calls to device according to the default policy.
+    /// @throws std::runtime_error if device is null.
+    Scheduling(const std::shared_ptr<biometry::Device>& device);
+
+    /// @brief Scheduling creates a new instance, scheduling calls to device according to policy.
+    /// @throws std::runtime_error if device is null.
+    Scheduling(const std::shared_ptr<biometry::Device>& device, const Policy& policy);
+
+    // From biometry::Device
+    biometry::TemplateStore& template_store() override;
+    biometry::Identifier& identifier() override;
+    biometry::Verifier& verifier() override;
+
+private:
+    std::shared_ptr<biometry::Device> impl;
+    std::shared_ptr<Scheduler> scheduler;
+    TemplateStore template_store_;
+    Identifier identifier_;
+    Verifier verifier_;
+};
+
+/// @brief operator<< inserts the name of kind into out.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, Scheduling::Kind kind);
+}
+}
+
+#endif // BIOMETRYD_DEVICES_SCHEDULING_H_
@@ -0,0 +1,605 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/devices/simulated.h>
+#include <biometry/devices/fingerprint_reader.h>
+
+#include <biometry/device_registry.h>
+#include <biometry/runtime.h>
+#include <biometry/void.h>
+
+#include <boost/asio/steady_timer.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+class biometry::devices::Simulated::State
+{
+public:
+    State(boost::asio::io_service& service, const Configuration& configuration)
+        : service(service),
+          configuration(configuration),
+          rng(configuration.seed == 0 ? std::random_device{}() : configuration.seed)
+    {
+    }
+
+    // sample draws a latency from the given distribution.
+    std::chrono::microseconds sample(const Latency& latency)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        return latency.sample(rng);
+    }
+
+    // draw returns a uniformly distributed number in [0, 1).
+    double draw()
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        return std::uniform_real_distribution<double>{0., 1.}(rng);
+    }
+
+    biometry::TemplateStore::SizeQuery::Result size(const biometry::User& user)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        auto it = templates.find(user);
+        return it == templates.end() ? 0 : it->second.size();
+    }
+
+    biometry::TemplateStore::List::Result list(const biometry::User& user)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        auto it = templates.find(user);
+        return it == templates.end() ? biometry::TemplateStore::List::Result{} : it->second;
+    }
+
+    biometry::TemplateStore::Enrollment::Result enroll(const biometry::User& user)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        auto id = ++next_id;
+        templates[user].push_back(id);
+        return id;
+    }
+
+    biometry::TemplateStore::Removal::Result remove(const biometry::User& user, biometry::TemplateStore::TemplateId id)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        auto it = templates.find(user);
+        if (it == templates.end())
+            throw std::runtime_error{"Unknown template id"};
+
+        auto jt = std::find(it->second.begin(), it->second.end(), id);
+        if (jt == it->second.end())
+            throw std::runtime_error{"Unknown template id"};
+
+        it->second.erase(jt);
+        if (it->second.empty())
+            templates.erase(it);
+
+        return id;
+    }
+
+    biometry::TemplateStore::Clearance::Result clear(const biometry::User& user)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        templates.erase(user);
+        return biometry::Void{};
+    }
+
+    // identify picks one of the users with enrolled templates at random.
+    biometry::Identification::Result identify()
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        if (templates.empty())
+        {
+            if (configuration.require_enrollment)
+                throw std::runtime_error{"No templates enrolled"};
+            return biometry::User::current();
+        }
+
+        auto it = templates.begin();
+        std::advance(it, std::uniform_int_distribution<std::size_t>{0, templates.size() - 1}(rng));
+        return it->first;
+    }
+
+    biometry::Verification::Result verify(const biometry::User& user)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        if (templates.count(user) > 0 || not configuration.require_enrollment)
+            return biometry::Verification::Result::verified;
+
+        return biometry::Verification::Result::not_verified;
+    }
+
+    boost::asio::io_service& service;
+    const Configuration configuration;
+
+private:
+    std::mutex guard;
+    std::mt19937 rng;
+    std::map<biometry::User, std::vector<biometry::TemplateStore::TemplateId>> templates;
+    biometry::TemplateStore::TemplateId next_id{0};
+};
+
+namespace
+{
+typedef biometry::devices::Simulated::State State;
+typedef biometry::devices::Simulated::Behavior Behavior;
+typedef biometry::devices::Simulated::Latency Latency;
+
+// SimulatedOperation drives a single simulated operation by means of a timer, reporting
+// progress at evenly spaced points in time until the sampled latency has elapsed.
+// All state transitions happen on a strand, such that canceling an operation and
+// its timer firing are serialized.
+template<typename T>
+class SimulatedOperation : public biometry::Operation<T>, public std::enable_shared_from_this<SimulatedOperation<T>>
+{
+public:
+    typedef typename biometry::Operation<T>::Observer Observer;
+    typedef std::function<typename T::Result()> Completion;
+    typedef std::function<biometry::Dictionary(std::uint32_t, std::uint32_t)> Details;
+
+    SimulatedOperation(const std::shared_ptr<State>& state, const Behavior& behavior, const Completion& completion, const Details& details = Details{})
+        : state{state},
+          behavior(behavior),
+          completion{completion},
+          details{details},
+          strand{state->service},
+          timer{state->service}
+    {
+    }
+
+    void start_with_observer(const typename Observer::Ptr& observer) override
+    {
+        auto sp = this->shared_from_this();
+        strand.dispatch([sp, observer]() { sp->start(observer); });
+    }
+
+    void cancel() override
+    {
+        auto sp = this->shared_from_this();
+        strand.dispatch([sp]() { sp->cancel_now("Operation has been canceled"); });
+    }
+
+private:
+    enum class Status
+    {
+        idle,
+        running,
+        done
+    };
+
+    void start(const typename Observer::Ptr& o)
+    {
+        if (status == Status::running)
+            return;
+
+        observer = o;
+
+        if (status == Status::done)
+        {
+            observer->on_canceled("Operation has been canceled");
+            return;
+        }
+
+        status = Status::running;
+        observer->on_started();
+
+        latency = state->sample(behavior.latency);
+        steps = behavior.progress_events + 1;
+        started_at = std::chrono::steady_clock::now();
+
+        schedule(1);
+    }
+
+    void schedule(std::uint32_t step)
+    {
+        auto sp = this->shared_from_this();
+
+        timer.expires_at(started_at + latency * step / steps);
+        timer.async_wait(strand.wrap([sp, step](const boost::system::error_code& ec)
+        {
+            if (ec)
+                return;
+
+            sp->tick(step);
+        }));
+    }
+
+    void tick(std::uint32_t step)
+    {
+        if (status != Status::running)
+            return;
+
+        if (step < steps)
+        {
+            observer->on_progress(biometry::Progress
+            {
+                biometry::Percent::from_raw_value(static_cast<double>(step) / steps),
+                details ? details(step, steps) : biometry::Dictionary{}
+            });
+
+            schedule(step + 1);
+            return;
+        }
+
+        complete();
+    }
+
+    void complete()
+    {
+        status = Status::done;
+
+        auto p = state->draw();
+
+        if (p < behavior.failure_probability)
+        {
+            observer->on_failed("Simulated failure");
+            return;
+        }
+
+        if (p < behavior.failure_probability + behavior.cancel_probability)
+        {
+            observer->on_canceled("Simulated cancellation");
+            return;
+        }
+
+        typename T::Result result{};
+
+        try
+        {
+            result = completion();
+        }
+        catch (const std::exception& e)
+        {
+            observer->on_failed(e.what());
+            return;
+        }
+
+        observer->on_succeeded(result);
+    }
+
+    void cancel_now(const typename T::Reason& reason)
+    {
+        if (status == Status::done)
+            return;
+
+        auto was_running = status == Status::running;
+        status = Status::done;
+
+        if (not was_running)
+            return;
+
+        timer.cancel();
+        observer->on_canceled(reason);
+    }
+
+    std::shared_ptr<State> state;
+    Behavior behavior;
+    Completion completion;
+    Details details;
+
+    boost::asio::io_service::strand strand;
+    boost::asio::steady_timer timer;
+
+    Status status{Status::idle};
+    typename Observer::Ptr observer;
+    std::chrono::microseconds latency{0};
+    std::uint32_t steps{1};
+    std::chrono::steady_clock::time_point started_at;
+};
+
+// enrollment_hints synthesizes guidance data for the given step of a guided enrollment,
+// with the scanned area growing in horizontal stripes and the suggested direction cycling
+// through all known directions.
+biometry::Dictionary enrollment_hints(std::uint32_t step, std::uint32_t steps)
+{
+    typedef biometry::devices::FingerprintReader FingerprintReader;
+
+    FingerprintReader::GuidedEnrollment::Hints hints;
+    hints.is_finger_present = true;
+    hints.is_main_cluster_identified = 2 * step >= steps;
+    hints.suggested_next_direction = static_cast<FingerprintReader::Direction>(1 + (step - 1) % 8);
+
+    std::vector<biometry::Rectangle> masks;
+    for (std::uint32_t i = 0; i < step; i++)
+        masks.push_back(biometry::Rectangle{
+                            biometry::Point{0., static_cast<double>(i) / steps},
+                            biometry::Point{1., static_cast<double>(i + 1) / steps}});
+    hints.masks = masks;
+
+    return hints.to_dictionary();
+}
+
+double number_or(const biometry::util::Configuration::Node& node, double fallback)
+{
+    if (not node)
+        return fallback;
+
+    switch (node.value().type())
+    {
+    case biometry::Variant::Type::integer:
+        return node.value().integer();
+    case biometry::Variant::Type::floating_point:
+        return node.value().floating_point();
+    default:
+        break;
+    }
+
+    throw std::invalid_argument{"Simulated: expected a number"};
+}
+
+Latency::Distribution distribution_from_string(const std::string& s)
+{
+    if (s == "fixed")
+        return Latency::Distribution::fixed;
+    if (s == "normal")
+        return Latency::Distribution::normal;
+    if (s == "lognormal")
+        return Latency::Distribution::lognormal;
+
+    throw std::invalid_argument{"Simulated: unknown latency distribution " + s};
+}
+
+Behavior behavior_from(const biometry::util::Configuration::Node& node, const Behavior& defaults)
+{
+    // Intermediate nodes do not carry a value and thus evaluate to false,
+    // we consequently only check for the presence of leaves.
+    auto result = defaults;
+
+    const auto& latency = node["latency"];
+    if (latency["distribution"])
+        result.latency.distribution = distribution_from_string(latency["distribution"].value().string());
+    result.latency.mean = std::chrono::milliseconds{static_cast<std::int64_t>(number_or(latency["mean"], result.latency.mean.count()))};
+    result.latency.stddev = std::chrono::milliseconds{static_cast<std::int64_t>(number_or(latency["stddev"], result.latency.stddev.count()))};
+
+    if (result.latency.mean.count() < 0 || result.latency.stddev.count() < 0)
+        throw std::invalid_argument{"Simulated: latencies must not be negative"};
+
+    auto progress_events = number_or(node["progressEvents"], result.progress_events);
+    if (progress_events < 0)
+        throw std::invalid_argument{"Simulated: progressEvents must not be negative"};
+    result.progress_events = static_cast<std::uint32_t>(progress_events);
+
+    result.failure_probability = number_or(node["failureProbability"], result.failure_probability);
+    result.cancel_probability = number_or(node["cancelProbability"], result.cancel_probability);
+
+    if (result.failure_probability < 0 || result.cancel_probability < 0 ||
+        result.failure_probability + result.cancel_probability > 1)
+        throw std::invalid_argument{"Simulated: invalid failure or cancel probability"};
+
+    return result;
+}
+
+Behavior make_behavior(Latency::Distribution distribution, std::chrono::milliseconds mean, std::chrono::milliseconds stddev, std::uint32_t progress_events = 0)
+{
+    Behavior result;
+    result.latency.distribution = distribution;
+    result.latency.mean = mean;
+    result.latency.stddev = stddev;
+    result.progress_events = progress_events;
+    return result;
+}
+}
+
+std::chrono::microseconds biometry::devices::Simulated::Latency::sample(std::mt19937& rng) const
+{
+    double mean_us = std::chrono::duration_cast<std::chrono::microseconds>(mean).count();
+    double stddev_us = std::chrono::duration_cast<std::chrono::microseconds>(stddev).count();
+
+    double value{mean_us};
+
+    switch (distribution)
+    {
+    case Distribution::fixed:
+        break;
+    case Distribution::normal:
+        if (stddev_us > 0)
+            value = std::normal_distribution<double>{mean_us, stddev_us}(rng);
+        break;
+    case Distribution::lognormal:
+        if (mean_us > 0 && stddev_us > 0)
+        {
+            // We parameterize the underlying normal distribution such that the
+            // resulting log-normal distribution has the configured mean and stddev.
+            auto sigma2 = std::log(1. + (stddev_us * stddev_us) / (mean_us * mean_us));
+            auto mu = std::log(mean_us) - sigma2 / 2.;
+            value = std::lognormal_distribution<double>{mu, std::sqrt(sigma2)}(rng);
+        }
+        break;
+    }
+
+    return std::chrono::microseconds{static_cast<std::int64_t>(std::max(0., value))};
+}
+
+biometry::devices::Simulated::Configuration biometry::devices::Simulated::Configuration::from(const util::Configuration::Node& node)
+{
+    using std::chrono::milliseconds;
+
+    Configuration result;
+
+    result.size = behavior_from(node["operations"]["size"], make_behavior(Latency::Distribution::fixed, milliseconds{5}, milliseconds{0}));
+    result.list = behavior_from(node["operations"]["list"], make_behavior(Latency::Distribution::fixed, milliseconds{5}, milliseconds{0}));
+    result.enroll = behavior_from(node["operations"]["enroll"], make_behavior(Latency::Distribution::normal, milliseconds{2000}, milliseconds{200}, 10));
+    result.remove = behavior_from(node["operations"]["remove"], make_behavior(Latency::Distribution::fixed, milliseconds{10}, milliseconds{0}));
+    result.clear = behavior_from(node["operations"]["clear"], make_behavior(Latency::Distribution::fixed, milliseconds{10}, milliseconds{0}));
+    result.identify = behavior_from(node["operations"]["identify"], make_behavior(Latency::Distribution::lognormal, milliseconds{300}, milliseconds{100}));
+    result.verify = behavior_from(node["operations"]["verify"], make_behavior(Latency::Distribution::lognormal, milliseconds{300}, milliseconds{100}));
+
+    if (node["requireEnrollment"])
+        result.require_enrollment = node["requireEnrollment"].value().boolean();
+
+    auto seed = number_or(node["seed"], result.seed);
+    if (seed < 0)
+        throw std::invalid_argument{"Simulated: seed must not be negative"};
+    result.seed = static_cast<std::uint32_t>(seed);
+
+    auto worker_threads = number_or(node["workerThreads"], result.worker_threads);
+    if (worker_threads < 1)
+        throw std::invalid_argument{"Simulated: workerThreads must be at least 1"};
+    result.worker_threads = static_cast<std::uint32_t>(worker_threads);
+
+    return result;
+}
+
+biometry::devices::Simulated::TemplateStore::TemplateStore(const std::shared_ptr<State>& state)
+    : state{state}
+{
+}
+
+biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr biometry::devices::Simulated::TemplateStore::size(const biometry::Application&, const biometry::User& user)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::TemplateStore::SizeQuery>>(state, state->configuration.size, [s, user]()
+    {
+        return s->size(user);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::List>::Ptr biometry::devices::Simulated::TemplateStore::list(const biometry::Application&, const biometry::User& user)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::TemplateStore::List>>(state, state->configuration.list, [s, user]()
+    {
+        return s->list(user);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr biometry::devices::Simulated::TemplateStore::enroll(const biometry::Application&, const biometry::User& user)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::TemplateStore::Enrollment>>(state, state->configuration.enroll, [s, user]()
+    {
+        return s->enroll(user);
+    }, enrollment_hints);
+}
+
+biometry::Operation<biometry::TemplateStore::Removal>::Ptr biometry::devices::Simulated::TemplateStore::remove(const biometry::Application&, const biometry::User& user, biometry::TemplateStore::TemplateId id)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::TemplateStore::Removal>>(state, state->configuration.remove, [s, user, id]()
+    {
+        return s->remove(user, id);
+    });
+}
+
+biometry::Operation<biometry::TemplateStore::Clearance>::Ptr biometry::devices::Simulated::TemplateStore::clear(const biometry::Application&, const biometry::User& user)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::TemplateStore::Clearance>>(state, state->configuration.clear, [s, user]()
+    {
+        return s->clear(user);
+    });
+}
+
+biometry::devices::Simulated::Identifier::Identifier(const std::shared_ptr<State>& state)
+    : state{state}
+{
+}
+
+biometry::Operation<biometry::Identification>::Ptr biometry::devices::Simulated::Identifier::identify_user(const biometry::Application&, const biometry::Reason&)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::Identification>>(state, state->configuration.identify, [s]()
+    {
+        return s->identify();
+    });
+}
+
+biometry::devices::Simulated::Verifier::Verifier(const std::shared_ptr<State>& state)
+    : state{state}
+{
+}
+
+biometry::Operation<biometry::Verification>::Ptr biometry::devices::Simulated::Verifier::verify_user(const biometry::Application&, const biometry::User& user, const biometry::Reason&)
+{
+    auto s = state;
+    return std::make_shared<SimulatedOperation<biometry::Verification>>(state, state->configuration.verify, [s, user]()
+    {
+        return s->verify(user);
+    });
+}
+
+biometry::devices::Simulated::Simulated(const Configuration& configuration)
+    : runtime{Runtime::create(configuration.worker_threads)},
+      state{std::make_shared<State>(runtime->service(), configuration)},
+      template_store_{state},
+      identifier_{state},
+      verifier_{state}
+{
+    runtime->start();
+}
+
+biometry::devices::Simulated::~Simulated()
+{
+    runtime->stop();
+}
+
+biometry::TemplateStore& biometry::devices::Simulated::template_store()
+{
+    return template_store_;
+}
+
+biometry::Identifier& biometry::devices::Simulated::identifier()
+{
+    return identifier_;
+}
+
+biometry::Verifier& biometry::devices::Simulated::verifier()
+{
+    return verifier_;
+}
+
+namespace
+{
+struct SimulatedDescriptor : public biometry::Device::Descriptor
+{
+    std::shared_ptr<biometry::Device> create(const biometry::util::Configuration& config) override
+    {
+        return std::make_shared<biometry::devices::Simulated>(
+                    biometry::devices::Simulated::Configuration::from(config["config"]));
+    }
+
+    std::string name() const override
+    {
+        return "Simulated";
+    }
+
+    std::string author() const override
+    {
+        return "Thomas Voß (thomas.voss@canonical.com)";
+    }
+
+    std::string description() const override
+    {
+        return "Simulated is a biometry::Device implementation with configurable latencies and failures.";
+    }
+};
+}
+
+biometry::Device::Descriptor::Ptr biometry::devices::Simulated::make_descriptor()
+{
+    return std::make_shared<SimulatedDescriptor>();
+}
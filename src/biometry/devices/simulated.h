@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRYD_DEVICES_SIMULATED_H_
+#define BIOMETRYD_DEVICES_SIMULATED_H_
+
+#include <biometry/device.h>
+
+#include <biometry/identifier.h>
+#include <biometry/template_store.h>
+#include <biometry/verifier.h>
+
+#include <biometry/util/configuration.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+
+namespace biometry
+{
+/// @cond
+class Runtime;
+/// @endcond
+
+namespace devices
+{
+/// @brief Simulated is a biometry::Device that mimics the timing and failure
+/// behavior of real hardware, for benchmarking and testing purposes.
+///
+/// Every operation waits for a latency drawn from a configurable distribution,
+/// reports a configurable number of progress events in between and finally
+/// succeeds, fails or cancels itself with configurable probabilities. Enrolled
+/// templates are kept in memory, keyed by user. Operations are driven by timers
+/// on a runtime owned by the device and thus execute concurrently. Operations
+/// must not outlive the device that created them.
+///
+/// The device is configured from a JSON snippet of the form:
+///   {
+///     "seed": 42,
+///     "workerThreads": 2,
+///     "requireEnrollment": false,
+///     "operations":
+///     {
+///       "identify":
+///       {
+///         "latency": { "distribution": "lognormal", "mean": 300, "stddev": 100 },
+///         "progressEvents": 0,
+///         "failureProbability": 0.01,
+///         "cancelProbability": 0.0
+///       },
+///       "enroll": { "latency": { "distribution": "fixed", "mean": 2000 }, "progressEvents": 10 }
+///     }
+///   }
+/// with operations being any of size, list, enroll, remove, clear, identify and verify.
+/// Latencies are given in milliseconds.
+class BIOMETRY_DLL_PUBLIC Simulated : public biometry::Device
+{
+public:
+    static constexpr const char* id{"Simulated"};
+
+    /// @brief Latency describes the distribution that operation latencies are drawn from.
+    struct Latency
+    {
+        /// @brief Distribution enumerates all known latency distributions.
+        enum class Distribution
+        {
+            fixed,      ///< Every operation takes exactly mean.
+            normal,     ///< Normally distributed around mean, clamped at 0.
+            lognormal   ///< Log-normally distributed with the given mean and stddev.
+        };
+
+        /// @brief sample draws a latency from the distribution, using rng.
+        std::chrono::microseconds sample(std::mt19937& rng) const;
+
+        Distribution distribution{Distribution::fixed};
+        std::chrono::milliseconds mean{0};
+        std::chrono::milliseconds stddev{0};
+    };
+
+    /// @brief Behavior describes how a single kind of operation behaves.
+    struct Behavior
+    {
+        Latency latency{};                  ///< Time until an operation reaches a terminal state.
+        std::uint32_t progress_events{0};   ///< Number of progress events, evenly spread over the latency.
+        double failure_probability{0.};     ///< Probability of an operation failing.
+        double cancel_probability{0.};      ///< Probability of an operation canceling itself.
+    };
+
+    /// @brief Configuration bundles the behavior of all operations of a Simulated device.
+    struct Configuration
+    {
+        /// @brief from parses a Configuration from node, falling back to defaults
+        /// for all values not present in node.
+        ///
+        /// Throws std::invalid_argument if node contains invalid values.
+        static Configuration from(const util::Configuration::Node& node);
+
+        Behavior size{};
+        Behavior list{};
+        Behavior enroll{};
+        Behavior remove{};
+        Behavior clear{};
+        Behavior identify{};
+        Behavior verify{};
+
+        /// @brief If true, identification and verification fail for users without templates.
+        bool require_enrollment{false};
+        /// @brief Seed of the random number generator, 0 selects a random seed.
+        std::uint32_t seed{0};
+        /// @brief Number of threads driving the operations of the device.
+        std::uint32_t worker_threads{2};
+    };
+
+    /// @brief State is shared by a Simulated device and all of its operations.
+    class State;
+
+    class TemplateStore : public biometry::TemplateStore
+    {
+    public:
+        /// @brief TemplateStore initializes a new instance operating on state.
+        explicit TemplateStore(const std::shared_ptr<State>& state);
+
+        // From biometry::TemplateStore.
+        biometry::Operation<biometry::TemplateStore::SizeQuery>::Ptr size(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::List>::Ptr list(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Enrollment>::Ptr enroll(const biometry::Application& app, const biometry::User& user) override;
+        biometry::Operation<biometry::TemplateStore::Removal>::Ptr remove(const biometry::Application& app, const biometry::User& user, biometry::TemplateStore::TemplateId id) override;
+        biometry::Operation<biometry::TemplateStore::Clearance>::Ptr clear(const biometry::Application& app, const biometry::User& user) override;
+
+    private:
+        /// @cond
+        std::shared_ptr<State> state;
+        /// @endcond
+    };
+
+    class Identifier : public biometry::Identifier
+    {
+    public:
+        /// @brief Identifier initializes a new instance operating on state.
+        explicit Identifier(const std::shared_ptr<State>& state);
+
+        // From biometry::Identifier.
+        biometry::Operation<biometry::Identification>::Ptr identify_user(const biometry::Application& app, const biometry::Reason& reason) override;
+
+    private:
+        /// @cond
+        std::shared_ptr<State> state;
+        /// @endcond
+    };
+
+    class Verifier : public biometry::Verifier
+    {
+    public:
+        /// @brief Verifier initializes a new instance operating on state.
+        explicit Verifier(const std::shared_ptr<State>& state);
+
+        // From biometry::Verifier.
+        biometry::Operation<biometry::Verification>::Ptr verify_user(const biometry::Application& app, const biometry::User& user, const biometry::Reason& reason) override;
+
+    private:
+        /// @cond
+        std::shared_ptr<State> state;
+        /// @endcond
+    };
+
+    /// @brief make_descriptor returns a descriptor instance describing a Simulated device.
+    static Descriptor::Ptr make_descriptor();
+
+    /// @brief Simulated initializes a new instance, behaving according to configuration.
+    explicit Simulated(const Configuration& configuration);
+    /// @brief ~Simulated stops the runtime driving outstanding operations.
+    ~Simulated();
+
+    // From biometry::Device
+    biometry::TemplateStore& template_store() override;
+    biometry::Identifier& identifier() override;
+    biometry::Verifier& verifier() override;
+
+private:
+    /// @cond
+    std::shared_ptr<Runtime> runtime;
+    std::shared_ptr<State> state;
+    TemplateStore template_store_;
+    Identifier identifier_;
+    Verifier verifier_;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRYD_DEVICES_SIMULATED_H_
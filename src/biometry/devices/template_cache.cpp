@@ -0,0 +1,290 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/template_cache.h>
+
+#include <sqlite3.h>
+
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+// schema_version is stored as the user_version of the database. Databases
+// with a different version are wiped and set up from scratch.
+constexpr const int schema_version{1};
+
+constexpr const char* schema
+{
+    "CREATE TABLE IF NOT EXISTS entries (app TEXT NOT NULL, uid INTEGER NOT NULL, size INTEGER NOT NULL, listed INTEGER NOT NULL, PRIMARY KEY (app, uid));"
+    "CREATE TABLE IF NOT EXISTS templates (app TEXT NOT NULL, uid INTEGER NOT NULL, id INTEGER NOT NULL, PRIMARY KEY (app, uid, id));"
+};
+
+std::runtime_error error_for(sqlite3* db, const std::string& what)
+{
+    return std::runtime_error{what + ": " + sqlite3_errmsg(db)};
+}
+}
+
+class biometry::devices::TemplateCache::Statement
+{
+public:
+    Statement(sqlite3* db, const char* sql) : db{db}, stmt{nullptr}
+    {
+        if (SQLITE_OK != sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr))
+            throw error_for(db, "Failed to prepare statement");
+    }
+
+    ~Statement()
+    {
+        sqlite3_finalize(stmt);
+    }
+
+    Statement& bind(const Application& app, const User& user)
+    {
+        if (SQLITE_OK != sqlite3_bind_text(stmt, 1, app.as_string().c_str(), -1, SQLITE_TRANSIENT))
+            throw error_for(db, "Failed to bind application");
+        return bind(2, user.id);
+    }
+
+    Statement& bind(int index, std::uint64_t value)
+    {
+        if (SQLITE_OK != sqlite3_bind_int64(stmt, index, static_cast<sqlite3_int64>(value)))
+            throw error_for(db, "Failed to bind value");
+        return *this;
+    }
+
+    // step advances to the next row, returning false if there is none.
+    bool step()
+    {
+        switch (sqlite3_step(stmt))
+        {
+        case SQLITE_ROW:
+            return true;
+        case SQLITE_DONE:
+            return false;
+        default:
+            throw error_for(db, "Failed to execute statement");
+        }
+    }
+
+    std::uint64_t integer(int column) const
+    {
+        return static_cast<std::uint64_t>(sqlite3_column_int64(stmt, column));
+    }
+
+    std::string text(int column) const
+    {
+        auto value = sqlite3_column_text(stmt, column);
+        return value ? std::string{reinterpret_cast<const char*>(value)} : std::string{};
+    }
+
+private:
+    sqlite3* db;
+    sqlite3_stmt* stmt;
+};
+
+constexpr const char* biometry::devices::TemplateCache::in_memory;
+
+biometry::devices::TemplateCache::Ptr biometry::devices::TemplateCache::open(const boost::filesystem::path& path)
+{
+    if (path.string() != in_memory && path.has_parent_path())
+        boost::filesystem::create_directories(path.parent_path());
+
+    sqlite3* db{nullptr};
+    if (SQLITE_OK != sqlite3_open_v2(path.string().c_str(), &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, nullptr))
+    {
+        auto e = error_for(db, "Failed to open template cache " + path.string());
+        sqlite3_close(db);
+        throw e;
+    }
+
+    // We hand over ownership of db before initializing the schema, such that it is closed on error.
+    Ptr cache{new TemplateCache{db}};
+
+    int version{0};
+    {
+        Statement stmt{db, "PRAGMA user_version;"};
+        if (stmt.step())
+            version = static_cast<int>(stmt.integer(0));
+    }
+
+    if (version != schema_version)
+        cache->execute("DROP TABLE IF EXISTS entries; DROP TABLE IF EXISTS templates;");
+
+    cache->execute(schema);
+    cache->execute(("PRAGMA user_version = " + std::to_string(schema_version) + ";").c_str());
+
+    return cache;
+}
+
+biometry::devices::TemplateCache::TemplateCache(sqlite3* db) : db{db}
+{
+}
+
+biometry::devices::TemplateCache::~TemplateCache()
+{
+    sqlite3_close(db);
+}
+
+biometry::Optional<std::uint32_t> biometry::devices::TemplateCache::size(const Application& app, const User& user) const
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    Statement stmt{db, "SELECT size FROM entries WHERE app = ?1 AND uid = ?2;"};
+    if (not stmt.bind(app, user).step())
+        return Optional<std::uint32_t>{};
+
+    return static_cast<std::uint32_t>(stmt.integer(0));
+}
+
+biometry::Optional<std::vector<biometry::TemplateStore::TemplateId>> biometry::devices::TemplateCache::list(const Application& app, const User& user) const
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    Statement entry{db, "SELECT listed FROM entries WHERE app = ?1 AND uid = ?2;"};
+    if (not entry.bind(app, user).step() || entry.integer(0) == 0)
+        return Optional<std::vector<TemplateStore::TemplateId>>{};
+
+    std::vector<TemplateStore::TemplateId> ids;
+    Statement stmt{db, "SELECT id FROM templates WHERE app = ?1 AND uid = ?2 ORDER BY id;"};
+    stmt.bind(app, user);
+    while (stmt.step())
+        ids.push_back(stmt.integer(0));
+
+    return ids;
+}
+
+void biometry::devices::TemplateCache::store_size(const Application& app, const User& user, std::uint32_t size)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    transaction([&]()
+    {
+        // Ids recorded before stay valid only if their number matches.
+        Statement update{db, "UPDATE entries SET listed = (listed AND size = ?3), size = ?3 WHERE app = ?1 AND uid = ?2;"};
+        update.bind(app, user).bind(3, size).step();
+
+        Statement insert{db, "INSERT OR IGNORE INTO entries (app, uid, size, listed) VALUES (?1, ?2, ?3, 0);"};
+        insert.bind(app, user).bind(3, size).step();
+
+        Statement prune{db, "DELETE FROM templates WHERE app = ?1 AND uid = ?2 AND NOT EXISTS (SELECT 1 FROM entries WHERE app = ?1 AND uid = ?2 AND listed);"};
+        prune.bind(app, user).step();
+    });
+}
+
+void biometry::devices::TemplateCache::store_list(const Application& app, const User& user, const std::vector<TemplateStore::TemplateId>& ids)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    transaction([&]()
+    {
+        Statement entry{db, "INSERT OR REPLACE INTO entries (app, uid, size, listed) VALUES (?1, ?2, ?3, 1);"};
+        entry.bind(app, user).bind(3, ids.size()).step();
+
+        Statement clear{db, "DELETE FROM templates WHERE app = ?1 AND uid = ?2;"};
+        clear.bind(app, user).step();
+
+        for (auto id : ids)
+        {
+            Statement insert{db, "INSERT OR IGNORE INTO templates (app, uid, id) VALUES (?1, ?2, ?3);"};
+            insert.bind(app, user).bind(3, id).step();
+        }
+    });
+}
+
+void biometry::devices::TemplateCache::enrolled(const Application& app, const User& user, TemplateStore::TemplateId id)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    transaction([&]()
+    {
+        Statement insert{db, "INSERT OR IGNORE INTO templates (app, uid, id) SELECT app, uid, ?3 FROM entries WHERE app = ?1 AND uid = ?2 AND listed;"};
+        insert.bind(app, user).bind(3, id).step();
+
+        Statement update{db, "UPDATE entries SET size = CASE WHEN listed THEN (SELECT COUNT(*) FROM templates WHERE app = ?1 AND uid = ?2) ELSE size + 1 END WHERE app = ?1 AND uid = ?2;"};
+        update.bind(app, user).step();
+    });
+}
+
+void biometry::devices::TemplateCache::removed(const Application& app, const User& user, TemplateStore::TemplateId id)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    transaction([&]()
+    {
+        Statement remove{db, "DELETE FROM templates WHERE app = ?1 AND uid = ?2 AND id = ?3;"};
+        remove.bind(app, user).bind(3, id).step();
+
+        Statement update{db, "UPDATE entries SET size = CASE WHEN listed THEN (SELECT COUNT(*) FROM templates WHERE app = ?1 AND uid = ?2) WHEN size > 0 THEN size - 1 ELSE 0 END WHERE app = ?1 AND uid = ?2;"};
+        update.bind(app, user).step();
+    });
+}
+
+void biometry::devices::TemplateCache::invalidate(const Application& app, const User& user)
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    transaction([&]()
+    {
+        Statement entry{db, "DELETE FROM entries WHERE app = ?1 AND uid = ?2;"};
+        entry.bind(app, user).step();
+
+        Statement templates{db, "DELETE FROM templates WHERE app = ?1 AND uid = ?2;"};
+        templates.bind(app, user).step();
+    });
+}
+
+std::vector<biometry::devices::TemplateCache::Key> biometry::devices::TemplateCache::keys() const
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    std::vector<Key> keys;
+    Statement stmt{db, "SELECT app, uid FROM entries ORDER BY app, uid;"};
+    while (stmt.step())
+        keys.push_back(Key{Application{stmt.text(0)}, User{static_cast<uid_t>(stmt.integer(1))}});
+
+    return keys;
+}
+
+void biometry::devices::TemplateCache::transaction(const std::function<void()>& f)
+{
+    execute("BEGIN;");
+    try
+    {
+        f();
+        execute("COMMIT;");
+    }
+    catch (...)
+    {
+        execute("ROLLBACK;");
+        throw;
+    }
+}
+
+void biometry::devices::TemplateCache::execute(const char* sql)
+{
+    char* message{nullptr};
+    if (SQLITE_OK != sqlite3_exec(db, sql, nullptr, nullptr, &message))
+    {
+        std::string what{message ? message : "unknown error"};
+        sqlite3_free(message);
+        throw std::runtime_error{"Failed to execute " + std::string{sql} + ": " + what};
+    }
+}
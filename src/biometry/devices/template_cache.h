@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_DEVICES_TEMPLATE_CACHE_H_
+#define BIOMETRYD_DEVICES_TEMPLATE_CACHE_H_
+
+#include <biometry/application.h>
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/optional.h>
+#include <biometry/template_store.h>
+#include <biometry/user.h>
+#include <biometry/visibility.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/// @cond
+struct sqlite3;
+/// @endcond
+
+namespace biometry
+{
+namespace devices
+{
+/// @brief TemplateCache persists the template metadata of (application, user) pairs in an SQLite database.
+///
+/// For every pair, the cache either knows nothing, only the number of templates or the
+/// number of templates together with their ids. All functions are thread-safe.
+class BIOMETRY_DLL_PUBLIC TemplateCache : public DoNotCopyOrMove
+{
+public:
+    // Safe us some typing.
+    typedef std::shared_ptr<TemplateCache> Ptr;
+
+    /// @brief Key identifies an entry of the cache.
+    typedef std::pair<Application, User> Key;
+
+    /// @brief in_memory is the path opening a cache that is not persisted.
+    static constexpr const char* in_memory{":memory:"};
+
+    /// @brief open opens the cache persisted at path, creating it if it does not exist yet.
+    /// @throws std::runtime_error if the database cannot be opened or initialized.
+    static Ptr open(const boost::filesystem::path& path);
+
+    /// @brief Closes the underlying database.
+    ~TemplateCache();
+
+    /// @brief size returns the number of templates known for app and user.
+    Optional<std::uint32_t> size(const Application& app, const User& user) const;
+
+    /// @brief list returns the ids of all templates known for app and user.
+    Optional<std::vector<TemplateStore::TemplateId>> list(const Application& app, const User& user) const;
+
+    /// @brief store_size records the number of templates for app and user.
+    ///
+    /// Previously recorded ids are dropped unless their number matches size.
+    void store_size(const Application& app, const User& user, std::uint32_t size);
+
+    /// @brief store_list records the ids of all templates for app and user.
+    void store_list(const Application& app, const User& user, const std::vector<TemplateStore::TemplateId>& ids);
+
+    /// @brief enrolled accounts for a new template id for app and user, if the cache knows about them.
+    void enrolled(const Application& app, const User& user, TemplateStore::TemplateId id);
+
+    /// @brief removed accounts for the removal of template id for app and user, if the cache knows about them.
+    void removed(const Application& app, const User& user, TemplateStore::TemplateId id);
+
+    /// @brief invalidate drops everything known about app and user.
+    void invalidate(const Application& app, const User& user);
+
+    /// @brief keys returns the keys of all entries known to the cache.
+    std::vector<Key> keys() const;
+
+private:
+    /// @cond
+    class Statement;
+
+    TemplateCache(sqlite3* db);
+
+    // transaction executes f within a transaction, rolling back if f throws.
+    void transaction(const std::function<void()>& f);
+    // execute executes all statements in sql.
+    void execute(const char* sql);
+
+    mutable std::mutex guard;
+    sqlite3* db;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRYD_DEVICES_TEMPLATE_CACHE_H_
@@ -0,0 +1,216 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dictionary.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace
+{
+// compare returns <0, 0 or >0 if lhs sorts before, equal to or after rhs, like std::string::compare.
+int compare(const char* lhs, std::size_t lhs_size, const char* rhs, std::size_t rhs_size)
+{
+    if (auto rc = std::char_traits<char>::compare(lhs, rhs, std::min(lhs_size, rhs_size)))
+        return rc;
+
+    return lhs_size < rhs_size ? -1 : (lhs_size > rhs_size ? 1 : 0);
+}
+}
+
+biometry::Dictionary::Key biometry::Dictionary::Key::from_static(const char* s)
+{
+    return Key{s, std::char_traits<char>::length(s)};
+}
+
+biometry::Dictionary::Key::Key(const char* s) : static_data{nullptr}, static_size{0}, owned{s}
+{
+}
+
+biometry::Dictionary::Key::Key(const std::string& s) : static_data{nullptr}, static_size{0}, owned{s}
+{
+}
+
+biometry::Dictionary::Key::Key(std::string&& s) : static_data{nullptr}, static_size{0}, owned{std::move(s)}
+{
+}
+
+biometry::Dictionary::Key::Key(const char* data, std::size_t size) : static_data{data}, static_size{size}
+{
+}
+
+const char* biometry::Dictionary::Key::c_str() const
+{
+    return static_data ? static_data : owned.c_str();
+}
+
+std::size_t biometry::Dictionary::Key::size() const
+{
+    return static_data ? static_size : owned.size();
+}
+
+std::string biometry::Dictionary::Key::str() const
+{
+    return std::string(c_str(), size());
+}
+
+biometry::Dictionary::Dictionary(std::initializer_list<value_type> values)
+{
+    entries.reserve(values.size());
+    for (const auto& value : values)
+        (*this)[value.first] = value.second;
+}
+
+biometry::Dictionary::iterator biometry::Dictionary::begin()
+{
+    return entries.begin();
+}
+
+biometry::Dictionary::iterator biometry::Dictionary::end()
+{
+    return entries.end();
+}
+
+biometry::Dictionary::const_iterator biometry::Dictionary::begin() const
+{
+    return entries.begin();
+}
+
+biometry::Dictionary::const_iterator biometry::Dictionary::end() const
+{
+    return entries.end();
+}
+
+biometry::Dictionary::const_iterator biometry::Dictionary::cbegin() const
+{
+    return entries.cbegin();
+}
+
+biometry::Dictionary::const_iterator biometry::Dictionary::cend() const
+{
+    return entries.cend();
+}
+
+bool biometry::Dictionary::empty() const
+{
+    return entries.empty();
+}
+
+biometry::Dictionary::size_type biometry::Dictionary::size() const
+{
+    return entries.size();
+}
+
+void biometry::Dictionary::clear()
+{
+    entries.clear();
+}
+
+void biometry::Dictionary::reserve(size_type n)
+{
+    entries.reserve(n);
+}
+
+std::pair<biometry::Dictionary::iterator, bool> biometry::Dictionary::insert(value_type value)
+{
+    auto view = view_of(value.first);
+    auto it = lower_bound(view);
+
+    if (it != entries.end() && equals(it->first, view))
+        return std::make_pair(it, false);
+
+    return std::make_pair(entries.insert(it, std::move(value)), true);
+}
+
+biometry::Dictionary::iterator biometry::Dictionary::erase(const_iterator it)
+{
+    return entries.erase(it);
+}
+
+biometry::Dictionary::View biometry::Dictionary::view_of(const char* key)
+{
+    return View{key, std::char_traits<char>::length(key)};
+}
+
+biometry::Dictionary::View biometry::Dictionary::view_of(const std::string& key)
+{
+    return View{key.c_str(), key.size()};
+}
+
+biometry::Dictionary::View biometry::Dictionary::view_of(const Key& key)
+{
+    return View{key.c_str(), key.size()};
+}
+
+biometry::Dictionary::const_iterator biometry::Dictionary::lower_bound(View view) const
+{
+    return std::lower_bound(entries.begin(), entries.end(), view, [](const value_type& entry, const View& view)
+    {
+        return compare(entry.first.c_str(), entry.first.size(), view.data, view.size) < 0;
+    });
+}
+
+biometry::Dictionary::iterator biometry::Dictionary::lower_bound(View view)
+{
+    return std::lower_bound(entries.begin(), entries.end(), view, [](const value_type& entry, const View& view)
+    {
+        return compare(entry.first.c_str(), entry.first.size(), view.data, view.size) < 0;
+    });
+}
+
+bool biometry::Dictionary::equals(const Key& key, View view)
+{
+    // Static keys are frequently looked up with the very same pointer.
+    if (key.c_str() == view.data)
+        return key.size() == view.size;
+
+    return compare(key.c_str(), key.size(), view.data, view.size) == 0;
+}
+
+void biometry::Dictionary::throw_out_of_range(View view)
+{
+    throw std::out_of_range{"Dictionary::at: unknown key " + std::string(view.data, view.size)};
+}
+
+bool biometry::operator==(const Dictionary::Key& lhs, const Dictionary::Key& rhs)
+{
+    return compare(lhs.c_str(), lhs.size(), rhs.c_str(), rhs.size()) == 0;
+}
+
+bool biometry::operator<(const Dictionary::Key& lhs, const Dictionary::Key& rhs)
+{
+    return compare(lhs.c_str(), lhs.size(), rhs.c_str(), rhs.size()) < 0;
+}
+
+std::ostream& biometry::operator<<(std::ostream& out, const Dictionary::Key& key)
+{
+    return out.write(key.c_str(), key.size());
+}
+
+bool biometry::operator==(const Dictionary& lhs, const Dictionary& rhs)
+{
+    return lhs.size() == rhs.size() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+bool biometry::operator!=(const Dictionary& lhs, const Dictionary& rhs)
+{
+    return not (lhs == rhs);
+}
@@ -28,6 +28,11 @@ biometry::DispatchingService::DispatchingService(const std::shared_ptr<biometry:
 {
 }
 
+biometry::DispatchingService::DispatchingService(const biometry::util::DispatcherFactory& factory, const std::shared_ptr<Device>& default_device)
+    : default_device_{std::make_shared<devices::Dispatching>(factory, default_device)}
+{
+}
+
 std::shared_ptr<biometry::Device> biometry::DispatchingService::default_device() const
 {
     return default_device_;
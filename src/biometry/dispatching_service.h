@@ -37,6 +37,10 @@ public:
     /// @brief DispatchingService initializes a new instance with the given default_device.
     DispatchingService(const std::shared_ptr<biometry::util::Dispatcher>& dispatcher, const std::shared_ptr<Device>& default_device);
 
+    /// @brief DispatchingService initializes a new instance with the given default_device, dispatching
+    /// calls to each of its interfaces through a separate dispatcher created by factory.
+    DispatchingService(const biometry::util::DispatcherFactory& factory, const std::shared_ptr<Device>& default_device);
+
     // From Service.
     std::shared_ptr<Device> default_device() const override;
 
@@ -21,6 +21,7 @@
 
 #include <biometry/qml/Biometryd/identifier.h>
 #include <biometry/qml/Biometryd/template_store.h>
+#include <biometry/qml/Biometryd/verifier.h>
 
 biometry::qml::Device::Device(const std::shared_ptr<biometry::Device>& impl, QObject* parent)
     : QObject{parent},
@@ -37,3 +38,8 @@ biometry::qml::Identifier* biometry::qml::Device::identifier()
 {
     return new Identifier{impl->identifier(), this};
 }
+
+biometry::qml::Verifier* biometry::qml::Device::verifier()
+{
+    return new Verifier{impl->verifier(), this};
+}
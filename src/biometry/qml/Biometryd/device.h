@@ -34,6 +34,7 @@ namespace qml
 /// @cond
 class Identifier;
 class TemplateStore;
+class Verifier;
 /// @endcond
 
 /// @brief Device models a biometric device.
@@ -43,6 +44,7 @@ class BIOMETRY_DLL_PUBLIC Device : public QObject
     Q_OBJECT
     Q_PROPERTY(biometry::qml::TemplateStore* templateStore READ templateStore CONSTANT)
     Q_PROPERTY(biometry::qml::Identifier* identifier READ identifier CONSTANT)
+    Q_PROPERTY(biometry::qml::Verifier* verifier READ verifier CONSTANT)
 public:
     /// @brief Device initializes a new instance with device and parent.
     Device(const std::shared_ptr<biometry::Device>& impl, QObject* parent);
@@ -51,6 +53,8 @@ public:
     biometry::qml::TemplateStore* templateStore();
     /// @brief identifier returns an Identifier instance.
     biometry::qml::Identifier* identifier();
+    /// @brief verifier returns a Verifier instance.
+    biometry::qml::Verifier* verifier();
 
 private:
     /// @cond
@@ -23,8 +23,11 @@
 #include <biometry/operation.h>
 #include <biometry/reason.h>
 #include <biometry/user.h>
+#include <biometry/verifier.h>
 #include <biometry/visibility.h>
 
+#include <biometry/dbus/stub/operation.h>
+
 #include <biometry/devices/fingerprint_reader.h>
 
 #include <biometry/qml/Biometryd/converter.h>
@@ -39,8 +42,10 @@
 #include <QRect>
 #include <QVector>
 
+#include <exception>
 #include <functional>
 #include <memory>
+#include <string>
 
 namespace biometry
 {
@@ -72,6 +77,15 @@ struct Result<biometry::User>
     }
 };
 
+template<>
+struct Result<biometry::Verification::Result>
+{
+    static QVariant to_variant(const biometry::Verification::Result& result)
+    {
+        return QVariant{result == biometry::Verification::Result::verified};
+    }
+};
+
 template<>
 struct Result<biometry::TemplateStore::SizeQuery::Result>
 {
@@ -215,6 +229,9 @@ public:
 };
 
 /// @brief TypedOperation implements Operation dispatching to a biometry::Operation<T>.
+///
+/// Operations talking to the daemon are started and cancelled without blocking the
+/// calling thread, which usually is the UI thread.
 template<typename T>
 class TypedOperation : public Operation
 {
@@ -331,7 +348,18 @@ public:
     {
         try
         {
-            impl->start_with_observer(Observer::create(observer));
+            auto obs = Observer::create(observer);
+
+            if (auto stub = std::dynamic_pointer_cast<biometry::dbus::stub::Operation<T>>(impl))
+            {
+                stub->start_with_observer_async(obs, [obs](std::exception_ptr error)
+                {
+                    if (error) obs->on_failed(describe(error));
+                });
+                return true;
+            }
+
+            impl->start_with_observer(obs);
             return true;
         }
         catch(...)
@@ -344,6 +372,13 @@ public:
     {
         try
         {
+            // Errors during cancellation are not reported, just like for the synchronous variant.
+            if (auto stub = std::dynamic_pointer_cast<biometry::dbus::stub::Operation<T>>(impl))
+            {
+                stub->cancel_async([](std::exception_ptr) {});
+                return true;
+            }
+
             impl->cancel();
             return true;
         }
@@ -355,6 +390,23 @@ public:
 
 private:
     /// @cond
+    /// @brief describe returns a human readable description of error.
+    static std::string describe(std::exception_ptr error)
+    {
+        try
+        {
+            std::rethrow_exception(error);
+        }
+        catch (const std::exception& e)
+        {
+            return e.what();
+        }
+        catch (...)
+        {
+            return "Unknown error while starting the operation";
+        }
+    }
+
     typename biometry::Operation<T>::Ptr impl;
     /// @endcond
 };
@@ -32,6 +32,7 @@
 #include <biometry/qml/Biometryd/service.h>
 #include <biometry/qml/Biometryd/template_store.h>
 #include <biometry/qml/Biometryd/user.h>
+#include <biometry/qml/Biometryd/verifier.h>
 
 #include <QPoint>
 #include <QDebug>
@@ -239,6 +240,40 @@ struct Identification : public biometry::Operation<biometry::Identification>,
     bool canceled{false};
 };
 
+struct Verification : public biometry::Operation<biometry::Verification>,
+                      public std::enable_shared_from_this<for_testing::Verification>
+{
+    void start_with_observer(const typename Observer::Ptr& observer) override
+    {
+        auto thiz = shared_from_this();
+        Dispatcher::instance().dispatch([observer, thiz]()
+        {
+            observer->on_started();
+
+            for (std::size_t i = 1; i <= 100; i++)
+            {
+                if (thiz->canceled)
+                {
+                    observer->on_canceled("Canceled due to request from client");
+                    return;
+                }
+
+                observer->on_progress(biometry::Progress{biometry::Percent::from_raw_value(i/100.f), biometry::Dictionary{}});
+                std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            }
+
+            observer->on_succeeded(biometry::Verification::Result::verified);
+        });
+    }
+
+    void cancel() override
+    {
+        canceled = true;
+    }
+
+    bool canceled{false};
+};
+
 struct Removal : public biometry::Operation<biometry::TemplateStore::Removal>,
                        public std::enable_shared_from_this<for_testing::Removal>
 {
@@ -349,6 +384,14 @@ struct Identifier : public biometry::Identifier
     }
 };
 
+struct Verifier : public biometry::Verifier
+{
+    biometry::Operation<biometry::Verification>::Ptr verify_user(const biometry::Application&, const biometry::User&, const biometry::Reason&) override
+    {
+        return std::make_shared<for_testing::Verification>();
+    }
+};
+
 struct Device : public biometry::Device
 {
     biometry::TemplateStore& template_store() override
@@ -363,11 +406,12 @@ struct Device : public biometry::Device
 
     biometry::Verifier& verifier() override
     {
-        throw not_implemented();
+        return verifier_;
     }
 
     TemplateStore template_store_;
     Identifier identifier_;
+    Verifier verifier_;
 };
 
 struct Service : public biometry::Service
@@ -396,6 +440,8 @@ void biometry::qml::Plugin::registerTypes(const char *uri)
     qmlRegisterUncreatableType<biometry::qml::Device>(uri, Plugin::major, Plugin::minor, "Device", "Rely on Biometryd.instance");
     qmlRegisterUncreatableType<biometry::qml::Identification>(uri, Plugin::major, Plugin::minor, "Identification", "Rely on Biometryd.instance");
     qmlRegisterUncreatableType<biometry::qml::Identifier>(uri, Plugin::major, Plugin::minor, "Identifier", "Rely on Biometryd.instance");
+    qmlRegisterUncreatableType<biometry::qml::Verification>(uri, Plugin::major, Plugin::minor, "Verification", "Rely on Biometryd.instance");
+    qmlRegisterUncreatableType<biometry::qml::Verifier>(uri, Plugin::major, Plugin::minor, "Verifier", "Rely on Biometryd.instance");
 
     qmlRegisterUncreatableType<biometry::qml::Operation>(uri, Plugin::major, Plugin::minor, "Operation", "Rely on Biometryd.instance");
     qmlRegisterUncreatableType<biometry::qml::SizeQuery>(uri, Plugin::major, Plugin::minor, "SizeQuery", "Rely on Biometryd.instance");
@@ -0,0 +1,38 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/qml/Biometryd/verifier.h>
+#include <biometry/qml/Biometryd/user.h>
+
+#include <biometry/application.h>
+#include <biometry/reason.h>
+#include <biometry/user.h>
+
+/// @brief Verifier initializes a new instance with impl and parent.
+biometry::qml::Verifier::Verifier(const std::reference_wrapper<biometry::Verifier>& impl, QObject* parent)
+    : QObject{parent},
+      impl{impl}
+{
+}
+
+/// @brief verifyUser returns an operation verifying user.
+biometry::qml::Verification* biometry::qml::Verifier::verifyUser(User* user)
+{
+    return new Verification{impl.get().verify_user(biometry::Application::system(), biometry::User{user->uid()}, biometry::Reason::unknown()), this};
+}
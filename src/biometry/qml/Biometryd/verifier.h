@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRYD_QML_VERIFIER_H_
+#define BIOMETRYD_QML_VERIFIER_H_
+
+#include <biometry/verifier.h>
+#include <biometry/visibility.h>
+
+#include <biometry/qml/Biometryd/operation.h>
+
+#include <QObject>
+#include <QString>
+
+namespace biometry
+{
+namespace qml
+{
+class User;
+
+/// @cond
+class BIOMETRY_DLL_PUBLIC Verification : public TypedOperation<biometry::Verification>
+{
+    Q_OBJECT
+public:
+    Verification(const biometry::Operation<biometry::Verification>::Ptr& impl, QObject* parent)
+        : TypedOperation<biometry::Verification>{impl, parent}
+    {
+    }
+};
+/// @endcond
+
+/// @brief Verifier models 1:1 matching of a given user against its enrolled templates.
+/// @ingroup qml
+class BIOMETRY_DLL_PUBLIC Verifier : public QObject
+{
+    Q_OBJECT
+public:
+    /// @brief Verifier initializes a new instance with impl and parent.
+    Verifier(const std::reference_wrapper<biometry::Verifier>& impl, QObject* parent);
+
+    /// @brief verifyUser returns an operation verifying user.
+    ///
+    /// The operation succeeds with true if the user could be verified, false otherwise.
+    Q_INVOKABLE biometry::qml::Verification* verifyUser(biometry::qml::User* user);
+
+private:
+    /// @cond
+    std::reference_wrapper<biometry::Verifier> impl;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRYD_QML_VERIFIER_H_
@@ -17,8 +17,10 @@
  *
  */
 #include <biometry/runtime.h>
+#include <biometry/util/metrics.h>
 
 #include <iostream>
+#include <stdexcept>
 
 namespace
 {
@@ -54,6 +56,9 @@ void exception_safe_run(boost::asio::io_service& service)
 
 std::shared_ptr<biometry::Runtime> biometry::Runtime::create(std::uint32_t pool_size)
 {
+    if (pool_size == 0)
+        throw std::invalid_argument{"Runtime::create: pool_size must not be 0"};
+
     return std::shared_ptr<biometry::Runtime>(new biometry::Runtime(pool_size));
 }
 
@@ -91,6 +96,15 @@ void biometry::Runtime::stop()
             worker.join();
 }
 
+bool biometry::Runtime::is_worker_thread() const
+{
+    for (const auto& worker : workers_)
+        if (worker.get_id() == std::this_thread::get_id())
+            return true;
+
+    return false;
+}
+
 std::function<void(std::function<void()>)> biometry::Runtime::to_dispatcher_functional()
 {
     // We have to make sure that we stay alive for as long as
@@ -98,7 +112,18 @@ std::function<void(std::function<void()>)> biometry::Runtime::to_dispatcher_func
     auto sp = shared_from_this();
     return [sp](std::function<void()> task)
     {
-        sp->strand_.post(task);
+        static auto& queue_depth = biometry::util::metrics().gauge("runtime.queue_depth");
+        static auto& wait = biometry::util::metrics().latency("runtime.wait_us");
+
+        queue_depth.increment();
+        auto enqueued_at = std::chrono::steady_clock::now();
+
+        sp->strand_.post([task, enqueued_at]()
+        {
+            queue_depth.decrement();
+            wait.record_since(enqueued_at);
+            task();
+        });
     };
 }
 
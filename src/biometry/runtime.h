@@ -43,7 +43,8 @@ public:
     static constexpr const std::uint32_t worker_threads = 2;
 
     // create returns a Runtime instance with pool_size worker threads
-    // executing the underlying service.
+    // executing the underlying service. Throws std::invalid_argument if
+    // pool_size is 0.
     static std::shared_ptr<Runtime> create(std::uint32_t pool_size = worker_threads);
 
     Runtime(const Runtime&) = delete;
@@ -61,6 +62,10 @@ public:
     // joining all worker threads.
     void stop();
 
+    // is_worker_thread returns true if called from one of the
+    // worker threads, which must not stop the Runtime.
+    bool is_worker_thread() const;
+
     // to_dispatcher_functional returns a function for integration
     // with components that expect a dispatcher for operation.
     std::function<void(std::function<void()>)> to_dispatcher_functional();
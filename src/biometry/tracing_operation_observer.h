@@ -54,7 +54,7 @@ struct Printer<biometry::Dictionary>
     {
         std::string indent(offset, ' ');
         for (auto it = dict.begin(); it != dict.end(); ++it)
-            out << indent << it->first << " = " << it->second << (it != std::prev(dict.end()) ? "" : "");
+            out << (it != dict.begin() ? "\n" : "") << indent << it->first << " = " << it->second;
 
         return out;
     }
@@ -20,6 +20,7 @@
 #include <biometry/util/benchmark.h>
 
 #include <chrono>
+#include <exception>
 
 namespace
 {
@@ -18,6 +18,7 @@
  */
 
 #include <biometry/util/dispatcher.h>
+#include <biometry/util/metrics.h>
 
 namespace
 {
@@ -32,7 +33,18 @@ public:
 
     void dispatch(const Task &task) override
     {
-        strand.post(task);
+        static auto& queue_depth = biometry::util::metrics().gauge("dispatcher.queue_depth");
+        static auto& wait = biometry::util::metrics().latency("dispatcher.wait_us");
+
+        queue_depth.increment();
+        auto enqueued_at = std::chrono::steady_clock::now();
+
+        strand.post([task, enqueued_at]()
+        {
+            queue_depth.decrement();
+            wait.record_since(enqueued_at);
+            task();
+        });
     }
 
 private:
@@ -45,3 +57,11 @@ std::shared_ptr<biometry::util::Dispatcher> biometry::util::create_dispatcher_fo
 {
     return std::make_shared<AsioStrandDispatcher>(rt);
 }
+
+biometry::util::DispatcherFactory biometry::util::create_dispatcher_factory_for_runtime(const std::shared_ptr<biometry::Runtime>& rt)
+{
+    return [rt]()
+    {
+        return create_dispatcher_for_runtime(rt);
+    };
+}
@@ -24,6 +24,7 @@
 #include <biometry/runtime.h>
 #include <biometry/visibility.h>
 
+#include <functional>
 #include <memory>
 
 namespace biometry
@@ -46,8 +47,17 @@ protected:
     /// @endcond
 };
 
+/// @brief A DispatcherFactory creates a new, independent Dispatcher instance per call.
+typedef std::function<std::shared_ptr<Dispatcher>()> DispatcherFactory;
+
 /// @brief create_dispatcher_for_runtime creates a dispatcher enqueuing to the runtime's service.
+///
+/// Tasks dispatched to the same instance are executed sequentially, tasks dispatched to
+/// different instances run concurrently on the runtime's thread pool.
 BIOMETRY_DLL_PUBLIC std::shared_ptr<Dispatcher> create_dispatcher_for_runtime(const std::shared_ptr<Runtime>&);
+
+/// @brief create_dispatcher_factory_for_runtime returns a factory creating dispatchers for the runtime.
+BIOMETRY_DLL_PUBLIC DispatcherFactory create_dispatcher_factory_for_runtime(const std::shared_ptr<Runtime>&);
 }
 }
 
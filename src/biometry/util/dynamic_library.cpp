@@ -29,10 +29,15 @@ namespace glibc
 {
 struct DlApi : public biometry::util::DynamicLibrary::Api
 {
+    explicit DlApi(biometry::util::DynamicLibrary::Binding binding)
+        : binding{binding == biometry::util::DynamicLibrary::Binding::lazy ? RTLD_LAZY : RTLD_NOW}
+    {
+    }
+
     // See man dlopen.
     biometry::util::DynamicLibrary::Handle open(const boost::filesystem::path& path) const override
     {
-        if (auto handle = ::dlopen(path.string().c_str(), RTLD_NOW | RTLD_LOCAL))
+        if (auto handle = ::dlopen(path.string().c_str(), binding | RTLD_LOCAL))
             return biometry::util::DynamicLibrary::Handle{handle};
 
         throw biometry::util::DynamicLibrary::Api::Error{*this};
@@ -62,6 +67,8 @@ struct DlApi : public biometry::util::DynamicLibrary::Api
 
         return std::string{};
     }
+
+    int binding;
 };
 }
 }
@@ -107,5 +114,10 @@ biometry::util::DynamicLibrary::Symbol biometry::util::DynamicLibrary::resolve_s
 
 std::shared_ptr<biometry::util::DynamicLibrary::Api> biometry::util::glibc::dl_api()
 {
-    return std::make_shared< ::glibc::DlApi >();
+    return dl_api(DynamicLibrary::Binding::now);
+}
+
+std::shared_ptr<biometry::util::DynamicLibrary::Api> biometry::util::glibc::dl_api(DynamicLibrary::Binding binding)
+{
+    return std::make_shared< ::glibc::DlApi >(binding);
 }
@@ -64,6 +64,13 @@ public:
     typedef TaggedOpaqueType<Tag::Handle> Handle;
     typedef TaggedOpaqueType<Tag::Symbol> Symbol;
 
+    /// @brief Binding enumerates the modes of resolving undefined symbols when opening a library.
+    enum class Binding
+    {
+        now,    ///< All undefined symbols are resolved when opening the library, see RTLD_NOW.
+        lazy    ///< Function symbols are resolved on first use, see RTLD_LAZY.
+    };
+
     class Api : public DoNotCopyOrMove
     {
     public:
@@ -108,6 +115,8 @@ private:
 namespace glibc
 {
 BIOMETRY_DLL_PUBLIC std::shared_ptr<DynamicLibrary::Api> dl_api();
+/// @brief dl_api returns an Api implementation opening libraries with the given binding mode.
+BIOMETRY_DLL_PUBLIC std::shared_ptr<DynamicLibrary::Api> dl_api(DynamicLibrary::Binding binding);
 }
 }
 }
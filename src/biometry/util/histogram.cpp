@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/util/histogram.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+constexpr const std::uint64_t sub_bucket_count{std::uint64_t{1} << biometry::util::Histogram::precision_bits};
+constexpr const std::uint64_t sub_bucket_half_count{sub_bucket_count / 2};
+
+// msb returns the index of the most significant bit set in value, value must not be 0.
+std::uint32_t msb(std::uint64_t value)
+{
+    return 63 - __builtin_clzll(value);
+}
+}
+
+constexpr const std::uint32_t biometry::util::Histogram::precision_bits;
+constexpr const std::uint32_t biometry::util::Histogram::range_bits;
+constexpr const std::uint64_t biometry::util::Histogram::max_value;
+constexpr const std::size_t biometry::util::Histogram::bucket_count;
+
+std::size_t biometry::util::Histogram::index_for(std::uint64_t value)
+{
+    value = std::min(value, max_value);
+
+    // Small values are counted exactly.
+    if (value < sub_bucket_count)
+        return value;
+
+    // Larger values are bucketed according to their magnitude and the
+    // precision_bits - 1 bits following the most significant one.
+    auto shift = msb(value) - (precision_bits - 1);
+    auto mantissa = value >> shift;
+
+    return sub_bucket_count + (shift - 1) * sub_bucket_half_count + (mantissa - sub_bucket_half_count);
+}
+
+std::uint64_t biometry::util::Histogram::lowest_value_for(std::size_t index)
+{
+    if (index < sub_bucket_count)
+        return index;
+
+    auto offset = index - sub_bucket_count;
+    auto shift = offset / sub_bucket_half_count + 1;
+    auto mantissa = offset % sub_bucket_half_count + sub_bucket_half_count;
+
+    return mantissa << shift;
+}
+
+std::uint64_t biometry::util::Histogram::highest_value_for(std::size_t index)
+{
+    if (index < sub_bucket_count)
+        return index;
+
+    auto shift = (index - sub_bucket_count) / sub_bucket_half_count + 1;
+    return lowest_value_for(index) + (std::uint64_t{1} << shift) - 1;
+}
+
+biometry::util::Histogram::Histogram()
+    : buckets_(bucket_count, 0),
+      count_{0},
+      min_{std::numeric_limits<std::uint64_t>::max()},
+      max_{0}
+{
+}
+
+biometry::util::Histogram& biometry::util::Histogram::record(std::uint64_t value, std::uint64_t count)
+{
+    if (count == 0)
+        return *this;
+
+    value = std::min(value, max_value);
+
+    buckets_[index_for(value)] += count;
+    count_ += count;
+    min_ = std::min(min_, value);
+    max_ = std::max(max_, value);
+
+    return *this;
+}
+
+biometry::util::Histogram& biometry::util::Histogram::merge(const Histogram& other)
+{
+    for (std::size_t i = 0; i < bucket_count; i++)
+        buckets_[i] += other.buckets_[i];
+
+    count_ += other.count_;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+
+    return *this;
+}
+
+std::uint64_t biometry::util::Histogram::count() const
+{
+    return count_;
+}
+
+std::uint64_t biometry::util::Histogram::percentile(double p) const
+{
+    if (p < 0. || p > 100.)
+        throw std::out_of_range{"Histogram::percentile: p must be in [0, 100]"};
+
+    if (count_ == 0)
+        return 0;
+
+    auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(p / 100. * count_)));
+
+    std::uint64_t seen{0};
+    for (std::size_t i = 0; i < bucket_count; i++)
+    {
+        seen += buckets_[i];
+        if (seen >= rank)
+            return std::max(min_, std::min(max_, highest_value_for(i)));
+    }
+
+    return max_;
+}
+
+const std::vector<std::uint64_t>& biometry::util::Histogram::buckets() const
+{
+    return buckets_;
+}
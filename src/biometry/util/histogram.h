@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#ifndef BIOMETRY_UTIL_HISTOGRAM_H_
+#define BIOMETRY_UTIL_HISTOGRAM_H_
+
+#include <biometry/visibility.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace biometry
+{
+namespace util
+{
+/// @brief Histogram counts non-negative integer observations in log-linear buckets.
+///
+/// Every power-of-two range is split into 2^(precision_bits - 1) equally sized buckets,
+/// bounding the relative error of reported percentiles to 2^-(precision_bits - 1) while
+/// keeping memory fixed, independent of the number of observations. Observations beyond
+/// max_value are clamped. Histograms with the same layout can be merged, e.g., to combine
+/// the observations recorded by multiple threads.
+class BIOMETRY_DLL_PUBLIC Histogram
+{
+public:
+    /// @brief precision_bits determines the number of buckets per power of two.
+    static constexpr const std::uint32_t precision_bits{7};
+    /// @brief range_bits determines the largest value that can be recorded without clamping.
+    static constexpr const std::uint32_t range_bits{40};
+    /// @brief max_value is the largest value that can be recorded without clamping.
+    static constexpr const std::uint64_t max_value{(std::uint64_t{1} << range_bits) - 1};
+    /// @brief bucket_count is the number of buckets of every histogram instance.
+    static constexpr const std::size_t bucket_count{(std::size_t{1} << precision_bits) + (range_bits - precision_bits) * (std::size_t{1} << (precision_bits - 1))};
+
+    /// @brief index_for returns the index of the bucket counting value.
+    static std::size_t index_for(std::uint64_t value);
+    /// @brief lowest_value_for returns the smallest value counted by the bucket at index.
+    static std::uint64_t lowest_value_for(std::size_t index);
+    /// @brief highest_value_for returns the largest value counted by the bucket at index.
+    static std::uint64_t highest_value_for(std::size_t index);
+
+    /// @brief Histogram initializes an empty instance.
+    Histogram();
+
+    /// @brief record adds count observations of value.
+    Histogram& record(std::uint64_t value, std::uint64_t count = 1);
+
+    /// @brief merge adds all observations recorded by other.
+    Histogram& merge(const Histogram& other);
+
+    /// @brief count returns the total number of observations.
+    std::uint64_t count() const;
+
+    /// @brief percentile returns the value that p percent of all observations are less than or equal to.
+    ///
+    /// The value is reported with the precision of the respective bucket, and returns 0 if empty.
+    /// @throws std::out_of_range if p is not in [0, 100].
+    std::uint64_t percentile(double p) const;
+
+    /// @brief buckets returns the raw counts of all buckets, indexed as described by index_for.
+    const std::vector<std::uint64_t>& buckets() const;
+
+private:
+    /// @cond
+    std::vector<std::uint64_t> buckets_;
+    std::uint64_t count_;
+    std::uint64_t min_;
+    std::uint64_t max_;
+    /// @endcond
+};
+}
+}
+
+#endif // BIOMETRY_UTIL_HISTOGRAM_H_
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/util/metrics.h>
+
+#include <iostream>
+
+namespace
+{
+// find_or_create returns the instrument known under name in instruments, creating it if necessary.
+template<typename T>
+T& find_or_create(std::map<std::string, std::unique_ptr<T>>& instruments, const std::string& name)
+{
+    auto it = instruments.find(name);
+    if (it == instruments.end())
+        it = instruments.emplace(name, std::unique_ptr<T>{new T{}}).first;
+
+    return *it->second;
+}
+}
+
+biometry::util::Metrics::Counter::Counter() : value_{0}
+{
+}
+
+void biometry::util::Metrics::Counter::increment(std::uint64_t delta)
+{
+    value_.fetch_add(delta, std::memory_order_relaxed);
+}
+
+std::uint64_t biometry::util::Metrics::Counter::value() const
+{
+    return value_.load(std::memory_order_relaxed);
+}
+
+biometry::util::Metrics::Gauge::Gauge() : value_{0}
+{
+}
+
+void biometry::util::Metrics::Gauge::increment()
+{
+    value_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void biometry::util::Metrics::Gauge::decrement()
+{
+    value_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::int64_t biometry::util::Metrics::Gauge::value() const
+{
+    return value_.load(std::memory_order_relaxed);
+}
+
+biometry::util::Metrics::Latency::Latency() : buckets(Histogram::bucket_count)
+{
+}
+
+void biometry::util::Metrics::Latency::record(const std::chrono::microseconds& duration)
+{
+    auto value = duration.count() < 0 ? 0 : static_cast<std::uint64_t>(duration.count());
+    buckets[Histogram::index_for(value)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void biometry::util::Metrics::Latency::record_since(const std::chrono::steady_clock::time_point& then)
+{
+    record(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - then));
+}
+
+biometry::util::Histogram biometry::util::Metrics::Latency::histogram() const
+{
+    Histogram result;
+
+    for (std::size_t i = 0; i < buckets.size(); i++)
+        if (auto count = buckets[i].load(std::memory_order_relaxed))
+            result.record(Histogram::lowest_value_for(i), count);
+
+    return result;
+}
+
+biometry::util::Metrics::Counter& biometry::util::Metrics::counter(const std::string& name)
+{
+    std::lock_guard<std::mutex> lg{guard};
+    return find_or_create(counters, name);
+}
+
+biometry::util::Metrics::Gauge& biometry::util::Metrics::gauge(const std::string& name)
+{
+    std::lock_guard<std::mutex> lg{guard};
+    return find_or_create(gauges, name);
+}
+
+biometry::util::Metrics::Latency& biometry::util::Metrics::latency(const std::string& name)
+{
+    std::lock_guard<std::mutex> lg{guard};
+    return find_or_create(latencies, name);
+}
+
+biometry::util::Metrics::Snapshot biometry::util::Metrics::snapshot() const
+{
+    Snapshot result;
+
+    std::lock_guard<std::mutex> lg{guard};
+
+    for (const auto& pair : counters)
+        result.counters[pair.first] = pair.second->value();
+    for (const auto& pair : gauges)
+        result.gauges[pair.first] = pair.second->value();
+    for (const auto& pair : latencies)
+        result.latencies[pair.first] = pair.second->histogram();
+
+    return result;
+}
+
+biometry::util::Metrics& biometry::util::metrics()
+{
+    static Metrics instance;
+    return instance;
+}
+
+std::ostream& biometry::util::operator<<(std::ostream& out, const Metrics::Snapshot& snapshot)
+{
+    for (const auto& pair : snapshot.counters)
+        out << pair.first << " " << pair.second << std::endl;
+
+    for (const auto& pair : snapshot.gauges)
+        out << pair.first << " " << pair.second << std::endl;
+
+    for (const auto& pair : snapshot.latencies)
+    {
+        const auto& h = pair.second;
+        out << pair.first << ".count " << h.count() << std::endl
+            << pair.first << ".p50 " << h.percentile(50) << std::endl
+            << pair.first << ".p90 " << h.percentile(90) << std::endl
+            << pair.first << ".p99 " << h.percentile(99) << std::endl
+            << pair.first << ".p999 " << h.percentile(99.9) << std::endl
+            << pair.first << ".max " << h.percentile(100) << std::endl;
+    }
+
+    return out;
+}
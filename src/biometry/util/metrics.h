@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRY_UTIL_METRICS_H_
+#define BIOMETRY_UTIL_METRICS_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <biometry/util/histogram.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace biometry
+{
+namespace util
+{
+/// @brief Metrics is a registry of named counters, gauges and latency histograms.
+///
+/// Instruments are created on first access and live as long as the registry. Callers are
+/// expected to look up an instrument once and to hold on to the returned reference. Updating
+/// an instrument is lock-free and only costs relaxed atomic operations, such that the
+/// instrumentation can stay enabled in production. Taking a snapshot is comparatively
+/// expensive and meant for occasional inspection.
+class BIOMETRY_DLL_PUBLIC Metrics : public DoNotCopyOrMove
+{
+public:
+    /// @brief Counter models a monotonically increasing count of events.
+    class BIOMETRY_DLL_PUBLIC Counter : public DoNotCopyOrMove
+    {
+    public:
+        /// @brief Counter initializes a new instance to 0.
+        Counter();
+        /// @brief increment adds delta to the counter.
+        void increment(std::uint64_t delta = 1);
+        /// @brief value returns the current value of the counter.
+        std::uint64_t value() const;
+
+    private:
+        /// @cond
+        std::atomic<std::uint64_t> value_;
+        /// @endcond
+    };
+
+    /// @brief Gauge models a value that goes up and down, e.g., the length of a queue.
+    class BIOMETRY_DLL_PUBLIC Gauge : public DoNotCopyOrMove
+    {
+    public:
+        /// @brief Gauge initializes a new instance to 0.
+        Gauge();
+        /// @brief increment increases the gauge by 1.
+        void increment();
+        /// @brief decrement decreases the gauge by 1.
+        void decrement();
+        /// @brief value returns the current value of the gauge.
+        std::int64_t value() const;
+
+    private:
+        /// @cond
+        std::atomic<std::int64_t> value_;
+        /// @endcond
+    };
+
+    /// @brief Latency records durations in µs into buckets laid out as described by Histogram.
+    class BIOMETRY_DLL_PUBLIC Latency : public DoNotCopyOrMove
+    {
+    public:
+        /// @brief Latency initializes a new instance without any observations.
+        Latency();
+        /// @brief record adds an observation of duration.
+        void record(const std::chrono::microseconds& duration);
+        /// @brief record_since adds an observation of the time elapsed since then.
+        void record_since(const std::chrono::steady_clock::time_point& then);
+        /// @brief histogram returns a Histogram with all observations recorded so far.
+        Histogram histogram() const;
+
+    private:
+        /// @cond
+        std::vector<std::atomic<std::uint64_t>> buckets;
+        /// @endcond
+    };
+
+    /// @brief Snapshot bundles the values of all instruments at a given point in time.
+    struct Snapshot
+    {
+        std::map<std::string, std::uint64_t> counters;  ///< Values of all counters, by name.
+        std::map<std::string, std::int64_t> gauges;     ///< Values of all gauges, by name.
+        std::map<std::string, Histogram> latencies;     ///< Observations of all latencies in µs, by name.
+    };
+
+    /// @brief Metrics initializes an empty registry.
+    Metrics() = default;
+
+    /// @brief counter returns the Counter known under name, creating it if necessary.
+    Counter& counter(const std::string& name);
+    /// @brief gauge returns the Gauge known under name, creating it if necessary.
+    Gauge& gauge(const std::string& name);
+    /// @brief latency returns the Latency known under name, creating it if necessary.
+    Latency& latency(const std::string& name);
+
+    /// @brief snapshot returns the current values of all instruments.
+    Snapshot snapshot() const;
+
+private:
+    /// @cond
+    mutable std::mutex guard;
+    std::map<std::string, std::unique_ptr<Counter>> counters;
+    std::map<std::string, std::unique_ptr<Gauge>> gauges;
+    std::map<std::string, std::unique_ptr<Latency>> latencies;
+    /// @endcond
+};
+
+/// @brief metrics returns the process-wide Metrics instance.
+BIOMETRY_DLL_PUBLIC Metrics& metrics();
+
+/// @brief operator<< inserts snapshot into out, one "name value" pair per line.
+///
+/// Latencies are expanded into their count and a set of percentiles in µs, with
+/// the name being suffixed by .count, .p50, .p90, .p99, .p999 and .max.
+BIOMETRY_DLL_PUBLIC std::ostream& operator<<(std::ostream& out, const Metrics::Snapshot& snapshot);
+}
+}
+
+#endif // BIOMETRY_UTIL_METRICS_H_
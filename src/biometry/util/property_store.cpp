@@ -19,8 +19,23 @@
 
 #include <biometry/util/property_store.h>
 
+#include <biometry/optional.h>
+
 #include <core/posix/exec.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 std::string biometry::util::AndroidPropertyStore::get(const std::string& key) const
 {
     core::posix::ChildProcess getprop = core::posix::exec("/usr/bin/getprop", {key}, {}, core::posix::StandardStream::stdout);
@@ -33,3 +48,361 @@ std::string biometry::util::AndroidPropertyStore::get(const std::string& key) co
 
     throw std::out_of_range{key};
 }
+
+namespace
+{
+// The layout of property areas as defined by bionic's system_properties implementation:
+//   prop_area: bytes_used, serial, magic, version, reserved[28], followed by data.
+//   prop_bt:   namelen, prop, left, right, children, name (all offsets relative to data).
+//   prop_info: serial, value[PROP_VALUE_MAX], name.
+// Nodes of the trie are named after the dot-separated components of property names, and
+// siblings form a binary search tree ordered by name length first and name second.
+namespace area
+{
+constexpr const std::uint32_t magic{0x504f5250};
+constexpr const std::uint32_t version{0xfc6ed0ab};
+constexpr const std::size_t header_size{128};
+
+namespace offsets
+{
+constexpr const std::size_t serial{4};
+constexpr const std::size_t magic{8};
+constexpr const std::size_t version{12};
+}
+}
+
+namespace bt
+{
+constexpr const std::size_t namelen{0};
+constexpr const std::size_t prop{4};
+constexpr const std::size_t left{8};
+constexpr const std::size_t right{12};
+constexpr const std::size_t children{16};
+constexpr const std::size_t name{20};
+}
+
+namespace info
+{
+constexpr const std::size_t serial{0};
+constexpr const std::size_t value{4};
+constexpr const std::size_t value_max{92};
+constexpr const std::size_t name{value + value_max};
+
+// Values longer than value_max are stored elsewhere in the area, flagged in the serial.
+constexpr const std::uint32_t long_flag{1 << 16};
+constexpr const std::size_t long_offset{value + 56};
+
+inline bool is_dirty(std::uint32_t serial) { return serial & 1; }
+inline std::size_t value_length(std::uint32_t serial) { return serial >> 24; }
+}
+
+// Bounds the depth of the trie, protecting against malformed areas.
+constexpr const std::size_t max_depth{128};
+}
+
+class biometry::util::MappedAndroidPropertyStore::Area
+{
+public:
+    // map returns the area mapped from the file at path, or nullptr if it is not a property area.
+    static std::shared_ptr<Area> map(const boost::filesystem::path& path)
+    {
+        int fd = ::open(path.string().c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0)
+            return nullptr;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || not S_ISREG(st.st_mode) || static_cast<std::size_t>(st.st_size) < area::header_size)
+        {
+            ::close(fd);
+            return nullptr;
+        }
+
+        auto addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+
+        if (addr == MAP_FAILED)
+            return nullptr;
+
+        std::shared_ptr<Area> result{new Area{addr, static_cast<std::size_t>(st.st_size)}};
+
+        if (result->word(area::offsets::magic) != area::magic || result->word(area::offsets::version) != area::version)
+            return nullptr;
+
+        return result;
+    }
+
+    ~Area()
+    {
+        ::munmap(addr, size);
+    }
+
+    // serial returns a pointer to the serial of the area.
+    const std::uint32_t* serial() const
+    {
+        return reinterpret_cast<const std::uint32_t*>(static_cast<const char*>(addr) + area::offsets::serial);
+    }
+
+    // find returns the value of the property named key.
+    biometry::Optional<std::string> find(const std::string& key) const
+    {
+        std::uint32_t node{0};
+        std::size_t begin{0};
+
+        while (true)
+        {
+            auto end = key.find('.', begin);
+            auto component = key.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+
+            if (not (node = find_sibling(data_word(node + bt::children), component)))
+                return biometry::Optional<std::string>{};
+
+            if (end == std::string::npos)
+                break;
+
+            begin = end + 1;
+        }
+
+        if (auto prop = data_word(node + bt::prop))
+            return read_value(prop);
+
+        return biometry::Optional<std::string>{};
+    }
+
+    // collect inserts all properties of the area into properties.
+    void collect(std::map<std::string, std::string>& properties) const
+    {
+        collect(properties, 0, 0);
+    }
+
+private:
+    Area(void* addr, std::size_t size) : addr{addr}, size{size}
+    {
+    }
+
+    // word atomically loads the 32-bit word at offset from the beginning of the area, or 0 if offset is out of bounds.
+    std::uint32_t word(std::size_t offset) const
+    {
+        if (offset % sizeof(std::uint32_t) != 0 || offset > size || size - offset < sizeof(std::uint32_t))
+            return 0;
+
+        return __atomic_load_n(reinterpret_cast<const std::uint32_t*>(static_cast<const char*>(addr) + offset), __ATOMIC_ACQUIRE);
+    }
+
+    // data_word returns the word at offset from the beginning of the area's data.
+    std::uint32_t data_word(std::size_t offset) const
+    {
+        return word(area::header_size + offset);
+    }
+
+    // string returns the NUL-terminated string at offset from the beginning of the area's data, limited to max characters.
+    biometry::Optional<std::string> string(std::size_t offset, std::size_t max) const
+    {
+        offset += area::header_size;
+        if (offset >= size)
+            return biometry::Optional<std::string>{};
+
+        auto s = static_cast<const char*>(addr) + offset;
+        return std::string(s, ::strnlen(s, std::min(max, size - offset)));
+    }
+
+    // find_sibling returns the offset of the node named name in the tree of siblings rooted at node, or 0.
+    std::uint32_t find_sibling(std::uint32_t node, const std::string& name) const
+    {
+        for (std::size_t depth = 0; node != 0 && depth < max_depth; depth++)
+        {
+            auto length = data_word(node + bt::namelen);
+            auto other = string(node + bt::name, length);
+
+            if (not other)
+                return 0;
+
+            int rc = name.size() < length ? -1 : name.size() > length ? 1 : name.compare(other.get());
+
+            if (rc == 0)
+                return node;
+
+            node = data_word(node + (rc < 0 ? bt::left : bt::right));
+        }
+
+        return 0;
+    }
+
+    // read_value reads the value of the property info at offset, following the protocol established by bionic.
+    biometry::Optional<std::string> read_value(std::uint32_t prop) const
+    {
+        while (true)
+        {
+            auto serial = data_word(prop + info::serial);
+
+            // The value is being updated.
+            if (info::is_dirty(serial))
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            biometry::Optional<std::string> value;
+
+            if (serial & info::long_flag)
+                value = string(prop + data_word(prop + info::long_offset), size);
+            else
+                value = string(prop + info::value, std::min(info::value_length(serial), info::value_max - 1));
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (serial == data_word(prop + info::serial))
+                return value;
+        }
+    }
+
+    void collect(std::map<std::string, std::string>& properties, std::uint32_t node, std::size_t depth) const
+    {
+        if (depth >= max_depth)
+            return;
+
+        if (auto prop = data_word(node + bt::prop))
+        {
+            auto name = string(prop + info::name, size);
+            auto value = read_value(prop);
+
+            if (name && value)
+                properties[name.get()] = value.get();
+        }
+
+        // The root node has no siblings.
+        if (node != 0)
+        {
+            if (auto left = data_word(node + bt::left))
+                collect(properties, left, depth + 1);
+            if (auto right = data_word(node + bt::right))
+                collect(properties, right, depth + 1);
+        }
+
+        if (auto children = data_word(node + bt::children))
+            collect(properties, children, depth + 1);
+    }
+
+    void* addr;
+    std::size_t size;
+};
+
+constexpr const char* biometry::util::MappedAndroidPropertyStore::default_path;
+
+biometry::util::MappedAndroidPropertyStore::MappedAndroidPropertyStore(const boost::filesystem::path& path)
+    : MappedAndroidPropertyStore{path, std::make_shared<AndroidPropertyStore>()}
+{
+}
+
+biometry::util::MappedAndroidPropertyStore::MappedAndroidPropertyStore(const boost::filesystem::path& path, const std::shared_ptr<PropertyStore>& fallback)
+    : path{path},
+      fallback{fallback}
+{
+}
+
+std::string biometry::util::MappedAndroidPropertyStore::get(const std::string& key) const
+{
+    auto areas = this->areas();
+
+    // We cannot tell missing properties from missing areas, and rather ask getprop.
+    if (areas.empty() && fallback)
+        return fallback->get(key);
+
+    for (const auto& area : areas)
+        if (auto value = area->find(key))
+            return value.get();
+
+    throw std::out_of_range{key};
+}
+
+std::map<std::string, std::string> biometry::util::MappedAndroidPropertyStore::snapshot() const
+{
+    std::map<std::string, std::string> result;
+
+    for (const auto& area : areas())
+        area->collect(result);
+
+    return result;
+}
+
+std::uint32_t biometry::util::MappedAndroidPropertyStore::serial() const
+{
+    auto areas = this->areas();
+
+    if (areas.empty())
+        return 0;
+
+    return __atomic_load_n(areas.front()->serial(), __ATOMIC_ACQUIRE);
+}
+
+std::uint32_t biometry::util::MappedAndroidPropertyStore::wait_for_change(std::uint32_t serial, const std::chrono::milliseconds& timeout) const
+{
+    auto areas = this->areas();
+
+    if (areas.empty())
+        return 0;
+
+    // init wakes up all waiters on the serial of the area whenever it changes a property.
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto current = __atomic_load_n(areas.front()->serial(), __ATOMIC_ACQUIRE);
+
+    while (current == serial)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+            break;
+
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now);
+        struct timespec ts{static_cast<time_t>(remaining.count() / 1000000000), static_cast<long>(remaining.count() % 1000000000)};
+
+        ::syscall(SYS_futex, areas.front()->serial(), FUTEX_WAIT, serial, &ts, nullptr, 0);
+        current = __atomic_load_n(areas.front()->serial(), __ATOMIC_ACQUIRE);
+    }
+
+    return current;
+}
+
+std::vector<std::shared_ptr<biometry::util::MappedAndroidPropertyStore::Area>> biometry::util::MappedAndroidPropertyStore::areas() const
+{
+    std::lock_guard<std::mutex> lg{guard};
+
+    if (not areas_.empty())
+        return areas_;
+
+    std::vector<std::shared_ptr<Area>> result;
+    boost::system::error_code ec;
+
+    if (not boost::filesystem::is_directory(path, ec))
+    {
+        if (auto area = Area::map(path))
+            result.push_back(area);
+
+        return areas_ = result;
+    }
+
+    // Starting with Android 8, the global serial lives in an area of its own. Without it,
+    // init has not finished setting up the areas yet.
+    auto complete = true;
+
+    if (auto area = Area::map(path / "properties_serial"))
+        result.push_back(area);
+    else
+        complete = false;
+
+    for (boost::filesystem::directory_iterator it{path, ec}, itE; not ec && it != itE; it.increment(ec))
+    {
+        // property_info maps property names to contexts and is not an area itself.
+        if (it->path().filename() == "properties_serial" || it->path().filename() == "property_info")
+            continue;
+
+        if (auto area = Area::map(it->path()))
+            result.push_back(area);
+        else
+            complete = false;
+    }
+
+    // We hand out partial sets of areas, but retry mapping on the next access.
+    if (complete && not ec)
+        areas_ = result;
+
+    return result;
+}
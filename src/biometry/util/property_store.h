@@ -23,7 +23,15 @@
 #include <biometry/do_not_copy_or_move.h>
 #include <biometry/visibility.h>
 
+#include <boost/filesystem.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace biometry
 {
@@ -38,13 +46,60 @@ public:
     virtual std::string get(const std::string& key) const = 0;
 };
 
-/// @brief AndroidPropertyStore queries properties from the android property system.
+/// @brief AndroidPropertyStore queries properties from the android property system by executing getprop.
 class BIOMETRY_DLL_PUBLIC AndroidPropertyStore : public PropertyStore
 {
 public:
     // From PropertyStore.
     std::string get(const std::string &key) const override;
 };
+
+/// @brief MappedAndroidPropertyStore reads properties directly from the memory-mapped property areas
+/// maintained by android's init, without spawning any processes.
+///
+/// path either refers to a single property area (up to Android 7) or to a directory containing one
+/// property area per security context (Android 8 and later). Areas are mapped on first access, and
+/// mapping is retried on subsequent accesses until all areas have been mapped. Lookups are handed to
+/// fallback as long as no area at all can be mapped.
+class BIOMETRY_DLL_PUBLIC MappedAndroidPropertyStore : public PropertyStore
+{
+public:
+    /// @brief default_path is the location of the property areas on android.
+    static constexpr const char* default_path{"/dev/__properties__"};
+
+    /// @brief MappedAndroidPropertyStore initializes a new instance reading the property areas at path.
+    explicit MappedAndroidPropertyStore(const boost::filesystem::path& path = default_path);
+    /// @brief MappedAndroidPropertyStore initializes a new instance reading the property areas at path,
+    /// handing lookups to fallback while no area can be mapped.
+    MappedAndroidPropertyStore(const boost::filesystem::path& path, const std::shared_ptr<PropertyStore>& fallback);
+
+    // From PropertyStore.
+    std::string get(const std::string& key) const override;
+
+    /// @brief snapshot returns all properties with their current values.
+    std::map<std::string, std::string> snapshot() const;
+
+    /// @brief serial returns a number that changes whenever any property changes, or 0 if no property area is accessible.
+    std::uint32_t serial() const;
+
+    /// @brief wait_for_change blocks until serial() differs from serial or timeout expires, returning the current serial().
+    std::uint32_t wait_for_change(std::uint32_t serial, const std::chrono::milliseconds& timeout) const;
+
+private:
+    /// @cond
+    class Area;
+
+    /// @brief areas returns the mapped property areas, the area carrying the global serial first.
+    ///
+    /// The areas are only cached once all of them could be mapped.
+    std::vector<std::shared_ptr<Area>> areas() const;
+
+    boost::filesystem::path path;
+    std::shared_ptr<PropertyStore> fallback;
+    mutable std::mutex guard;
+    mutable std::vector<std::shared_ptr<Area>> areas_;
+    /// @endcond
+};
 }
 }
 
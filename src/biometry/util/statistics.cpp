@@ -19,27 +19,85 @@
 
 #include <biometry/util/statistics.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+biometry::util::Statistics::Statistics()
+    : count_{0},
+      min_{std::numeric_limits<double>::max()},
+      max_{std::numeric_limits<double>::lowest()},
+      mean_{0.},
+      m2_{0.}
+{
+}
+
 biometry::util::Statistics& biometry::util::Statistics::update(double observation)
 {
-    accumulator(observation); return *this;
+    count_++;
+    min_ = std::min(min_, observation);
+    max_ = std::max(max_, observation);
+
+    auto delta = observation - mean_;
+    mean_ += delta / count_;
+    m2_ += delta * (observation - mean_);
+
+    histogram_.record(static_cast<std::uint64_t>(std::llround(std::max(0., observation))));
+
+    return *this;
+}
+
+biometry::util::Statistics& biometry::util::Statistics::merge(const Statistics& other)
+{
+    if (other.count_ == 0)
+        return *this;
+
+    // See Chan et al., "Updating Formulae and a Pairwise Algorithm for Computing Sample Variances".
+    auto count = count_ + other.count_;
+    auto delta = other.mean_ - mean_;
+
+    mean_ += delta * other.count_ / count;
+    m2_ += other.m2_ + delta * delta * count_ * other.count_ / count;
+    count_ = count;
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+
+    histogram_.merge(other.histogram_);
+
+    return *this;
+}
+
+std::uint64_t biometry::util::Statistics::count() const
+{
+    return count_;
 }
 
 double biometry::util::Statistics::min() const
 {
-    return boost::accumulators::min(accumulator);
+    return min_;
 }
 
 double biometry::util::Statistics::mean() const
 {
-    return boost::accumulators::mean(accumulator);
+    return mean_;
 }
 
 double biometry::util::Statistics::variance() const
 {
-    return boost::accumulators::variance(accumulator);
+    return count_ == 0 ? 0. : m2_ / count_;
 }
 
 double biometry::util::Statistics::max() const
 {
-    return boost::accumulators::max(accumulator);
+    return max_;
+}
+
+double biometry::util::Statistics::percentile(double p) const
+{
+    return histogram_.percentile(p);
+}
+
+const biometry::util::Histogram& biometry::util::Statistics::histogram() const
+{
+    return histogram_;
 }
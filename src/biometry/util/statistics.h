@@ -22,24 +22,33 @@
 
 #include <biometry/visibility.h>
 
-#include <boost/accumulators/accumulators.hpp>
-#include <boost/accumulators/statistics/stats.hpp>
-#include <boost/accumulators/statistics/mean.hpp>
-#include <boost/accumulators/statistics/max.hpp>
-#include <boost/accumulators/statistics/min.hpp>
-#include <boost/accumulators/statistics/variance.hpp>
+#include <biometry/util/histogram.h>
+
+#include <cstdint>
 
 namespace biometry
 {
 namespace util
 {
-/// @brief Statistics helps in tracking min/max/mean/variance of a sample.
+/// @brief Statistics helps in tracking min/max/mean/variance and percentiles of a sample.
+///
+/// Percentiles are answered from a Histogram of the observations, rounded to the nearest
+/// non-negative integer. Instances can be merged, e.g., to combine samples collected by
+/// multiple threads.
 class BIOMETRY_DLL_PUBLIC Statistics
 {
 public:
+    /// @brief Statistics initializes an instance without any observations.
+    Statistics();
+
     /// @brief update adds the observation to the statistics.
     Statistics& update(double observation);
 
+    /// @brief merge adds all observations seen by other to the statistics.
+    Statistics& merge(const Statistics& other);
+
+    /// @brief count returns the number of observations seen thus far.
+    std::uint64_t count() const;
     /// @brief min returns the current min of the sample seen thus far.
     double min() const;
     /// @brief mean returns the current mean of the sample seen thus far.
@@ -48,22 +57,22 @@ public:
     double variance() const;
     /// @brief max returns the current max of the sample seen thus far.
     double max() const;
+    /// @brief percentile returns the value p percent of the sample seen thus far are less than or equal to.
+    /// @throws std::out_of_range if p is not in [0, 100].
+    double percentile(double p) const;
+
+    /// @brief histogram returns the histogram of the sample seen thus far.
+    const Histogram& histogram() const;
 
 private:
     /// @cond
-    typedef boost::accumulators::accumulator_set
-    <
-        double,
-        boost::accumulators::stats
-        <
-            boost::accumulators::tag::min,
-            boost::accumulators::tag::max,
-            boost::accumulators::tag::mean,
-            boost::accumulators::tag::variance
-        >
-    > Accumulator;
-
-    Accumulator accumulator;
+    std::uint64_t count_;
+    double min_;
+    double max_;
+    double mean_;
+    // Sum of squared differences from the mean, see Welford's online algorithm.
+    double m2_;
+    Histogram histogram_;
     /// @endcond
 };
 }
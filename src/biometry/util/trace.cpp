@@ -0,0 +1,388 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/util/trace.h>
+
+#include <biometry/util/json.hpp>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <ostream>
+#include <utility>
+
+namespace json = nlohmann;
+
+namespace
+{
+std::uint64_t next_tracer_id()
+{
+    static std::atomic<std::uint64_t> id{0};
+    return ++id;
+}
+
+// The correlation id installed on the calling thread, 0 if none.
+thread_local std::uint64_t current_correlation_id{0};
+
+std::chrono::microseconds since_epoch(const biometry::util::trace::Clock::time_point& tp)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(tp.time_since_epoch());
+}
+
+const char* phase_to_string(biometry::util::trace::Event::Phase phase)
+{
+    switch (phase)
+    {
+    case biometry::util::trace::Event::Phase::complete: return "X";
+    case biometry::util::trace::Event::Phase::instant: return "i";
+    }
+
+    return "i";
+}
+}
+
+// Ring is a fixed-size buffer of events, written by exactly one thread and read by any thread.
+// Every slot is guarded by a sequence counter that is odd while the writer updates the slot. Readers
+// discard slots whose counter is odd or changed while they were copying the slot's fields.
+class biometry::util::trace::Tracer::Ring
+{
+public:
+    Ring(std::size_t capacity, std::uint32_t tid) : tid{tid}, slots(capacity), head{0}
+    {
+    }
+
+    void write(const Event& event)
+    {
+        auto& slot = slots[head.load(std::memory_order_relaxed) % slots.size()];
+
+        auto seq = slot.seq.load(std::memory_order_relaxed);
+        slot.seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.phase.store(event.phase, std::memory_order_relaxed);
+        slot.category.store(event.category, std::memory_order_relaxed);
+        slot.name.store(event.name, std::memory_order_relaxed);
+        slot.id.store(event.id, std::memory_order_relaxed);
+        slot.timestamp.store(event.timestamp.count(), std::memory_order_relaxed);
+        slot.duration.store(event.duration.count(), std::memory_order_relaxed);
+
+        slot.seq.store(seq + 2, std::memory_order_release);
+        head.fetch_add(1, std::memory_order_release);
+    }
+
+    void read(std::vector<Event>& events) const
+    {
+        // We start at the oldest slot, keeping events with equal timestamps in the order they were recorded.
+        auto begin = head.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < slots.size(); i++)
+        {
+            const auto& slot = slots[(begin + i) % slots.size()];
+
+            auto before = slot.seq.load(std::memory_order_acquire);
+            // Never written or currently being written.
+            if (before == 0 || before % 2 == 1)
+                continue;
+
+            Event event
+            {
+                slot.phase.load(std::memory_order_relaxed),
+                slot.category.load(std::memory_order_relaxed),
+                slot.name.load(std::memory_order_relaxed),
+                slot.id.load(std::memory_order_relaxed),
+                std::chrono::microseconds{slot.timestamp.load(std::memory_order_relaxed)},
+                std::chrono::microseconds{slot.duration.load(std::memory_order_relaxed)},
+                tid
+            };
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) != before)
+                continue;
+
+            events.push_back(event);
+        }
+    }
+
+    const std::uint32_t tid;
+
+private:
+    struct Slot
+    {
+        std::atomic<std::uint64_t> seq{0};
+        std::atomic<Event::Phase> phase{Event::Phase::instant};
+        std::atomic<const char*> category{nullptr};
+        std::atomic<const char*> name{nullptr};
+        std::atomic<std::uint64_t> id{0};
+        std::atomic<std::chrono::microseconds::rep> timestamp{0};
+        std::atomic<std::chrono::microseconds::rep> duration{0};
+    };
+
+    std::vector<Slot> slots;
+    std::atomic<std::uint64_t> head;
+};
+
+// Registry holds the rings of all threads recording into a Tracer.
+//
+// The rings of exited threads are retired, keeping their events around until they are
+// superseded by the rings of threads exiting later on.
+class biometry::util::trace::Tracer::Registry
+{
+public:
+    // max_retired is the number of rings of exited threads that are kept around.
+    static constexpr const std::size_t max_retired{16};
+
+    void add(const std::shared_ptr<Ring>& ring)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        live.push_back(ring);
+    }
+
+    void retire(const Ring* ring)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        auto it = std::find_if(live.begin(), live.end(), [ring](const std::shared_ptr<Ring>& r) { return r.get() == ring; });
+        if (it == live.end())
+            return;
+
+        retired.push_back(*it);
+        live.erase(it);
+
+        if (retired.size() > max_retired)
+            retired.pop_front();
+    }
+
+    std::vector<std::shared_ptr<Ring>> snapshot() const
+    {
+        std::lock_guard<std::mutex> lg{guard};
+
+        std::vector<std::shared_ptr<Ring>> result{retired.begin(), retired.end()};
+        result.insert(result.end(), live.begin(), live.end());
+        return result;
+    }
+
+private:
+    mutable std::mutex guard;
+    std::vector<std::shared_ptr<Ring>> live;
+    std::deque<std::shared_ptr<Ring>> retired;
+};
+
+constexpr const std::size_t biometry::util::trace::Tracer::Registry::max_retired;
+
+// ThreadRings maps tracer ids to the rings of the current thread, retiring them once the thread exits.
+class biometry::util::trace::Tracer::ThreadRings
+{
+public:
+    struct Entry
+    {
+        std::uint64_t tracer;
+        std::weak_ptr<Registry> registry;
+        Ring* ring;
+    };
+
+    ~ThreadRings()
+    {
+        for (const auto& entry : entries)
+            if (auto registry = entry.registry.lock())
+                registry->retire(entry.ring);
+    }
+
+    std::vector<Entry> entries;
+};
+
+constexpr const std::size_t biometry::util::trace::Tracer::default_capacity;
+
+biometry::util::trace::Tracer::Tracer(std::size_t capacity)
+    : id{next_tracer_id()},
+      capacity{std::max<std::size_t>(capacity, 1)},
+      enabled{false},
+      registry{std::make_shared<Registry>()}
+{
+}
+
+void biometry::util::trace::Tracer::enable()
+{
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void biometry::util::trace::Tracer::disable()
+{
+    enabled.store(false, std::memory_order_relaxed);
+}
+
+bool biometry::util::trace::Tracer::is_enabled() const
+{
+    return enabled.load(std::memory_order_relaxed);
+}
+
+void biometry::util::trace::Tracer::complete(const char* category, const char* name, const Clock::time_point& begin, std::uint64_t id)
+{
+    if (not is_enabled())
+        return;
+
+    auto now = Clock::now();
+    record(Event{Event::Phase::complete, category, name, id, since_epoch(begin), since_epoch(now) - since_epoch(begin), 0});
+}
+
+void biometry::util::trace::Tracer::instant(const char* category, const char* name, std::uint64_t id)
+{
+    if (not is_enabled())
+        return;
+
+    record(Event{Event::Phase::instant, category, name, id, since_epoch(Clock::now()), std::chrono::microseconds{0}, 0});
+}
+
+std::vector<biometry::util::trace::Event> biometry::util::trace::Tracer::events() const
+{
+    std::vector<Event> result;
+    for (const auto& ring : registry->snapshot())
+        ring->read(result);
+
+    std::stable_sort(result.begin(), result.end(), [](const Event& lhs, const Event& rhs)
+    {
+        return lhs.timestamp < rhs.timestamp;
+    });
+
+    return result;
+}
+
+void biometry::util::trace::Tracer::dump(std::ostream& out) const
+{
+    static const auto pid = ::getpid();
+
+    auto trace_events = json::json::array();
+    for (const auto& event : events())
+    {
+        json::json e
+        {
+            {"name", event.name},
+            {"cat", event.category},
+            {"ph", phase_to_string(event.phase)},
+            {"ts", event.timestamp.count()},
+            {"pid", pid},
+            {"tid", event.tid},
+            {"args", {{"id", event.id}}}
+        };
+
+        switch (event.phase)
+        {
+        case Event::Phase::complete:
+            e["dur"] = event.duration.count();
+            break;
+        case Event::Phase::instant:
+            e["s"] = "t";
+            break;
+        }
+
+        trace_events.push_back(e);
+    }
+
+    out << json::json{{"traceEvents", trace_events}, {"displayTimeUnit", "ms"}};
+}
+
+biometry::util::trace::Tracer::Ring& biometry::util::trace::Tracer::ring()
+{
+    // Tracer ids are never reused, entries of tracers that have been destroyed are never looked up again.
+    static thread_local ThreadRings cache;
+
+    for (const auto& entry : cache.entries)
+        if (entry.tracer == id)
+            return *entry.ring;
+
+    auto ring = std::make_shared<Ring>(capacity, static_cast<std::uint32_t>(::syscall(SYS_gettid)));
+    registry->add(ring);
+
+    cache.entries.push_back(ThreadRings::Entry{id, registry, ring.get()});
+    return *ring;
+}
+
+void biometry::util::trace::Tracer::record(Event event)
+{
+    ring().write(event);
+}
+
+biometry::util::trace::Tracer& biometry::util::trace::tracer()
+{
+    static Tracer instance;
+    static const bool enabled_from_env = []()
+    {
+        auto value = std::getenv("BIOMETRYD_TRACE");
+        if (value && std::strcmp(value, "1") == 0)
+            instance.enable();
+        return true;
+    }();
+
+    (void) enabled_from_env;
+    return instance;
+}
+
+biometry::util::trace::Span::Span(const char* category, const char* name, std::uint64_t id, Tracer& tracer)
+    : tracer{tracer.is_enabled() ? &tracer : nullptr},
+      category{category},
+      name{name},
+      id_{id},
+      begin{this->tracer ? Clock::now() : Clock::time_point{}}
+{
+}
+
+biometry::util::trace::Span::Span(Span&& rhs)
+    : tracer{rhs.tracer},
+      category{rhs.category},
+      name{rhs.name},
+      id_{rhs.id_},
+      begin{rhs.begin}
+{
+    rhs.tracer = nullptr;
+}
+
+biometry::util::trace::Span::~Span()
+{
+    if (tracer)
+        tracer->complete(category, name, begin, id_);
+}
+
+std::uint64_t biometry::util::trace::Span::id() const
+{
+    return id_;
+}
+
+std::uint64_t biometry::util::trace::next_id()
+{
+    static std::atomic<std::uint64_t> id{0};
+    return id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+biometry::util::trace::Correlation::Correlation(std::uint64_t id) : previous{current_correlation_id}
+{
+    current_correlation_id = id;
+}
+
+biometry::util::trace::Correlation::~Correlation()
+{
+    current_correlation_id = previous;
+}
+
+std::uint64_t biometry::util::trace::correlation_id()
+{
+    return current_correlation_id ? current_correlation_id : next_id();
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef BIOMETRY_UTIL_TRACE_H_
+#define BIOMETRY_UTIL_TRACE_H_
+
+#include <biometry/do_not_copy_or_move.h>
+#include <biometry/visibility.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace biometry
+{
+namespace util
+{
+namespace trace
+{
+/// @brief Clock is the clock used to timestamp events.
+typedef std::chrono::steady_clock Clock;
+
+/// @brief Event describes a single trace event.
+struct BIOMETRY_DLL_PUBLIC Event
+{
+    /// @brief Phase enumerates all known kinds of events.
+    enum class Phase
+    {
+        complete,   ///< A span with a duration.
+        instant     ///< A point in time.
+    };
+
+    Phase phase;                            ///< The kind of the event.
+    const char* category;                   ///< Category of the event, must have static storage duration.
+    const char* name;                       ///< Name of the event, must have static storage duration.
+    std::uint64_t id;                       ///< Correlates events belonging to the same entity, 0 if unused.
+    std::chrono::microseconds timestamp;    ///< Begin of the event, relative to the epoch of Clock.
+    std::chrono::microseconds duration;     ///< Duration of the event, 0 for instant events.
+    std::uint32_t tid;                      ///< Id of the thread that recorded the event.
+};
+
+/// @brief Tracer records events into per-thread ring buffers.
+///
+/// Every thread records into its own ring buffer, overwriting its oldest events once the
+/// buffer is full. Recording is lock-free and wait-free, and costs a single relaxed load
+/// while tracing is disabled. Reading the buffers is safe at any time, events that are
+/// overwritten concurrently are skipped. The ring buffer of a thread is retired when the
+/// thread exits, and only the rings of the most recently exited threads are kept around.
+class BIOMETRY_DLL_PUBLIC Tracer : public DoNotCopyOrMove
+{
+public:
+    /// @brief default_capacity is the default number of events kept per thread.
+    static constexpr const std::size_t default_capacity{8192};
+
+    /// @brief Tracer initializes a new, disabled instance, keeping capacity events per thread.
+    explicit Tracer(std::size_t capacity = default_capacity);
+
+    /// @brief enable starts recording events.
+    void enable();
+    /// @brief disable stops recording events.
+    void disable();
+    /// @brief is_enabled returns true if events are recorded.
+    bool is_enabled() const;
+
+    /// @brief complete records a span with the given category and name, lasting from begin until now.
+    void complete(const char* category, const char* name, const Clock::time_point& begin, std::uint64_t id = 0);
+    /// @brief instant records a point-in-time event with the given category and name.
+    void instant(const char* category, const char* name, std::uint64_t id = 0);
+
+    /// @brief events returns all events currently buffered, ordered by timestamp.
+    std::vector<Event> events() const;
+
+    /// @brief dump inserts all buffered events into out in the Chrome trace-event format,
+    /// as understood by chrome://tracing and Perfetto.
+    void dump(std::ostream& out) const;
+
+private:
+    /// @cond
+    class Ring;
+    class Registry;
+    class ThreadRings;
+
+    /// @brief ring returns the ring buffer of the calling thread, creating it if necessary.
+    Ring& ring();
+    /// @brief record adds event to the ring buffer of the calling thread.
+    void record(Event event);
+
+    const std::uint64_t id;
+    const std::size_t capacity;
+    std::atomic<bool> enabled;
+
+    // Shared with the threads recording into this instance, such that exiting threads
+    // retire their rings without outliving the instance.
+    std::shared_ptr<Registry> registry;
+    /// @endcond
+};
+
+/// @brief tracer returns the process-wide Tracer instance.
+///
+/// The instance is enabled if the environment variable BIOMETRYD_TRACE is set to 1.
+BIOMETRY_DLL_PUBLIC Tracer& tracer();
+
+/// @brief Span records a complete event spanning its own lifetime.
+class BIOMETRY_DLL_PUBLIC Span
+{
+public:
+    /// @brief Span starts a new span with the given category and name, recorded to tracer.
+    Span(const char* category, const char* name, std::uint64_t id = 0, Tracer& tracer = trace::tracer());
+    /// @brief Span takes over the span tracked by rhs.
+    Span(Span&& rhs);
+    /// @brief ~Span records the span if tracing was enabled when the span was started.
+    ~Span();
+
+    /// @brief id returns the id correlating the span with other events.
+    std::uint64_t id() const;
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+    Span& operator=(Span&&) = delete;
+
+private:
+    /// @cond
+    Tracer* tracer;
+    const char* category;
+    const char* name;
+    std::uint64_t id_;
+    Clock::time_point begin;
+    /// @endcond
+};
+
+/// @brief next_id returns a new id for correlating events, unique within the process and never 0.
+BIOMETRY_DLL_PUBLIC std::uint64_t next_id();
+
+/// @brief Correlation makes an id the correlation id of the calling thread for its lifetime.
+///
+/// Layers handing work to other threads pick up correlation_id() and install a Correlation
+/// on the receiving thread, such that all events of an operation share a single id.
+class BIOMETRY_DLL_PUBLIC Correlation : public DoNotCopyOrMove
+{
+public:
+    /// @brief Correlation installs id as the correlation id of the calling thread.
+    explicit Correlation(std::uint64_t id);
+    /// @brief ~Correlation restores the previous correlation id of the calling thread.
+    ~Correlation();
+
+private:
+    /// @cond
+    std::uint64_t previous;
+    /// @endcond
+};
+
+/// @brief correlation_id returns the correlation id of the calling thread, or a new id if none is installed.
+BIOMETRY_DLL_PUBLIC std::uint64_t correlation_id();
+}
+}
+}
+
+#endif // BIOMETRY_UTIL_TRACE_H_
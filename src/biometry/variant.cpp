@@ -19,55 +19,22 @@
 
 #include <biometry/variant.h>
 
-#include <boost/variant.hpp>
+#include <boost/variant/get.hpp>
 
 #include <iostream>
+#include <new>
+#include <utility>
+
+static_assert(sizeof(std::vector<biometry::Variant>) == sizeof(std::vector<std::uint8_t>) &&
+              alignof(std::vector<biometry::Variant>) == alignof(std::vector<std::uint8_t>),
+              "Variant's inline storage is not suitable for std::vector<Variant>");
 
 namespace
 {
-typedef typename boost::make_recursive_variant
-<
-    biometry::Variant::None,
-    bool,
-    std::int64_t,
-    double,
-    biometry::Rectangle,
-    std::string,
-    std::vector<std::uint8_t>,
-    std::vector<biometry::Variant>
->::type Value;
-
-struct Visitor : public boost::static_visitor<std::ostream&>
-{
-    Visitor(std::ostream& out) : out{out}
-    {
-    }
-
-    template<typename T>
-    std::ostream& operator()(const T& t)
-    {
-        return out << t;
-    }
-
-    std::ostream& operator()(const std::vector<std::uint8_t>& v)
-    {
-        return out << "@" << &v[0];
-    }
-
-    std::ostream& operator()(const std::vector<biometry::Variant>& v)
-    {
-        return out << "@" << &v[0];
-    }
-
-    std::ostream& out;
-};
+typedef std::vector<std::uint8_t> Blob;
+typedef std::vector<biometry::Variant> Vector;
 }
 
-struct biometry::Variant::Private
-{
-    Value value;
-};
-
 biometry::Variant biometry::Variant::b(bool value)
 {
     return Variant(value);
@@ -103,136 +70,278 @@ biometry::Variant biometry::Variant::v(const std::vector<biometry::Variant>& val
     return Variant{value};
 }
 
-biometry::Variant::Variant(const Variant& rhs) : p{new Private{rhs.p->value}}
+biometry::Variant::Variant(const Variant& rhs) : type_{Type::none}
+{
+    *this = rhs;
+}
+
+biometry::Variant::Variant(Variant&& rhs) noexcept : type_{Type::none}
 {
+    *this = std::move(rhs);
 }
 
-biometry::Variant::Variant() : p{new Private{None{}}}
+biometry::Variant::Variant() : type_{Type::none}
 {
 }
 
-biometry::Variant::Variant(bool b) : p{new Private{b}}
+biometry::Variant::Variant(bool b) : type_{Type::none}
 {
+    assign<bool>(Type::boolean, b);
 }
 
-biometry::Variant::Variant(std::int64_t i) : p{new Private{i}}
+biometry::Variant::Variant(std::int64_t i) : type_{Type::none}
 {
+    assign<std::int64_t>(Type::integer, i);
 }
 
-biometry::Variant::Variant(double fp) : p{new Private{fp}}
+biometry::Variant::Variant(double fp) : type_{Type::none}
 {
+    assign<double>(Type::floating_point, fp);
 }
 
-biometry::Variant::Variant(const biometry::Rectangle& r) : p{new Private{r}}
+biometry::Variant::Variant(const biometry::Rectangle& r) : type_{Type::none}
 {
+    assign<biometry::Rectangle>(Type::rectangle, r);
 }
 
-biometry::Variant::Variant(const std::string& s) : p{new Private{s}}
+biometry::Variant::Variant(const std::string& s) : type_{Type::none}
 {
+    assign<std::string>(Type::string, s);
 }
 
-biometry::Variant::Variant(const std::vector<std::uint8_t>& b) : p{new Private{b}}
+biometry::Variant::Variant(std::string&& s) : type_{Type::none}
 {
+    assign<std::string>(Type::string, std::move(s));
 }
 
-biometry::Variant::Variant(const std::vector<biometry::Variant>& v) : p{new Private{v}}
+biometry::Variant::Variant(const std::vector<std::uint8_t>& b) : type_{Type::none}
 {
+    assign<Blob>(Type::blob, b);
+}
+
+biometry::Variant::Variant(std::vector<std::uint8_t>&& b) : type_{Type::none}
+{
+    assign<Blob>(Type::blob, std::move(b));
+}
+
+biometry::Variant::Variant(const std::vector<biometry::Variant>& v) : type_{Type::none}
+{
+    assign<Vector>(Type::vector, v);
+}
+
+biometry::Variant::Variant(std::vector<biometry::Variant>&& v) : type_{Type::none}
+{
+    assign<Vector>(Type::vector, std::move(v));
 }
 
 biometry::Variant::~Variant()
 {
+    reset();
 }
 
 biometry::Variant& biometry::Variant::operator=(const biometry::Variant& rhs)
 {
-    *p = *rhs.p;
+    if (this == &rhs)
+        return *this;
+
+    switch (rhs.type_)
+    {
+    case Type::none: reset(); break;
+    case Type::boolean: assign<bool>(rhs.type_, rhs.as<bool>()); break;
+    case Type::integer: assign<std::int64_t>(rhs.type_, rhs.as<std::int64_t>()); break;
+    case Type::floating_point: assign<double>(rhs.type_, rhs.as<double>()); break;
+    case Type::rectangle: assign<biometry::Rectangle>(rhs.type_, rhs.as<biometry::Rectangle>()); break;
+    case Type::string: assign<std::string>(rhs.type_, rhs.as<std::string>()); break;
+    case Type::blob: assign<Blob>(rhs.type_, rhs.as<Blob>()); break;
+    case Type::vector: assign<Vector>(rhs.type_, rhs.as<Vector>()); break;
+    }
+
+    return *this;
+}
+
+biometry::Variant& biometry::Variant::operator=(biometry::Variant&& rhs) noexcept
+{
+    if (this == &rhs)
+        return *this;
+
+    // Moving strings and vectors hands over their contents without allocating.
+    switch (rhs.type_)
+    {
+    case Type::none: reset(); break;
+    case Type::boolean: assign<bool>(rhs.type_, rhs.as<bool>()); break;
+    case Type::integer: assign<std::int64_t>(rhs.type_, rhs.as<std::int64_t>()); break;
+    case Type::floating_point: assign<double>(rhs.type_, rhs.as<double>()); break;
+    case Type::rectangle: assign<biometry::Rectangle>(rhs.type_, rhs.as<biometry::Rectangle>()); break;
+    case Type::string: assign<std::string>(rhs.type_, std::move(rhs.as<std::string>())); break;
+    case Type::blob: assign<Blob>(rhs.type_, std::move(rhs.as<Blob>())); break;
+    case Type::vector: assign<Vector>(rhs.type_, std::move(rhs.as<Vector>())); break;
+    }
+
     return *this;
 }
 
 bool biometry::Variant::operator==(const biometry::Variant& rhs) const
 {
-    return p->value == rhs.p->value;
+    if (type_ != rhs.type_)
+        return false;
+
+    switch (type_)
+    {
+    case Type::none: return true;
+    case Type::boolean: return as<bool>() == rhs.as<bool>();
+    case Type::integer: return as<std::int64_t>() == rhs.as<std::int64_t>();
+    case Type::floating_point: return as<double>() == rhs.as<double>();
+    case Type::rectangle: return as<biometry::Rectangle>() == rhs.as<biometry::Rectangle>();
+    case Type::string: return as<std::string>() == rhs.as<std::string>();
+    case Type::blob: return as<Blob>() == rhs.as<Blob>();
+    case Type::vector: return as<Vector>() == rhs.as<Vector>();
+    }
+
+    return false;
 }
 
 std::ostream& biometry::Variant::print(std::ostream& out) const
 {
-    Visitor v{out};
-    return p->value.apply_visitor(v);
+    switch (type_)
+    {
+    case Type::none: return out << None{};
+    case Type::boolean: return out << as<bool>();
+    case Type::integer: return out << as<std::int64_t>();
+    case Type::floating_point: return out << as<double>();
+    case Type::rectangle: return out << as<biometry::Rectangle>();
+    case Type::string: return out << as<std::string>();
+    case Type::blob: return out << "@" << static_cast<const void*>(as<Blob>().data());
+    case Type::vector: return out << "@" << static_cast<const void*>(as<Vector>().data());
+    }
+
+    return out;
 }
 
 biometry::Variant::Type biometry::Variant::type() const
 {
-    return static_cast<Type>(p->value.which());
+    return type_;
 }
 
 const bool& biometry::Variant::boolean() const
 {
-    return boost::get<bool>(p->value);
+    return checked_as<bool>(Type::boolean);
 }
 
 void biometry::Variant::boolean(bool value)
 {
-    p->value = value;
+    assign<bool>(Type::boolean, value);
 }
 
 std::int64_t biometry::Variant::integer() const
 {
-    return boost::get<std::int64_t>(p->value);
+    return checked_as<std::int64_t>(Type::integer);
 }
 
 void biometry::Variant::integer(std::int64_t value)
 {
-    p->value = value;
+    assign<std::int64_t>(Type::integer, value);
 }
 
 double biometry::Variant::floating_point() const
 {
-    return boost::get<double>(p->value);
+    return checked_as<double>(Type::floating_point);
 }
 
 void biometry::Variant::floating_point(double value)
 {
-    p->value = value;
+    assign<double>(Type::floating_point, value);
 }
 
 const biometry::Rectangle& biometry::Variant::rectangle() const
 {
-    return boost::get<biometry::Rectangle>(p->value);
+    return checked_as<biometry::Rectangle>(Type::rectangle);
 }
 
 void biometry::Variant::rectangle(const biometry::Rectangle& value)
 {
-    p->value = value;
+    assign<biometry::Rectangle>(Type::rectangle, value);
 }
 
 const std::string& biometry::Variant::string() const
 {
-    return boost::get<std::string>(p->value);
+    return checked_as<std::string>(Type::string);
 }
 
 void biometry::Variant::string(const std::string& value)
 {
-    p->value = value;
+    assign<std::string>(Type::string, value);
 }
 
 const std::vector<std::uint8_t>& biometry::Variant::blob() const
 {
-    return boost::get<std::vector<std::uint8_t>>(p->value);
+    return checked_as<Blob>(Type::blob);
 }
 
 void biometry::Variant::blob(const std::vector<std::uint8_t>& value)
 {
-    p->value = value;
+    assign<Blob>(Type::blob, value);
 }
 
 const std::vector<biometry::Variant>& biometry::Variant::vector() const
 {
-    return boost::get<std::vector<Variant>>(p->value);
+    return checked_as<Vector>(Type::vector);
 }
 
 void biometry::Variant::vector(const std::vector<biometry::Variant>& value)
 {
-    p->value = value;
+    assign<Vector>(Type::vector, value);
+}
+
+template<typename T>
+T& biometry::Variant::as()
+{
+    return *reinterpret_cast<T*>(&storage);
+}
+
+template<typename T>
+const T& biometry::Variant::as() const
+{
+    return *reinterpret_cast<const T*>(&storage);
+}
+
+template<typename T>
+const T& biometry::Variant::checked_as(Type expected) const
+{
+    // We keep on reporting type mismatches the way we did when relying on boost::variant.
+    if (type_ != expected)
+        throw boost::bad_get{};
+
+    return as<T>();
+}
+
+template<typename T, typename U>
+void biometry::Variant::assign(Type type, U&& value)
+{
+    // We assign in place if the type does not change, reusing any memory held by the current value.
+    if (type_ == type)
+    {
+        as<T>() = std::forward<U>(value);
+        return;
+    }
+
+    // value might refer to a part of our current value, and we thus construct a temporary first.
+    T t(std::forward<U>(value));
+    reset();
+    new (&storage) T(std::move(t));
+    type_ = type;
+}
+
+void biometry::Variant::reset()
+{
+    switch (type_)
+    {
+    case Type::string: as<std::string>().~basic_string(); break;
+    case Type::blob: as<Blob>().~Blob(); break;
+    case Type::vector: as<Vector>().~Vector(); break;
+    default: break;
+    }
+
+    type_ = Type::none;
 }
 
 bool biometry::operator==(const biometry::Variant::None&, const biometry::Variant::None&)
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#ifndef TESTING_ANDROID_PROPERTY_AREA_H_
+#define TESTING_ANDROID_PROPERTY_AREA_H_
+
+#include <boost/filesystem.hpp>
+
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace testing
+{
+// AndroidPropertyArea is a file-backed stand-in for a property area maintained by
+// android's init, laid out and updated the same way bionic does.
+class AndroidPropertyArea
+{
+public:
+    static constexpr const std::uint32_t magic{0x504f5250};
+    static constexpr const std::uint32_t version{0xfc6ed0ab};
+    static constexpr const std::size_t header_size{128};
+    static constexpr const std::size_t value_max{92};
+    static constexpr const std::uint32_t long_flag{1 << 16};
+
+    // AndroidPropertyArea creates a new, empty area of the given size at path.
+    explicit AndroidPropertyArea(const boost::filesystem::path& path, std::size_t size = 128 * 1024)
+        : size{size}
+    {
+        int fd = ::open(path.string().c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::system_error{errno, std::system_category()};
+
+        if (::ftruncate(fd, size) != 0)
+        {
+            ::close(fd);
+            throw std::system_error{errno, std::system_category()};
+        }
+
+        addr = static_cast<char*>(::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        ::close(fd);
+
+        if (addr == MAP_FAILED)
+            throw std::system_error{errno, std::system_category()};
+
+        store(at(8), magic);
+        store(at(12), version);
+
+        // The root node of the trie has an empty name.
+        allocate_node("");
+    }
+
+    ~AndroidPropertyArea()
+    {
+        ::munmap(addr, size);
+    }
+
+    // set adds or updates the property named key, waking up all waiters on the serial of the area.
+    void set(const std::string& key, const std::string& value)
+    {
+        std::uint32_t node{0};
+        std::size_t begin{0};
+
+        while (true)
+        {
+            auto end = key.find('.', begin);
+            node = child(node, key.substr(begin, end == std::string::npos ? std::string::npos : end - begin));
+
+            if (end == std::string::npos)
+                break;
+
+            begin = end + 1;
+        }
+
+        if (auto prop = load(data(node + 4)))
+            update(prop, value);
+        else
+            store(data(node + 4), allocate_info(key, value));
+
+        store(at(4), load(at(4)) + 1);
+        ::syscall(SYS_futex, at(4), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+private:
+    std::uint32_t* at(std::size_t offset)
+    {
+        return reinterpret_cast<std::uint32_t*>(addr + offset);
+    }
+
+    std::uint32_t* data(std::size_t offset)
+    {
+        return at(header_size + offset);
+    }
+
+    static std::uint32_t load(const std::uint32_t* p)
+    {
+        return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+    }
+
+    static void store(std::uint32_t* p, std::uint32_t value)
+    {
+        __atomic_store_n(p, value, __ATOMIC_RELEASE);
+    }
+
+    // allocate returns the offset of size bytes of zeroed memory in the data section.
+    std::uint32_t allocate(std::size_t bytes)
+    {
+        bytes = (bytes + sizeof(std::uint32_t) - 1) & ~(sizeof(std::uint32_t) - 1);
+
+        auto offset = load(at(0));
+        if (header_size + offset + bytes > size)
+            throw std::runtime_error{"property area is full"};
+
+        store(at(0), offset + bytes);
+        return offset;
+    }
+
+    std::uint32_t allocate_node(const std::string& name)
+    {
+        auto node = allocate(20 + name.size() + 1);
+        std::memcpy(data(node + 20), name.c_str(), name.size() + 1);
+        store(data(node), name.size());
+        return node;
+    }
+
+    std::uint32_t allocate_info(const std::string& name, const std::string& value)
+    {
+        auto prop = allocate(4 + value_max + name.size() + 1);
+        std::memcpy(data(prop + 4 + value_max), name.c_str(), name.size() + 1);
+
+        if (value.size() < value_max)
+        {
+            std::memcpy(data(prop + 4), value.c_str(), value.size() + 1);
+            store(data(prop), value.size() << 24);
+        }
+        else
+        {
+            auto long_value = allocate(value.size() + 1);
+            std::memcpy(data(long_value), value.c_str(), value.size() + 1);
+            store(data(prop + 4 + 56), long_value - prop);
+            store(data(prop), long_flag);
+        }
+
+        return prop;
+    }
+
+    // update replaces the value of the property at prop, following the protocol established by bionic.
+    void update(std::uint32_t prop, const std::string& value)
+    {
+        if (value.size() >= value_max || load(data(prop)) & long_flag)
+            throw std::logic_error{"long values are immutable"};
+
+        auto serial = load(data(prop)) | 1;
+        store(data(prop), serial);
+        std::memcpy(data(prop + 4), value.c_str(), value.size() + 1);
+        store(data(prop), (value.size() << 24) | ((serial + 1) & 0xffffff));
+    }
+
+    // child returns the child named name of node, creating it if necessary.
+    std::uint32_t child(std::uint32_t node, const std::string& name)
+    {
+        auto slot = data(node + 16);
+
+        while (true)
+        {
+            auto current = load(slot);
+
+            if (current == 0)
+            {
+                current = allocate_node(name);
+                store(slot, current);
+                return current;
+            }
+
+            auto length = load(data(current));
+            int rc = name.size() < length ? -1 : name.size() > length ? 1 :
+                        std::strncmp(name.c_str(), reinterpret_cast<const char*>(data(current + 20)), length);
+
+            if (rc == 0)
+                return current;
+
+            slot = data(current + (rc < 0 ? 8 : 12));
+        }
+    }
+
+    char* addr;
+    std::size_t size;
+};
+}
+
+#endif // TESTING_ANDROID_PROPERTY_AREA_H_
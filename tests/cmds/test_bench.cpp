@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/cmds/bench.h>
+
+#include <biometry/device_registrar.h>
+#include <biometry/devices/dummy.h>
+#include <biometry/devices/plugin/enumerator.h>
+
+#include <biometry/util/json.hpp>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+namespace cli = biometry::util::cli;
+
+namespace
+{
+struct NullEnumerator : public biometry::devices::plugin::Enumerator
+{
+    std::size_t enumerate(const Functor& ) const override
+    {
+        return 0;
+    }
+};
+
+struct CmdBench : public ::testing::Test
+{
+    biometry::cmds::Bench::Configuration configuration(const biometry::cmds::Bench::Mix& mix) const
+    {
+        return biometry::cmds::Bench::Configuration
+        {
+            biometry::User::current(), 2, mix, 10, 0., std::chrono::milliseconds{200}, std::chrono::seconds{1}
+        };
+    }
+
+    biometry::DeviceRegistrar device_registrar{NullEnumerator{}};
+    std::shared_ptr<biometry::Device> dummy{std::make_shared<biometry::devices::Dummy>()};
+};
+}
+
+TEST_F(CmdBench, parses_weighted_mix)
+{
+    auto mix = biometry::cmds::Bench::parse_mix("identify=8, verify=1,size");
+
+    EXPECT_EQ(3u, mix.size());
+    EXPECT_EQ(8u, mix.at(biometry::cmds::Bench::Kind::identify));
+    EXPECT_EQ(1u, mix.at(biometry::cmds::Bench::Kind::verify));
+    EXPECT_EQ(1u, mix.at(biometry::cmds::Bench::Kind::size));
+}
+
+TEST_F(CmdBench, throws_for_invalid_mix)
+{
+    EXPECT_THROW(biometry::cmds::Bench::parse_mix("unknown=1"), cli::Command::FlagsWithInvalidValue);
+    EXPECT_THROW(biometry::cmds::Bench::parse_mix("identify=many"), cli::Command::FlagsWithInvalidValue);
+    EXPECT_THROW(biometry::cmds::Bench::parse_mix("identify=1=2"), cli::Command::FlagsWithInvalidValue);
+}
+
+TEST_F(CmdBench, throws_for_empty_mix)
+{
+    EXPECT_THROW(biometry::cmds::Bench::measure(configuration({{biometry::cmds::Bench::Kind::identify, 0}}), dummy), std::invalid_argument);
+}
+
+TEST_F(CmdBench, closed_loop_run_reports_all_operations_of_mix)
+{
+    auto report = biometry::cmds::Bench::measure(configuration(biometry::cmds::Bench::parse_mix("identify,verify,size,list,enroll,remove")), dummy);
+
+    EXPECT_GE(report.elapsed, std::chrono::milliseconds{200});
+    EXPECT_EQ(6u, report.results.size());
+
+    for (const auto& pair : report.results)
+    {
+        EXPECT_LT(0u, pair.second.latencies.count()) << pair.first;
+        EXPECT_EQ(0u, pair.second.errors) << pair.first;
+    }
+}
+
+TEST_F(CmdBench, open_loop_run_issues_operations_at_rate)
+{
+    auto c = configuration(biometry::cmds::Bench::parse_mix("identify"));
+    c.rate = 100.;
+    c.duration = std::chrono::milliseconds{500};
+
+    auto report = biometry::cmds::Bench::measure(c, dummy);
+    EXPECT_EQ(50u, report.results.at(biometry::cmds::Bench::Kind::identify).latencies.count());
+}
+
+TEST_F(CmdBench, json_output_contains_percentiles_per_operation)
+{
+    auto report = biometry::cmds::Bench::measure(configuration(biometry::cmds::Bench::parse_mix("identify,size")), dummy);
+
+    std::stringstream ss; biometry::cmds::Bench::print_json(ss, report);
+    auto doc = nlohmann::json::parse(ss.str());
+
+    for (const auto& op : {"identify", "size"})
+    {
+        EXPECT_EQ(0, doc["operations"][op]["errors"].get<int>());
+        EXPECT_LT(0., doc["operations"][op]["throughput"].get<double>());
+        EXPECT_TRUE(doc["operations"][op]["latency_us"].count("p99.9") > 0);
+    }
+}
+
+TEST_F(CmdBench, csv_output_has_header_and_one_line_per_operation)
+{
+    auto report = biometry::cmds::Bench::measure(configuration(biometry::cmds::Bench::parse_mix("identify,size")), dummy);
+
+    std::stringstream ss; biometry::cmds::Bench::print_csv(ss, report);
+
+    std::string line; std::vector<std::string> lines;
+    while (std::getline(ss, line))
+        lines.push_back(line);
+
+    ASSERT_EQ(3u, lines.size());
+    EXPECT_EQ(0u, lines[0].find("operation,count,errors,error_rate,throughput"));
+    EXPECT_EQ(0u, lines[1].find("identify,"));
+    EXPECT_EQ(0u, lines[2].find("size,"));
+}
+
+TEST_F(CmdBench, runs_successfully_for_dummy_device)
+{
+    {std::remove("dummy.json"); std::ofstream out{"dummy.json"}; out << R"_({"device": {"id": "Dummy"}})_" << std::endl;}
+
+    std::stringstream out;
+    biometry::cmds::Bench bench;
+    EXPECT_EQ(EXIT_SUCCESS, bench.run(cli::Command::Context{std::cin, out, {"--config=dummy.json", "--duration=1", "--clients=4", "--format=csv"}}));
+    EXPECT_EQ(0u, out.str().find("operation,"));
+}
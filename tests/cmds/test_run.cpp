@@ -25,6 +25,7 @@
 
 #include <did_finish_successfully.h>
 
+#include <fstream>
 #include <iostream>
 
 namespace
@@ -69,6 +70,30 @@ TEST(CmdRun, queries_configuration_oracle_if_no_config_given)
     EXPECT_TRUE(testing::did_finish_successfully(cp.wait_for(core::posix::wait::Flags::untraced)));
 }
 
+TEST(CmdRun, exits_with_failure_once_all_attempts_to_instantiate_the_device_failed)
+{
+    using namespace ::testing;
+
+    {
+        std::remove("unknown_device.json"); std::ofstream out{"unknown_device.json"};
+        out << R"_({"defaultDevice": {"id": "Unknown"}, "deviceInstantiation": {"attempts": 3, "backoffMs": 1}})_" << std::endl;
+    }
+
+    auto cp = core::posix::fork([]()
+    {
+        auto mock = std::make_shared<NiceMock<MockPropertyStore>>();
+
+        biometry::cmds::Run run{mock, biometry::cmds::Run::system_bus_factory()};
+        EXPECT_EQ(EXIT_FAILURE, run.run(biometry::util::cli::Command::Context{std::cin, std::cout, {"--config=unknown_device.json"}}));
+
+        return testing::Test::HasFailure() ?
+                core::posix::exit::Status::failure :
+                core::posix::exit::Status::success;
+    }, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(testing::did_finish_successfully(cp.wait_for(core::posix::wait::Flags::untraced)));
+}
+
 TEST(CmdRun, android_property_store_throws_if_getprop_missing)
 {
     biometry::util::AndroidPropertyStore store;
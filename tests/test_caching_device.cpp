@@ -0,0 +1,256 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/caching.h>
+#include <biometry/devices/template_cache.h>
+
+#include <biometry/application.h>
+#include <biometry/user.h>
+
+#include <boost/filesystem.hpp>
+
+#include <gmock/gmock.h>
+
+#include "mock_device.h"
+
+namespace
+{
+struct CachingDevice : public ::testing::Test
+{
+    // Safe us some typing.
+    typedef std::vector<biometry::TemplateStore::TemplateId> Ids;
+
+    template<typename T>
+    std::shared_ptr<::testing::MockOperation<T>> operation_succeeding_with(const typename T::Result& result)
+    {
+        using namespace ::testing;
+
+        auto op = std::make_shared<MockOperation<T>>();
+        EXPECT_CALL(*op, start_with_observer(_)).Times(1).WillOnce(Invoke([result](const typename biometry::Operation<T>::Observer::Ptr& observer)
+        {
+            observer->on_started();
+            observer->on_succeeded(result);
+        }));
+
+        return op;
+    }
+
+    template<typename T>
+    typename T::Result run(const typename biometry::Operation<T>::Ptr& op)
+    {
+        using namespace ::testing;
+
+        typename T::Result result;
+        auto observer = std::make_shared<NiceMock<MockObserver<T>>>();
+        EXPECT_CALL(*observer, on_succeeded(_)).Times(1).WillOnce(SaveArg<0>(&result));
+        op->start_with_observer(observer);
+
+        return result;
+    }
+
+    const biometry::Application app{"com.ubuntu.settings"};
+    const biometry::User user{42};
+
+    biometry::devices::TemplateCache::Ptr cache{biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory)};
+    ::testing::MockTemplateStore ts;
+    std::shared_ptr<::testing::MockDevice> impl{std::make_shared<::testing::NiceMock<::testing::MockDevice>>()};
+};
+}
+
+TEST(TemplateCache, knows_nothing_after_creation)
+{
+    auto cache = biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory);
+    EXPECT_FALSE(cache->size(biometry::Application::system(), biometry::User::root()));
+    EXPECT_FALSE(cache->list(biometry::Application::system(), biometry::User::root()));
+    EXPECT_TRUE(cache->keys().empty());
+}
+
+TEST(TemplateCache, stored_list_implies_size)
+{
+    auto cache = biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory);
+    cache->store_list(biometry::Application::system(), biometry::User::root(), {3, 1, 2});
+
+    EXPECT_EQ(3u, *cache->size(biometry::Application::system(), biometry::User::root()));
+    EXPECT_EQ((std::vector<biometry::TemplateStore::TemplateId>{1, 2, 3}), *cache->list(biometry::Application::system(), biometry::User::root()));
+}
+
+TEST(TemplateCache, stored_size_does_not_imply_list)
+{
+    auto cache = biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory);
+    cache->store_size(biometry::Application::system(), biometry::User::root(), 2);
+
+    EXPECT_EQ(2u, *cache->size(biometry::Application::system(), biometry::User::root()));
+    EXPECT_FALSE(cache->list(biometry::Application::system(), biometry::User::root()));
+}
+
+TEST(TemplateCache, mismatching_size_drops_list)
+{
+    auto cache = biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory);
+    cache->store_list(biometry::Application::system(), biometry::User::root(), {1, 2});
+    cache->store_size(biometry::Application::system(), biometry::User::root(), 2);
+    EXPECT_TRUE(cache->list(biometry::Application::system(), biometry::User::root()));
+
+    cache->store_size(biometry::Application::system(), biometry::User::root(), 3);
+    EXPECT_EQ(3u, *cache->size(biometry::Application::system(), biometry::User::root()));
+    EXPECT_FALSE(cache->list(biometry::Application::system(), biometry::User::root()));
+}
+
+TEST(TemplateCache, enrollment_and_removal_update_known_entries_only)
+{
+    auto cache = biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory);
+    const biometry::User other{1000};
+
+    cache->store_list(biometry::Application::system(), biometry::User::root(), {1});
+    cache->store_size(biometry::Application::system(), other, 1);
+
+    cache->enrolled(biometry::Application::system(), biometry::User::root(), 2);
+    cache->enrolled(biometry::Application::system(), other, 2);
+    cache->enrolled(biometry::Application{"unknown"}, biometry::User::root(), 2);
+
+    EXPECT_EQ((std::vector<biometry::TemplateStore::TemplateId>{1, 2}), *cache->list(biometry::Application::system(), biometry::User::root()));
+    EXPECT_EQ(2u, *cache->size(biometry::Application::system(), other));
+    EXPECT_FALSE(cache->size(biometry::Application{"unknown"}, biometry::User::root()));
+
+    cache->removed(biometry::Application::system(), biometry::User::root(), 1);
+    cache->removed(biometry::Application::system(), other, 1);
+
+    EXPECT_EQ((std::vector<biometry::TemplateStore::TemplateId>{2}), *cache->list(biometry::Application::system(), biometry::User::root()));
+    EXPECT_EQ(1u, *cache->size(biometry::Application::system(), other));
+}
+
+TEST(TemplateCache, invalidation_drops_entry)
+{
+    auto cache = biometry::devices::TemplateCache::open(biometry::devices::TemplateCache::in_memory);
+    cache->store_list(biometry::Application::system(), biometry::User::root(), {1});
+    cache->invalidate(biometry::Application::system(), biometry::User::root());
+
+    EXPECT_FALSE(cache->size(biometry::Application::system(), biometry::User::root()));
+    EXPECT_TRUE(cache->keys().empty());
+}
+
+TEST(TemplateCache, entries_are_persisted)
+{
+    auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path();
+
+    biometry::devices::TemplateCache::open(path)->store_list(biometry::Application{"app"}, biometry::User{1000}, {1, 2});
+
+    auto cache = biometry::devices::TemplateCache::open(path);
+    EXPECT_EQ((std::vector<biometry::TemplateStore::TemplateId>{1, 2}), *cache->list(biometry::Application{"app"}, biometry::User{1000}));
+    ASSERT_EQ(1u, cache->keys().size());
+    EXPECT_EQ(biometry::Application{"app"}, cache->keys().front().first);
+    EXPECT_EQ(biometry::User{1000}, cache->keys().front().second);
+
+    boost::filesystem::remove(path);
+}
+
+TEST(TemplateCache, throws_for_inaccessible_database)
+{
+    EXPECT_THROW(biometry::devices::TemplateCache::open("/proc/does/not/exist/templates.db"), std::exception);
+}
+
+TEST_F(CachingDevice, throws_for_missing_cache)
+{
+    EXPECT_THROW(biometry::devices::Caching(impl, biometry::devices::TemplateCache::Ptr{}), std::runtime_error);
+}
+
+TEST_F(CachingDevice, list_is_served_from_the_device_once)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(ts, list(_, _)).Times(1).WillOnce(Return(operation_succeeding_with<biometry::TemplateStore::List>(Ids{1, 2})));
+    ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(ts));
+
+    biometry::devices::Caching caching{impl, cache};
+    EXPECT_EQ((Ids{1, 2}), run<biometry::TemplateStore::List>(caching.template_store().list(app, user)));
+    EXPECT_EQ((Ids{1, 2}), run<biometry::TemplateStore::List>(caching.template_store().list(app, user)));
+    EXPECT_EQ(2u, run<biometry::TemplateStore::SizeQuery>(caching.template_store().size(app, user)));
+}
+
+TEST_F(CachingDevice, successful_enrollment_updates_cache)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(ts, size(_, _)).Times(0);
+    EXPECT_CALL(ts, enroll(_, _)).Times(1).WillOnce(Return(operation_succeeding_with<biometry::TemplateStore::Enrollment>(7)));
+    ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(ts));
+
+    cache->store_list(app, user, Ids{1});
+
+    biometry::devices::Caching caching{impl, cache};
+    EXPECT_EQ(7u, run<biometry::TemplateStore::Enrollment>(caching.template_store().enroll(app, user)));
+    EXPECT_EQ(2u, run<biometry::TemplateStore::SizeQuery>(caching.template_store().size(app, user)));
+    EXPECT_EQ((Ids{1, 7}), *cache->list(app, user));
+}
+
+TEST_F(CachingDevice, successful_removal_and_clearance_update_cache)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(ts, remove(_, _, 1)).Times(1).WillOnce(Return(operation_succeeding_with<biometry::TemplateStore::Removal>(1)));
+    EXPECT_CALL(ts, clear(_, _)).Times(1).WillOnce(Return(operation_succeeding_with<biometry::TemplateStore::Clearance>(biometry::Void{})));
+    ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(ts));
+
+    cache->store_list(app, user, Ids{1, 2});
+
+    biometry::devices::Caching caching{impl, cache};
+    run<biometry::TemplateStore::Removal>(caching.template_store().remove(app, user, 1));
+    EXPECT_EQ((Ids{2}), *cache->list(app, user));
+
+    run<biometry::TemplateStore::Clearance>(caching.template_store().clear(app, user));
+    EXPECT_EQ(Ids{}, *cache->list(app, user));
+}
+
+TEST_F(CachingDevice, failed_operations_leave_cache_untouched)
+{
+    using namespace ::testing;
+
+    auto op = std::make_shared<MockOperation<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*op, start_with_observer(_)).Times(1).WillOnce(Invoke([](const biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr& observer)
+    {
+        observer->on_failed("no finger");
+    }));
+
+    EXPECT_CALL(ts, enroll(_, _)).Times(1).WillOnce(Return(op));
+    ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(ts));
+
+    cache->store_list(app, user, Ids{1});
+
+    biometry::devices::Caching caching{impl, cache};
+
+    auto observer = std::make_shared<MockObserver<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*observer, on_failed("no finger")).Times(1);
+    caching.template_store().enroll(app, user)->start_with_observer(observer);
+
+    EXPECT_EQ((Ids{1}), *cache->list(app, user));
+}
+
+TEST_F(CachingDevice, resync_refreshes_known_entries_from_device)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(ts, list(_, _)).Times(1).WillOnce(Return(operation_succeeding_with<biometry::TemplateStore::List>(Ids{3})));
+    ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(ts));
+
+    cache->store_list(app, user, Ids{1, 2});
+
+    biometry::devices::Caching caching{impl, cache};
+    caching.resync();
+
+    EXPECT_EQ((Ids{3}), *cache->list(app, user));
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/coalescing.h>
+
+#include <biometry/application.h>
+#include <biometry/reason.h>
+#include <biometry/user.h>
+
+#include <biometry/util/configuration.h>
+#include <biometry/util/metrics.h>
+
+#include <gmock/gmock.h>
+
+#include "mock_device.h"
+
+namespace
+{
+struct CoalescingDevice : public ::testing::Test
+{
+    // Safe us some typing.
+    typedef biometry::Operation<biometry::Identification> Operation;
+
+    CoalescingDevice()
+    {
+        using namespace ::testing;
+        ON_CALL(*impl, identifier()).WillByDefault(ReturnRef(identifier));
+    }
+
+    // expect_capture expects a single identification on the actual device, storing
+    // the observer it gets started with in relay.
+    std::shared_ptr<::testing::MockOperation<biometry::Identification>> expect_capture()
+    {
+        using namespace ::testing;
+
+        auto op = std::make_shared<MockOperation<biometry::Identification>>();
+        EXPECT_CALL(*op, start_with_observer(_)).Times(1).WillOnce(SaveArg<0>(&relay));
+        EXPECT_CALL(identifier, identify_user(_, _)).Times(1).WillOnce(Return(op));
+
+        return op;
+    }
+
+    const biometry::Application app{biometry::Application::system()};
+    const biometry::Reason reason{biometry::Reason::unknown()};
+
+    ::testing::MockIdentifier identifier;
+    std::shared_ptr<::testing::MockDevice> impl{std::make_shared<::testing::NiceMock<::testing::MockDevice>>()};
+    Operation::Observer::Ptr relay;
+};
+}
+
+TEST(Coalescing, throws_for_null_device)
+{
+    EXPECT_THROW(biometry::devices::Coalescing{std::shared_ptr<biometry::Device>{}}, std::runtime_error);
+}
+
+TEST_F(CoalescingDevice, concurrent_requests_share_one_capture)
+{
+    using namespace ::testing;
+
+    expect_capture();
+
+    auto coalesced = biometry::util::metrics().counter("identifier.coalesced").value();
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    std::vector<std::shared_ptr<MockObserver<biometry::Identification>>> observers;
+    std::vector<Operation::Ptr> ops;
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        observers.push_back(std::make_shared<MockObserver<biometry::Identification>>());
+        EXPECT_CALL(*observers.back(), on_started()).Times(1);
+        EXPECT_CALL(*observers.back(), on_progress(_)).Times(1);
+        EXPECT_CALL(*observers.back(), on_succeeded(biometry::User{42})).Times(1);
+
+        ops.push_back(coalescing.identifier().identify_user(app, reason));
+        ops.back()->start_with_observer(observers.back());
+    }
+
+    ASSERT_NE(nullptr, relay);
+    relay->on_started();
+    relay->on_progress(biometry::Progress{});
+    relay->on_succeeded(biometry::User{42});
+
+    EXPECT_EQ(coalesced + 2, biometry::util::metrics().counter("identifier.coalesced").value());
+}
+
+TEST_F(CoalescingDevice, requests_for_different_apps_get_their_own_capture)
+{
+    using namespace ::testing;
+
+    Operation::Observer::Ptr greeter_relay, payment_relay;
+
+    auto greeter_op = std::make_shared<MockOperation<biometry::Identification>>();
+    auto payment_op = std::make_shared<MockOperation<biometry::Identification>>();
+    EXPECT_CALL(*greeter_op, start_with_observer(_)).Times(1).WillOnce(SaveArg<0>(&greeter_relay));
+    EXPECT_CALL(*payment_op, start_with_observer(_)).Times(1).WillOnce(SaveArg<0>(&payment_relay));
+    EXPECT_CALL(identifier, identify_user(biometry::Application{"greeter"}, reason)).Times(1).WillOnce(Return(greeter_op));
+    EXPECT_CALL(identifier, identify_user(biometry::Application{"payment"}, reason)).Times(1).WillOnce(Return(payment_op));
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto greeter = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*greeter, on_succeeded(biometry::User{42})).Times(1);
+    auto payment = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*payment, on_succeeded(_)).Times(0);
+
+    auto op1 = coalescing.identifier().identify_user(biometry::Application{"greeter"}, reason);
+    op1->start_with_observer(greeter);
+    auto op2 = coalescing.identifier().identify_user(biometry::Application{"payment"}, reason);
+    op2->start_with_observer(payment);
+
+    ASSERT_NE(nullptr, greeter_relay);
+    ASSERT_NE(nullptr, payment_relay);
+    greeter_relay->on_succeeded(biometry::User{42});
+}
+
+TEST(CoalescingPolicy, is_read_from_configuration)
+{
+    biometry::util::Configuration config;
+    config["coalescing"]["sharedApplications"]["0"] = biometry::util::Configuration::Node{biometry::Variant::s("greeter")};
+    config["coalescing"]["sharedApplications"]["1"] = biometry::util::Configuration::Node{biometry::Variant::s("indicator")};
+
+    const auto& node = static_cast<const biometry::util::Configuration&>(config)["coalescing"];
+    auto policy = biometry::devices::Coalescing::Policy::from_configuration(node);
+
+    EXPECT_EQ((std::set<std::string>{"greeter", "indicator"}), policy.shared_applications);
+}
+
+TEST(CoalescingPolicy, shares_nothing_across_apps_by_default)
+{
+    biometry::util::Configuration config;
+    const auto& node = static_cast<const biometry::util::Configuration&>(config)["coalescing"];
+
+    EXPECT_TRUE(biometry::devices::Coalescing::Policy::from_configuration(node).shared_applications.empty());
+    EXPECT_TRUE(biometry::devices::Coalescing::Policy{}.shared_applications.empty());
+}
+
+TEST_F(CoalescingDevice, requests_for_shared_apps_share_one_capture_regardless_of_reason)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(identifier, identify_user(biometry::Application{"greeter"}, biometry::Reason{"unlock"})).Times(1)
+            .WillOnce(Invoke([this](const biometry::Application&, const biometry::Reason&)
+            {
+                auto op = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+                EXPECT_CALL(*op, start_with_observer(_)).Times(1).WillOnce(SaveArg<0>(&relay));
+                return op;
+            }));
+
+    biometry::devices::Coalescing::Policy policy;
+    policy.shared_applications = {"greeter", "indicator"};
+    biometry::devices::Coalescing coalescing{impl, policy};
+
+    auto greeter = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*greeter, on_succeeded(biometry::User{42})).Times(1);
+    auto indicator = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*indicator, on_succeeded(biometry::User{42})).Times(1);
+
+    auto op1 = coalescing.identifier().identify_user(biometry::Application{"greeter"}, biometry::Reason{"unlock"});
+    op1->start_with_observer(greeter);
+    auto op2 = coalescing.identifier().identify_user(biometry::Application{"indicator"}, biometry::Reason{"session"});
+    op2->start_with_observer(indicator);
+
+    ASSERT_NE(nullptr, relay);
+    relay->on_succeeded(biometry::User{42});
+}
+
+TEST_F(CoalescingDevice, requests_for_shared_and_other_apps_get_their_own_capture)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(identifier, identify_user(_, reason)).Times(2)
+            .WillRepeatedly(Invoke([](const biometry::Application&, const biometry::Reason&)
+            {
+                auto op = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+                EXPECT_CALL(*op, start_with_observer(_)).Times(1);
+                return op;
+            }));
+
+    biometry::devices::Coalescing::Policy policy;
+    policy.shared_applications = {"greeter"};
+    biometry::devices::Coalescing coalescing{impl, policy};
+
+    auto op1 = coalescing.identifier().identify_user(biometry::Application{"greeter"}, reason);
+    op1->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+    auto op2 = coalescing.identifier().identify_user(biometry::Application{"payment"}, reason);
+    op2->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+}
+
+TEST_F(CoalescingDevice, requests_for_different_reasons_get_their_own_capture)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(identifier, identify_user(app, _)).Times(2)
+            .WillRepeatedly(Invoke([](const biometry::Application&, const biometry::Reason&)
+            {
+                auto op = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+                EXPECT_CALL(*op, start_with_observer(_)).Times(1);
+                return op;
+            }));
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto op1 = coalescing.identifier().identify_user(app, biometry::Reason{"unlock"});
+    op1->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+    auto op2 = coalescing.identifier().identify_user(app, biometry::Reason{"payment"});
+    op2->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+}
+
+TEST_F(CoalescingDevice, late_requesters_are_reported_as_started)
+{
+    using namespace ::testing;
+
+    expect_capture();
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto first = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+    auto op1 = coalescing.identifier().identify_user(app, reason);
+    op1->start_with_observer(first);
+
+    relay->on_started();
+
+    auto second = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*second, on_started()).Times(1);
+    EXPECT_CALL(*second, on_failed("no finger")).Times(1);
+
+    auto op2 = coalescing.identifier().identify_user(app, reason);
+    op2->start_with_observer(second);
+
+    relay->on_failed("no finger");
+}
+
+TEST_F(CoalescingDevice, canceling_requester_is_detached_without_canceling_capture)
+{
+    using namespace ::testing;
+
+    auto op = expect_capture();
+    EXPECT_CALL(*op, cancel()).Times(0);
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto canceling = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+    EXPECT_CALL(*canceling, on_canceled(_)).Times(1);
+    EXPECT_CALL(*canceling, on_succeeded(_)).Times(0);
+
+    auto remaining = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+    EXPECT_CALL(*remaining, on_succeeded(_)).Times(1);
+
+    auto op1 = coalescing.identifier().identify_user(app, reason);
+    op1->start_with_observer(canceling);
+    auto op2 = coalescing.identifier().identify_user(app, reason);
+    op2->start_with_observer(remaining);
+
+    op1->cancel();
+    relay->on_succeeded(biometry::User{42});
+}
+
+TEST_F(CoalescingDevice, last_requester_canceling_cancels_capture)
+{
+    using namespace ::testing;
+
+    auto op = expect_capture();
+    EXPECT_CALL(*op, cancel()).Times(1).WillOnce(Invoke([this]() { relay->on_canceled("canceled"); }));
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto first = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+    EXPECT_CALL(*first, on_canceled("Canceled by requester")).Times(1);
+    auto second = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+    EXPECT_CALL(*second, on_canceled("canceled")).Times(1);
+
+    auto op1 = coalescing.identifier().identify_user(app, reason);
+    op1->start_with_observer(first);
+    auto op2 = coalescing.identifier().identify_user(app, reason);
+    op2->start_with_observer(second);
+
+    op1->cancel();
+    op2->cancel();
+}
+
+TEST_F(CoalescingDevice, requests_after_completion_start_a_new_capture)
+{
+    using namespace ::testing;
+
+    auto first_op = std::make_shared<MockOperation<biometry::Identification>>();
+    auto second_op = std::make_shared<MockOperation<biometry::Identification>>();
+    EXPECT_CALL(*first_op, start_with_observer(_)).Times(1).WillOnce(SaveArg<0>(&relay));
+    EXPECT_CALL(*second_op, start_with_observer(_)).Times(1);
+    EXPECT_CALL(identifier, identify_user(_, _)).Times(2).WillOnce(Return(first_op)).WillOnce(Return(second_op));
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto op1 = coalescing.identifier().identify_user(app, reason);
+    op1->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+    relay->on_succeeded(biometry::User{42});
+
+    auto op2 = coalescing.identifier().identify_user(app, reason);
+    op2->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+}
+
+TEST_F(CoalescingDevice, canceling_before_start_never_reaches_the_device)
+{
+    using namespace ::testing;
+
+    EXPECT_CALL(identifier, identify_user(_, _)).Times(0);
+
+    biometry::devices::Coalescing coalescing{impl};
+
+    auto observer = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*observer, on_canceled(_)).Times(1);
+
+    auto op = coalescing.identifier().identify_user(app, reason);
+    op->cancel();
+    op->start_with_observer(observer);
+}
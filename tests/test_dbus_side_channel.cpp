@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/side_channel.h>
+
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <stdexcept>
+
+namespace
+{
+std::vector<std::uint8_t> blob_of_size(std::size_t size, std::uint8_t value)
+{
+    return std::vector<std::uint8_t>(size, value);
+}
+
+biometry::Progress progress_with_blob(const std::vector<std::uint8_t>& blob)
+{
+    biometry::Progress progress{biometry::Percent::from_raw_value(0.5), biometry::Dictionary{}};
+    progress.details["frame"] = biometry::Variant::bl(blob);
+    progress.details["hint"] = biometry::Variant::s("lift finger");
+    return progress;
+}
+}
+
+TEST(SideChannel, packing_replaces_large_blobs_with_references)
+{
+    auto sc = biometry::dbus::SideChannel::create(1024 * 1024, 1024);
+
+    auto blob = blob_of_size(64 * 1024, 42);
+    auto packed = sc->pack(progress_with_blob(blob));
+
+    EXPECT_EQ(biometry::Variant::Type::vector, packed.details.at("frame").type());
+    EXPECT_EQ(biometry::Variant::s("lift finger"), packed.details.at("hint"));
+}
+
+TEST(SideChannel, packing_keeps_small_blobs_inline)
+{
+    auto sc = biometry::dbus::SideChannel::create(1024 * 1024, 1024);
+
+    auto progress = progress_with_blob(blob_of_size(16, 42));
+    EXPECT_EQ(progress, sc->pack(progress));
+}
+
+TEST(SideChannel, packed_progress_is_unpacked_by_attached_instance)
+{
+    auto reader = biometry::dbus::SideChannel::create(1024 * 1024, 1024);
+    auto writer = biometry::dbus::SideChannel::attach(::dup(reader->fd()), 1024);
+
+    auto progress = progress_with_blob(blob_of_size(64 * 1024, 42));
+    EXPECT_EQ(progress, reader->unpack(writer->pack(progress)));
+}
+
+TEST(SideChannel, references_to_overwritten_data_are_dropped)
+{
+    auto reader = biometry::dbus::SideChannel::create(256 * 1024, 1024);
+    auto writer = biometry::dbus::SideChannel::attach(::dup(reader->fd()), 1024);
+
+    auto stale = writer->pack(progress_with_blob(blob_of_size(100 * 1024, 1)));
+
+    // Wrapping around the ring overwrites the first record.
+    for (int i = 0; i < 4; i++)
+        writer->pack(progress_with_blob(blob_of_size(100 * 1024, 2)));
+
+    auto unpacked = reader->unpack(stale);
+    EXPECT_EQ(0u, unpacked.details.count("frame"));
+    EXPECT_EQ(biometry::Variant::s("lift finger"), unpacked.details.at("hint"));
+
+    auto fresh = progress_with_blob(blob_of_size(100 * 1024, 3));
+    EXPECT_EQ(fresh, reader->unpack(writer->pack(fresh)));
+}
+
+TEST(SideChannel, bogus_references_are_dropped)
+{
+    auto sc = biometry::dbus::SideChannel::create(1024 * 1024, 1024);
+
+    auto packed = sc->pack(progress_with_blob(blob_of_size(64 * 1024, 42)));
+    auto reference = packed.details.at("frame").vector();
+
+    for (auto offset : {std::int64_t{-8}, std::int64_t{3}, std::int64_t{1024 * 1024 * 1024}})
+    {
+        auto bogus = packed;
+        bogus.details["frame"] = biometry::Variant::v({reference[0], biometry::Variant::i(offset), reference[2], reference[3]});
+        EXPECT_EQ(0u, sc->unpack(bogus).details.count("frame"));
+    }
+}
+
+TEST(SideChannel, attaching_to_unsealed_fd_throws)
+{
+    int fds[2]; ASSERT_EQ(0, ::pipe(fds));
+    ::close(fds[1]);
+
+    EXPECT_THROW(biometry::dbus::SideChannel::attach(fds[0], 1024), std::runtime_error);
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/admission_control.h>
+
+#include <biometry/util/configuration.h>
+#include <biometry/util/metrics.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace
+{
+// limits returns a configuration enforcing the given limits.
+biometry::dbus::skeleton::AdmissionControl::Configuration limits(std::uint32_t per_peer, std::uint32_t per_app, double rate, std::uint32_t burst)
+{
+    biometry::dbus::skeleton::AdmissionControl::Configuration config;
+    config.max_operations_per_peer = per_peer;
+    config.max_operations_per_app = per_app;
+    config.requests_per_second = rate;
+    config.burst = burst;
+    return config;
+}
+
+const biometry::Application app{"com.ubuntu.system-settings"};
+const biometry::dbus::skeleton::AdmissionControl::Clock::time_point now = biometry::dbus::skeleton::AdmissionControl::Clock::now();
+}
+
+TEST(AdmissionControl, admits_requests_within_limits)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(2, 0, 0, 0));
+
+    auto admission = ac->admit(":1.42", app, now);
+    EXPECT_TRUE(static_cast<bool>(admission));
+    EXPECT_EQ(biometry::dbus::skeleton::AdmissionControl::Verdict::admitted, admission.verdict);
+    EXPECT_NE(nullptr, admission.ticket);
+}
+
+TEST(AdmissionControl, rejects_peer_with_too_many_operations_in_flight)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(2, 0, 0, 0));
+
+    auto first = ac->admit(":1.42", app, now);
+    auto second = ac->admit(":1.42", app, now);
+    auto third = ac->admit(":1.42", app, now);
+
+    EXPECT_FALSE(static_cast<bool>(third));
+    EXPECT_EQ(biometry::dbus::skeleton::AdmissionControl::Verdict::too_many_operations_for_peer, third.verdict);
+    EXPECT_EQ(nullptr, third.ticket);
+
+    // Other peers are not affected.
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.43", app, now)));
+}
+
+TEST(AdmissionControl, dropping_ticket_releases_operation)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(1, 0, 0, 0));
+
+    auto first = ac->admit(":1.42", app, now);
+    EXPECT_FALSE(static_cast<bool>(ac->admit(":1.42", app, now)));
+
+    first.ticket.reset();
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.42", app, now)));
+}
+
+TEST(AdmissionControl, releasing_ticket_releases_operation_exactly_once)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(1, 0, 0, 0));
+
+    auto first = ac->admit(":1.42", app, now);
+    first.ticket->release();
+    first.ticket->release();
+
+    auto second = ac->admit(":1.42", app, now);
+    EXPECT_TRUE(static_cast<bool>(second));
+    EXPECT_FALSE(static_cast<bool>(ac->admit(":1.42", app, now)));
+
+    // Dropping an already released ticket does not release the operation of another ticket.
+    first.ticket.reset();
+    EXPECT_FALSE(static_cast<bool>(ac->admit(":1.42", app, now)));
+}
+
+TEST(AdmissionControl, admits_trusted_apps_beyond_limits)
+{
+    auto config = limits(1, 1, 10., 1);
+    config.trusted_apps = {"unconfined"};
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(config);
+
+    std::vector<biometry::dbus::skeleton::AdmissionControl::Admission> admissions;
+    for (int i = 0; i < 10; i++)
+        admissions.push_back(ac->admit(":1.42", biometry::Application{"unconfined"}, now));
+
+    for (const auto& admission : admissions)
+        EXPECT_TRUE(static_cast<bool>(admission));
+
+    EXPECT_EQ(10u, ac->counters().at(":1.42").in_flight);
+    // Other apps are still limited.
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.43", app, now)));
+    EXPECT_FALSE(static_cast<bool>(ac->admit(":1.43", app, now)));
+}
+
+TEST(AdmissionControl, rejects_app_with_too_many_operations_in_flight_across_peers)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(0, 2, 0, 0));
+
+    auto first = ac->admit(":1.42", app, now);
+    auto second = ac->admit(":1.43", app, now);
+    auto third = ac->admit(":1.44", app, now);
+
+    EXPECT_EQ(biometry::dbus::skeleton::AdmissionControl::Verdict::too_many_operations_for_app, third.verdict);
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.44", biometry::Application{"unconfined"}, now)));
+}
+
+TEST(AdmissionControl, rejects_peer_exceeding_request_rate_until_bucket_refills)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(0, 0, 10., 2));
+
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.42", app, now)));
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.42", app, now)));
+    EXPECT_EQ(biometry::dbus::skeleton::AdmissionControl::Verdict::rate_exceeded, ac->admit(":1.42", app, now).verdict);
+
+    // At 10 requests per second, a single token is back after 100ms.
+    EXPECT_TRUE(static_cast<bool>(ac->admit(":1.42", app, now + std::chrono::milliseconds{100})));
+    EXPECT_FALSE(static_cast<bool>(ac->admit(":1.42", app, now + std::chrono::milliseconds{100})));
+}
+
+TEST(AdmissionControl, counts_requests_per_peer)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(1, 0, 0, 0));
+
+    auto rejected = biometry::util::metrics().counter("admission.rejected").value();
+
+    auto first = ac->admit(":1.42", app, now);
+    ac->admit(":1.42", app, now);
+    ac->admit(":1.42", app, now);
+
+    auto counters = ac->counters().at(":1.42");
+    EXPECT_EQ(app, counters.app);
+    EXPECT_EQ(1u, counters.admitted);
+    EXPECT_EQ(2u, counters.rejected);
+    EXPECT_EQ(1u, counters.in_flight);
+
+    EXPECT_EQ(rejected + 2, biometry::util::metrics().counter("admission.rejected").value());
+}
+
+TEST(AdmissionControl, counts_rejections_per_app_without_exporting_metrics_per_app)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(1, 0, 0, 0));
+
+    auto first = ac->admit(":1.42", app, now);
+    ac->admit(":1.42", app, now);
+    auto second = ac->admit(":1.43", app, now);
+    ac->admit(":1.43", app, now);
+
+    auto counters = ac->app_counters().at(app.as_string());
+    EXPECT_EQ(2u, counters.rejected);
+    EXPECT_EQ(2u, counters.in_flight);
+
+    EXPECT_EQ(0u, biometry::util::metrics().snapshot().counters.count("admission.rejected." + app.as_string()));
+}
+
+TEST(AdmissionControl, burst_of_zero_disables_rate_limiting)
+{
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(limits(0, 0, 10., 0));
+
+    for (int i = 0; i < 100; i++)
+        EXPECT_TRUE(static_cast<bool>(ac->admit(":1.42", app, now)));
+}
+
+TEST(AdmissionControl, forgets_idle_peers)
+{
+    auto config = limits(1, 0, 0, 0);
+    config.idle_ttl = std::chrono::seconds{1};
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(config);
+
+    ac->admit(":1.42", app, now);
+    auto busy = ac->admit(":1.43", app, now);
+    EXPECT_EQ(2u, ac->counters().size());
+
+    ac->admit(":1.44", app, now + std::chrono::hours{1});
+
+    auto counters = ac->counters();
+    EXPECT_EQ(0u, counters.count(":1.42"));
+    // Peers with operations in flight are never forgotten.
+    EXPECT_EQ(1u, counters.count(":1.43"));
+    EXPECT_EQ(1u, counters.count(":1.44"));
+}
+
+TEST(AdmissionControl, forgets_idle_apps)
+{
+    auto config = limits(1, 0, 0, 0);
+    config.idle_ttl = std::chrono::seconds{1};
+    auto ac = biometry::dbus::skeleton::AdmissionControl::create(config);
+
+    ac->admit(":1.42", biometry::Application{"com.example.app_app_1.0"}, now);
+    auto busy = ac->admit(":1.43", app, now);
+    EXPECT_EQ(2u, ac->app_counters().size());
+
+    ac->admit(":1.44", biometry::Application{"com.example.app_app_1.1"}, now + std::chrono::hours{1});
+
+    auto counters = ac->app_counters();
+    EXPECT_EQ(0u, counters.count("com.example.app_app_1.0"));
+    // App labels with operations in flight are never forgotten.
+    EXPECT_EQ(1u, counters.count(app.as_string()));
+    EXPECT_EQ(1u, counters.count("com.example.app_app_1.1"));
+}
+
+TEST(AdmissionControl, configuration_is_read_from_node)
+{
+    biometry::util::Configuration config;
+    config["admissionControl"]["maxOperationsPerPeer"] = biometry::util::Configuration::Node{biometry::Variant::i(4)};
+    config["admissionControl"]["maxOperationsPerApp"] = biometry::util::Configuration::Node{biometry::Variant::i(8)};
+    config["admissionControl"]["requestsPerSecond"] = biometry::util::Configuration::Node{biometry::Variant::d(2.5)};
+    config["admissionControl"]["burst"] = biometry::util::Configuration::Node{biometry::Variant::i(5)};
+    config["admissionControl"]["trustedApps"]["0"] = biometry::util::Configuration::Node{biometry::Variant::s("com.ubuntu.shell")};
+
+    const auto& node = static_cast<const biometry::util::Configuration&>(config)["admissionControl"];
+    auto configuration = biometry::dbus::skeleton::AdmissionControl::Configuration::from_configuration(node);
+
+    EXPECT_EQ(4u, configuration.max_operations_per_peer);
+    EXPECT_EQ(8u, configuration.max_operations_per_app);
+    EXPECT_DOUBLE_EQ(2.5, configuration.requests_per_second);
+    EXPECT_EQ(5u, configuration.burst);
+    EXPECT_EQ(std::set<std::string>{"com.ubuntu.shell"}, configuration.trusted_apps);
+}
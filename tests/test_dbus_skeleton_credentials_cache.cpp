@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/credentials_cache.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+typedef biometry::Optional<biometry::dbus::skeleton::RequestVerifier::Credentials> Credentials;
+
+const biometry::dbus::skeleton::RequestVerifier::Credentials credentials
+{
+    biometry::Application{"com.ubuntu.system-settings"},
+    biometry::User{4242}
+};
+
+// PendingQueries collects the handlers of issued queries, to be completed by the test.
+struct PendingQueries
+{
+    biometry::dbus::skeleton::CredentialsCache::Query query()
+    {
+        return [this](const biometry::dbus::skeleton::CredentialsCache::Handler& handler)
+        {
+            handlers.push_back(handler);
+        };
+    }
+
+    std::vector<biometry::dbus::skeleton::CredentialsCache::Handler> handlers;
+};
+
+// Result records the credentials handed to a lookup.
+struct Result
+{
+    biometry::dbus::skeleton::CredentialsCache::Handler handler()
+    {
+        return [this](const Credentials& c)
+        {
+            called = true;
+            credentials = c;
+        };
+    }
+
+    bool called{false};
+    Credentials credentials;
+};
+}
+
+TEST(CredentialsCache, cached_credentials_are_handed_out_without_querying)
+{
+    auto cache = biometry::dbus::skeleton::CredentialsCache::create();
+    PendingQueries queries;
+
+    Result first; cache->lookup(":1.42", queries.query(), first.handler());
+    ASSERT_EQ(1u, queries.handlers.size());
+    EXPECT_FALSE(first.called);
+
+    queries.handlers.front()(credentials);
+    EXPECT_TRUE(first.called);
+    EXPECT_EQ(credentials, first.credentials.get());
+    EXPECT_EQ(1u, cache->size());
+
+    Result second; cache->lookup(":1.42", queries.query(), second.handler());
+    EXPECT_EQ(1u, queries.handlers.size());
+    EXPECT_TRUE(second.called);
+    EXPECT_EQ(credentials, second.credentials.get());
+}
+
+TEST(CredentialsCache, failed_queries_are_not_cached)
+{
+    auto cache = biometry::dbus::skeleton::CredentialsCache::create();
+    PendingQueries queries;
+
+    Result first; cache->lookup(":1.42", queries.query(), first.handler());
+    queries.handlers.front()(Credentials{});
+    EXPECT_TRUE(first.called);
+    EXPECT_FALSE(first.credentials);
+    EXPECT_EQ(0u, cache->size());
+
+    Result second; cache->lookup(":1.42", queries.query(), second.handler());
+    EXPECT_EQ(2u, queries.handlers.size());
+}
+
+TEST(CredentialsCache, invalidation_drops_cached_credentials)
+{
+    auto cache = biometry::dbus::skeleton::CredentialsCache::create();
+    PendingQueries queries;
+
+    Result first; cache->lookup(":1.42", queries.query(), first.handler());
+    queries.handlers.front()(credentials);
+    EXPECT_EQ(1u, cache->size());
+
+    cache->invalidate(":1.42");
+    EXPECT_EQ(0u, cache->size());
+
+    Result second; cache->lookup(":1.42", queries.query(), second.handler());
+    EXPECT_EQ(2u, queries.handlers.size());
+    EXPECT_FALSE(second.called);
+}
+
+TEST(CredentialsCache, credentials_of_a_name_leaving_while_the_query_is_pending_are_not_cached)
+{
+    auto cache = biometry::dbus::skeleton::CredentialsCache::create();
+    PendingQueries queries;
+
+    Result result; cache->lookup(":1.42", queries.query(), result.handler());
+    cache->invalidate(":1.42");
+    queries.handlers.front()(credentials);
+
+    // The pending lookup is still answered, but the name is gone for good.
+    EXPECT_TRUE(result.called);
+    EXPECT_EQ(credentials, result.credentials.get());
+    EXPECT_EQ(0u, cache->size());
+}
+
+TEST(CredentialsCache, concurrent_lookups_share_a_single_query)
+{
+    auto cache = biometry::dbus::skeleton::CredentialsCache::create();
+    PendingQueries queries;
+
+    Result first; cache->lookup(":1.42", queries.query(), first.handler());
+    Result second; cache->lookup(":1.42", queries.query(), second.handler());
+    Result other; cache->lookup(":1.43", queries.query(), other.handler());
+    EXPECT_EQ(2u, queries.handlers.size());
+
+    queries.handlers.front()(credentials);
+    EXPECT_TRUE(first.called);
+    EXPECT_TRUE(second.called);
+    EXPECT_EQ(credentials, second.credentials.get());
+    EXPECT_FALSE(other.called);
+}
+
+TEST(CredentialsCache, lookups_from_many_threads_are_answered_exactly_once)
+{
+    static constexpr std::size_t thread_count{8};
+    static constexpr std::size_t lookups_per_thread{1000};
+
+    auto cache = biometry::dbus::skeleton::CredentialsCache::create();
+    std::atomic<std::size_t> queries{0};
+    std::atomic<std::size_t> answers{0};
+
+    // Queries complete right away, racing with lookups and invalidations on other threads.
+    auto query = [&queries](const biometry::dbus::skeleton::CredentialsCache::Handler& handler)
+    {
+        queries++;
+        handler(credentials);
+    };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; i++)
+    {
+        threads.emplace_back([cache, query, i, &answers]()
+        {
+            for (std::size_t j = 0; j < lookups_per_thread; j++)
+            {
+                auto name = ":1." + std::to_string(j % 16);
+                cache->lookup(name, query, [&answers](const Credentials&) { answers++; });
+                if (i == 0) cache->invalidate(name);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(thread_count * lookups_per_thread, answers.load());
+    EXPECT_LE(16u, queries.load());
+    EXPECT_GE(16u, cache->size());
+}
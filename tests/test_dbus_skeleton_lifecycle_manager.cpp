@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/lifecycle_manager.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+namespace
+{
+// We disable the worker thread's sweeps for the purpose of testing
+// and sweep manually instead.
+biometry::dbus::skeleton::LifecycleManager::Configuration manual_sweeps()
+{
+    biometry::dbus::skeleton::LifecycleManager::Configuration config;
+    config.idle_ttl = std::chrono::seconds{10};
+    config.started_ttl = std::chrono::hours{24};
+    config.sweep_interval = std::chrono::hours{1};
+    return config;
+}
+
+core::dbus::types::ObjectPath path(int i)
+{
+    return core::dbus::types::ObjectPath{"/operation/" + std::to_string(i)};
+}
+
+const std::chrono::steady_clock::time_point later = std::chrono::steady_clock::now() + std::chrono::hours{2};
+}
+
+TEST(LifecycleManager, keeps_operation_alive_until_reaped)
+{
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(manual_sweeps());
+
+    auto op = std::make_shared<int>(42); std::weak_ptr<int> wp{op};
+    lm->add(path(0), ":1.42", op, [](){}); op.reset();
+
+    EXPECT_FALSE(wp.expired());
+    EXPECT_EQ(1u, lm->counters().live);
+    EXPECT_EQ(0u, lm->sweep());
+    EXPECT_FALSE(wp.expired());
+}
+
+TEST(LifecycleManager, reaps_finished_operations)
+{
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(manual_sweeps());
+
+    auto op = std::make_shared<int>(42); std::weak_ptr<int> wp{op};
+    lm->add(path(0), ":1.42", op, [](){}); op.reset();
+    lm->started(path(0));
+    lm->finished(path(0));
+
+    EXPECT_EQ(1u, lm->sweep(later));
+    EXPECT_TRUE(wp.expired());
+
+    auto counters = lm->counters();
+    EXPECT_EQ(0u, counters.live);
+    EXPECT_EQ(1u, counters.reaped);
+    EXPECT_EQ(1u, counters.terminated);
+}
+
+TEST(LifecycleManager, does_not_reap_running_operations)
+{
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(manual_sweeps());
+
+    lm->add(path(0), ":1.42", std::make_shared<int>(42), [](){});
+    lm->started(path(0));
+
+    EXPECT_EQ(0u, lm->sweep(later));
+    EXPECT_EQ(1u, lm->counters().live);
+}
+
+TEST(LifecycleManager, cancels_and_reaps_running_operations_after_ttl)
+{
+    auto config = manual_sweeps();
+    config.started_ttl = std::chrono::minutes{1};
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(config);
+
+    bool canceled{false};
+    lm->add(path(0), ":1.42", std::make_shared<int>(42), [&canceled]() { canceled = true; });
+    lm->started(path(0));
+
+    EXPECT_EQ(0u, lm->sweep());
+    EXPECT_FALSE(canceled);
+    EXPECT_EQ(1u, lm->sweep(later));
+    EXPECT_TRUE(canceled);
+
+    auto counters = lm->counters();
+    EXPECT_EQ(0u, counters.live);
+    EXPECT_EQ(1u, counters.expired);
+}
+
+TEST(LifecycleManager, reaps_idle_operations_after_ttl)
+{
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(manual_sweeps());
+
+    lm->add(path(0), ":1.42", std::make_shared<int>(42), [](){});
+
+    EXPECT_EQ(0u, lm->sweep());
+    EXPECT_EQ(1u, lm->sweep(later));
+
+    auto counters = lm->counters();
+    EXPECT_EQ(0u, counters.live);
+    EXPECT_EQ(1u, counters.idle);
+}
+
+TEST(LifecycleManager, cancels_and_reaps_running_operations_of_vanished_peer)
+{
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(manual_sweeps());
+
+    bool canceled{false};
+    lm->add(path(0), ":1.42", std::make_shared<int>(42), [&canceled, lm]() { canceled = true; lm->finished(path(0)); });
+    lm->add(path(1), ":1.43", std::make_shared<int>(43), [](){});
+    lm->started(path(0));
+    lm->started(path(1));
+
+    lm->vanished(":1.42");
+
+    EXPECT_EQ(1u, lm->sweep());
+    EXPECT_TRUE(canceled);
+
+    auto counters = lm->counters();
+    EXPECT_EQ(1u, counters.live);
+    EXPECT_EQ(1u, counters.vanished);
+}
+
+TEST(LifecycleManager, does_not_cancel_idle_operations_of_vanished_peer)
+{
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(manual_sweeps());
+
+    bool canceled{false};
+    lm->add(path(0), ":1.42", std::make_shared<int>(42), [&canceled]() { canceled = true; });
+
+    lm->vanished(":1.42");
+
+    EXPECT_EQ(1u, lm->sweep());
+    EXPECT_FALSE(canceled);
+    EXPECT_EQ(0u, lm->counters().live);
+}
+
+TEST(LifecycleManager, worker_reaps_finished_operations)
+{
+    biometry::dbus::skeleton::LifecycleManager::Configuration config;
+    config.sweep_interval = std::chrono::milliseconds{10};
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(config);
+
+    for (int i = 0; i < 100; i++)
+    {
+        lm->add(path(i), ":1.42", std::make_shared<int>(i), [](){});
+        lm->started(path(i));
+        lm->finished(path(i));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    auto counters = lm->counters();
+    EXPECT_EQ(0u, counters.live);
+    EXPECT_EQ(100u, counters.reaped);
+}
+
+TEST(LifecycleManager, survives_dropping_the_last_reference_on_the_worker_thread)
+{
+    biometry::dbus::skeleton::LifecycleManager::Configuration config;
+    config.sweep_interval = std::chrono::milliseconds{10};
+    auto lm = biometry::dbus::skeleton::LifecycleManager::create(config);
+    std::weak_ptr<biometry::dbus::skeleton::LifecycleManager> wp{lm};
+
+    // The operation holds on to the manager, just like the observer of an operation reporting back to it.
+    std::shared_ptr<void> op{new int{42}, [lm](int* p) { delete p; }};
+    lm->add(path(0), ":1.42", op, [](){});
+    lm->started(path(0));
+    lm->finished(path(0));
+    op.reset(); lm.reset();
+
+    for (int i = 0; i < 100 && not wp.expired(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+    EXPECT_TRUE(wp.expired());
+}
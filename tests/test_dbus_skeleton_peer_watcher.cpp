@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/peer_watcher.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(PeerWatcher, reports_vanished_peers_to_all_handlers)
+{
+    auto watcher = biometry::dbus::skeleton::PeerWatcher::create();
+
+    std::vector<std::string> first, second;
+    auto t1 = watcher->on_peer_vanished([&first](const std::string& peer) { first.push_back(peer); });
+    auto t2 = watcher->on_peer_vanished([&second](const std::string& peer) { second.push_back(peer); });
+
+    watcher->vanished(":1.42");
+
+    EXPECT_EQ(std::vector<std::string>{":1.42"}, first);
+    EXPECT_EQ(std::vector<std::string>{":1.42"}, second);
+}
+
+TEST(PeerWatcher, stops_reporting_once_token_is_dropped)
+{
+    auto watcher = biometry::dbus::skeleton::PeerWatcher::create();
+
+    std::size_t calls{0};
+    auto token = watcher->on_peer_vanished([&calls](const std::string&) { calls++; });
+
+    watcher->vanished(":1.42");
+    token.reset();
+    watcher->vanished(":1.43");
+
+    EXPECT_EQ(1u, calls);
+}
+
+TEST(PeerWatcher, token_keeps_watcher_alive)
+{
+    auto watcher = biometry::dbus::skeleton::PeerWatcher::create();
+    std::weak_ptr<biometry::dbus::skeleton::PeerWatcher> wp{watcher};
+
+    auto token = watcher->on_peer_vanished([](const std::string&) {});
+    watcher.reset();
+
+    EXPECT_FALSE(wp.expired());
+    token.reset();
+    EXPECT_TRUE(wp.expired());
+}
+
+TEST(PeerWatcher, handlers_may_drop_their_token_while_being_invoked)
+{
+    auto watcher = biometry::dbus::skeleton::PeerWatcher::create();
+
+    std::shared_ptr<void> token;
+    std::size_t calls{0};
+    token = watcher->on_peer_vanished([&token, &calls](const std::string&) { calls++; token.reset(); });
+
+    watcher->vanished(":1.42");
+    watcher->vanished(":1.43");
+
+    EXPECT_EQ(1u, calls);
+}
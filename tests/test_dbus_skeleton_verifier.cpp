@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/dbus/skeleton/verifier.h>
+
+#include <biometry/application.h>
+#include <biometry/user.h>
+
+#include <gtest/gtest.h>
+
+namespace
+{
+// Safe us some typing.
+typedef biometry::dbus::skeleton::Verifier::RequestVerifier RequestVerifier;
+typedef RequestVerifier::Credentials Credentials;
+
+const biometry::Application settings{"com.ubuntu.system-settings"};
+const biometry::Application unconfined{"unconfined"};
+const biometry::User user{42};
+const biometry::User other_user{43};
+}
+
+TEST(VerifierRequestVerifier, allows_requests_for_own_app_and_user)
+{
+    RequestVerifier rv;
+    EXPECT_TRUE(rv.verify_verify_user_request(Credentials{settings, user}, Credentials{settings, user}));
+}
+
+TEST(VerifierRequestVerifier, rejects_requests_on_behalf_of_other_apps)
+{
+    RequestVerifier rv;
+    EXPECT_FALSE(rv.verify_verify_user_request(Credentials{biometry::Application{"com.evil.payment"}, user}, Credentials{settings, user}));
+}
+
+TEST(VerifierRequestVerifier, rejects_requests_for_other_users)
+{
+    RequestVerifier rv;
+    EXPECT_FALSE(rv.verify_verify_user_request(Credentials{settings, other_user}, Credentials{settings, user}));
+}
+
+TEST(VerifierRequestVerifier, allows_unconfined_apps_to_request_on_behalf_of_other_apps_for_their_own_user)
+{
+    RequestVerifier rv;
+    EXPECT_TRUE(rv.verify_verify_user_request(Credentials{settings, user}, Credentials{unconfined, user}));
+    EXPECT_TRUE(rv.verify_verify_user_request(Credentials{biometry::Application::system(), user}, Credentials{unconfined, user}));
+}
+
+TEST(VerifierRequestVerifier, rejects_unconfined_apps_requesting_for_other_users)
+{
+    RequestVerifier rv;
+    EXPECT_FALSE(rv.verify_verify_user_request(Credentials{settings, other_user}, Credentials{unconfined, user}));
+}
@@ -19,8 +19,18 @@
 
 #include <biometry/runtime.h>
 
+#include <biometry/dbus/client_connection.h>
+#include <biometry/dbus/interface.h>
 #include <biometry/dbus/skeleton/service.h>
+#include <biometry/dbus/stub/errors.h>
+#include <biometry/dbus/stub/identifier.h>
+#include <biometry/dbus/stub/metrics.h>
+#include <biometry/dbus/stub/observer.h>
 #include <biometry/dbus/stub/service.h>
+#include <biometry/devices/deferred.h>
+
+#include <biometry/util/json.hpp>
+#include <biometry/util/trace.h>
 
 #include <core/dbus/fixture.h>
 #include <core/posix/fork.h>
@@ -30,6 +40,10 @@
 
 #include <gmock/gmock.h>
 
+#include <atomic>
+#include <future>
+#include <thread>
+
 #include "did_finish_successfully.h"
 #include "mock_device.h"
 
@@ -119,6 +133,21 @@ std::future<typename biometry::Operation<T>::Observer::Result> start(const typen
     return observer->promise.get_future();
 }
 
+// FrozenProgressTimer never advances and never runs scheduled tasks.
+struct FrozenProgressTimer : public biometry::dbus::stub::ProgressTimer
+{
+    Clock::time_point now() const override
+    {
+        return Clock::time_point{} + std::chrono::hours{1};
+    }
+
+    void schedule(const Clock::duration&, const std::function<void()>&) override
+    {
+        scheduled++;
+    }
+
+    std::atomic<int> scheduled{0};
+};
 }
 
 TEST_F(TestDbusStubSkeleton, stub_skeleton_service_can_talk_with_one_another)
@@ -182,3 +211,600 @@ TEST_F(TestDbusStubSkeleton, stub_skeleton_service_can_talk_with_one_another)
     ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
     EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
 }
+
+TEST_F(TestDbusStubSkeleton, async_stub_pipelines_creating_and_starting_operations)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto identifier = std::make_shared<NiceMock<MockIdentifier>>();
+        ON_CALL(*identifier, identify_user(_,_)).WillByDefault(Return(std::make_shared<NiceMock<MockOperation<biometry::Identification>>>()));
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        ON_CALL(*device, identifier()).WillByDefault(ReturnRef(*identifier));
+
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        auto device = service->default_device_async().get();
+
+        auto& identifier = dynamic_cast<biometry::dbus::stub::Identifier&>(device->identifier());
+
+        // We do not wait for the operation to be created before starting it.
+        auto op = identifier.identify_user_async(biometry::Application::system(), biometry::Reason::unknown());
+        auto started = op->start_with_observer_async(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+        auto canceled = op->cancel_async();
+
+        EXPECT_NO_THROW(started.get());
+        EXPECT_NO_THROW(canceled.get());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, fused_method_creates_and_starts_operation_in_a_single_round_trip)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto op = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+        ON_CALL(*op, start_with_observer(_)).WillByDefault(Invoke([](const biometry::Operation<biometry::Identification>::Observer::Ptr& observer)
+        {
+            observer->on_started();
+        }));
+
+        auto identifier = std::make_shared<NiceMock<MockIdentifier>>();
+        ON_CALL(*identifier, identify_user(_,_)).WillByDefault(Return(op));
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        ON_CALL(*device, identifier()).WillByDefault(ReturnRef(*identifier));
+
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        auto device = service->default_device_async().get();
+
+        auto& identifier = dynamic_cast<biometry::dbus::stub::Identifier&>(device->identifier());
+
+        auto on_started = std::make_shared<std::promise<void>>();
+        auto observer = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+        ON_CALL(*observer, on_started()).WillByDefault(Invoke([on_started]() { on_started->set_value(); }));
+
+        auto acked = std::make_shared<std::promise<void>>();
+        auto op = identifier.identify_user_and_start_async(biometry::Application::system(), biometry::Reason::unknown(), observer, [acked](std::exception_ptr error)
+        {
+            if (error) acked->set_exception(error); else acked->set_value();
+        });
+
+        EXPECT_NO_THROW(acked->get_future().get());
+        EXPECT_EQ(std::future_status::ready, on_started->get_future().wait_for(std::chrono::seconds{5}));
+        EXPECT_NO_THROW(op->cancel_async().get());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, operations_created_through_the_generic_interface_are_created_and_started_in_a_single_round_trip)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto op = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+        ON_CALL(*op, start_with_observer(_)).WillByDefault(Invoke([](const biometry::Operation<biometry::Identification>::Observer::Ptr& observer)
+        {
+            observer->on_started();
+        }));
+
+        auto identifier = std::make_shared<NiceMock<MockIdentifier>>();
+        ON_CALL(*identifier, identify_user(_,_)).WillByDefault(Return(op));
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        ON_CALL(*device, identifier()).WillByDefault(ReturnRef(*identifier));
+
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        auto device = service->default_device();
+
+        auto on_started = std::make_shared<std::promise<void>>();
+        auto observer = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+        ON_CALL(*observer, on_started()).WillByDefault(Invoke([on_started]() { on_started->set_value(); }));
+
+        auto op = device->identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown());
+        EXPECT_NO_THROW(op->start_with_observer(observer));
+        EXPECT_EQ(std::future_status::ready, on_started->get_future().wait_for(std::chrono::seconds{5}));
+        EXPECT_NO_THROW(op->cancel());
+
+        auto dump = biometry::dbus::stub::Metrics::create_for_bus(scope->bus)->dump();
+        EXPECT_THAT(dump, HasSubstr("requests.com.ubuntu.biometryd.Identifier.IdentifyUserAndStart 1\n"));
+        EXPECT_THAT(dump, Not(HasSubstr("requests.com.ubuntu.biometryd.Identifier.IdentifyUser ")));
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, progress_updates_are_coalesced_and_terminal_events_delivered)
+{
+    using namespace ::testing;
+
+    static constexpr const int progress_updates{1000};
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        // With time standing still, the first update is sent right away and all further
+        // ones are merged until the terminal event flushes the latest one.
+        auto timer = std::make_shared<FrozenProgressTimer>();
+        biometry::dbus::stub::Observer<biometry::Identification>::configure_defaults({std::chrono::minutes{1}, timer});
+
+        auto op = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+        ON_CALL(*op, start_with_observer(_)).WillByDefault(Invoke([timer](const biometry::Operation<biometry::Identification>::Observer::Ptr& observer)
+        {
+            observer->on_started();
+            for (int i = 0; i < progress_updates; i++)
+                observer->on_progress(biometry::Progress::none());
+            observer->on_succeeded(biometry::User::root());
+            // At most once, when the first update is acknowledged before the terminal event.
+            EXPECT_GE(1, timer->scheduled.load());
+        }));
+
+        auto identifier = std::make_shared<NiceMock<MockIdentifier>>();
+        ON_CALL(*identifier, identify_user(_,_)).WillByDefault(Return(op));
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        ON_CALL(*device, identifier()).WillByDefault(ReturnRef(*identifier));
+
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        auto device = service->default_device_async().get();
+
+        std::atomic<int> progress{0};
+        auto succeeded = std::make_shared<std::promise<void>>();
+
+        auto observer = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+        ON_CALL(*observer, on_progress(_)).WillByDefault(Invoke([&progress](const biometry::Progress&) { progress++; }));
+        ON_CALL(*observer, on_succeeded(_)).WillByDefault(Invoke([succeeded](const biometry::User&) { succeeded->set_value(); }));
+
+        auto op = device->identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown());
+        op->start_with_observer(observer);
+
+        EXPECT_EQ(std::future_status::ready, succeeded->get_future().wait_for(std::chrono::seconds{5}));
+        EXPECT_EQ(2, progress.load());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, verifier_delivers_verification_results)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto op = std::make_shared<NiceMock<MockOperation<biometry::Verification>>>();
+        ON_CALL(*op, start_with_observer(_)).WillByDefault(Invoke([](const biometry::Operation<biometry::Verification>::Observer::Ptr& observer)
+        {
+            observer->on_started();
+            observer->on_succeeded(biometry::Verification::Result::verified);
+        }));
+
+        auto verifier = std::make_shared<NiceMock<MockVerifier>>();
+        ON_CALL(*verifier, verify_user(_,_,_)).WillByDefault(Return(op));
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        ON_CALL(*device, verifier()).WillByDefault(ReturnRef(*verifier));
+
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        auto device = service->default_device();
+
+        auto succeeded = std::make_shared<std::promise<biometry::Verification::Result>>();
+
+        auto observer = std::make_shared<NiceMock<MockObserver<biometry::Verification>>>();
+        ON_CALL(*observer, on_succeeded(_)).WillByDefault(Invoke([succeeded](const biometry::Verification::Result& result) { succeeded->set_value(result); }));
+
+        auto op = device->verifier().verify_user(biometry::Application::system(), biometry::User::current(), biometry::Reason::unknown());
+        op->start_with_observer(observer);
+
+        auto result = succeeded->get_future();
+        EXPECT_EQ(std::future_status::ready, result.wait_for(std::chrono::seconds{5}));
+        EXPECT_EQ(biometry::Verification::Result::verified, result.get());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, metrics_are_exported_and_count_requests)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        service->default_device();
+
+        auto dump = biometry::dbus::stub::Metrics::create_for_bus(scope->bus)->dump();
+        EXPECT_THAT(dump, HasSubstr("requests.com.ubuntu.biometryd.Service.DefaultDevice 1\n"));
+        EXPECT_THAT(dump, HasSubstr("requests.com.ubuntu.biometryd.Metrics.Dump 1\n"));
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, trace_events_are_exported_in_chrome_trace_event_format)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        biometry::util::trace::tracer().enable();
+
+        auto scope = skeleton_scope();
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        service->default_device();
+
+        auto trace = nlohmann::json::parse(biometry::dbus::stub::Metrics::create_for_bus(scope->bus)->trace());
+
+        bool found{false};
+        for (const auto& event : trace["traceEvents"])
+            found = found || event["name"] == "com.ubuntu.biometryd.Service.DefaultDevice";
+        EXPECT_TRUE(found);
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, readiness_reflects_deferred_device_instantiation)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto device = std::make_shared<biometry::devices::Deferred>();
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service, device);
+
+        // We mimic a slow vendor HAL, making the actual device available only after a while.
+        std::thread instantiator{[device]()
+        {
+            std::this_thread::sleep_for(std::chrono::seconds{1});
+            device->resolve(std::make_shared<NiceMock<MockDevice>>());
+        }};
+
+        auto status = scope->run();
+        instantiator.join();
+
+        return status;
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+
+        EXPECT_FALSE(service->is_ready());
+        EXPECT_NO_THROW(service->default_device());
+        std::this_thread::sleep_for(std::chrono::seconds{2});
+        EXPECT_TRUE(service->is_ready());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{250});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, stubs_share_a_client_connection)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto rt = biometry::Runtime::create();
+        rt->start();
+
+        auto connection = biometry::dbus::ClientConnection::create([this]() { return session_bus(); }, rt);
+
+        auto first = biometry::dbus::stub::Service::create_for_connection(connection);
+        auto second = biometry::dbus::stub::Service::create_for_connection(connection);
+
+        EXPECT_NE(nullptr, first->default_device());
+        EXPECT_NE(nullptr, second->default_device());
+        EXPECT_EQ(connection->object_for_path(biometry::dbus::interface::Service::path()),
+                  connection->object_for_path(biometry::dbus::interface::Service::path()));
+        EXPECT_EQ(0u, connection->generation());
+
+        connection->bus()->stop();
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, last_connection_can_be_dropped_from_a_bus_callback)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service);
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        std::weak_ptr<biometry::Runtime> runtime;
+        auto dropped = std::make_shared<std::promise<void>>();
+
+        {
+            auto rt = biometry::Runtime::create();
+            rt->start();
+            runtime = rt;
+
+            auto connection = biometry::dbus::ClientConnection::create([this]() { return session_bus(); }, rt);
+            auto service = std::make_shared<biometry::dbus::stub::Service::Ptr>(biometry::dbus::stub::Service::create_for_connection(connection));
+
+            (*service)->default_device_async([service, dropped](const std::shared_ptr<biometry::Device>&, std::exception_ptr)
+            {
+                // Drops the last reference to the connection, and thus to its runtime, on a worker thread of that runtime.
+                service->reset();
+                dropped->set_value();
+            });
+        }
+
+        EXPECT_EQ(std::future_status::ready, dropped->get_future().wait_for(std::chrono::seconds{5}));
+
+        // The runtime is torn down on a helper thread, without terminating the process.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+        while (not runtime.expired() && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+
+        EXPECT_TRUE(runtime.expired());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
+
+TEST_F(TestDbusStubSkeleton, requests_over_the_limit_are_rejected_as_busy)
+{
+    using namespace ::testing;
+
+    auto skeleton = [this]()
+    {
+        auto scope = skeleton_scope();
+
+        auto identifier = std::make_shared<NiceMock<MockIdentifier>>();
+        ON_CALL(*identifier, identify_user(_,_)).WillByDefault(Return(std::make_shared<NiceMock<MockOperation<biometry::Identification>>>()));
+
+        auto device = std::make_shared<NiceMock<MockDevice>>();
+        ON_CALL(*device, identifier()).WillByDefault(ReturnRef(*identifier));
+
+        auto service = std::make_shared<NiceMock<MockService>>();
+        ON_CALL(*service, default_device()).WillByDefault(Return(device));
+
+        biometry::dbus::skeleton::AdmissionControl::Configuration config;
+        config.max_operations_per_peer = 1;
+        // The test runs unconfined, which is trusted by default.
+        config.trusted_apps.clear();
+
+        auto skeleton = biometry::dbus::skeleton::Service::create_for_bus(scope->bus, service, biometry::devices::Deferred::Ptr{},
+                                                                          biometry::dbus::skeleton::AdmissionControl::create(config));
+
+        return scope->run();
+    };
+
+    auto stub = [this]()
+    {
+        auto scope = stub_scope();
+        auto service = biometry::dbus::stub::Service::create_for_bus(scope->bus);
+        auto device = service->default_device();
+
+        auto& identifier = dynamic_cast<biometry::dbus::stub::Identifier&>(device->identifier());
+
+        // The first operation is never started and stays in flight.
+        auto op = identifier.identify_user_async(biometry::Application::system(), biometry::Reason::unknown());
+        EXPECT_NO_THROW(op->wait_for_resolution());
+        EXPECT_THROW(identifier.identify_user_async(biometry::Application::system(), biometry::Reason::unknown())->wait_for_resolution(),
+                     biometry::dbus::stub::Busy);
+
+        // Canceling releases the operation right away, without waiting for it to be reaped.
+        op->cancel();
+        EXPECT_NO_THROW(identifier.identify_user_async(biometry::Application::system(), biometry::Reason::unknown())->wait_for_resolution());
+
+        return ::testing::Test::HasFailure() ? core::posix::exit::Status::failure : core::posix::exit::Status::success;
+    };
+
+    auto cp_skeleton = core::posix::fork(skeleton, core::posix::StandardStream::empty);
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    auto cp_stub = core::posix::fork(stub, core::posix::StandardStream::empty);
+
+    EXPECT_TRUE(did_finish_successfully(cp_stub.wait_for(core::posix::wait::Flags::untraced)));
+    ASSERT_NO_THROW(cp_skeleton.send_signal_or_throw(core::posix::Signal::sig_term));
+    EXPECT_TRUE(did_finish_successfully(cp_skeleton.wait_for(core::posix::wait::Flags::untraced)));
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/deferred.h>
+
+#include <biometry/application.h>
+#include <biometry/reason.h>
+#include <biometry/user.h>
+
+#include <gmock/gmock.h>
+
+#include <thread>
+
+#include "mock_device.h"
+
+namespace
+{
+struct DeferredDevice : public ::testing::Test
+{
+    const biometry::Application app{biometry::Application::system()};
+    const biometry::Reason reason{biometry::Reason::unknown()};
+    const biometry::User user{biometry::User::current()};
+};
+}
+
+TEST(Deferred, is_pending_after_construction)
+{
+    biometry::devices::Deferred deferred;
+    EXPECT_EQ(biometry::devices::Deferred::State::pending, deferred.state());
+}
+
+TEST(Deferred, throws_for_null_device)
+{
+    biometry::devices::Deferred deferred;
+    EXPECT_THROW(deferred.resolve(std::shared_ptr<biometry::Device>{}), std::runtime_error);
+    EXPECT_EQ(biometry::devices::Deferred::State::pending, deferred.state());
+}
+
+TEST(Deferred, can_only_be_resolved_once)
+{
+    biometry::devices::Deferred deferred;
+    deferred.resolve(std::make_shared<::testing::NiceMock<::testing::MockDevice>>());
+    EXPECT_EQ(biometry::devices::Deferred::State::ready, deferred.state());
+    EXPECT_THROW(deferred.resolve(std::make_shared<::testing::NiceMock<::testing::MockDevice>>()), std::logic_error);
+    EXPECT_THROW(deferred.fail("lala"), std::logic_error);
+}
+
+TEST(Deferred, invokes_continuations_once_resolved)
+{
+    biometry::devices::Deferred deferred;
+
+    std::shared_ptr<biometry::Device> parked, immediate;
+    deferred.when_resolved([&parked](const std::shared_ptr<biometry::Device>& device, const std::string&) { parked = device; });
+    EXPECT_EQ(nullptr, parked);
+
+    auto device = std::make_shared<::testing::NiceMock<::testing::MockDevice>>();
+    deferred.resolve(device);
+    EXPECT_EQ(device, parked);
+
+    deferred.when_resolved([&immediate](const std::shared_ptr<biometry::Device>& device, const std::string&) { immediate = device; });
+    EXPECT_EQ(device, immediate);
+}
+
+TEST_F(DeferredDevice, parks_operations_until_resolved)
+{
+    using namespace ::testing;
+
+    bool resolved{false};
+
+    auto op = std::make_shared<MockOperation<biometry::Identification>>();
+    EXPECT_CALL(*op, start_with_observer(_)).Times(1);
+
+    MockIdentifier identifier;
+    EXPECT_CALL(identifier, identify_user(_, _)).Times(1).WillOnce(Invoke([&resolved, op](const biometry::Application&, const biometry::Reason&)
+    {
+        EXPECT_TRUE(resolved);
+        return op;
+    }));
+
+    auto impl = std::make_shared<MockDevice>();
+    EXPECT_CALL(*impl, identifier()).Times(1).WillOnce(ReturnRef(identifier));
+
+    biometry::devices::Deferred deferred;
+    deferred.identifier().identify_user(app, reason)->start_with_observer(std::make_shared<MockObserver<biometry::Identification>>());
+
+    resolved = true;
+    deferred.resolve(impl);
+}
+
+TEST_F(DeferredDevice, forwards_operations_once_resolved)
+{
+    using namespace ::testing;
+
+    auto op = std::make_shared<MockOperation<biometry::TemplateStore::SizeQuery>>();
+    EXPECT_CALL(*op, start_with_observer(_)).Times(1);
+    EXPECT_CALL(*op, cancel()).Times(1);
+
+    MockTemplateStore ts;
+    EXPECT_CALL(ts, size(_, _)).Times(1).WillOnce(Return(op));
+
+    auto impl = std::make_shared<MockDevice>();
+    EXPECT_CALL(*impl, template_store()).Times(1).WillOnce(ReturnRef(ts));
+
+    biometry::devices::Deferred deferred;
+    deferred.resolve(impl);
+
+    auto deferred_op = deferred.template_store().size(app, user);
+    deferred_op->start_with_observer(std::make_shared<MockObserver<biometry::TemplateStore::SizeQuery>>());
+    deferred_op->cancel();
+}
+
+TEST_F(DeferredDevice, fails_parked_and_subsequent_operations_if_device_cannot_be_created)
+{
+    using namespace ::testing;
+
+    biometry::devices::Deferred deferred;
+
+    auto parked = std::make_shared<MockObserver<biometry::Verification>>();
+    EXPECT_CALL(*parked, on_failed("no hal")).Times(1);
+    deferred.verifier().verify_user(app, user, reason)->start_with_observer(parked);
+
+    deferred.fail("no hal");
+    EXPECT_EQ(biometry::devices::Deferred::State::failed, deferred.state());
+
+    auto subsequent = std::make_shared<MockObserver<biometry::Verification>>();
+    EXPECT_CALL(*subsequent, on_failed("no hal")).Times(1);
+    deferred.verifier().verify_user(app, user, reason)->start_with_observer(subsequent);
+}
+
+TEST_F(DeferredDevice, reports_parked_operations_canceled_before_resolution_as_canceled)
+{
+    using namespace ::testing;
+
+    MockTemplateStore ts;
+    EXPECT_CALL(ts, enroll(_, _)).Times(0);
+
+    auto impl = std::make_shared<NiceMock<MockDevice>>();
+    ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(ts));
+
+    biometry::devices::Deferred deferred;
+
+    auto observer = std::make_shared<MockObserver<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*observer, on_canceled(_)).Times(1);
+
+    auto op = deferred.template_store().enroll(app, user);
+    op->start_with_observer(observer);
+    op->cancel();
+
+    deferred.resolve(impl);
+}
+
+TEST_F(DeferredDevice, resolution_from_another_thread_starts_parked_operations)
+{
+    using namespace ::testing;
+
+    auto op = std::make_shared<MockOperation<biometry::TemplateStore::List>>();
+    EXPECT_CALL(*op, start_with_observer(_)).Times(1);
+
+    MockTemplateStore ts;
+    EXPECT_CALL(ts, list(_, _)).Times(1).WillOnce(Return(op));
+
+    auto impl = std::make_shared<MockDevice>();
+    EXPECT_CALL(*impl, template_store()).Times(1).WillOnce(ReturnRef(ts));
+
+    biometry::devices::Deferred deferred;
+    deferred.template_store().list(app, user)->start_with_observer(std::make_shared<MockObserver<biometry::TemplateStore::List>>());
+
+    std::thread instantiator{[&deferred, impl]() { deferred.resolve(impl); }};
+    instantiator.join();
+
+    EXPECT_EQ(biometry::devices::Deferred::State::ready, deferred.state());
+}
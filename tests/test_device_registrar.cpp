@@ -22,6 +22,7 @@
 #include <biometry/device_registry.h>
 
 #include <biometry/devices/dummy.h>
+#include <biometry/devices/simulated.h>
 #include <biometry/devices/plugin/device.h>
 #include <biometry/devices/plugin/enumerator.h>
 
@@ -62,6 +63,12 @@ TEST(DeviceRegistrar, adds_dummy_device)
     EXPECT_EQ(1, biometry::device_registry().count(biometry::devices::Dummy::id));
 }
 
+TEST(DeviceRegistrar, adds_simulated_device)
+{
+    biometry::DeviceRegistrar dr{biometry::devices::plugin::DirectoryEnumerator{{testing::runtime_dir()}}};
+    EXPECT_EQ(1, biometry::device_registry().count(biometry::devices::Simulated::id));
+}
+
 TEST(DeviceRegistrar, adds_plugin_device)
 {
     biometry::DeviceRegistrar dr{biometry::devices::plugin::DirectoryEnumerator{{testing::runtime_dir()}}};
@@ -21,6 +21,8 @@
 
 #include <gtest/gtest.h>
 
+#include <stdexcept>
+
 TEST(Dictionary, default_constructor_works)
 {
     biometry::Dictionary{};
@@ -43,6 +45,62 @@ TEST(Dictionary, removal_works)
     EXPECT_TRUE(dict.count("test") == 0);
 }
 
+TEST(Dictionary, lookup_works_for_c_strings_std_strings_and_keys)
+{
+    biometry::Dictionary dict;
+    dict[std::string{"test"}] = biometry::Variant::i(42);
+
+    EXPECT_EQ(42, dict.at("test").integer());
+    EXPECT_EQ(42, dict.at(std::string{"test"}).integer());
+    EXPECT_EQ(42, dict.at(biometry::Dictionary::Key{"test"}).integer());
+    EXPECT_EQ(42, dict.at(biometry::Dictionary::Key::from_static("test")).integer());
+    EXPECT_TRUE(dict.find("unknown") == dict.end());
+    EXPECT_THROW(dict.at("unknown"), std::out_of_range);
+}
+
+TEST(Dictionary, static_keys_are_not_copied)
+{
+    static constexpr const char* key{"FingerprintReader::Hints::suggested_next_direction"};
+
+    biometry::Dictionary dict;
+    dict[biometry::Dictionary::Key::from_static(key)] = biometry::Variant::i(42);
+
+    EXPECT_EQ(key, dict.begin()->first.c_str());
+}
+
+TEST(Dictionary, iteration_is_ordered_by_key)
+{
+    biometry::Dictionary dict{{biometry::Dictionary::Key{"c"}, biometry::Variant::i(3)},
+                              {biometry::Dictionary::Key{"a"}, biometry::Variant::i(1)},
+                              {biometry::Dictionary::Key{"b"}, biometry::Variant::i(2)}};
+    dict["ab"] = biometry::Variant::i(4);
+
+    std::vector<std::string> keys;
+    for (const auto& pair : dict)
+        keys.push_back(pair.first.str());
+
+    EXPECT_EQ((std::vector<std::string>{"a", "ab", "b", "c"}), keys);
+}
+
+TEST(Dictionary, insertion_does_not_replace_existing_values)
+{
+    biometry::Dictionary dict;
+    dict["test"] = biometry::Variant::i(42);
+
+    EXPECT_FALSE(dict.insert(std::make_pair(biometry::Dictionary::Key{"test"}, biometry::Variant::i(43))).second);
+    EXPECT_EQ(42, dict.at("test").integer());
+}
+
+TEST(Dictionary, equality_compares_entries)
+{
+    biometry::Dictionary lhs; lhs["a"] = biometry::Variant::i(1); lhs[biometry::Dictionary::Key::from_static("b")] = biometry::Variant::s("2");
+    biometry::Dictionary rhs; rhs["b"] = biometry::Variant::s("2"); rhs["a"] = biometry::Variant::i(1);
+
+    EXPECT_EQ(lhs, rhs);
+    rhs["c"] = biometry::Variant{};
+    EXPECT_NE(lhs, rhs);
+}
+
 TEST(Variant, constructors_yield_correct_type_and_value)
 {
     {const bool rv = true; biometry::Variant v{rv}; EXPECT_EQ(biometry::Variant::Type::boolean, v.type()); EXPECT_EQ(rv, v.boolean());}
@@ -18,11 +18,14 @@
 */
 
 #include <biometry/devices/dispatching.h>
+#include <biometry/devices/dummy.h>
 
 #include "mock_device.h"
 
 #include <gmock/gmock.h>
 
+#include <future>
+
 namespace
 {
 struct MockDispatcher : public biometry::util::Dispatcher
@@ -151,3 +154,45 @@ TEST(DispatchingDevice, calls_into_dispatcher_for_identification)
     op->start_with_observer(mock_observer);
 }
 
+
+TEST(DispatchingDevice, slow_template_store_operation_does_not_delay_identification)
+{
+    using namespace testing;
+
+    std::promise<void> clearance_started, release_clearance;
+    auto clearance_released = release_clearance.get_future().share();
+
+    auto clearance = std::make_shared<NiceMock<MockOperation<biometry::TemplateStore::Clearance>>>();
+    ON_CALL(*clearance, start_with_observer(_)).WillByDefault(Invoke([&clearance_started, clearance_released](const MockOperation<biometry::TemplateStore::Clearance>::Observer::Ptr&)
+    {
+        clearance_started.set_value();
+        clearance_released.wait();
+    }));
+
+    auto template_store = std::make_shared<NiceMock<MockTemplateStore>>();
+    ON_CALL(*template_store, clear(_, _)).WillByDefault(Return(clearance));
+
+    biometry::devices::Dummy dummy;
+    auto device = std::make_shared<NiceMock<MockDevice>>();
+    ON_CALL(*device, template_store()).WillByDefault(ReturnRef(*template_store));
+    ON_CALL(*device, identifier()).WillByDefault(ReturnRef(dummy.identifier()));
+
+    auto rt = biometry::Runtime::create(2);
+    rt->start();
+
+    biometry::devices::Dispatching dispatching{biometry::util::create_dispatcher_factory_for_runtime(rt), device};
+
+    dispatching.template_store().clear(biometry::Application::system(), biometry::User::current())
+            ->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Clearance>>>());
+    ASSERT_EQ(std::future_status::ready, clearance_started.get_future().wait_for(std::chrono::seconds{1}));
+
+    std::promise<void> identified;
+    auto observer = std::make_shared<NiceMock<MockObserver<biometry::Identification>>>();
+    EXPECT_CALL(*observer, on_succeeded(_)).Times(1).WillOnce(InvokeWithoutArgs([&identified]() { identified.set_value(); }));
+
+    dispatching.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown())->start_with_observer(observer);
+    EXPECT_EQ(std::future_status::ready, identified.get_future().wait_for(std::chrono::seconds{1}));
+
+    release_clearance.set_value();
+    rt->stop();
+}
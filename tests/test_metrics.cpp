@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/util/dispatcher.h>
+#include <biometry/util/metrics.h>
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+TEST(Metrics, instruments_are_created_once_per_name)
+{
+    biometry::util::Metrics metrics;
+
+    EXPECT_EQ(&metrics.counter("a"), &metrics.counter("a"));
+    EXPECT_NE(&metrics.counter("a"), &metrics.counter("b"));
+    EXPECT_EQ(&metrics.gauge("a"), &metrics.gauge("a"));
+    EXPECT_EQ(&metrics.latency("a"), &metrics.latency("a"));
+}
+
+TEST(Metrics, counters_and_gauges_are_reflected_in_snapshot)
+{
+    biometry::util::Metrics metrics;
+
+    metrics.counter("requests").increment();
+    metrics.counter("requests").increment(41);
+    metrics.gauge("depth").increment();
+    metrics.gauge("depth").increment();
+    metrics.gauge("depth").decrement();
+
+    auto snapshot = metrics.snapshot();
+    EXPECT_EQ(42u, snapshot.counters.at("requests"));
+    EXPECT_EQ(1, snapshot.gauges.at("depth"));
+}
+
+TEST(Metrics, latency_reports_percentiles_of_recorded_durations)
+{
+    biometry::util::Metrics metrics;
+    auto& latency = metrics.latency("latency_us");
+
+    for (int i = 1; i <= 100; i++)
+        latency.record(std::chrono::microseconds{i});
+
+    auto histogram = metrics.snapshot().latencies.at("latency_us");
+    EXPECT_EQ(100u, histogram.count());
+    EXPECT_EQ(50u, histogram.percentile(50));
+    EXPECT_EQ(99u, histogram.percentile(99));
+}
+
+TEST(Metrics, updates_from_multiple_threads_are_not_lost)
+{
+    static constexpr int threads{8};
+    static constexpr int iterations{10000};
+
+    biometry::util::Metrics metrics;
+    auto& counter = metrics.counter("counter");
+    auto& latency = metrics.latency("latency_us");
+
+    std::vector<std::thread> workers;
+    for (int i = 0; i < threads; i++)
+        workers.emplace_back([&counter, &latency]()
+        {
+            for (int j = 0; j < iterations; j++)
+            {
+                counter.increment();
+                latency.record(std::chrono::microseconds{j});
+            }
+        });
+
+    for (auto& worker : workers)
+        worker.join();
+
+    auto snapshot = metrics.snapshot();
+    EXPECT_EQ(threads * iterations, snapshot.counters.at("counter"));
+    EXPECT_EQ(threads * iterations, snapshot.latencies.at("latency_us").count());
+}
+
+TEST(Metrics, snapshot_is_dumped_as_name_value_pairs)
+{
+    biometry::util::Metrics metrics;
+    metrics.counter("requests").increment(3);
+    metrics.gauge("depth").decrement();
+    metrics.latency("wait_us").record(std::chrono::microseconds{7});
+
+    std::stringstream ss; ss << metrics.snapshot();
+
+    EXPECT_EQ("requests 3\n"
+              "depth -1\n"
+              "wait_us.count 1\n"
+              "wait_us.p50 7\n"
+              "wait_us.p90 7\n"
+              "wait_us.p99 7\n"
+              "wait_us.p999 7\n"
+              "wait_us.max 7\n", ss.str());
+}
+
+TEST(Metrics, dispatcher_reports_queue_depth_and_wait_time)
+{
+    auto rt = biometry::Runtime::create(1);
+    rt->start();
+
+    auto& wait = biometry::util::metrics().latency("dispatcher.wait_us");
+    auto before = wait.histogram().count();
+
+    std::promise<void> promise;
+    biometry::util::create_dispatcher_for_runtime(rt)->dispatch([&promise]() { promise.set_value(); });
+    promise.get_future().wait();
+
+    auto snapshot = biometry::util::metrics().snapshot();
+    EXPECT_EQ(before + 1, snapshot.latencies.at("dispatcher.wait_us").count());
+    EXPECT_EQ(0, snapshot.gauges.at("dispatcher.queue_depth"));
+}
@@ -17,8 +17,10 @@
  *
  */
 
+#include <biometry/devices/plugin/descriptor_cache.h>
 #include <biometry/devices/plugin/device.h>
 #include <biometry/devices/plugin/enumerator.h>
+#include <biometry/devices/plugin/loaded_plugin_cache.h>
 #include <biometry/devices/plugin/verifier.h>
 
 #include <biometry/util/configuration.h>
@@ -43,6 +45,34 @@ struct MockDynamicLibraryApi : public biometry::util::DynamicLibrary::Api
     MOCK_CONST_METHOD0(error, std::string());
 };
 
+// CountingDynamicLibraryApi forwards to the glibc implementation, counting opened and closed libraries.
+struct CountingDynamicLibraryApi : public biometry::util::DynamicLibrary::Api
+{
+    biometry::util::DynamicLibrary::Handle open(const boost::filesystem::path& path) const override
+    {
+        ++opened; return impl->open(path);
+    }
+
+    void close(const biometry::util::DynamicLibrary::Handle& handle) const override
+    {
+        ++closed; impl->close(handle);
+    }
+
+    biometry::util::DynamicLibrary::Symbol sym(const biometry::util::DynamicLibrary::Handle& handle, const std::string& symbol) const override
+    {
+        return impl->sym(handle, symbol);
+    }
+
+    std::string error() const override
+    {
+        return impl->error();
+    }
+
+    std::shared_ptr<biometry::util::DynamicLibrary::Api> impl{biometry::util::glibc::dl_api()};
+    mutable std::size_t opened{0};
+    mutable std::size_t closed{0};
+};
+
 struct MockPluginLoader : public biometry::devices::plugin::Loader
 {
     MOCK_CONST_METHOD2(
@@ -108,6 +138,31 @@ TEST(ElfDescriptorLoader, throws_when_trying_to_load_non_elf_object)
     EXPECT_THROW(loader.load_with_name("test.txt", "DoesNotExist"), std::runtime_error);
 }
 
+TEST(ElfDescriptorLoader, finds_descriptor_in_plugin)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+    biometry::devices::plugin::ElfDescriptorLoader loader;
+    auto desc = loader.find_with_name(p, BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION);
+
+    ASSERT_TRUE(desc.is_initialized());
+    EXPECT_STREQ("TestPlugin", desc->name);
+    EXPECT_STREQ("Thomas Voß <thomas.voss@canonical.com>", desc->author);
+    EXPECT_EQ(biometry::build::version_major, desc->version.host.major);
+}
+
+TEST(ElfDescriptorLoader, finds_nothing_for_missing_section_non_elf_object_and_non_existing_file)
+{
+    std::remove("test.txt");
+    biometry::devices::plugin::ElfDescriptorLoader loader;
+    EXPECT_FALSE(loader.find_with_name("test.txt", BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION).is_initialized());
+
+    {std::ofstream out("test.txt"); out << "\x7f" "ELF but not really";}
+    EXPECT_FALSE(loader.find_with_name("test.txt", BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION).is_initialized());
+
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+    EXPECT_FALSE(loader.find_with_name(p, "DoesNotExist").is_initialized());
+}
+
 TEST(MajorVersionVerifier, throws_when_verifying_plugin_with_major_host_version_mismatch)
 {
     const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl_version_mismatch.so";
@@ -136,3 +191,153 @@ TEST(DirectoryEnumerator, finds_biometryd_plugins)
         EXPECT_NO_THROW(ptr->create(the_empty_config));
     }));
 }
+
+TEST(DescriptorCache, survives_round_trip_through_file)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+    const auto file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path() / "plugins.cache";
+
+    auto key = biometry::devices::plugin::DescriptorCache::Key::for_file(p);
+    ASSERT_TRUE(key.is_initialized());
+    auto other = biometry::devices::plugin::DescriptorCache::Key::for_file(testing::runtime_dir());
+    ASSERT_TRUE(other.is_initialized());
+
+    biometry::devices::plugin::DescriptorCache cache;
+    cache.insert({key.get(), biometry::devices::plugin::ElfDescriptorLoader{}.find_with_name(p, BIOMETRYD_DEVICES_PLUGIN_DESCRIPTOR_SECTION)});
+    cache.insert({other.get(), biometry::Optional<biometry::devices::plugin::Descriptor>{}});
+    ASSERT_NO_THROW(cache.store(file));
+
+    auto loaded = biometry::devices::plugin::DescriptorCache::load(file);
+    EXPECT_EQ(2u, loaded.size());
+
+    auto entry = loaded.find(key.get());
+    ASSERT_TRUE(entry.is_initialized());
+    ASSERT_TRUE(entry->descriptor.is_initialized());
+    EXPECT_STREQ("TestPlugin", entry->descriptor->name);
+
+    auto other_entry = loaded.find(other.get());
+    ASSERT_TRUE(other_entry.is_initialized());
+    EXPECT_FALSE(other_entry->descriptor.is_initialized());
+
+    boost::filesystem::remove_all(file.parent_path());
+}
+
+TEST(DescriptorCache, misses_for_changed_files)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+
+    auto key = biometry::devices::plugin::DescriptorCache::Key::for_file(p);
+    ASSERT_TRUE(key.is_initialized());
+
+    biometry::devices::plugin::DescriptorCache cache;
+    cache.insert({key.get(), biometry::Optional<biometry::devices::plugin::Descriptor>{}});
+    EXPECT_TRUE(cache.find(key.get()).is_initialized());
+
+    auto changed = key.get(); changed.mtime += 1;
+    EXPECT_FALSE(cache.find(changed).is_initialized());
+
+    changed = key.get(); changed.size += 1;
+    EXPECT_FALSE(cache.find(changed).is_initialized());
+
+    changed = key.get(); changed.inode += 1;
+    EXPECT_FALSE(cache.find(changed).is_initialized());
+}
+
+TEST(DescriptorCache, load_yields_empty_cache_for_malformed_file)
+{
+    std::remove("test.txt");
+    {std::ofstream out("test.txt"); out << "not a cache";}
+    EXPECT_EQ(0u, biometry::devices::plugin::DescriptorCache::load("test.txt").size());
+    EXPECT_EQ(0u, biometry::devices::plugin::DescriptorCache::load("does_not_exist.cache").size());
+}
+
+TEST(DirectoryEnumerator, finds_same_plugins_with_populated_cache)
+{
+    const auto cache = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path() / "plugins.cache";
+
+    auto noop = [](const biometry::Device::Descriptor::Ptr&) {};
+
+    biometry::devices::plugin::DirectoryEnumerator uncached{{testing::runtime_dir()}};
+    biometry::devices::plugin::DirectoryEnumerator cached{{testing::runtime_dir()}, cache};
+
+    auto expected = uncached.enumerate(noop);
+    EXPECT_EQ(expected, cached.enumerate(noop));
+    EXPECT_TRUE(boost::filesystem::exists(cache));
+    EXPECT_LT(0u, biometry::devices::plugin::DescriptorCache::load(cache).size());
+    EXPECT_EQ(expected, cached.enumerate(noop));
+
+    boost::filesystem::remove_all(cache.parent_path());
+}
+
+TEST(DirectoryEnumerator, enumerates_multiple_directories)
+{
+    biometry::devices::plugin::DirectoryEnumerator single{{testing::runtime_dir()}};
+    biometry::devices::plugin::DirectoryEnumerator multiple{{testing::runtime_dir(), boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()}};
+
+    auto noop = [](const biometry::Device::Descriptor::Ptr&) {};
+    EXPECT_EQ(single.enumerate(noop), multiple.enumerate(noop));
+}
+
+TEST(LoadedPluginCache, shares_library_among_devices_and_releases_it_with_last_device)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+    auto api = std::make_shared<CountingDynamicLibraryApi>();
+
+    biometry::devices::plugin::LoadedPluginCache cache;
+
+    auto d1 = cache.device(api, p);
+    auto d2 = cache.device(api, p);
+    EXPECT_NE(d1, d2);
+    EXPECT_EQ(1u, api->opened);
+
+    d1.reset();
+    EXPECT_EQ(0u, api->closed);
+    d2.reset();
+    EXPECT_EQ(1u, api->closed);
+
+    auto d3 = cache.device(api, p);
+    EXPECT_EQ(2u, api->opened);
+}
+
+TEST(LoadedPluginCache, pools_devices_with_equal_configuration)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+    auto api = std::make_shared<CountingDynamicLibraryApi>();
+
+    biometry::devices::plugin::LoadedPluginCache cache;
+
+    biometry::util::Configuration c1; c1["answer"] = biometry::Variant::i(42);
+    biometry::util::Configuration c2; c2["answer"] = biometry::Variant::i(42);
+    biometry::util::Configuration c3; c3["answer"] = biometry::Variant::s("42");
+
+    auto d1 = cache.pooled_device(api, p, c1);
+    EXPECT_EQ(d1, cache.pooled_device(api, p, c2));
+    EXPECT_NE(d1, cache.pooled_device(api, p, c3));
+    EXPECT_EQ(1u, api->opened);
+}
+
+TEST(LoadedPluginCache, throws_for_plugin_with_major_host_version_mismatch)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl_version_mismatch.so";
+    auto api = std::make_shared<CountingDynamicLibraryApi>();
+
+    biometry::devices::plugin::LoadedPluginCache cache;
+    EXPECT_THROW(cache.device(api, p), biometry::devices::plugin::MajorVersionVerifier::MajorVersionMismatch);
+    EXPECT_EQ(0u, api->opened);
+}
+
+TEST(PluginDeviceCreate, honors_binding_and_pool_configuration)
+{
+    const auto p = testing::runtime_dir() / "libbiometryd_devices_plugin_dl.so";
+
+    biometry::util::Configuration config;
+    config["binding"] = biometry::Variant::s("lazy");
+    config["pool"] = biometry::Variant::b(true);
+
+    auto d1 = biometry::devices::plugin::create(p, config);
+    EXPECT_NE(nullptr, d1);
+    EXPECT_EQ(d1, biometry::devices::plugin::create(p, config));
+
+    config["pool"] = biometry::Variant::b(false);
+    EXPECT_NE(d1, biometry::devices::plugin::create(p, config));
+}
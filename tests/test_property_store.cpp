@@ -0,0 +1,220 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/util/property_store.h>
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <future>
+#include <thread>
+
+#include "android_property_area.h"
+
+namespace
+{
+struct MappedAndroidPropertyStore : public ::testing::Test
+{
+    MappedAndroidPropertyStore() : dir{boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()}
+    {
+        boost::filesystem::create_directories(dir);
+    }
+
+    ~MappedAndroidPropertyStore()
+    {
+        boost::filesystem::remove_all(dir);
+    }
+
+    boost::filesystem::path dir;
+};
+
+// FakePropertyStore serves properties from a map, standing in for getprop.
+struct FakePropertyStore : public biometry::util::PropertyStore
+{
+    std::string get(const std::string& key) const override
+    {
+        return values.at(key);
+    }
+
+    std::map<std::string, std::string> values;
+};
+}
+
+TEST_F(MappedAndroidPropertyStore, reads_properties_from_single_area)
+{
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("ro.product.device", "turbo");
+    area.set("ro.product.name", "meizu_PRO5");
+    area.set("ro.build.product", "turbo");
+    area.set("persist.sys.locale", "en-US");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    EXPECT_EQ("turbo", store.get("ro.product.device"));
+    EXPECT_EQ("meizu_PRO5", store.get("ro.product.name"));
+    EXPECT_EQ("en-US", store.get("persist.sys.locale"));
+}
+
+TEST_F(MappedAndroidPropertyStore, throws_out_of_range_for_unknown_properties)
+{
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("ro.product.device", "turbo");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    EXPECT_THROW(store.get("ro.product"), std::out_of_range);
+    EXPECT_THROW(store.get("ro.product.device.name"), std::out_of_range);
+    EXPECT_THROW(store.get("ro.product.devic"), std::out_of_range);
+    EXPECT_THROW(store.get(""), std::out_of_range);
+}
+
+TEST_F(MappedAndroidPropertyStore, reads_long_values)
+{
+    const std::string value(200, 'x');
+
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("ro.vendor.fingerprint", value);
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    EXPECT_EQ(value, store.get("ro.vendor.fingerprint"));
+}
+
+TEST_F(MappedAndroidPropertyStore, observes_updated_values)
+{
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("sys.boot_completed", "0");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    EXPECT_EQ("0", store.get("sys.boot_completed"));
+
+    area.set("sys.boot_completed", "1");
+    EXPECT_EQ("1", store.get("sys.boot_completed"));
+}
+
+TEST_F(MappedAndroidPropertyStore, snapshot_contains_all_properties)
+{
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("ro.product.device", "turbo");
+    area.set("ro.product.name", "meizu_PRO5");
+    area.set("ro", "root");
+    area.set("a.b.c.d", "e");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    std::map<std::string, std::string> expected
+    {
+        {"ro.product.device", "turbo"},
+        {"ro.product.name", "meizu_PRO5"},
+        {"ro", "root"},
+        {"a.b.c.d", "e"}
+    };
+    EXPECT_EQ(expected, store.snapshot());
+}
+
+TEST_F(MappedAndroidPropertyStore, reads_properties_from_directory_of_areas)
+{
+    boost::filesystem::create_directories(dir / "__properties__");
+
+    testing::AndroidPropertyArea serial{dir / "__properties__" / "properties_serial"};
+    testing::AndroidPropertyArea default_area{dir / "__properties__" / "u:object_r:default_prop:s0"};
+    testing::AndroidPropertyArea vendor_area{dir / "__properties__" / "u:object_r:vendor_prop:s0"};
+    {std::ofstream out{(dir / "__properties__" / "property_info").string()}; out << "not an area";}
+
+    default_area.set("ro.product.device", "turbo");
+    vendor_area.set("ro.vendor.product", "PRO5");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    EXPECT_EQ("turbo", store.get("ro.product.device"));
+    EXPECT_EQ("PRO5", store.get("ro.vendor.product"));
+    EXPECT_EQ(2u, store.snapshot().size());
+}
+
+TEST_F(MappedAndroidPropertyStore, wait_for_change_returns_once_a_property_changes)
+{
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("sys.boot_completed", "0");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    auto serial = store.serial();
+
+    auto setter = std::async(std::launch::async, [&area]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{50});
+        area.set("sys.boot_completed", "1");
+    });
+
+    auto before = std::chrono::steady_clock::now();
+    EXPECT_NE(serial, store.wait_for_change(serial, std::chrono::seconds{10}));
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::seconds{5});
+    EXPECT_EQ("1", store.get("sys.boot_completed"));
+}
+
+TEST_F(MappedAndroidPropertyStore, wait_for_change_times_out)
+{
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("sys.boot_completed", "0");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__"};
+    auto serial = store.serial();
+
+    EXPECT_EQ(serial, store.wait_for_change(serial, std::chrono::milliseconds{20}));
+}
+
+TEST_F(MappedAndroidPropertyStore, maps_area_once_it_becomes_available)
+{
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__", std::make_shared<FakePropertyStore>()};
+    EXPECT_THROW(store.get("ro.product.device"), std::out_of_range);
+    EXPECT_EQ(0u, store.serial());
+
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("ro.product.device", "turbo");
+    EXPECT_EQ("turbo", store.get("ro.product.device"));
+}
+
+TEST_F(MappedAndroidPropertyStore, falls_back_while_no_area_can_be_mapped)
+{
+    auto fallback = std::make_shared<FakePropertyStore>();
+    fallback->values["ro.product.device"] = "krillin";
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__", fallback};
+    EXPECT_EQ("krillin", store.get("ro.product.device"));
+    EXPECT_THROW(store.get("ro.product.name"), std::out_of_range);
+
+    testing::AndroidPropertyArea area{dir / "__properties__"};
+    area.set("ro.product.device", "turbo");
+    EXPECT_EQ("turbo", store.get("ro.product.device"));
+}
+
+TEST_F(MappedAndroidPropertyStore, retries_mapping_areas_until_all_of_them_are_available)
+{
+    boost::filesystem::create_directories(dir / "__properties__");
+
+    testing::AndroidPropertyArea serial{dir / "__properties__" / "properties_serial"};
+    testing::AndroidPropertyArea default_area{dir / "__properties__" / "u:object_r:default_prop:s0"};
+    // init has created, but not yet initialized the vendor area.
+    {std::ofstream out{(dir / "__properties__" / "u:object_r:vendor_prop:s0").string()};}
+
+    default_area.set("ro.product.device", "turbo");
+
+    biometry::util::MappedAndroidPropertyStore store{dir / "__properties__", std::make_shared<FakePropertyStore>()};
+    EXPECT_EQ("turbo", store.get("ro.product.device"));
+    EXPECT_THROW(store.get("ro.vendor.product"), std::out_of_range);
+
+    testing::AndroidPropertyArea vendor_area{dir / "__properties__" / "u:object_r:vendor_prop:s0"};
+    vendor_area.set("ro.vendor.product", "PRO5");
+    EXPECT_EQ("PRO5", store.get("ro.vendor.product"));
+}
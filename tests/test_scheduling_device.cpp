@@ -0,0 +1,486 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/devices/scheduling.h>
+
+#include <biometry/application.h>
+#include <biometry/reason.h>
+#include <biometry/user.h>
+
+#include <biometry/util/configuration.h>
+#include <biometry/util/metrics.h>
+
+#include <gmock/gmock.h>
+
+#include <future>
+
+#include "mock_device.h"
+
+namespace
+{
+struct SchedulingDevice : public ::testing::Test
+{
+    SchedulingDevice()
+    {
+        using namespace ::testing;
+        ON_CALL(*impl, template_store()).WillByDefault(ReturnRef(template_store));
+        ON_CALL(*impl, identifier()).WillByDefault(ReturnRef(identifier));
+        ON_CALL(*impl, verifier()).WillByDefault(ReturnRef(verifier));
+    }
+
+    // operation returns a mock operation that stores the observer it gets started with in relay.
+    template<typename T>
+    std::shared_ptr<::testing::MockOperation<T>> operation(typename biometry::Operation<T>::Observer::Ptr& relay)
+    {
+        using namespace ::testing;
+
+        auto op = std::make_shared<NiceMock<MockOperation<T>>>();
+        ON_CALL(*op, start_with_observer(_)).WillByDefault(SaveArg<0>(&relay));
+        return op;
+    }
+
+    const biometry::Application app{"com.ubuntu.system-settings"};
+    const biometry::Application shell{biometry::Application::system()};
+    const biometry::User user{biometry::User::current()};
+    const biometry::Reason reason{biometry::Reason::unknown()};
+
+    ::testing::NiceMock<::testing::MockTemplateStore> template_store;
+    ::testing::NiceMock<::testing::MockIdentifier> identifier;
+    ::testing::NiceMock<::testing::MockVerifier> verifier;
+    std::shared_ptr<::testing::MockDevice> impl{std::make_shared<::testing::NiceMock<::testing::MockDevice>>()};
+};
+
+biometry::devices::Scheduling::Policy without_preemption()
+{
+    biometry::devices::Scheduling::Policy policy;
+    policy.preemption = false;
+    return policy;
+}
+}
+
+TEST(Scheduling, throws_for_null_device)
+{
+    EXPECT_THROW(biometry::devices::Scheduling{std::shared_ptr<biometry::Device>{}}, std::runtime_error);
+}
+
+TEST(SchedulingPolicy, unlock_beats_verify_beats_enroll)
+{
+    using Kind = biometry::devices::Scheduling::Kind;
+
+    biometry::devices::Scheduling::Policy policy;
+    biometry::Application app{"com.ubuntu.system-settings"};
+
+    auto unlock = policy.priority_for(Kind::identification, biometry::Application::system());
+    auto verify = policy.priority_for(Kind::verification, app);
+    auto enroll = policy.priority_for(Kind::enrollment, app);
+
+    EXPECT_GT(unlock, verify);
+    EXPECT_GT(verify, enroll);
+    EXPECT_EQ(verify, policy.priority_for(Kind::identification, app));
+    // Only identifications and verifications unlock the device.
+    EXPECT_EQ(enroll, policy.priority_for(Kind::enrollment, biometry::Application::system()));
+}
+
+TEST(SchedulingPolicy, is_read_from_configuration)
+{
+    using Kind = biometry::devices::Scheduling::Kind;
+
+    biometry::util::Configuration config;
+    config["scheduler"]["priorities"]["enrollment"] = biometry::util::Configuration::Node{biometry::Variant::i(7)};
+    config["scheduler"]["unlockApplications"]["0"] = biometry::util::Configuration::Node{biometry::Variant::s("greeter")};
+    config["scheduler"]["unlockPriority"] = biometry::util::Configuration::Node{biometry::Variant::i(9)};
+    config["scheduler"]["preemption"] = biometry::util::Configuration::Node{biometry::Variant::b(false)};
+
+    const auto& node = static_cast<const biometry::util::Configuration&>(config)["scheduler"];
+    auto policy = biometry::devices::Scheduling::Policy::from_configuration(node);
+
+    EXPECT_EQ(7, policy.priority_for(Kind::enrollment, biometry::Application{"greeter"}));
+    EXPECT_EQ(9, policy.priority_for(Kind::identification, biometry::Application{"greeter"}));
+    EXPECT_EQ(3, policy.priority_for(Kind::identification, biometry::Application::system()));
+    EXPECT_FALSE(policy.preemption);
+}
+
+TEST(SchedulingPolicy, reads_preemption_timeout_from_configuration)
+{
+    biometry::util::Configuration config;
+    config["scheduler"]["preemptionTimeoutMs"] = biometry::util::Configuration::Node{biometry::Variant::i(250)};
+
+    const auto& node = static_cast<const biometry::util::Configuration&>(config)["scheduler"];
+    EXPECT_EQ(std::chrono::milliseconds{250}, biometry::devices::Scheduling::Policy::from_configuration(node).preemption_timeout);
+}
+
+TEST(SchedulingPolicy, throws_for_unknown_kind_of_operation)
+{
+    biometry::util::Configuration config;
+    config["scheduler"]["priorities"]["calibration"] = biometry::util::Configuration::Node{biometry::Variant::i(1)};
+
+    const auto& node = static_cast<const biometry::util::Configuration&>(config)["scheduler"];
+    EXPECT_THROW(biometry::devices::Scheduling::Policy::from_configuration(node), std::runtime_error);
+}
+
+TEST_F(SchedulingDevice, operation_on_idle_device_is_started_right_away)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr relay;
+    auto op = operation<biometry::TemplateStore::Enrollment>(relay);
+    EXPECT_CALL(*op, start_with_observer(_)).Times(1);
+    EXPECT_CALL(template_store, enroll(app, user)).Times(1).WillOnce(Return(op));
+
+    auto observer = std::make_shared<MockObserver<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*observer, on_succeeded(5)).Times(1);
+
+    biometry::devices::Scheduling scheduling{impl};
+    scheduling.template_store().enroll(app, user)->start_with_observer(observer);
+
+    ASSERT_NE(nullptr, relay);
+    relay->on_succeeded(5);
+}
+
+TEST_F(SchedulingDevice, template_store_queries_and_modifications_do_not_wait_for_the_sensor)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::Identification>::Observer::Ptr identify_relay;
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(operation<biometry::Identification>(identify_relay)));
+
+    auto size = std::make_shared<MockOperation<biometry::TemplateStore::SizeQuery>>();
+    auto list = std::make_shared<MockOperation<biometry::TemplateStore::List>>();
+    auto removal = std::make_shared<MockOperation<biometry::TemplateStore::Removal>>();
+    auto clearance = std::make_shared<MockOperation<biometry::TemplateStore::Clearance>>();
+    EXPECT_CALL(template_store, size(app, user)).Times(1).WillOnce(Return(size));
+    EXPECT_CALL(template_store, list(app, user)).Times(1).WillOnce(Return(list));
+    EXPECT_CALL(template_store, remove(app, user, 42)).Times(1).WillOnce(Return(removal));
+    EXPECT_CALL(template_store, clear(app, user)).Times(1).WillOnce(Return(clearance));
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    // The identification might well never finish.
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+    ASSERT_NE(nullptr, identify_relay);
+
+    EXPECT_EQ(size, scheduling.template_store().size(app, user));
+    EXPECT_EQ(list, scheduling.template_store().list(app, user));
+    EXPECT_EQ(removal, scheduling.template_store().remove(app, user, 42));
+    EXPECT_EQ(clearance, scheduling.template_store().clear(app, user));
+}
+
+TEST_F(SchedulingDevice, pending_operations_are_started_by_priority)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr first_enroll_relay;
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr second_enroll_relay;
+    biometry::Operation<biometry::Verification>::Observer::Ptr verify_relay;
+    biometry::Operation<biometry::Identification>::Observer::Ptr identify_relay;
+
+    EXPECT_CALL(template_store, enroll(_, _)).Times(2)
+            .WillOnce(Return(operation<biometry::TemplateStore::Enrollment>(first_enroll_relay)))
+            .WillOnce(Return(operation<biometry::TemplateStore::Enrollment>(second_enroll_relay)));
+    ON_CALL(verifier, verify_user(_, _, _)).WillByDefault(Return(operation<biometry::Verification>(verify_relay)));
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(operation<biometry::Identification>(identify_relay)));
+
+    biometry::devices::Scheduling scheduling{impl, without_preemption()};
+
+    auto first_enroll = scheduling.template_store().enroll(app, user);
+    first_enroll->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Enrollment>>>());
+    ASSERT_NE(nullptr, first_enroll_relay);
+
+    auto second_enroll = scheduling.template_store().enroll(app, user);
+    second_enroll->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Enrollment>>>());
+    auto verify = scheduling.verifier().verify_user(app, user, reason);
+    verify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Verification>>>());
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+
+    EXPECT_EQ(nullptr, second_enroll_relay);
+    EXPECT_EQ(nullptr, verify_relay);
+    EXPECT_EQ(nullptr, identify_relay);
+
+    first_enroll_relay->on_succeeded(1);
+    ASSERT_NE(nullptr, identify_relay);
+    EXPECT_EQ(nullptr, verify_relay);
+
+    identify_relay->on_succeeded(user);
+    ASSERT_NE(nullptr, verify_relay);
+    EXPECT_EQ(nullptr, second_enroll_relay);
+
+    verify_relay->on_failed("no finger");
+    ASSERT_NE(nullptr, second_enroll_relay);
+}
+
+TEST_F(SchedulingDevice, operation_failing_to_start_releases_the_device)
+{
+    using namespace ::testing;
+
+    auto failing = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+    ON_CALL(*failing, start_with_observer(_)).WillByDefault(Throw(std::runtime_error{"sensor gone"}));
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(failing));
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(operation<biometry::TemplateStore::Enrollment>(enroll_relay)));
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    auto observer = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*observer, on_failed("sensor gone")).Times(1);
+
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    EXPECT_NO_THROW(identify->start_with_observer(observer));
+
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Enrollment>>>());
+    EXPECT_NE(nullptr, enroll_relay);
+}
+
+TEST_F(SchedulingDevice, pending_operation_failing_to_start_hands_the_device_to_the_next_one)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+    biometry::Operation<biometry::Verification>::Observer::Ptr verify_relay;
+
+    auto failing = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+    ON_CALL(*failing, start_with_observer(_)).WillByDefault(Throw(std::runtime_error{"sensor gone"}));
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(failing));
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(operation<biometry::TemplateStore::Enrollment>(enroll_relay)));
+    ON_CALL(verifier, verify_user(_, _, _)).WillByDefault(Return(operation<biometry::Verification>(verify_relay)));
+
+    biometry::devices::Scheduling scheduling{impl, without_preemption()};
+
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Enrollment>>>());
+
+    auto observer = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*observer, on_failed("sensor gone")).Times(1);
+
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    identify->start_with_observer(observer);
+    auto verify = scheduling.verifier().verify_user(app, user, reason);
+    verify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Verification>>>());
+
+    ASSERT_NE(nullptr, enroll_relay);
+    EXPECT_NO_THROW(enroll_relay->on_succeeded(1));
+    EXPECT_NE(nullptr, verify_relay);
+}
+
+TEST_F(SchedulingDevice, operation_of_higher_priority_preempts_running_operation)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+    biometry::Operation<biometry::Identification>::Observer::Ptr identify_relay;
+
+    auto enrollment = operation<biometry::TemplateStore::Enrollment>(enroll_relay);
+    EXPECT_CALL(*enrollment, cancel()).Times(1);
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(enrollment));
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(operation<biometry::Identification>(identify_relay)));
+
+    auto preemptions = biometry::util::metrics().counter("scheduler.preemptions").value();
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    auto preempted = std::make_shared<MockObserver<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*preempted, on_canceled(biometry::devices::Scheduling::preempted)).Times(1);
+
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(preempted);
+
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+
+    EXPECT_EQ(preemptions + 1, biometry::util::metrics().counter("scheduler.preemptions").value());
+
+    // The identification only gets the device once the enrollment has wound down.
+    EXPECT_EQ(nullptr, identify_relay);
+    ASSERT_NE(nullptr, enroll_relay);
+    enroll_relay->on_canceled("Canceled by device");
+    EXPECT_NE(nullptr, identify_relay);
+}
+
+TEST_F(SchedulingDevice, operation_preempted_while_starting_is_canceled_once_started)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+    biometry::Operation<biometry::Identification>::Observer::Ptr identify_relay;
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    bool starting{false};
+    biometry::Operation<biometry::Identification>::Ptr identify;
+
+    auto enrollment = std::make_shared<NiceMock<MockOperation<biometry::TemplateStore::Enrollment>>>();
+    EXPECT_CALL(*enrollment, start_with_observer(_)).Times(1).WillOnce(Invoke([&](const biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr& observer)
+    {
+        // An identification of higher priority arrives while the enrollment is still starting up.
+        starting = true;
+        enroll_relay = observer;
+        identify = scheduling.identifier().identify_user(shell, reason);
+        identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+        starting = false;
+    }));
+    EXPECT_CALL(*enrollment, cancel()).Times(1).WillOnce(Invoke([&starting]() { EXPECT_FALSE(starting); }));
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(enrollment));
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(operation<biometry::Identification>(identify_relay)));
+
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Enrollment>>>());
+
+    // The identification only gets the device once the enrollment has wound down.
+    EXPECT_EQ(nullptr, identify_relay);
+    ASSERT_NE(nullptr, enroll_relay);
+    enroll_relay->on_canceled("Canceled by device");
+    EXPECT_NE(nullptr, identify_relay);
+}
+
+TEST_F(SchedulingDevice, preempted_operation_not_winding_down_in_time_is_abandoned)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+    auto enrollment = operation<biometry::TemplateStore::Enrollment>(enroll_relay);
+    EXPECT_CALL(*enrollment, cancel()).Times(1);
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(enrollment));
+
+    auto identify_started = std::make_shared<std::promise<void>>();
+    auto identification = std::make_shared<NiceMock<MockOperation<biometry::Identification>>>();
+    ON_CALL(*identification, start_with_observer(_)).WillByDefault(InvokeWithoutArgs([identify_started]() { identify_started->set_value(); }));
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(identification));
+
+    auto abandoned = biometry::util::metrics().counter("scheduler.abandoned").value();
+
+    biometry::devices::Scheduling::Policy policy;
+    policy.preemption_timeout = std::chrono::milliseconds{10};
+    biometry::devices::Scheduling scheduling{impl, policy};
+
+    auto preempted = std::make_shared<MockObserver<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*preempted, on_canceled(biometry::devices::Scheduling::preempted)).Times(1);
+
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(preempted);
+
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+
+    // The enrollment never reports back, the identification gets the device anyway.
+    EXPECT_EQ(std::future_status::ready, identify_started->get_future().wait_for(std::chrono::seconds{5}));
+    EXPECT_EQ(abandoned + 1, biometry::util::metrics().counter("scheduler.abandoned").value());
+
+    // Late reports of the abandoned operation still carry the reason for its cancelation.
+    ASSERT_NE(nullptr, enroll_relay);
+    enroll_relay->on_canceled("Canceled by device");
+}
+
+TEST_F(SchedulingDevice, operation_of_equal_or_lower_priority_does_not_preempt)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::Identification>::Observer::Ptr identify_relay;
+    biometry::Operation<biometry::Verification>::Observer::Ptr verify_relay;
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+
+    auto identification = operation<biometry::Identification>(identify_relay);
+    EXPECT_CALL(*identification, cancel()).Times(0);
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(identification));
+    ON_CALL(verifier, verify_user(_, _, _)).WillByDefault(Return(operation<biometry::Verification>(verify_relay)));
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(operation<biometry::TemplateStore::Enrollment>(enroll_relay)));
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    auto identify = scheduling.identifier().identify_user(app, reason);
+    identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+    auto verify = scheduling.verifier().verify_user(app, user, reason);
+    verify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Verification>>>());
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::TemplateStore::Enrollment>>>());
+
+    EXPECT_EQ(nullptr, verify_relay);
+    EXPECT_EQ(nullptr, enroll_relay);
+}
+
+TEST_F(SchedulingDevice, canceling_pending_operation_reports_cancelation_without_starting_it)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::Identification>::Observer::Ptr identify_relay;
+    biometry::Operation<biometry::TemplateStore::Enrollment>::Observer::Ptr enroll_relay;
+
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(operation<biometry::Identification>(identify_relay)));
+    auto enrollment = operation<biometry::TemplateStore::Enrollment>(enroll_relay);
+    EXPECT_CALL(*enrollment, start_with_observer(_)).Times(0);
+    EXPECT_CALL(*enrollment, cancel()).Times(0);
+    ON_CALL(template_store, enroll(_, _)).WillByDefault(Return(enrollment));
+
+    biometry::devices::Scheduling scheduling{impl, without_preemption()};
+
+    auto identify = scheduling.identifier().identify_user(app, reason);
+    identify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Identification>>>());
+
+    auto observer = std::make_shared<MockObserver<biometry::TemplateStore::Enrollment>>();
+    EXPECT_CALL(*observer, on_canceled(_)).Times(1);
+
+    auto enroll = scheduling.template_store().enroll(app, user);
+    enroll->start_with_observer(observer);
+    enroll->cancel();
+
+    ASSERT_NE(nullptr, identify_relay);
+    identify_relay->on_succeeded(user);
+}
+
+TEST_F(SchedulingDevice, canceling_running_operation_cancels_actual_operation)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::Identification>::Observer::Ptr relay;
+    auto op = operation<biometry::Identification>(relay);
+    EXPECT_CALL(*op, cancel()).Times(1);
+    ON_CALL(identifier, identify_user(_, _)).WillByDefault(Return(op));
+
+    auto observer = std::make_shared<MockObserver<biometry::Identification>>();
+    EXPECT_CALL(*observer, on_canceled("Canceled by requester")).Times(1);
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    auto identify = scheduling.identifier().identify_user(shell, reason);
+    identify->start_with_observer(observer);
+    identify->cancel();
+
+    ASSERT_NE(nullptr, relay);
+    relay->on_canceled("Canceled by requester");
+}
+
+TEST_F(SchedulingDevice, records_queue_wait_times_by_kind)
+{
+    using namespace ::testing;
+
+    biometry::Operation<biometry::Verification>::Observer::Ptr relay;
+    ON_CALL(verifier, verify_user(_, _, _)).WillByDefault(Return(operation<biometry::Verification>(relay)));
+
+    auto& wait = biometry::util::metrics().latency("scheduler.verification.wait_us");
+    auto count = wait.histogram().count();
+
+    biometry::devices::Scheduling scheduling{impl};
+
+    auto verify = scheduling.verifier().verify_user(app, user, reason);
+    verify->start_with_observer(std::make_shared<NiceMock<MockObserver<biometry::Verification>>>());
+
+    EXPECT_EQ(count + 1, wait.histogram().count());
+}
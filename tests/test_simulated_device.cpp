@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+#include <biometry/application.h>
+#include <biometry/reason.h>
+#include <biometry/devices/simulated.h>
+#include <biometry/devices/fingerprint_reader.h>
+
+#include <biometry/util/json_configuration_builder.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+// Observer records all events reported by an operation, allowing
+// test cases to wait for the operation to reach a terminal state.
+template<typename T>
+struct Observer : public biometry::Operation<T>::Observer
+{
+    enum class Outcome
+    {
+        none,
+        canceled,
+        failed,
+        succeeded
+    };
+
+    void on_started() override
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        started = true;
+    }
+
+    void on_progress(const typename T::Progress& progress) override
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        progresses.push_back(progress);
+    }
+
+    void on_canceled(const typename T::Reason&) override
+    {
+        finish(Outcome::canceled);
+    }
+
+    void on_failed(const typename T::Error&) override
+    {
+        finish(Outcome::failed);
+    }
+
+    void on_succeeded(const typename T::Result& r) override
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        result = r;
+        outcome = Outcome::succeeded;
+        terminal_events++;
+        cv.notify_all();
+    }
+
+    void finish(Outcome o)
+    {
+        std::lock_guard<std::mutex> lg{guard};
+        outcome = o;
+        terminal_events++;
+        cv.notify_all();
+    }
+
+    Outcome wait_for_outcome(const std::chrono::milliseconds& timeout = std::chrono::seconds{5})
+    {
+        std::unique_lock<std::mutex> ul{guard};
+        cv.wait_for(ul, timeout, [this]() { return outcome != Outcome::none; });
+        return outcome;
+    }
+
+    std::mutex guard;
+    std::condition_variable cv;
+    bool started{false};
+    std::vector<typename T::Progress> progresses;
+    Outcome outcome{Outcome::none};
+    typename T::Result result{};
+    int terminal_events{0};
+};
+
+biometry::devices::Simulated::Configuration configuration_from_json(const std::string& json)
+{
+    std::stringstream in{json};
+    biometry::util::JsonConfigurationBuilder builder{in};
+    return biometry::devices::Simulated::Configuration::from(builder.build_configuration()["config"]);
+}
+
+biometry::devices::Simulated::Configuration fast_configuration()
+{
+    return configuration_from_json(R"({"config": { "seed": 42, "operations": {
+        "size": { "latency": { "distribution": "fixed", "mean": 1 } },
+        "list": { "latency": { "distribution": "fixed", "mean": 1 } },
+        "enroll": { "latency": { "distribution": "fixed", "mean": 20 }, "progressEvents": 4 },
+        "remove": { "latency": { "distribution": "fixed", "mean": 1 } },
+        "clear": { "latency": { "distribution": "fixed", "mean": 1 } },
+        "identify": { "latency": { "distribution": "fixed", "mean": 1 } },
+        "verify": { "latency": { "distribution": "fixed", "mean": 1 } }
+    }}})");
+}
+
+template<typename T>
+typename Observer<T>::Outcome run(const typename biometry::Operation<T>::Ptr& op, const std::shared_ptr<Observer<T>>& observer)
+{
+    op->start_with_observer(observer);
+    return observer->wait_for_outcome();
+}
+}
+
+TEST(SimulatedDevice, configuration_parses_json)
+{
+    auto config = configuration_from_json(R"({"config": {
+        "seed": 7,
+        "workerThreads": 3,
+        "requireEnrollment": true,
+        "operations": {
+            "identify": {
+                "latency": { "distribution": "lognormal", "mean": 300, "stddev": 50 },
+                "progressEvents": 2,
+                "failureProbability": 0.25,
+                "cancelProbability": 0.5
+            }
+        }
+    }})");
+
+    EXPECT_EQ(7u, config.seed);
+    EXPECT_EQ(3u, config.worker_threads);
+    EXPECT_TRUE(config.require_enrollment);
+    EXPECT_EQ(biometry::devices::Simulated::Latency::Distribution::lognormal, config.identify.latency.distribution);
+    EXPECT_EQ(std::chrono::milliseconds{300}, config.identify.latency.mean);
+    EXPECT_EQ(std::chrono::milliseconds{50}, config.identify.latency.stddev);
+    EXPECT_EQ(2u, config.identify.progress_events);
+    EXPECT_DOUBLE_EQ(0.25, config.identify.failure_probability);
+    EXPECT_DOUBLE_EQ(0.5, config.identify.cancel_probability);
+    // Operations not present in the configuration keep their defaults.
+    EXPECT_LT(0u, config.enroll.progress_events);
+}
+
+TEST(SimulatedDevice, configuration_throws_for_invalid_values)
+{
+    EXPECT_THROW(configuration_from_json(R"({"config": {"operations": {"identify": {"latency": {"distribution": "uniform"}}}}})"), std::invalid_argument);
+    EXPECT_THROW(configuration_from_json(R"({"config": {"operations": {"identify": {"failureProbability": 0.7, "cancelProbability": 0.7}}}})"), std::invalid_argument);
+    EXPECT_THROW(configuration_from_json(R"({"config": {"operations": {"identify": {"latency": {"mean": -1}}}}})"), std::invalid_argument);
+    EXPECT_THROW(configuration_from_json(R"({"config": {"workerThreads": 0}})"), std::invalid_argument);
+}
+
+TEST(SimulatedDevice, latency_samples_follow_distribution)
+{
+    std::mt19937 rng{42};
+
+    biometry::devices::Simulated::Latency fixed;
+    fixed.mean = std::chrono::milliseconds{10};
+    EXPECT_EQ(std::chrono::microseconds{10000}, fixed.sample(rng));
+
+    biometry::devices::Simulated::Latency lognormal;
+    lognormal.distribution = biometry::devices::Simulated::Latency::Distribution::lognormal;
+    lognormal.mean = std::chrono::milliseconds{100};
+    lognormal.stddev = std::chrono::milliseconds{20};
+
+    double sum{0};
+    static constexpr int n{10000};
+    for (int i = 0; i < n; i++)
+    {
+        auto sample = lognormal.sample(rng).count();
+        EXPECT_LE(0, sample);
+        sum += sample;
+    }
+
+    EXPECT_NEAR(100000., sum / n, 2000.);
+}
+
+TEST(SimulatedDevice, enrollment_reports_progress_with_hints_and_stores_template)
+{
+    biometry::devices::Simulated device{fast_configuration()};
+    auto user = biometry::User{42};
+
+    auto enrollment = std::make_shared<Observer<biometry::TemplateStore::Enrollment>>();
+    EXPECT_EQ(Observer<biometry::TemplateStore::Enrollment>::Outcome::succeeded,
+              run<biometry::TemplateStore::Enrollment>(device.template_store().enroll(biometry::Application::system(), user), enrollment));
+
+    EXPECT_TRUE(enrollment->started);
+    ASSERT_EQ(4u, enrollment->progresses.size());
+
+    biometry::devices::FingerprintReader::GuidedEnrollment::Hints hints;
+    hints.from_dictionary(enrollment->progresses.back().details);
+    EXPECT_TRUE(hints.is_finger_present.get());
+    EXPECT_TRUE(hints.masks);
+
+    auto size = std::make_shared<Observer<biometry::TemplateStore::SizeQuery>>();
+    run<biometry::TemplateStore::SizeQuery>(device.template_store().size(biometry::Application::system(), user), size);
+    EXPECT_EQ(1u, size->result);
+
+    auto list = std::make_shared<Observer<biometry::TemplateStore::List>>();
+    run<biometry::TemplateStore::List>(device.template_store().list(biometry::Application::system(), user), list);
+    ASSERT_EQ(1u, list->result.size());
+    EXPECT_EQ(enrollment->result, list->result.front());
+
+    auto removal = std::make_shared<Observer<biometry::TemplateStore::Removal>>();
+    EXPECT_EQ(Observer<biometry::TemplateStore::Removal>::Outcome::succeeded,
+              run<biometry::TemplateStore::Removal>(device.template_store().remove(biometry::Application::system(), user, enrollment->result), removal));
+
+    auto again = std::make_shared<Observer<biometry::TemplateStore::Removal>>();
+    EXPECT_EQ(Observer<biometry::TemplateStore::Removal>::Outcome::failed,
+              run<biometry::TemplateStore::Removal>(device.template_store().remove(biometry::Application::system(), user, enrollment->result), again));
+}
+
+TEST(SimulatedDevice, identification_returns_enrolled_user)
+{
+    auto config = fast_configuration();
+    config.require_enrollment = true;
+    biometry::devices::Simulated device{config};
+
+    auto failing = std::make_shared<Observer<biometry::Identification>>();
+    EXPECT_EQ(Observer<biometry::Identification>::Outcome::failed,
+              run<biometry::Identification>(device.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown()), failing));
+
+    auto enrollment = std::make_shared<Observer<biometry::TemplateStore::Enrollment>>();
+    run<biometry::TemplateStore::Enrollment>(device.template_store().enroll(biometry::Application::system(), biometry::User{42}), enrollment);
+
+    auto identification = std::make_shared<Observer<biometry::Identification>>();
+    EXPECT_EQ(Observer<biometry::Identification>::Outcome::succeeded,
+              run<biometry::Identification>(device.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown()), identification));
+    EXPECT_EQ(biometry::User{42}, identification->result);
+
+    auto verification = std::make_shared<Observer<biometry::Verification>>();
+    run<biometry::Verification>(device.verifier().verify_user(biometry::Application::system(), biometry::User{43}, biometry::Reason::unknown()), verification);
+    EXPECT_EQ(biometry::Verification::Result::not_verified, verification->result);
+}
+
+TEST(SimulatedDevice, failure_and_cancel_probabilities_are_honored)
+{
+    auto config = fast_configuration();
+
+    config.identify.failure_probability = 1.;
+    {
+        biometry::devices::Simulated device{config};
+        auto observer = std::make_shared<Observer<biometry::Identification>>();
+        EXPECT_EQ(Observer<biometry::Identification>::Outcome::failed,
+                  run<biometry::Identification>(device.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown()), observer));
+    }
+
+    config.identify.failure_probability = 0.;
+    config.identify.cancel_probability = 1.;
+    {
+        biometry::devices::Simulated device{config};
+        auto observer = std::make_shared<Observer<biometry::Identification>>();
+        EXPECT_EQ(Observer<biometry::Identification>::Outcome::canceled,
+                  run<biometry::Identification>(device.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown()), observer));
+    }
+}
+
+TEST(SimulatedDevice, cancel_reports_exactly_one_terminal_event)
+{
+    auto config = fast_configuration();
+    config.identify.latency.mean = std::chrono::seconds{10};
+    biometry::devices::Simulated device{config};
+
+    auto observer = std::make_shared<Observer<biometry::Identification>>();
+    auto op = device.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown());
+    op->start_with_observer(observer);
+    op->cancel();
+    op->cancel();
+
+    EXPECT_EQ(Observer<biometry::Identification>::Outcome::canceled, observer->wait_for_outcome(std::chrono::seconds{1}));
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    EXPECT_EQ(1, observer->terminal_events);
+}
+
+TEST(SimulatedDevice, operations_execute_concurrently)
+{
+    auto config = fast_configuration();
+    config.identify.latency.mean = std::chrono::milliseconds{200};
+    config.worker_threads = 1;
+    biometry::devices::Simulated device{config};
+
+    std::vector<std::shared_ptr<Observer<biometry::Identification>>> observers;
+    std::vector<biometry::Operation<biometry::Identification>::Ptr> ops;
+
+    auto before = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++)
+    {
+        observers.push_back(std::make_shared<Observer<biometry::Identification>>());
+        ops.push_back(device.identifier().identify_user(biometry::Application::system(), biometry::Reason::unknown()));
+        ops.back()->start_with_observer(observers.back());
+    }
+
+    for (const auto& observer : observers)
+        EXPECT_EQ(Observer<biometry::Identification>::Outcome::succeeded, observer->wait_for_outcome());
+
+    EXPECT_LT(std::chrono::steady_clock::now() - before, std::chrono::milliseconds{1000});
+}
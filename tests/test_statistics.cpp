@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/util/histogram.h>
+#include <biometry/util/statistics.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+TEST(Histogram, buckets_cover_values_without_gaps)
+{
+    for (std::size_t i = 1; i < biometry::util::Histogram::bucket_count; i++)
+        EXPECT_EQ(biometry::util::Histogram::highest_value_for(i - 1) + 1, biometry::util::Histogram::lowest_value_for(i));
+
+    EXPECT_EQ(biometry::util::Histogram::max_value, biometry::util::Histogram::highest_value_for(biometry::util::Histogram::bucket_count - 1));
+}
+
+TEST(Histogram, values_map_to_bucket_containing_them)
+{
+    for (std::uint64_t value : std::initializer_list<std::uint64_t>{0, 1, 127, 128, 129, 1000, 123456789, biometry::util::Histogram::max_value})
+    {
+        auto index = biometry::util::Histogram::index_for(value);
+        EXPECT_LE(biometry::util::Histogram::lowest_value_for(index), value);
+        EXPECT_GE(biometry::util::Histogram::highest_value_for(index), value);
+    }
+}
+
+TEST(Histogram, percentiles_of_uniform_sample_are_within_precision)
+{
+    biometry::util::Histogram histogram;
+    for (std::uint64_t i = 1; i <= 100000; i++)
+        histogram.record(i);
+
+    for (double p : {50., 95., 99., 99.9})
+    {
+        double expected = p * 1000.;
+        EXPECT_NEAR(expected, histogram.percentile(p), expected / 64.);
+    }
+
+    EXPECT_EQ(1u, histogram.percentile(0));
+    EXPECT_EQ(100000u, histogram.percentile(100));
+}
+
+TEST(Histogram, empty_histogram_reports_zero)
+{
+    EXPECT_EQ(0u, biometry::util::Histogram{}.percentile(99));
+}
+
+TEST(Histogram, percentile_out_of_range_throws)
+{
+    biometry::util::Histogram histogram; histogram.record(42);
+    EXPECT_THROW(histogram.percentile(-1), std::out_of_range);
+    EXPECT_THROW(histogram.percentile(100.1), std::out_of_range);
+}
+
+TEST(Histogram, merging_equals_recording_into_single_instance)
+{
+    biometry::util::Histogram a, b, all;
+    for (std::uint64_t i = 0; i < 1000; i++)
+    {
+        (i % 2 ? a : b).record(i * i);
+        all.record(i * i);
+    }
+
+    a.merge(b);
+    EXPECT_EQ(all.count(), a.count());
+    EXPECT_EQ(all.buckets(), a.buckets());
+}
+
+TEST(Statistics, tracks_moments_of_sample)
+{
+    biometry::util::Statistics stats;
+    for (double d : {2., 4., 4., 4., 5., 5., 7., 9.})
+        stats.update(d);
+
+    EXPECT_EQ(8u, stats.count());
+    EXPECT_DOUBLE_EQ(2., stats.min());
+    EXPECT_DOUBLE_EQ(9., stats.max());
+    EXPECT_DOUBLE_EQ(5., stats.mean());
+    EXPECT_DOUBLE_EQ(4., stats.variance());
+    EXPECT_DOUBLE_EQ(4., stats.percentile(50));
+}
+
+TEST(Statistics, merging_equals_updating_single_instance)
+{
+    std::mt19937 rng{42};
+    std::lognormal_distribution<double> dist{8., 1.};
+
+    biometry::util::Statistics a, b, all;
+    for (int i = 0; i < 10000; i++)
+    {
+        auto d = dist(rng);
+        (i % 3 ? a : b).update(d);
+        all.update(d);
+    }
+
+    a.merge(b);
+    EXPECT_EQ(all.count(), a.count());
+    EXPECT_DOUBLE_EQ(all.min(), a.min());
+    EXPECT_DOUBLE_EQ(all.max(), a.max());
+    EXPECT_NEAR(all.mean(), a.mean(), 1e-9 * all.mean());
+    EXPECT_NEAR(all.variance(), a.variance(), 1e-9 * all.variance());
+    EXPECT_DOUBLE_EQ(all.percentile(99.9), a.percentile(99.9));
+}
@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+
+
+#include <biometry/util/trace.h>
+#include <biometry/util/json.hpp>
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace trace = biometry::util::trace;
+
+TEST(Tracer, is_disabled_by_default_and_records_nothing)
+{
+    trace::Tracer tracer;
+    EXPECT_FALSE(tracer.is_enabled());
+
+    tracer.instant("test", "instant");
+    tracer.complete("test", "complete", trace::Clock::now());
+    { trace::Span span{"test", "span", 0, tracer}; }
+
+    EXPECT_TRUE(tracer.events().empty());
+}
+
+TEST(Tracer, records_instant_and_complete_events_when_enabled)
+{
+    trace::Tracer tracer; tracer.enable();
+
+    tracer.instant("test", "instant", 42);
+    {
+        trace::Span span{"test", "span", 43, tracer};
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    auto events = tracer.events();
+    ASSERT_EQ(2u, events.size());
+
+    EXPECT_EQ(trace::Event::Phase::instant, events[0].phase);
+    EXPECT_STREQ("instant", events[0].name);
+    EXPECT_EQ(42u, events[0].id);
+
+    EXPECT_EQ(trace::Event::Phase::complete, events[1].phase);
+    EXPECT_STREQ("span", events[1].name);
+    EXPECT_EQ(43u, events[1].id);
+    EXPECT_GE(events[1].duration, std::chrono::milliseconds{5});
+    EXPECT_EQ(events[0].tid, events[1].tid);
+}
+
+TEST(Tracer, moved_from_span_does_not_record)
+{
+    trace::Tracer tracer; tracer.enable();
+
+    {
+        trace::Span span{"test", "span", 0, tracer};
+        trace::Span other{std::move(span)};
+    }
+
+    EXPECT_EQ(1u, tracer.events().size());
+}
+
+TEST(Tracer, keeps_most_recent_events_once_ring_wraps_around)
+{
+    static const char* names[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8", "9"};
+
+    trace::Tracer tracer{4}; tracer.enable();
+
+    for (auto name : names)
+        tracer.instant("test", name);
+
+    auto events = tracer.events();
+    ASSERT_EQ(4u, events.size());
+    EXPECT_STREQ("6", events[0].name);
+    EXPECT_STREQ("9", events[3].name);
+}
+
+TEST(Tracer, records_events_of_multiple_threads_into_separate_rings)
+{
+    static constexpr const std::size_t thread_count{4};
+    static constexpr const std::size_t events_per_thread{1000};
+
+    trace::Tracer tracer{events_per_thread}; tracer.enable();
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < thread_count; i++)
+        threads.emplace_back([&tracer]()
+        {
+            for (std::size_t j = 0; j < events_per_thread; j++)
+                tracer.instant("test", "instant", j);
+        });
+
+    // Reading concurrently to the writers must be safe.
+    for (std::size_t i = 0; i < 10; i++)
+        EXPECT_LE(tracer.events().size(), thread_count * events_per_thread);
+
+    for (auto& thread : threads)
+        thread.join();
+
+    auto events = tracer.events();
+    EXPECT_EQ(thread_count * events_per_thread, events.size());
+
+    std::set<std::uint32_t> tids;
+    for (const auto& event : events)
+        tids.insert(event.tid);
+    EXPECT_EQ(thread_count, tids.size());
+
+    for (std::size_t i = 1; i < events.size(); i++)
+        EXPECT_LE(events[i-1].timestamp, events[i].timestamp);
+}
+
+TEST(Tracer, dumps_chrome_trace_event_format)
+{
+    trace::Tracer tracer; tracer.enable();
+
+    tracer.instant("cat", "instant", 1);
+    tracer.complete("cat", "complete", trace::Clock::now() - std::chrono::milliseconds{1}, 2);
+
+    std::stringstream ss; tracer.dump(ss);
+    auto json = nlohmann::json::parse(ss.str());
+
+    ASSERT_TRUE(json["traceEvents"].is_array());
+    ASSERT_EQ(2u, json["traceEvents"].size());
+
+    for (const auto& event : json["traceEvents"])
+    {
+        EXPECT_EQ("cat", event["cat"].get<std::string>());
+        EXPECT_TRUE(event["ts"].is_number());
+        EXPECT_TRUE(event["pid"].is_number());
+        EXPECT_TRUE(event["tid"].is_number());
+
+        if (event["name"] == "instant")
+        {
+            EXPECT_EQ("i", event["ph"].get<std::string>());
+            EXPECT_EQ(1u, event["args"]["id"].get<std::uint64_t>());
+        }
+        else
+        {
+            EXPECT_EQ("X", event["ph"].get<std::string>());
+            EXPECT_GE(event["dur"].get<std::int64_t>(), 1000);
+            EXPECT_EQ(2u, event["args"]["id"].get<std::uint64_t>());
+        }
+    }
+}
+
+TEST(Tracer, keeps_rings_of_most_recently_exited_threads_only)
+{
+    static constexpr const std::size_t thread_count{64};
+
+    trace::Tracer tracer{1}; tracer.enable();
+
+    for (std::size_t i = 0; i < thread_count; i++)
+        std::thread{[&tracer, i]() { tracer.instant("test", "instant", i + 1); }}.join();
+
+    auto events = tracer.events();
+    ASSERT_FALSE(events.empty());
+    EXPECT_LT(events.size(), thread_count);
+    EXPECT_EQ(thread_count, events.back().id);
+}
+
+TEST(Trace, next_id_hands_out_unique_non_zero_ids)
+{
+    auto first = trace::next_id();
+    auto second = trace::next_id();
+
+    EXPECT_NE(0u, first);
+    EXPECT_LT(first, second);
+}
+
+TEST(Trace, correlation_installs_id_for_the_calling_thread_and_restores_the_previous_one)
+{
+    // Without a correlation, every call hands out a new id.
+    EXPECT_NE(trace::correlation_id(), trace::correlation_id());
+
+    {
+        trace::Correlation outer{42};
+        EXPECT_EQ(42u, trace::correlation_id());
+
+        {
+            trace::Correlation inner{43};
+            EXPECT_EQ(43u, trace::correlation_id());
+
+            std::uint64_t other{0};
+            std::thread{[&other]() { other = trace::correlation_id(); }}.join();
+            EXPECT_NE(43u, other);
+        }
+
+        EXPECT_EQ(42u, trace::correlation_id());
+    }
+
+    EXPECT_NE(42u, trace::correlation_id());
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2016 Canonical, Ltd.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; version 3.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Authored by: Thomas Voß <thomas.voss@canonical.com>
+ *
+ */
+
+#include <biometry/progress.h>
+#include <biometry/variant.h>
+#include <biometry/dbus/codec.h>
+
+#include <core/dbus/message.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+namespace
+{
+// We count allocations going through the global operator new, but only on threads
+// inside of an Allocations scope. All other allocations pass straight to malloc.
+std::atomic<std::size_t> allocations{0};
+thread_local bool counting{false};
+
+// Allocations counts the allocations happening on the calling thread during its lifetime.
+struct Allocations
+{
+    Allocations()
+    {
+        counting = true;
+    }
+
+    ~Allocations()
+    {
+        counting = false;
+    }
+
+    std::size_t count() const
+    {
+        return allocations.load() - begin;
+    }
+
+    std::size_t begin{allocations.load()};
+};
+
+biometry::Progress a_progress()
+{
+    biometry::Progress progress;
+    progress.percent = biometry::Percent::from_raw_value(0.42);
+    progress.details["x"] = biometry::Variant::i(42);
+    progress.details["y"] = biometry::Variant::d(0.42);
+    progress.details["roi"] = biometry::Variant::r(biometry::Rectangle{});
+    progress.details["hint"] = biometry::Variant::s("place finger");
+    progress.details["ok"] = biometry::Variant::b(true);
+    return progress;
+}
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting)
+        allocations++;
+
+    if (auto p = std::malloc(size))
+        return p;
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+TEST(Variant, scalars_and_rectangles_do_not_allocate)
+{
+    Allocations allocs;
+
+    biometry::Variant b{true}; biometry::Variant bc{b};
+    biometry::Variant i{std::int64_t{42}}; biometry::Variant ic{i};
+    biometry::Variant d{42.}; biometry::Variant dc{d};
+    biometry::Variant r{biometry::Rectangle{}}; biometry::Variant rc{r};
+    bc = ic; ic = dc; dc = rc;
+
+    EXPECT_EQ(0u, allocs.count());
+}
+
+TEST(Variant, short_strings_do_not_allocate)
+{
+    const std::string s{"short"};
+
+    Allocations allocs;
+    biometry::Variant v{s}; biometry::Variant c{v};
+
+    EXPECT_EQ(0u, allocs.count());
+    EXPECT_EQ(s, c.string());
+}
+
+TEST(Variant, moving_does_not_allocate)
+{
+    biometry::Variant s{std::string(128, 'x')};
+    biometry::Variant bl{std::vector<std::uint8_t>(128, 42)};
+    biometry::Variant v{std::vector<biometry::Variant>{s, bl}};
+
+    Allocations allocs;
+    biometry::Variant ms{std::move(s)}; biometry::Variant mbl{std::move(bl)}; biometry::Variant mv{std::move(v)};
+    s = std::move(ms); bl = std::move(mbl); v = std::move(mv);
+
+    EXPECT_EQ(0u, allocs.count());
+    EXPECT_EQ(std::string(128, 'x'), s.string());
+    EXPECT_EQ(std::vector<std::uint8_t>(128, 42), bl.blob());
+    EXPECT_EQ(2u, v.vector().size());
+}
+
+TEST(Variant, assigning_a_nested_value_works)
+{
+    auto v = biometry::Variant::v({biometry::Variant::s(std::string(128, 'x'))});
+    v = v.vector().front();
+
+    EXPECT_EQ(biometry::Variant::Type::string, v.type());
+    EXPECT_EQ(std::string(128, 'x'), v.string());
+}
+
+TEST(Variant, accessing_with_wrong_type_throws)
+{
+    biometry::Variant v{std::int64_t{42}};
+    EXPECT_ANY_THROW(v.string());
+    EXPECT_ANY_THROW(v.boolean());
+}
+
+// Microbenchmark reporting allocations and time per Progress encode/decode round-trip.
+// Disabled by default, run it with --gtest_also_run_disabled_tests.
+TEST(Variant, DISABLED_benchmark_progress_encode_decode)
+{
+    static constexpr const std::size_t iterations{10000};
+
+    const auto progress = a_progress();
+
+    Allocations allocs;
+    auto start = std::chrono::steady_clock::now();
+
+    for (std::size_t i = 0; i < iterations; i++)
+    {
+        auto msg = core::dbus::Message::make_method_call(
+                    "com.ubuntu.biometryd.Service",
+                    core::dbus::types::ObjectPath{"/"},
+                    "com.ubuntu.biometryd.Service",
+                    "Benchmark");
+
+        {
+            auto writer = msg->writer();
+            writer << progress;
+        }
+
+        biometry::Progress decoded;
+        auto reader = msg->reader(); reader >> decoded;
+    }
+
+    auto duration = std::chrono::steady_clock::now() - start;
+
+    std::cout << "Progress encode/decode: "
+              << static_cast<double>(allocs.count()) / iterations << " allocations, "
+              << std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count() / iterations << " ns per round-trip" << std::endl;
+
+    RecordProperty("allocations_per_round_trip", static_cast<int>(allocs.count() / iterations));
+}